@@ -0,0 +1,96 @@
+#include "bench/baseline.h"
+
+#include <algorithm>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+
+namespace {
+
+static constexpr absl::string_view NAME_KEY = "\"name\": \"";
+static constexpr absl::string_view CPU_TIME_KEY = "\"cpu_time\": ";
+static constexpr absl::string_view TIME_UNIT_KEY = "\"time_unit\": \"";
+
+// Value following `key` in `object`, up to the next character in `end`.
+absl::string_view FindValue(absl::string_view object, absl::string_view key,
+                           absl::string_view end) {
+  const size_t start = object.find(key);
+  if (start == absl::string_view::npos) {
+    return {};
+  }
+  object.remove_prefix(start + key.size());
+  return object.substr(0, object.find_first_of(end));
+}
+
+double NanosecondsPerUnit(absl::string_view unit) {
+  if (unit == "us") {
+    return 1e3;
+  }
+  if (unit == "ms") {
+    return 1e6;
+  }
+  if (unit == "s") {
+    return 1e9;
+  }
+  return 1;
+}
+
+} // namespace
+
+absl::StatusOr<BenchmarkTimes> ParseBenchmarkJson(absl::string_view json) {
+  const size_t benchmarks_start = json.find("\"benchmarks\"");
+  if (benchmarks_start == absl::string_view::npos) {
+    return absl::InvalidArgumentError("No \"benchmarks\" in the JSON output");
+  }
+  json.remove_prefix(benchmarks_start);
+  BenchmarkTimes times;
+  // Each benchmark is an object starting with its name.
+  size_t name_start = json.find(NAME_KEY);
+  while (name_start != absl::string_view::npos) {
+    absl::string_view object = json.substr(name_start);
+    const size_t next_name_start = json.find(NAME_KEY, name_start + 1);
+    object = object.substr(0, next_name_start == absl::string_view::npos
+                                  ? absl::string_view::npos
+                                  : next_name_start - name_start);
+    const absl::string_view name = FindValue(object, NAME_KEY, "\"");
+    double cpu_time;
+    if (!absl::SimpleAtod(FindValue(object, CPU_TIME_KEY, ",\n}"),
+                          &cpu_time)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("No CPU time for benchmark \"%s\"", name));
+    }
+    times[std::string(name)] =
+        cpu_time * NanosecondsPerUnit(FindValue(object, TIME_UNIT_KEY, "\""));
+    name_start = next_name_start;
+  }
+  return times;
+}
+
+std::vector<BenchmarkComparison>
+CompareBenchmarks(const BenchmarkTimes& baseline,
+                  const BenchmarkTimes& current) {
+  std::vector<BenchmarkComparison> comparisons;
+  for (const auto& [name, current_ns] : current) {
+    const auto baseline_time = baseline.find(name);
+    if (baseline_time != baseline.end() && baseline_time->second > 0) {
+      comparisons.push_back({name, baseline_time->second, current_ns});
+    }
+  }
+  return comparisons;
+}
+
+std::string FormatComparisons(
+    const std::vector<BenchmarkComparison>& comparisons) {
+  size_t name_width = 0;
+  for (const BenchmarkComparison& comparison : comparisons) {
+    name_width = std::max(name_width, comparison.name.size());
+  }
+  std::string output;
+  for (const BenchmarkComparison& comparison : comparisons) {
+    absl::StrAppendFormat(&output, "%-*s %12.1f ns %12.1f ns %+7.1f%%\n",
+                          name_width, comparison.name, comparison.baseline_ns,
+                          comparison.current_ns, 100 * comparison.Change());
+  }
+  return output;
+}
@@ -0,0 +1,37 @@
+#ifndef BENCH_BASELINE_H_
+#define BENCH_BASELINE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+// CPU time per iteration of each benchmark, in nanoseconds.
+using BenchmarkTimes = std::map<std::string, double>;
+
+// Reads the times of a run written with --benchmark_out_format=json. Only the
+// fields needed for comparisons are read, relying on the layout Google
+// Benchmark writes rather than parsing JSON in general.
+absl::StatusOr<BenchmarkTimes> ParseBenchmarkJson(absl::string_view json);
+
+struct BenchmarkComparison {
+  std::string name;
+  double baseline_ns = 0;
+  double current_ns = 0;
+
+  // Relative change of the time, positive when slower.
+  double Change() const { return current_ns / baseline_ns - 1; }
+};
+
+// Benchmarks present in both runs, by name.
+std::vector<BenchmarkComparison>
+CompareBenchmarks(const BenchmarkTimes& baseline,
+                  const BenchmarkTimes& current);
+
+// One line per benchmark, with both times and the change in percent.
+std::string FormatComparisons(
+    const std::vector<BenchmarkComparison>& comparisons);
+
+#endif // BENCH_BASELINE_H_
@@ -0,0 +1,63 @@
+#include "bench/baseline.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using ::testing::HasSubstr;
+
+namespace {
+
+static constexpr char BENCHMARK_JSON[] = R"({
+  "context": {
+    "date": "2026-10-19T10:00:00+00:00",
+    "num_cpus": 8
+  },
+  "benchmarks": [
+    {
+      "name": "BM_PositionCopy",
+      "run_name": "BM_PositionCopy",
+      "run_type": "iteration",
+      "iterations": 1000000,
+      "real_time": 1.2000000000000000e+02,
+      "cpu_time": 1.1000000000000000e+02,
+      "time_unit": "ns"
+    },
+    {
+      "name": "BM_GenerateMovesForAPiece/pawn",
+      "run_name": "BM_GenerateMovesForAPiece/pawn",
+      "run_type": "iteration",
+      "iterations": 1000,
+      "real_time": 2.5000000000000000e+00,
+      "cpu_time": 2.0000000000000000e+00,
+      "time_unit": "us",
+      "items_per_second": 1.0e+07
+    }
+  ]
+}
+)";
+
+} // namespace
+
+TEST(ParseBenchmarkJson, CpuTimesInNanoseconds) {
+  absl::StatusOr<BenchmarkTimes> times = ParseBenchmarkJson(BENCHMARK_JSON);
+
+  ASSERT_TRUE(times.ok()) << times.status();
+  EXPECT_EQ(*times, (BenchmarkTimes{{"BM_PositionCopy", 110},
+                                    {"BM_GenerateMovesForAPiece/pawn", 2000}}));
+}
+
+TEST(ParseBenchmarkJson, RejectsOtherFiles) {
+  EXPECT_FALSE(ParseBenchmarkJson("{}").ok());
+  EXPECT_FALSE(
+      ParseBenchmarkJson(R"({"benchmarks": [{"name": "BM_X"}]})").ok());
+}
+
+TEST(CompareBenchmarks, BenchmarksInBothRuns) {
+  const std::vector<BenchmarkComparison> comparisons = CompareBenchmarks(
+      {{"BM_A", 100}, {"BM_B", 200}}, {{"BM_B", 150}, {"BM_C", 10}});
+
+  ASSERT_EQ(comparisons.size(), 1);
+  EXPECT_EQ(comparisons[0].name, "BM_B");
+  EXPECT_DOUBLE_EQ(comparisons[0].Change(), -0.25);
+  EXPECT_THAT(FormatComparisons(comparisons), HasSubstr("-25.0%"));
+}
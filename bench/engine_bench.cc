@@ -0,0 +1,297 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/statusor.h"
+
+#include "bench/baseline.h"
+#include "bench/positions.h"
+#include "engine/arena.h"
+#include "engine/fen.h"
+#include "engine/game_engine.h"
+#include "engine/move.h"
+#include "engine/notation_parser.h"
+#include "engine/position.h"
+
+ABSL_FLAG(std::string, baseline, "",
+          "JSON output of an earlier run, written with --benchmark_out and "
+          "--benchmark_out_format=json, to compare this run with.");
+ABSL_FLAG(double, max_regression_percent, 0,
+          "If positive, fails when a benchmark got slower than the baseline "
+          "by more than this.");
+
+namespace {
+
+static constexpr Kind PIECE_KINDS[] = {Kind::PAWN,   Kind::KNIGHT,
+                                       Kind::BISHOP, Kind::ROOK,
+                                       Kind::QUEEN,  Kind::KING};
+
+// A legal move of a benchmark position, with its notation.
+struct NotatedMove {
+  const FenPosition* position;
+  std::string notation;
+};
+
+// Short algebraic notation of the legal moves of all the positions, e.g. "Nf3"
+// or "exd5", keeping those the parser reads back.
+const std::vector<NotatedMove>& BenchmarkNotations() {
+  static const std::vector<NotatedMove> notations = []() {
+    std::vector<NotatedMove> notations;
+    for (const FenPosition& fen_position : BenchmarkPositions()) {
+      const Position& position = fen_position.position;
+      for (const Move& move :
+           GenerateLegalMoves(position, fen_position.side_to_move)) {
+        const Kind kind = position.GetPiece(move.From()).Kind();
+        const std::string destination = move.ToCoordinateNotation().substr(2);
+        std::string notation;
+        if (kind == Kind::PAWN) {
+          notation = position.HasPiece(move.To())
+                         ? move.ToCoordinateNotation().substr(0, 1) + "x" +
+                               destination
+                         : destination;
+        } else {
+          notation = move.ToAlgebraicNotation().substr(0, 1) + destination;
+        }
+        if (ParseAlgebraicNotation(notation, fen_position.side_to_move,
+                                   position)
+                .ok()) {
+          notations.push_back({&fen_position, notation});
+        }
+      }
+    }
+    return notations;
+  }();
+  return notations;
+}
+
+void BM_GenerateMovesForAPiece(benchmark::State& state, Kind kind) {
+  std::vector<std::pair<const Position*, Square>> pieces;
+  for (const FenPosition& fen_position : BenchmarkPositions()) {
+    for (const Color color : {Color::WHITE, Color::BLACK}) {
+      for (const Square& square :
+           fen_position.position.FindPieces(Piece(kind, color))) {
+        pieces.emplace_back(&fen_position.position, square);
+      }
+    }
+  }
+  for (auto _ : state) {
+    for (const auto& [position, square] : pieces) {
+      benchmark::DoNotOptimize(
+          GenerateMovesForAPiece(*position, square.file, square.rank));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * pieces.size());
+}
+BENCHMARK_CAPTURE(BM_GenerateMovesForAPiece, pawn, Kind::PAWN);
+BENCHMARK_CAPTURE(BM_GenerateMovesForAPiece, knight, Kind::KNIGHT);
+BENCHMARK_CAPTURE(BM_GenerateMovesForAPiece, bishop, Kind::BISHOP);
+BENCHMARK_CAPTURE(BM_GenerateMovesForAPiece, rook, Kind::ROOK);
+BENCHMARK_CAPTURE(BM_GenerateMovesForAPiece, queen, Kind::QUEEN);
+BENCHMARK_CAPTURE(BM_GenerateMovesForAPiece, king, Kind::KING);
+
+void BM_GetSquaresUnderAttack(benchmark::State& state) {
+  const std::vector<FenPosition>& positions = BenchmarkPositions();
+  for (auto _ : state) {
+    for (const FenPosition& fen_position : positions) {
+      benchmark::DoNotOptimize(GetSquaresUnderAttack(
+          fen_position.position, OppositeColor(fen_position.side_to_move)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_GetSquaresUnderAttack);
+
+void BM_MoveIsValid(benchmark::State& state) {
+  // Pseudo-legal moves of both sides, so that some are invalid.
+  std::vector<std::pair<const Position*, Move>> moves;
+  for (const FenPosition& fen_position : BenchmarkPositions()) {
+    for (const Color color : {Color::WHITE, Color::BLACK}) {
+      for (const Move& move : GenerateMoves(fen_position.position, color)) {
+        moves.emplace_back(&fen_position.position, move);
+      }
+    }
+  }
+  for (auto _ : state) {
+    for (const auto& [position, move] : moves) {
+      benchmark::DoNotOptimize(MoveIsValid(*position, move));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * moves.size());
+}
+BENCHMARK(BM_MoveIsValid);
+
+void BM_MovesAreValid(benchmark::State& state) {
+  std::vector<MoveInPosition> moves;
+  for (const FenPosition& fen_position : BenchmarkPositions()) {
+    for (const Color color : {Color::WHITE, Color::BLACK}) {
+      for (const Move& move : GenerateMoves(fen_position.position, color)) {
+        moves.push_back({&fen_position.position, move});
+      }
+    }
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MovesAreValid(moves));
+  }
+  state.SetItemsProcessed(state.iterations() * moves.size());
+}
+BENCHMARK(BM_MovesAreValid);
+
+// Legal moves of all the positions, allocated from the heap, or from the
+// arena of the thread with a nonzero argument, as a search does. Threads
+// share the heap's allocator, but not their arenas.
+void BM_GenerateLegalMoves(benchmark::State& state) {
+  std::optional<ScopedArena> arena;
+  if (state.range(0) != 0) {
+    arena.emplace();
+  }
+  const std::vector<FenPosition>& positions = BenchmarkPositions();
+  for (auto _ : state) {
+    for (const FenPosition& fen_position : positions) {
+      benchmark::DoNotOptimize(GenerateLegalMoves(fen_position.position,
+                                                  fen_position.side_to_move));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_GenerateLegalMoves)->ArgName("arena")->Arg(0)->Arg(1)
+    ->ThreadRange(1, 8)->UseRealTime();
+
+void BM_ParseAlgebraicNotation(benchmark::State& state) {
+  const std::vector<NotatedMove>& notations = BenchmarkNotations();
+  for (auto _ : state) {
+    for (const NotatedMove& notated_move : notations) {
+      benchmark::DoNotOptimize(ParseAlgebraicNotation(
+          notated_move.notation, notated_move.position->side_to_move,
+          notated_move.position->position));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * notations.size());
+}
+BENCHMARK(BM_ParseAlgebraicNotation);
+
+void BM_MakeMove(benchmark::State& state) {
+  std::vector<Position> positions;
+  std::vector<MoveList> moves;
+  for (const FenPosition& fen_position : BenchmarkPositions()) {
+    positions.push_back(fen_position.position);
+    moves.push_back(GenerateLegalMoves(fen_position.position,
+                                       fen_position.side_to_move));
+  }
+  int64_t moves_made = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < positions.size(); ++i) {
+      for (const Move& move : moves[i]) {
+        const UndoRecord undo =
+            positions[i].MakeMove(move.From(), move.To(), move.Promotion());
+        benchmark::DoNotOptimize(positions[i]);
+        positions[i].UnmakeMove(undo);
+      }
+      moves_made += moves[i].size();
+    }
+  }
+  state.SetItemsProcessed(moves_made);
+}
+BENCHMARK(BM_MakeMove);
+
+void BM_PositionCopy(benchmark::State& state) {
+  const std::vector<FenPosition>& positions = BenchmarkPositions();
+  for (auto _ : state) {
+    for (const FenPosition& fen_position : positions) {
+      Position copy = fen_position.position;
+      benchmark::DoNotOptimize(copy);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_PositionCopy);
+
+void BM_FindPieces(benchmark::State& state) {
+  const std::vector<FenPosition>& positions = BenchmarkPositions();
+  for (auto _ : state) {
+    for (const FenPosition& fen_position : positions) {
+      for (const Kind kind : PIECE_KINDS) {
+        for (const Color color : {Color::WHITE, Color::BLACK}) {
+          benchmark::DoNotOptimize(
+              fen_position.position.FindPieces(Piece(kind, color)));
+        }
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size() *
+                          std::size(PIECE_KINDS) * 2);
+}
+BENCHMARK(BM_FindPieces);
+
+// Prints the usual console output, and keeps the times for the comparison
+// with the baseline.
+class RecordingReporter : public benchmark::ConsoleReporter {
+ public:
+  void ReportRuns(const std::vector<Run>& runs) override {
+    ConsoleReporter::ReportRuns(runs);
+    for (const Run& run : runs) {
+      times_[run.benchmark_name()] =
+          run.GetAdjustedCPUTime() * 1e9 /
+          benchmark::GetTimeUnitMultiplier(run.time_unit);
+    }
+  }
+
+  const BenchmarkTimes& Times() const { return times_; }
+
+ private:
+  BenchmarkTimes times_;
+};
+
+} // namespace
+
+// Runs the benchmarks, taking Google Benchmark flags such as --benchmark_out
+// for JSON output, and compares them with --baseline if given.
+int main(int argc, char* argv[]) {
+  benchmark::Initialize(&argc, argv);
+  absl::ParseCommandLine(argc, argv);
+
+  RecordingReporter reporter;
+  benchmark::RunSpecifiedBenchmarks(&reporter);
+  benchmark::Shutdown();
+
+  const std::string baseline_path = absl::GetFlag(FLAGS_baseline);
+  if (baseline_path.empty()) {
+    return 0;
+  }
+  std::ifstream baseline_file(baseline_path);
+  std::stringstream baseline_json;
+  baseline_json << baseline_file.rdbuf();
+  absl::StatusOr<BenchmarkTimes> baseline =
+      ParseBenchmarkJson(baseline_json.str());
+  if (!baseline_file || !baseline.ok()) {
+    std::cerr << "Couldn't read the baseline " << baseline_path << ": "
+              << baseline.status() << std::endl;
+    return 1;
+  }
+  const std::vector<BenchmarkComparison> comparisons =
+      CompareBenchmarks(*baseline, reporter.Times());
+  std::cout << "\nComparison with " << baseline_path << ":\n"
+            << FormatComparisons(comparisons);
+
+  const double max_regression = absl::GetFlag(FLAGS_max_regression_percent);
+  int regressions = 0;
+  for (const BenchmarkComparison& comparison : comparisons) {
+    regressions += max_regression > 0 &&
+                   100 * comparison.Change() > max_regression;
+  }
+  if (regressions > 0) {
+    std::cout << regressions << " benchmarks regressed by more than "
+              << max_regression << "%" << std::endl;
+    return 1;
+  }
+  return 0;
+}
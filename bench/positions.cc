@@ -0,0 +1,35 @@
+#include "bench/positions.h"
+
+namespace {
+
+static constexpr const char* POSITION_FENS[] = {
+    // Openings.
+    STARTING_POSITION_FEN,
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "r1bqkbnr/pppp1ppp/2n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+    "rnbqk2r/ppp1bppp/4pn2/3p4/2PP4/2N2N2/PP2PPPP/R1BQKB1R w KQkq - 4 5",
+    // Middlegames.
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 9",
+    "r2q1rk1/1b2bppp/p2ppn2/1p6/3NP3/1BN1B3/PPP2PPP/R2Q1RK1 w - - 2 12",
+    "2rq1rk1/pb1nbppp/1p2pn2/2pp4/2PP4/1PN1PN2/PB2BPPP/2RQ1RK1 w - - 4 12",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1b2rk1/2q1bppp/p2ppn2/1p6/3BPP2/2N2B2/PPP3PP/R2Q1R1K w - - 4 14",
+    // Endings.
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/4kpp1/3p1b2/p6P/2B5/6P1/6K1 b - - 0 47",
+    "8/5pk1/6p1/8/2Q5/6P1/5PK1/3q4 w - - 0 60",
+};
+
+} // namespace
+
+const std::vector<FenPosition>& BenchmarkPositions() {
+  static const std::vector<FenPosition> positions = []() {
+    std::vector<FenPosition> positions;
+    for (const char* fen : POSITION_FENS) {
+      positions.push_back(*ParseFen(fen));
+    }
+    return positions;
+  }();
+  return positions;
+}
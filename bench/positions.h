@@ -0,0 +1,12 @@
+#ifndef BENCH_POSITIONS_H_
+#define BENCH_POSITIONS_H_
+
+#include <vector>
+
+#include "engine/fen.h"
+
+// Fixed positions the benchmarks run over, from openings, middlegames and
+// endings of real games, so that results are comparable between runs.
+const std::vector<FenPosition>& BenchmarkPositions();
+
+#endif // BENCH_POSITIONS_H_
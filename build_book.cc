@@ -0,0 +1,44 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+#include "engine/book_builder.h"
+#include "engine/opening_book.h"
+
+ABSL_FLAG(std::string, output, "book.bin", "Path of the book file to write.");
+ABSL_FLAG(int, threads, std::thread::hardware_concurrency(),
+          "Number of threads replaying the games.");
+ABSL_FLAG(int, max_plies, 30,
+          "Number of plies from the start of each game to put in the book.");
+ABSL_FLAG(int, min_games, 2,
+          "Moves played in fewer games are left out of the book.");
+
+// Builds an opening book from the PGN files given as arguments.
+int main(int argc, char* argv[]) {
+  const std::vector<char*> arguments = absl::ParseCommandLine(argc, argv);
+  const std::vector<std::string> pgn_paths(arguments.begin() + 1,
+                                           arguments.end());
+  BookBuilderOptions options;
+  options.threads = absl::GetFlag(FLAGS_threads);
+  options.max_plies = absl::GetFlag(FLAGS_max_plies);
+  options.min_games = absl::GetFlag(FLAGS_min_games);
+  absl::StatusOr<BookBuildResult> book = BuildBook(pgn_paths, options);
+  absl::Status status = book.status();
+  if (status.ok()) {
+    status = WriteBook(book->entries, absl::GetFlag(FLAGS_output));
+  }
+  if (!status.ok()) {
+    std::cerr << status << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << book->entries.size() << " moves from "
+            << book->games << " games, skipped " << book->skipped_games
+            << " games" << std::endl;
+  return 0;
+}
@@ -1,22 +1,186 @@
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
 #include <string>
+#include <thread>
+#include <utility>
 
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 
 #include "engine/game.h"
+#include "engine/latency.h"
 #include "engine/move.h"
 #include "engine/notation_parser.h"
+#include "engine/opening_book.h"
+#include "engine/search.h"
+#include "engine/stats.h"
+#include "engine/time_manager.h"
+#include "engine/transposition_table.h"
+
+ABSL_FLAG(std::string, book, "",
+          "Opening book file written by build_book, to play moves from "
+          "without searching.");
+ABSL_FLAG(std::string, latency_clock, "off",
+          "Clock timing engine operations for the \"latency\" command: off, "
+          "steady or tsc.");
 
 namespace {
 
+static constexpr size_t ENGINE_TABLE_SIZE_IN_MEGABYTES = 64;
+static constexpr int64_t DEFAULT_ENGINE_MOVE_TIME_MS = 1000;
+static constexpr char MOVE_TIME_COMMAND[] = "movetime ";
+
+// Searches for a reply to the move the opponent is expected to play, while the
+// opponent is still thinking. The search runs without a time limit until the
+// opponent plays the expected move, and then goes on with the engine's move
+// time from that moment on.
+class Ponderer {
+ public:
+  Ponderer(const Game& game, const Move& expected_move,
+           const TimeControl& control, TranspositionTable* table)
+      : game_(game), expected_move_(PackMove(expected_move)),
+        time_manager_(control, /*pondering=*/true) {
+    game_.MakeMove(expected_move);
+    options_.depth = MAX_SEARCH_DEPTH;
+    options_.time_manager = &time_manager_;
+    options_.stop = &stop_;
+    options_.game_hashes = game_.ReversibleHashes();
+    options_.halfmove_clock = game_.HalfmoveClock();
+    thread_ = std::thread([this, table]() {
+      result_ = SearchBestMove(game_.Position(), game_.ActivePlayerColor(),
+                               options_, table);
+    });
+  }
+
+  // Abandons the search if the opponent played something else.
+  ~Ponderer() {
+    stop_ = true;
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  bool IsExpected(const Move& move) const {
+    return PackMove(move) == expected_move_;
+  }
+
+  // Starts the clock and waits for the search to complete.
+  SearchResult PonderHit() {
+    time_manager_.PonderHit();
+    thread_.join();
+    return result_;
+  }
+
+ private:
+  Game game_;
+  uint16_t expected_move_;
+  TimeManager time_manager_;
+  std::atomic<bool> stop_{false};
+  SearchOptions options_;
+  SearchResult result_;
+  std::thread thread_;
+};
+
+struct Engine {
+  // Side played by the engine, if any.
+  std::optional<Color> color;
+  TimeControl time_control;
+  TranspositionTable table{ENGINE_TABLE_SIZE_IN_MEGABYTES};
+  std::unique_ptr<Ponderer> ponderer;
+  std::optional<OpeningBook> book;
+  std::mt19937_64 random{std::random_device{}()};
+
+  Engine() { time_control.move_time_ms = DEFAULT_ENGINE_MOVE_TIME_MS; }
+};
+
 void PrintGameState(const Game& game) {
   std::cout << "Turn " << game.Turn() << " ("
             << (game.ActivePlayerColor() == Color::BLACK ? "Black" : "White")
             << ")" << std::endl;
   std::cout << game.Position().ToString() << std::endl;
+  if (game.IsThreefoldRepetition()) {
+    std::cout << "Draw by threefold repetition can be claimed" << std::endl;
+  } else if (game.IsFiftyMoveDraw()) {
+    std::cout << "Draw by the fifty-move rule can be claimed" << std::endl;
+  }
+}
+
+// Plays the engine's move found by `result`, and starts pondering on the
+// expected reply.
+void PlayEngineMove(const SearchResult& result, Game& game, Engine& engine) {
+  if (!result.best_move.has_value()) {
+    return;
+  }
+  const Move move(&game.Position(), result.best_move->From(),
+                  result.best_move->To(), result.best_move->Promotion());
+  std::cout << "Engine plays " << move << " (depth " << result.depth
+            << ", score " << result.score << ")" << std::endl;
+  game.MakeMove(move);
+
+  if (result.principal_variation.size() >= 2) {
+    engine.ponderer = std::make_unique<Ponderer>(
+        game, result.principal_variation[1], engine.time_control,
+        &engine.table);
+  }
+}
+
+// Plays a move from the book instantly, if the position is in the book.
+bool PlayBookMove(Game& game, Engine& engine) {
+  if (!engine.book.has_value()) {
+    return false;
+  }
+  const std::optional<Move> move = engine.book->PickMove(
+      game.Position(), game.ActivePlayerColor(), engine.random());
+  if (!move.has_value()) {
+    return false;
+  }
+  std::cout << "Engine plays " << *move << " from the book" << std::endl;
+  game.MakeMove(*move);
+  return true;
+}
+
+void SearchAndPlayEngineMove(Game& game, Engine& engine) {
+  if (PlayBookMove(game, engine)) {
+    return;
+  }
+  const TimeManager time_manager(engine.time_control);
+  SearchOptions options;
+  options.depth = MAX_SEARCH_DEPTH;
+  options.time_manager = &time_manager;
+  options.game_hashes = game.ReversibleHashes();
+  options.halfmove_clock = game.HalfmoveClock();
+  PlayEngineMove(SearchBestMove(game.Position(), game.ActivePlayerColor(),
+                                options, &engine.table),
+                 game, engine);
+}
+
+// Plays the opponent's move, and replies if the engine is playing.
+void PlayMove(const Move& move, Game& game, Engine& engine) {
+  std::unique_ptr<Ponderer> ponderer = std::move(engine.ponderer);
+  const bool ponder_hit = ponderer != nullptr && ponderer->IsExpected(move);
+  if (!ponder_hit) {
+    ponderer.reset();
+  }
+  game.MakeMove(move);
+  if (engine.color != game.ActivePlayerColor()) {
+    return;
+  }
+  if (ponder_hit) {
+    PlayEngineMove(ponderer->PonderHit(), game, engine);
+  } else {
+    SearchAndPlayEngineMove(game, engine);
+  }
 }
 
-bool ParseInputAndReact(const std::string& input, Game& game) {
+bool ParseInputAndReact(const std::string& input, Game& game,
+                        Engine& engine) {
   if (input.empty()) {
     return false;
   }
@@ -27,11 +191,51 @@ bool ParseInputAndReact(const std::string& input, Game& game) {
     std::cout << game.Position().ToString() << std::endl;
     return false;
   }
+  // Counts of engine operations since the start or the last "stats reset".
+  if (input == "stats") {
+    std::cout << FormatStats(ReadStats());
+    return false;
+  }
+  if (input == "stats reset") {
+    ResetStats();
+    return false;
+  }
+  // Latency percentiles of engine operations, if timed with --latency_clock.
+  if (input == "latency") {
+    std::cout << FormatLatenciesText(ReadLatencies());
+    return false;
+  }
+  if (input == "latency json") {
+    std::cout << FormatLatenciesJson(ReadLatencies()) << std::endl;
+    return false;
+  }
+  if (input == "latency reset") {
+    ResetLatencies();
+    return false;
+  }
+  // The engine takes over the side to move.
+  if (input == "engine") {
+    engine.ponderer.reset();
+    engine.color = game.ActivePlayerColor();
+    SearchAndPlayEngineMove(game, engine);
+    return false;
+  }
+  if (absl::StartsWith(input, MOVE_TIME_COMMAND)) {
+    int64_t move_time_ms;
+    if (absl::SimpleAtoi(input.substr(sizeof(MOVE_TIME_COMMAND) - 1),
+                         &move_time_ms) &&
+        move_time_ms > 0) {
+      engine.time_control.move_time_ms = move_time_ms;
+    } else {
+      std::cout << "Couldn't parse move time: " << input << std::endl;
+    }
+    return false;
+  }
 
   absl::StatusOr<Move> move_or =
       ParseAlgebraicNotation(input, game.ActivePlayerColor(), game.Position());
   if (move_or.ok()) {
-    game.MakeMove(*move_or);
+    PlayMove(*move_or, game, engine);
     return false;
   }
 
@@ -41,8 +245,31 @@ bool ParseInputAndReact(const std::string& input, Game& game) {
 
 } // namespace
 
-int main() {
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
   Game game;
+  Engine engine;
+  const std::string book_path = absl::GetFlag(FLAGS_book);
+  if (!book_path.empty()) {
+    absl::StatusOr<OpeningBook> book = OpeningBook::Open(book_path);
+    if (!book.ok()) {
+      std::cerr << book.status() << std::endl;
+      return 1;
+    }
+    engine.book.emplace(*std::move(book));
+  }
+  const std::string latency_clock = absl::GetFlag(FLAGS_latency_clock);
+  if (latency_clock == "steady") {
+    SetLatencyClock(LatencyClock::STEADY_CLOCK);
+  } else if (latency_clock == "tsc") {
+    if (!SetLatencyClock(LatencyClock::TSC)) {
+      std::cerr << "No time stamp counter on this processor" << std::endl;
+      return 1;
+    }
+  } else if (latency_clock != "off") {
+    std::cerr << "Unknown latency clock: " << latency_clock << std::endl;
+    return 1;
+  }
   while (true) {
     PrintGameState(game);
     std::string line;
@@ -50,10 +277,10 @@ int main() {
     if (std::cin.eof()) {
       break;
     }
-    if (ParseInputAndReact(line, game)) {
+    if (ParseInputAndReact(line, game, engine)) {
       break;
     }
   }
 
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+#include "engine/arena.h"
+
+#include <algorithm>
+
+namespace {
+
+thread_local std::pmr::memory_resource* transient_memory = nullptr;
+thread_local int arena_depth = 0;
+
+} // namespace
+
+Arena::Arena(size_t initial_size)
+    : buffer_size_(initial_size),
+      buffer_(std::make_unique_for_overwrite<std::byte[]>(initial_size)),
+      next_(buffer_.get()),
+      end_(buffer_.get() + initial_size) {}
+
+Arena::~Arena() = default;
+
+void Arena::Reset() {
+  if (overflow_bytes_ > 0) {
+    buffer_size_ += overflow_bytes_;
+    buffer_ = std::make_unique_for_overwrite<std::byte[]>(buffer_size_);
+    overflow_chunks_.clear();
+    overflow_bytes_ = 0;
+  }
+  next_ = buffer_.get();
+  end_ = buffer_.get() + buffer_size_;
+  std::fill(std::begin(free_blocks_), std::end(free_blocks_), nullptr);
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+  if (!IsPooled(bytes, alignment)) {
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  const size_t size_class = SizeClass(bytes);
+  if (FreeBlock* block = free_blocks_[size_class]) {
+    free_blocks_[size_class] = block->next;
+    return block;
+  }
+  const size_t block_size = (size_class + 1) * GRANULE;
+  if (static_cast<size_t>(end_ - next_) < block_size) {
+    Overflow(block_size);
+  }
+  void* block = next_;
+  next_ += block_size;
+  return block;
+}
+
+void Arena::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+  if (!IsPooled(bytes, alignment)) {
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    return;
+  }
+  FreeBlock* block = static_cast<FreeBlock*>(pointer);
+  const size_t size_class = SizeClass(bytes);
+  block->next = free_blocks_[size_class];
+  free_blocks_[size_class] = block;
+}
+
+void Arena::Overflow(size_t bytes) {
+  // Chunks grow with the arena, so that few are needed however much of it a
+  // search takes.
+  const size_t chunk_size =
+      std::max(bytes, std::max(buffer_size_, overflow_bytes_) / 2);
+  overflow_chunks_.push_back(
+      std::make_unique_for_overwrite<std::byte[]>(chunk_size));
+  overflow_bytes_ += chunk_size;
+  next_ = overflow_chunks_.back().get();
+  end_ = next_ + chunk_size;
+}
+
+std::pmr::memory_resource* TransientMemory() {
+  return transient_memory != nullptr ? transient_memory
+                                     : std::pmr::get_default_resource();
+}
+
+ScopedTransientMemory::ScopedTransientMemory(std::pmr::memory_resource* memory)
+    : previous_(transient_memory) {
+  transient_memory = memory;
+}
+
+ScopedTransientMemory::~ScopedTransientMemory() {
+  transient_memory = previous_;
+}
+
+ScopedArena::ScopedArena()
+    : memory_(&ThreadArena()), outermost_(arena_depth++ == 0) {}
+
+ScopedArena::~ScopedArena() {
+  --arena_depth;
+  if (outermost_) {
+    ThreadArena().Reset();
+  }
+}
+
+Arena& ScopedArena::ThreadArena() {
+  // Only threads which use their arena pay for it.
+  thread_local std::unique_ptr<Arena> arena = std::make_unique<Arena>();
+  return *arena;
+}
@@ -0,0 +1,114 @@
+#ifndef ENGINE_ARENA_H_
+#define ENGINE_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Memory for the containers the engine returns from move generation and
+// board queries, which live for a few calls at most. By default they come
+// from the heap, whose allocator is shared by all the threads. Within a
+// ScopedArena they come from an arena of the thread instead, without ever
+// taking a lock, and are all released at once when the scope ends.
+//
+// Containers allocated within a scope must not outlive it, and must be freed
+// on the thread which allocated them.
+
+static constexpr size_t DEFAULT_ARENA_SIZE = 256 * 1024;
+
+// Blocks bumped off a buffer. Freed blocks are kept in lists by size for
+// reuse, so that a long search doesn't keep growing the arena. Not
+// thread-safe.
+class Arena : public std::pmr::memory_resource {
+ public:
+  explicit Arena(size_t initial_size = DEFAULT_ARENA_SIZE);
+  ~Arena() override;
+
+  // Frees all the blocks at once. The buffer grows to what was used since the
+  // previous reset, so that the next search or game fits in it again.
+  void Reset();
+
+  // Size of the buffer blocks are bumped off before more is taken from the
+  // heap.
+  size_t BufferSize() const { return buffer_size_; }
+
+  // Bytes taken from the heap since the last reset, once the buffer ran out.
+  size_t OverflowBytes() const { return overflow_bytes_; }
+
+ private:
+  // Blocks are multiples of this, which is also the largest alignment they
+  // get. Larger blocks or alignments come from the heap.
+  static constexpr size_t GRANULE = 16;
+  static constexpr size_t MAX_BLOCK_SIZE = 4096;
+  static constexpr size_t SIZE_CLASS_COUNT = MAX_BLOCK_SIZE / GRANULE;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  static size_t SizeClass(size_t bytes) {
+    return bytes == 0 ? 0 : (bytes - 1) / GRANULE;
+  }
+  static bool IsPooled(size_t bytes, size_t alignment) {
+    return bytes <= MAX_BLOCK_SIZE && alignment <= GRANULE;
+  }
+  // Takes another chunk from the heap for blocks of at least `bytes`.
+  void Overflow(size_t bytes);
+
+  size_t buffer_size_;
+  std::unique_ptr<std::byte[]> buffer_;
+  // Chunks taken from the heap since the last reset.
+  std::vector<std::unique_ptr<std::byte[]>> overflow_chunks_;
+  size_t overflow_bytes_ = 0;
+  // Unused part of the buffer or of the last chunk.
+  std::byte* next_ = nullptr;
+  std::byte* end_ = nullptr;
+  FreeBlock* free_blocks_[SIZE_CLASS_COUNT] = {};
+};
+
+// Memory for the engine containers allocated by the calling thread: its arena
+// within a ScopedArena, and the default resource otherwise.
+std::pmr::memory_resource* TransientMemory();
+
+// Makes the calling thread allocate engine containers from `memory` until the
+// end of the scope, e.g. from the heap for work which may move to another
+// thread before it ends.
+class ScopedTransientMemory {
+ public:
+  explicit ScopedTransientMemory(std::pmr::memory_resource* memory);
+  ~ScopedTransientMemory();
+
+  ScopedTransientMemory(const ScopedTransientMemory&) = delete;
+  ScopedTransientMemory& operator=(const ScopedTransientMemory&) = delete;
+
+ private:
+  std::pmr::memory_resource* previous_;
+};
+
+// Makes the calling thread allocate engine containers from its arena, created
+// on first use, until the end of the scope, e.g. a root search or a game.
+// Nested scopes share the arena of the outermost one, which resets it.
+class ScopedArena {
+ public:
+  ScopedArena();
+  ~ScopedArena();
+
+  ScopedArena(const ScopedArena&) = delete;
+  ScopedArena& operator=(const ScopedArena&) = delete;
+
+  // The arena of the calling thread, e.g. to see how much of it is used.
+  static Arena& ThreadArena();
+
+ private:
+  ScopedTransientMemory memory_;
+  bool outermost_;
+};
+
+#endif // ENGINE_ARENA_H_
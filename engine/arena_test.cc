@@ -0,0 +1,139 @@
+#include "engine/arena.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "engine/search.h"
+
+namespace {
+
+// Allocations taken from the heap by the whole test, through any form of
+// operator new, which all end up in this one.
+std::atomic<int64_t> heap_allocations(0);
+
+} // namespace
+
+void* operator new(size_t size) {
+  ++heap_allocations;
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+// GCC takes the memory these free for memory from the operator new it
+// replaces.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+TEST(Arena, AllocatesFromItsBuffer) {
+  Arena arena;
+  std::pmr::vector<int> numbers(&arena);
+  numbers.reserve(16);
+  numbers.push_back(1);
+  EXPECT_EQ(numbers.front(), 1);
+  EXPECT_EQ(arena.OverflowBytes(), 0);
+}
+
+TEST(Arena, GrowsToWhatWasUsedOnReset) {
+  Arena arena;
+  const auto allocate_twice_the_buffer = [&]() {
+    for (size_t i = 0; i < 2 * DEFAULT_ARENA_SIZE / 64; ++i) {
+      EXPECT_NE(arena.allocate(64), nullptr);
+    }
+  };
+  allocate_twice_the_buffer();
+  EXPECT_GT(arena.OverflowBytes(), 0);
+
+  arena.Reset();
+  EXPECT_EQ(arena.OverflowBytes(), 0);
+  EXPECT_GE(arena.BufferSize(), 2 * DEFAULT_ARENA_SIZE);
+  allocate_twice_the_buffer();
+  EXPECT_EQ(arena.OverflowBytes(), 0);
+}
+
+TEST(Arena, ReusesFreedBlocks) {
+  Arena arena;
+  // Far more than the buffer holds, were blocks not reused.
+  for (int i = 0; i < 10000; ++i) {
+    std::pmr::vector<int> numbers(&arena);
+    numbers.resize(1024);
+  }
+  EXPECT_EQ(arena.OverflowBytes(), 0);
+}
+
+TEST(Arena, LargeBlocksComeFromTheHeap) {
+  Arena arena(1024);
+  std::pmr::vector<char> bytes(&arena);
+  bytes.resize(4 * DEFAULT_ARENA_SIZE);
+  EXPECT_EQ(arena.OverflowBytes(), 0);
+}
+
+TEST(ScopedArena, AllocatesFromTheThreadArenaWithinTheScope) {
+  EXPECT_EQ(TransientMemory(), std::pmr::get_default_resource());
+  {
+    ScopedArena arena;
+    EXPECT_EQ(TransientMemory(), &ScopedArena::ThreadArena());
+    {
+      ScopedTransientMemory heap(std::pmr::new_delete_resource());
+      EXPECT_EQ(TransientMemory(), std::pmr::new_delete_resource());
+    }
+    EXPECT_EQ(TransientMemory(), &ScopedArena::ThreadArena());
+  }
+  EXPECT_EQ(TransientMemory(), std::pmr::get_default_resource());
+}
+
+TEST(ScopedArena, OnlyTheOutermostScopeResets) {
+  ScopedArena outer;
+  std::pmr::vector<int> numbers(TransientMemory());
+  numbers.push_back(1);
+  { ScopedArena inner; }
+  // Still allocated, or the pools would hand the block out again.
+  std::pmr::vector<int> other(TransientMemory());
+  other.push_back(2);
+  EXPECT_NE(numbers.data(), other.data());
+  EXPECT_EQ(numbers.front(), 1);
+}
+
+TEST(ScopedArena, ThreadsHaveArenasOfTheirOwn) {
+  Arena* main_arena = &ScopedArena::ThreadArena();
+  Arena* other_arena = nullptr;
+  std::thread thread([&]() {
+    ScopedArena arena;
+    other_arena = &ScopedArena::ThreadArena();
+  });
+  thread.join();
+  EXPECT_NE(main_arena, other_arena);
+}
+
+TEST(ScopedArena, SearchNodesTakeNothingFromTheHeap) {
+  // The outer scope keeps the arena from being reset by the search, so that
+  // what the search used of it can be seen.
+  ScopedArena arena;
+  TranspositionTable table(1);
+  const Position position = StartingPosition();
+  // Lets the search set up its tables and thread locals first.
+  SearchBestMove(position, Color::WHITE, 1, &table);
+
+  const int64_t allocations_before = heap_allocations;
+  const SearchResult result = SearchBestMove(position, Color::WHITE, 7, &table);
+  const int64_t allocations = heap_allocations - allocations_before;
+  // A few allocations per iteration remain, e.g. for the principal variation.
+  EXPECT_LT(allocations * 100, result.nodes);
+  EXPECT_EQ(ScopedArena::ThreadArena().OverflowBytes(), 0);
+}
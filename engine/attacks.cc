@@ -0,0 +1,131 @@
+#include "engine/attacks.h"
+
+namespace {
+
+using attacks_internal::AttackTables;
+using attacks_internal::DIRECTION_COUNT;
+using attacks_internal::SQUARE_COUNT;
+
+// Rays are indexed by direction, the first four pointing towards higher
+// square indices and the last four towards lower ones, so that the first
+// blocker on a ray is its lowest or highest occupied square respectively.
+static constexpr int DIRECTIONS[DIRECTION_COUNT][2] = {
+    {1, 0}, {0, 1}, {1, 1}, {-1, 1}, {-1, 0}, {0, -1}, {-1, -1}, {1, -1}};
+
+constexpr bool IsOnBoard(int x, int y) {
+  return x >= 0 && y >= 0 && x < BOARD_SIZE && y < BOARD_SIZE;
+}
+
+constexpr int Abs(int value) { return value < 0 ? -value : value; }
+
+constexpr AttackTables MakeAttackTables() {
+  AttackTables tables = {};
+  for (int square = 0; square < SQUARE_COUNT; ++square) {
+    const int file = square & (BOARD_SIZE - 1);
+    const int rank = square >> BOARD_SIZE_LOG;
+    for (int dx = -2; dx <= 2; ++dx) {
+      for (int dy = -2; dy <= 2; ++dy) {
+        if (!IsOnBoard(file + dx, rank + dy)) {
+          continue;
+        }
+        const Bitboard to = SquareBit(file + dx, rank + dy);
+        if (Abs(dx) <= 1 && Abs(dy) <= 1 && (dx != 0 || dy != 0)) {
+          tables.king[square] |= to;
+        }
+        if (Abs(dx) + Abs(dy) == 3) {
+          tables.knight[square] |= to;
+        }
+        if (Abs(dx) == 1 && dy == 1) {
+          tables.pawn[static_cast<int>(Color::WHITE)][square] |= to;
+        }
+        if (Abs(dx) == 1 && dy == -1) {
+          tables.pawn[static_cast<int>(Color::BLACK)][square] |= to;
+        }
+      }
+    }
+    for (int other = 0; other < SQUARE_COUNT; ++other) {
+      const int other_file = other & (BOARD_SIZE - 1);
+      const int other_rank = other >> BOARD_SIZE_LOG;
+      const int dx = Abs(other_file - file);
+      const int dy = Abs(other_rank - rank);
+      tables.distance[square][other] = dx > dy ? dx : dy;
+    }
+    for (int direction = 0; direction < DIRECTION_COUNT; ++direction) {
+      int x = file + DIRECTIONS[direction][0];
+      int y = rank + DIRECTIONS[direction][1];
+      Bitboard between = 0;
+      while (IsOnBoard(x, y)) {
+        const int to = SquareIndex(x, y);
+        tables.rays[direction][square] |= SquareBit(x, y);
+        tables.between[square][to] = between;
+        between |= SquareBit(x, y);
+        x += DIRECTIONS[direction][0];
+        y += DIRECTIONS[direction][1];
+      }
+    }
+  }
+  // A line is both rays through a square, plus the square itself.
+  for (int square = 0; square < SQUARE_COUNT; ++square) {
+    for (int direction = 0; direction < DIRECTION_COUNT / 2; ++direction) {
+      const Bitboard line = tables.rays[direction][square] |
+                            tables.rays[direction + 4][square] |
+                            (Bitboard{1} << square);
+      Bitboard others = tables.rays[direction][square] |
+                        tables.rays[direction + 4][square];
+      while (others) {
+        const int other = LowestSquareIndex(others);
+        others &= others - 1;
+        tables.line[square][other] = line;
+      }
+    }
+  }
+  return tables;
+}
+
+// Squares along a ray up to and including the first occupied one.
+Bitboard RayAttacks(int direction, int square, Bitboard occupancy) {
+  const Bitboard ray = attacks_internal::TABLES.rays[direction][square];
+  const Bitboard blockers = ray & occupancy;
+  if (blockers == 0) {
+    return ray;
+  }
+  const int blocker = direction < DIRECTION_COUNT / 2
+                          ? LowestSquareIndex(blockers)
+                          : 63 - __builtin_clzll(blockers);
+  return ray & ~attacks_internal::TABLES.rays[direction][blocker];
+}
+
+} // namespace
+
+constinit const AttackTables attacks_internal::TABLES = MakeAttackTables();
+
+Bitboard BishopAttacks(int square, Bitboard occupancy) {
+  return RayAttacks(2, square, occupancy) | RayAttacks(3, square, occupancy) |
+         RayAttacks(6, square, occupancy) | RayAttacks(7, square, occupancy);
+}
+
+Bitboard RookAttacks(int square, Bitboard occupancy) {
+  return RayAttacks(0, square, occupancy) | RayAttacks(1, square, occupancy) |
+         RayAttacks(4, square, occupancy) | RayAttacks(5, square, occupancy);
+}
+
+Bitboard QueenAttacks(int square, Bitboard occupancy) {
+  return BishopAttacks(square, occupancy) | RookAttacks(square, occupancy);
+}
+
+Bitboard PieceAttacks(Kind kind, int square, Bitboard occupancy) {
+  switch (kind) {
+  case Kind::KING:
+    return KingAttacks(square);
+  case Kind::KNIGHT:
+    return KnightAttacks(square);
+  case Kind::BISHOP:
+    return BishopAttacks(square, occupancy);
+  case Kind::ROOK:
+    return RookAttacks(square, occupancy);
+  case Kind::QUEEN:
+    return QueenAttacks(square, occupancy);
+  default:
+    return 0;
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef ENGINE_ATTACKS_H_
+#define ENGINE_ATTACKS_H_
+
+#include <cstdint>
+
+#include "engine/base.h"
+#include "engine/bitboard.h"
+
+namespace attacks_internal {
+
+static constexpr int SQUARE_COUNT = BOARD_SIZE * BOARD_SIZE;
+static constexpr int DIRECTION_COUNT = 8;
+
+struct AttackTables {
+  Bitboard king[SQUARE_COUNT];
+  Bitboard knight[SQUARE_COUNT];
+  // Indexed by Color.
+  Bitboard pawn[2][SQUARE_COUNT];
+  // Squares from a square to the edge of the board in a direction, the
+  // square itself excluded. See DIRECTIONS in attacks.cc.
+  Bitboard rays[DIRECTION_COUNT][SQUARE_COUNT];
+  Bitboard between[SQUARE_COUNT][SQUARE_COUNT];
+  Bitboard line[SQUARE_COUNT][SQUARE_COUNT];
+  uint8_t distance[SQUARE_COUNT][SQUARE_COUNT];
+};
+
+// Computed by the compiler, so that the tables are in read-only data, nothing
+// is initialized at startup and a lookup is a single load.
+extern const AttackTables TABLES;
+
+} // namespace attacks_internal
+
+// Squares attacked by a piece standing on the square with a given index, see
+// SquareIndex(). Sliding pieces stop at the first square occupied in
+// `occupancy`, which they attack whatever its color.
+inline Bitboard KingAttacks(int square) {
+  return attacks_internal::TABLES.king[square];
+}
+inline Bitboard KnightAttacks(int square) {
+  return attacks_internal::TABLES.knight[square];
+}
+Bitboard BishopAttacks(int square, Bitboard occupancy);
+Bitboard RookAttacks(int square, Bitboard occupancy);
+Bitboard QueenAttacks(int square, Bitboard occupancy);
+
+// Squares attacked by a pawn of a given color, diagonally forward.
+inline Bitboard PawnAttacks(Color color, int square) {
+  return attacks_internal::TABLES.pawn[static_cast<int>(color)][square];
+}
+
+// Any of the above for a piece kind other than a pawn.
+Bitboard PieceAttacks(Kind kind, int square, Bitboard occupancy);
+
+// Squares strictly between two squares on the same rank, file or diagonal,
+// and none otherwise.
+inline Bitboard BetweenSquares(int from, int to) {
+  return attacks_internal::TABLES.between[from][to];
+}
+
+// The whole rank, file or diagonal through two squares, edge to edge, and
+// no squares if they aren't on one or are the same square.
+inline Bitboard LineThrough(int first, int second) {
+  return attacks_internal::TABLES.line[first][second];
+}
+
+// Number of king moves from one square to another.
+inline int SquareDistance(int from, int to) {
+  return attacks_internal::TABLES.distance[from][to];
+}
+
+#endif // ENGINE_ATTACKS_H_
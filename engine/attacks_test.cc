@@ -0,0 +1,68 @@
+#include "engine/attacks.h"
+
+#include <gtest/gtest.h>
+
+#include "engine/position.h"
+
+TEST(Attacks, KingAndKnightFromCornerAndCenter) {
+  EXPECT_EQ(KingAttacks(SquareIndex(A, ONE)),
+            SquareBit(B, ONE) | SquareBit(A, TWO) | SquareBit(B, TWO));
+  EXPECT_EQ(PopCount(KingAttacks(SquareIndex(E, FOUR))), 8);
+  EXPECT_EQ(KnightAttacks(SquareIndex(A, ONE)),
+            SquareBit(B, THREE) | SquareBit(C, TWO));
+  EXPECT_EQ(PopCount(KnightAttacks(SquareIndex(D, FOUR))), 8);
+}
+
+TEST(Attacks, SlidersStopAtTheFirstOccupiedSquare) {
+  const Bitboard occupancy = SquareBit(A, FOUR) | SquareBit(C, ONE);
+
+  EXPECT_EQ(RookAttacks(SquareIndex(A, ONE), occupancy),
+            SquareBit(A, TWO) | SquareBit(A, THREE) | SquareBit(A, FOUR) |
+                SquareBit(B, ONE) | SquareBit(C, ONE));
+  EXPECT_EQ(BishopAttacks(SquareIndex(D, TWO), occupancy),
+            SquareBit(C, ONE) | SquareBit(E, ONE) | SquareBit(C, THREE) |
+                SquareBit(B, FOUR) | SquareBit(A, FIVE) | SquareBit(E, THREE) |
+                SquareBit(F, FOUR) | SquareBit(G, FIVE) | SquareBit(H, SIX));
+  EXPECT_EQ(PopCount(QueenAttacks(SquareIndex(D, FOUR), 0)), 27);
+  EXPECT_EQ(PieceAttacks(Kind::QUEEN, SquareIndex(A, ONE), occupancy),
+            RookAttacks(SquareIndex(A, ONE), occupancy) |
+                BishopAttacks(SquareIndex(A, ONE), occupancy));
+}
+
+TEST(Attacks, PawnsAttackDiagonallyForward) {
+  EXPECT_EQ(PawnAttacks(Color::WHITE, SquareIndex(E, FOUR)),
+            SquareBit(D, FIVE) | SquareBit(F, FIVE));
+  EXPECT_EQ(PawnAttacks(Color::BLACK, SquareIndex(A, FIVE)),
+            SquareBit(B, FOUR));
+  EXPECT_EQ(PawnAttacks(Color::WHITE, SquareIndex(H, EIGHT)), 0);
+}
+
+TEST(Attacks, BetweenSquares) {
+  EXPECT_EQ(BetweenSquares(SquareIndex(A, ONE), SquareIndex(D, FOUR)),
+            SquareBit(B, TWO) | SquareBit(C, THREE));
+  EXPECT_EQ(BetweenSquares(SquareIndex(D, FOUR), SquareIndex(A, ONE)),
+            SquareBit(B, TWO) | SquareBit(C, THREE));
+  EXPECT_EQ(BetweenSquares(SquareIndex(E, ONE), SquareIndex(E, EIGHT)),
+            RookAttacks(SquareIndex(E, ONE), 0) &
+                RookAttacks(SquareIndex(E, EIGHT), 0));
+  EXPECT_EQ(BetweenSquares(SquareIndex(E, ONE), SquareIndex(E, TWO)), 0);
+  EXPECT_EQ(BetweenSquares(SquareIndex(A, ONE), SquareIndex(B, THREE)), 0);
+}
+
+TEST(Attacks, LineThrough) {
+  const Bitboard long_diagonal = LineThrough(SquareIndex(C, THREE),
+                                             SquareIndex(F, SIX));
+  EXPECT_EQ(PopCount(long_diagonal), 8);
+  EXPECT_TRUE(long_diagonal & SquareBit(A, ONE));
+  EXPECT_TRUE(long_diagonal & SquareBit(H, EIGHT));
+  EXPECT_EQ(LineThrough(SquareIndex(B, TWO), SquareIndex(G, TWO)),
+            LineThrough(SquareIndex(A, TWO), SquareIndex(H, TWO)));
+  EXPECT_EQ(LineThrough(SquareIndex(A, ONE), SquareIndex(B, THREE)), 0);
+  EXPECT_EQ(LineThrough(SquareIndex(A, ONE), SquareIndex(A, ONE)), 0);
+}
+
+TEST(Attacks, SquareDistance) {
+  EXPECT_EQ(SquareDistance(SquareIndex(A, ONE), SquareIndex(H, EIGHT)), 7);
+  EXPECT_EQ(SquareDistance(SquareIndex(E, FOUR), SquareIndex(F, SIX)), 2);
+  EXPECT_EQ(SquareDistance(SquareIndex(C, THREE), SquareIndex(C, THREE)), 0);
+}
@@ -0,0 +1,71 @@
+#include "engine/bitbases.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "engine/bitboard.h"
+
+namespace {
+
+// Most pieces in an embedded ending, kings included.
+static constexpr int MAX_BITBASE_PIECES = 3;
+
+struct BitbaseData {
+  const char* name;
+  const uint64_t* bits;
+};
+
+// Defines BITBASE_DATA.
+#include "engine/bitbase_data.inc"
+
+struct Bitbase {
+  uint32_t key;
+  uint32_t index_count;
+  const uint64_t* bits;
+};
+
+const std::vector<Bitbase>& GetBitbases() {
+  static const std::vector<Bitbase> bitbases = []() {
+    std::vector<Bitbase> bitbases;
+    for (const BitbaseData& data : BITBASE_DATA) {
+      const TablebaseMaterial material = *TablebaseMaterial::Parse(data.name);
+      bitbases.push_back({material.Key(), material.IndexCount(), data.bits});
+    }
+    return bitbases;
+  }();
+  return bitbases;
+}
+
+} // namespace
+
+std::optional<TablebaseOutcome> ProbeBitbase(const Position& position,
+                                             Color side_to_move) {
+  if (PopCount(position.Occupancy()) > MAX_BITBASE_PIECES) {
+    return std::nullopt;
+  }
+  const std::optional<TablebasePieces> pieces = TablebasePiecesOf(position);
+  if (!pieces.has_value()) {
+    return std::nullopt;
+  }
+  const std::optional<TablebaseEntry> entry =
+      FindTablebaseEntry(*pieces, side_to_move);
+  if (!entry.has_value() ||
+      entry->index == TablebaseMaterial::INVALID_INDEX) {
+    return std::nullopt;
+  }
+  for (const Bitbase& bitbase : GetBitbases()) {
+    if (bitbase.key != entry->material.Key()) {
+      continue;
+    }
+    const uint32_t id =
+        static_cast<int>(entry->side_to_move) * bitbase.index_count +
+        entry->index;
+    if ((bitbase.bits[id / 64] >> (id % 64) & 1) == 0) {
+      return TablebaseOutcome::DRAW;
+    }
+    // The stronger side is white in the bitbase.
+    return entry->side_to_move == Color::WHITE ? TablebaseOutcome::WIN
+                                               : TablebaseOutcome::LOSS;
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,20 @@
+#ifndef ENGINE_BITBASES_H_
+#define ENGINE_BITBASES_H_
+
+#include <optional>
+
+#include "engine/base.h"
+#include "engine/position.h"
+#include "engine/tablebase.h"
+
+// Win or draw bitbases of the most frequent trivial endings, KQK, KRK and
+// KPK, generated by the build and embedded in the engine: a bit per position
+// tells whether the stronger side wins, which takes a few KB per ending, about
+// 30 KB for KPK, and needs no files.
+
+// Outcome for the side to move, or nothing if the position isn't in a
+// bitbase. Positions where the side not to move is in check read as draws.
+std::optional<TablebaseOutcome> ProbeBitbase(const Position& position,
+                                             Color side_to_move);
+
+#endif // ENGINE_BITBASES_H_
@@ -0,0 +1,44 @@
+#include "engine/bitbases.h"
+
+#include <gtest/gtest.h>
+
+#include "engine/fen.h"
+
+namespace {
+
+std::optional<TablebaseOutcome> Probe(const std::string& fen) {
+  const FenPosition position = *ParseFen(fen);
+  return ProbeBitbase(position.position, position.side_to_move);
+}
+
+} // namespace
+
+TEST(ProbeBitbase, StrongerSideWins) {
+  EXPECT_EQ(Probe("8/8/3k4/8/8/8/8/R3K3 w - - 0 1"), TablebaseOutcome::WIN);
+  EXPECT_EQ(Probe("8/8/3k4/8/8/8/8/R3K3 b - - 0 1"), TablebaseOutcome::LOSS);
+  EXPECT_EQ(Probe("8/8/8/3K4/8/8/7q/1k6 b - - 0 1"), TablebaseOutcome::WIN);
+}
+
+TEST(ProbeBitbase, HangingPieceIsADraw) {
+  EXPECT_EQ(Probe("8/8/8/8/8/2k5/1R6/7K b - - 0 1"), TablebaseOutcome::DRAW);
+  EXPECT_EQ(Probe("8/8/8/8/8/2k5/1R6/7K w - - 0 1"), TablebaseOutcome::WIN);
+  // Stalemate.
+  EXPECT_EQ(Probe("k7/2Q5/1K6/8/8/8/8/8 b - - 0 1"), TablebaseOutcome::DRAW);
+}
+
+TEST(ProbeBitbase, PawnEndings) {
+  // The king in front of its pawn, with the opposition.
+  EXPECT_EQ(Probe("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1"), TablebaseOutcome::WIN);
+  EXPECT_EQ(Probe("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1"), TablebaseOutcome::LOSS);
+  // Without it.
+  EXPECT_EQ(Probe("4k3/8/8/4K3/4P3/8/8/8 b - - 0 1"), TablebaseOutcome::DRAW);
+  // A rook pawn.
+  EXPECT_EQ(Probe("k7/8/K7/P7/8/8/8/8 w - - 0 1"), TablebaseOutcome::DRAW);
+  EXPECT_EQ(Probe("8/8/8/8/8/8/3kp3/7K b - - 0 1"), TablebaseOutcome::WIN);
+}
+
+TEST(ProbeBitbase, OtherEndingsAreNotCovered) {
+  EXPECT_EQ(Probe("8/8/3k4/8/8/8/8/B3K3 w - - 0 1"), std::nullopt);
+  EXPECT_EQ(Probe("8/8/3k4/8/8/8/8/RR2K3 w - - 0 1"), std::nullopt);
+  EXPECT_EQ(Probe("8/8/3k4/8/8/8/8/4K3 w - - 0 1"), std::nullopt);
+}
@@ -0,0 +1,47 @@
+#ifndef ENGINE_BITBOARD_H_
+#define ENGINE_BITBOARD_H_
+
+#include <cstdint>
+
+#include "engine/base.h"
+
+// A set of squares, one bit per square. Bit index is rank * 8 + file, so that
+// a1 is the least significant bit and h8 is the most significant one.
+using Bitboard = uint64_t;
+
+constexpr int SquareIndex(int x, int y) { return y << BOARD_SIZE_LOG | x; }
+
+inline int SquareIndex(const Square& square) {
+  return SquareIndex(square.file, square.rank);
+}
+
+inline Square SquareFromIndex(int index) {
+  return Square{index & (BOARD_SIZE - 1), index >> BOARD_SIZE_LOG};
+}
+
+constexpr Bitboard SquareBit(int x, int y) {
+  return Bitboard{1} << SquareIndex(x, y);
+}
+
+inline Bitboard SquareBit(const Square& square) {
+  return Bitboard{1} << SquareIndex(square);
+}
+
+inline int PopCount(Bitboard bitboard) {
+  return __builtin_popcountll(bitboard);
+}
+
+// Undefined for an empty bitboard.
+constexpr int LowestSquareIndex(Bitboard bitboard) {
+  return __builtin_ctzll(bitboard);
+}
+
+// Removes the lowest set bit and returns its index. Undefined for an empty
+// bitboard.
+inline int PopLowestSquareIndex(Bitboard* bitboard) {
+  const int index = LowestSquareIndex(*bitboard);
+  *bitboard &= *bitboard - 1;
+  return index;
+}
+
+#endif // ENGINE_BITBOARD_H_
@@ -0,0 +1,64 @@
+#include "engine/block_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+BlockCache::BlockCache(size_t capacity_bytes, int shard_count)
+    : shard_capacity_bytes_(capacity_bytes / std::max(shard_count, 1)),
+      shards_(std::max(shard_count, 1)) {}
+
+BlockCache::Block BlockCache::Find(uint64_t key, bool wait) {
+  Shard& shard = ShardOf(key);
+  std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+  if (wait) {
+    lock.lock();
+  } else if (!lock.try_lock()) {
+    return nullptr;
+  }
+  const auto position = shard.positions.find(key);
+  if (position == shard.positions.end()) {
+    return nullptr;
+  }
+  shard.blocks.splice(shard.blocks.begin(), shard.blocks, position->second);
+  return position->second->second;
+}
+
+BlockCache::Block BlockCache::Insert(uint64_t key, Block block, bool wait) {
+  Shard& shard = ShardOf(key);
+  std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+  if (wait) {
+    lock.lock();
+  } else if (!lock.try_lock()) {
+    return block;
+  }
+  const auto position = shard.positions.find(key);
+  if (position != shard.positions.end()) {
+    shard.blocks.splice(shard.blocks.begin(), shard.blocks, position->second);
+    return position->second->second;
+  }
+  shard.size_bytes += block->size();
+  shard.blocks.emplace_front(key, block);
+  shard.positions.emplace(key, shard.blocks.begin());
+  // Keeps at least the new block, even if it alone exceeds the capacity.
+  while (shard.size_bytes > shard_capacity_bytes_ && shard.blocks.size() > 1) {
+    const auto& [evicted_key, evicted] = shard.blocks.back();
+    shard.size_bytes -= evicted->size();
+    shard.positions.erase(evicted_key);
+    shard.blocks.pop_back();
+  }
+  return block;
+}
+
+size_t BlockCache::SizeBytes() const {
+  size_t size_bytes = 0;
+  for (const Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_bytes += shard.size_bytes;
+  }
+  return size_bytes;
+}
+
+BlockCache::Shard& BlockCache::ShardOf(uint64_t key) {
+  // Spreads neighbouring keys, e.g. the blocks of a file, over the shards.
+  return shards_[((key * 0x9e3779b97f4a7c15) >> 32) % shards_.size()];
+}
@@ -0,0 +1,54 @@
+#ifndef ENGINE_BLOCK_CACHE_H_
+#define ENGINE_BLOCK_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Blocks of bytes shared between threads, e.g. decompressed from files, which
+// are dropped least recently used first once they take more than a capacity.
+// The blocks are spread over shards by key, each with its own lock, so that
+// threads seldom wait for each other. Blocks stay valid while referenced, even
+// once dropped from the cache.
+class BlockCache {
+ public:
+  using Block = std::shared_ptr<const std::vector<uint8_t>>;
+
+  // Each shard holds up to `capacity_bytes / shard_count` bytes of blocks.
+  BlockCache(size_t capacity_bytes, int shard_count);
+
+  // The cached block, or null if there is none. Unless `wait`, also null when
+  // another thread holds the lock of the shard.
+  Block Find(uint64_t key, bool wait = true);
+
+  // Caches a block, unless another thread cached one with the same key first,
+  // and returns the cached one. Unless `wait`, gives up and returns `block`
+  // when another thread holds the lock of the shard.
+  Block Insert(uint64_t key, Block block, bool wait = true);
+
+  // Bytes of the blocks in the cache.
+  size_t SizeBytes() const;
+
+ private:
+  struct Shard {
+    mutable std::mutex mutex;
+    // Most recently used first.
+    std::list<std::pair<uint64_t, Block>> blocks;
+    std::unordered_map<uint64_t,
+                       std::list<std::pair<uint64_t, Block>>::iterator>
+        positions;
+    size_t size_bytes = 0;
+  };
+
+  Shard& ShardOf(uint64_t key);
+
+  const size_t shard_capacity_bytes_;
+  std::vector<Shard> shards_;
+};
+
+#endif // ENGINE_BLOCK_CACHE_H_
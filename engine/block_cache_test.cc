@@ -0,0 +1,62 @@
+#include "engine/block_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+BlockCache::Block MakeBlock(size_t size, uint8_t value) {
+  return std::make_shared<const std::vector<uint8_t>>(size, value);
+}
+
+} // namespace
+
+TEST(BlockCache, FindsInsertedBlocks) {
+  BlockCache cache(/*capacity_bytes=*/1000, /*shard_count=*/4);
+
+  EXPECT_EQ(cache.Find(1), nullptr);
+  cache.Insert(1, MakeBlock(10, 7));
+  cache.Insert(2, MakeBlock(20, 8));
+
+  ASSERT_NE(cache.Find(1), nullptr);
+  EXPECT_EQ((*cache.Find(1))[0], 7);
+  ASSERT_NE(cache.Find(2, /*wait=*/false), nullptr);
+  EXPECT_EQ((*cache.Find(2, /*wait=*/false))[0], 8);
+  EXPECT_EQ(cache.SizeBytes(), 30);
+}
+
+TEST(BlockCache, KeepsTheFirstBlockInserted) {
+  BlockCache cache(/*capacity_bytes=*/1000, /*shard_count=*/1);
+  const BlockCache::Block first = MakeBlock(10, 1);
+
+  EXPECT_EQ(cache.Insert(5, first), first);
+  EXPECT_EQ(cache.Insert(5, MakeBlock(10, 2)), first);
+  EXPECT_EQ(cache.Find(5), first);
+  EXPECT_EQ(cache.SizeBytes(), 10);
+}
+
+TEST(BlockCache, DropsLeastRecentlyUsedBlocks) {
+  BlockCache cache(/*capacity_bytes=*/30, /*shard_count=*/1);
+  cache.Insert(1, MakeBlock(10, 1));
+  cache.Insert(2, MakeBlock(10, 2));
+  const BlockCache::Block third = cache.Insert(3, MakeBlock(10, 3));
+  cache.Find(1);
+
+  cache.Insert(4, MakeBlock(10, 4));
+
+  EXPECT_NE(cache.Find(1), nullptr);
+  EXPECT_EQ(cache.Find(2), nullptr);
+  EXPECT_NE(cache.Find(3), nullptr);
+  EXPECT_NE(cache.Find(4), nullptr);
+  EXPECT_EQ(cache.SizeBytes(), 30);
+
+  // Larger than the capacity alone.
+  cache.Insert(5, MakeBlock(50, 5));
+  EXPECT_NE(cache.Find(5), nullptr);
+  EXPECT_EQ(cache.Find(3), nullptr);
+  EXPECT_EQ(cache.SizeBytes(), 50);
+  // Still valid once dropped.
+  EXPECT_EQ((*third)[9], 3);
+}
@@ -0,0 +1,315 @@
+#include "engine/book_builder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_format.h"
+
+#include "engine/arena.h"
+#include "engine/fen.h"
+#include "engine/move.h"
+#include "engine/notation_parser.h"
+#include "engine/position.h"
+
+namespace {
+
+// First tag of each game, which the threads look for to find where the games
+// in their part of a file start.
+static constexpr std::string_view GAME_START = "[Event ";
+
+enum class GameResult { WHITE_WINS, BLACK_WINS, DRAW, UNKNOWN };
+
+struct BookKey {
+  uint64_t hash;
+  uint16_t move;
+
+  bool operator==(const BookKey& other) const {
+    return hash == other.hash && move == other.move;
+  }
+
+  template <typename H> friend H AbslHashValue(H state, const BookKey& key) {
+    return H::combine(std::move(state), key.hash, key.move);
+  }
+};
+
+struct BookCounts {
+  uint32_t wins = 0;
+  uint32_t draws = 0;
+  uint32_t losses = 0;
+};
+
+// What a thread found in its share of the games.
+struct Aggregation {
+  absl::flat_hash_map<BookKey, BookCounts> counts;
+  int64_t games = 0;
+  int64_t skipped_games = 0;
+};
+
+std::optional<GameResult> ParseResult(std::string_view token) {
+  if (token == "1-0") {
+    return GameResult::WHITE_WINS;
+  } else if (token == "0-1") {
+    return GameResult::BLACK_WINS;
+  } else if (token == "1/2-1/2") {
+    return GameResult::DRAW;
+  } else if (token == "*") {
+    return GameResult::UNKNOWN;
+  }
+  return std::nullopt;
+}
+
+// Name and value of a tag pair line, e.g. `[Result "1-0"]`.
+std::optional<std::pair<std::string_view, std::string_view>>
+ParseTag(std::string_view line) {
+  const size_t space = line.find(' ');
+  const size_t open_quote = line.find('"');
+  const size_t close_quote = line.rfind('"');
+  if (space == std::string_view::npos || open_quote == std::string_view::npos ||
+      close_quote <= open_quote) {
+    return std::nullopt;
+  }
+  return std::make_pair(
+      line.substr(1, space - 1),
+      line.substr(open_quote + 1, close_quote - open_quote - 1));
+}
+
+// Moves and the game termination marker of a movetext, leaving out comments,
+// variations, move numbers and numeric annotation glyphs.
+std::vector<std::string> MovetextTokens(std::string_view movetext) {
+  std::vector<std::string> tokens;
+  std::string token;
+  int variation_depth = 0;
+  const auto flush = [&]() {
+    // Move numbers, e.g. "12." or "12...", may be stuck to their move, as in
+    // "1.e4".
+    std::string_view kept = token;
+    size_t digits = 0;
+    while (digits < kept.size() &&
+           std::isdigit(static_cast<unsigned char>(kept[digits]))) {
+      ++digits;
+    }
+    if (digits < kept.size() && kept[digits] == '.') {
+      kept.remove_prefix(digits);
+    }
+    while (!kept.empty() && kept[0] == '.') {
+      kept.remove_prefix(1);
+    }
+    if (variation_depth == 0 && !kept.empty() && kept[0] != '$') {
+      tokens.emplace_back(kept);
+    }
+    token.clear();
+  };
+  for (size_t i = 0; i < movetext.size(); ++i) {
+    const char c = movetext[i];
+    if (c == '{' || c == ';') {
+      flush();
+      i = movetext.find(c == '{' ? '}' : '\n', i);
+      if (i == std::string_view::npos) {
+        break;
+      }
+    } else if (c == '(') {
+      flush();
+      ++variation_depth;
+    } else if (c == ')') {
+      flush();
+      variation_depth = std::max(variation_depth - 1, 0);
+    } else if (std::isspace(static_cast<unsigned char>(c))) {
+      flush();
+    } else {
+      token += c;
+    }
+  }
+  flush();
+  return tokens;
+}
+
+// Standard Algebraic Notation as ParseAlgebraicNotation() expects it, without
+// check marks and annotations.
+std::string NormalizeMove(std::string move) {
+  while (!move.empty() && (move.back() == '+' || move.back() == '#' ||
+                           move.back() == '!' || move.back() == '?')) {
+    move.pop_back();
+  }
+  if (move == "O-O") {
+    return "0-0";
+  } else if (move == "O-O-O") {
+    return "0-0-0";
+  }
+  return move;
+}
+
+void AddGame(const std::string& game, const BookBuilderOptions& options,
+             Aggregation* aggregation) {
+  // Threads import games side by side, so moves come from an arena of each
+  // thread rather than from the shared heap.
+  ScopedArena arena;
+  GameResult result = GameResult::UNKNOWN;
+  std::optional<std::string> fen;
+  std::string movetext;
+  size_t line_start = 0;
+  while (line_start < game.size()) {
+    size_t line_end = game.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = game.size();
+    }
+    const std::string_view line(game.data() + line_start,
+                                line_end - line_start);
+    line_start = line_end + 1;
+    const auto tag = line.empty() || line[0] != '[' ? std::nullopt
+                                                    : ParseTag(line);
+    if (!tag.has_value()) {
+      movetext.append(line);
+      movetext += '\n';
+    } else if (tag->first == "Result") {
+      result = ParseResult(tag->second).value_or(GameResult::UNKNOWN);
+    } else if (tag->first == "FEN") {
+      fen = std::string(tag->second);
+    }
+  }
+
+  const std::vector<std::string> tokens = MovetextTokens(movetext);
+  if (result == GameResult::UNKNOWN && !tokens.empty()) {
+    result = ParseResult(tokens.back()).value_or(GameResult::UNKNOWN);
+  }
+  absl::StatusOr<FenPosition> start = ParseFen(fen.value_or(
+      STARTING_POSITION_FEN));
+  if (result == GameResult::UNKNOWN || !start.ok()) {
+    ++aggregation->skipped_games;
+    return;
+  }
+  ++aggregation->games;
+
+  Position& position = start->position;
+  Color color = start->side_to_move;
+  for (int ply = 0; ply < std::min<int>(options.max_plies, tokens.size());
+       ++ply) {
+    if (ParseResult(tokens[ply]).has_value()) {
+      break;
+    }
+    const absl::StatusOr<Move> move =
+        ParseAlgebraicNotation(NormalizeMove(tokens[ply]), color, position);
+    if (!move.ok()) {
+      break;
+    }
+    BookCounts& counts =
+        aggregation->counts[{position.Hash(color), PackMove(*move)}];
+    if (result == GameResult::DRAW) {
+      ++counts.draws;
+    } else if ((result == GameResult::WHITE_WINS) == (color == Color::WHITE)) {
+      ++counts.wins;
+    } else {
+      ++counts.losses;
+    }
+    position.MakeMove(move->From(), move->To(), move->Promotion());
+    color = OppositeColor(color);
+  }
+}
+
+// Adds the games starting in the bytes [begin, end) of a file. The game in
+// progress at `end` is read to its end.
+void AddGames(const std::string& path, uint64_t begin, uint64_t end,
+              const BookBuilderOptions& options, Aggregation* aggregation) {
+  std::ifstream file(path, std::ios::binary);
+  std::string line;
+  uint64_t offset = 0;
+  if (begin > 0) {
+    // Skips the line in progress at `begin`, which belongs to the previous
+    // part unless it starts right at `begin`.
+    file.seekg(begin - 1);
+    std::getline(file, line);
+    offset = begin + line.size();
+  }
+  std::string game;
+  bool in_game = false;
+  while (std::getline(file, line)) {
+    const uint64_t line_offset = offset;
+    offset += line.size() + 1;
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.compare(0, GAME_START.size(), GAME_START) == 0) {
+      if (in_game) {
+        AddGame(game, options, aggregation);
+        game.clear();
+      }
+      in_game = line_offset < end;
+      if (!in_game) {
+        return;
+      }
+    }
+    if (in_game) {
+      game += line;
+      game += '\n';
+    }
+  }
+  if (in_game) {
+    AddGame(game, options, aggregation);
+  }
+}
+
+} // namespace
+
+absl::StatusOr<BookBuildResult>
+BuildBook(const std::vector<std::string>& pgn_paths,
+          const BookBuilderOptions& options) {
+  std::vector<uint64_t> sizes;
+  for (const std::string& path : pgn_paths) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+      return absl::NotFoundError(
+          absl::StrFormat("Couldn't open \"%s\"", path));
+    }
+    sizes.push_back(file.tellg());
+  }
+
+  const int thread_count = std::max(options.threads, 1);
+  std::vector<Aggregation> aggregations(thread_count);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < thread_count; ++thread) {
+    threads.emplace_back([&, thread]() {
+      for (size_t i = 0; i < pgn_paths.size(); ++i) {
+        const uint64_t share = (sizes[i] + thread_count - 1) / thread_count;
+        const uint64_t begin = std::min(sizes[i], thread * share);
+        const uint64_t end = std::min(sizes[i], begin + share);
+        if (begin < end) {
+          AddGames(pgn_paths[i], begin, end, options, &aggregations[thread]);
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  Aggregation& merged = aggregations[0];
+  for (int thread = 1; thread < thread_count; ++thread) {
+    for (const auto& [key, counts] : aggregations[thread].counts) {
+      BookCounts& merged_counts = merged.counts[key];
+      merged_counts.wins += counts.wins;
+      merged_counts.draws += counts.draws;
+      merged_counts.losses += counts.losses;
+    }
+    aggregations[thread].counts.clear();
+    merged.games += aggregations[thread].games;
+    merged.skipped_games += aggregations[thread].skipped_games;
+  }
+
+  BookBuildResult result;
+  result.games = merged.games;
+  result.skipped_games = merged.skipped_games;
+  for (const auto& [key, counts] : merged.counts) {
+    const BookEntry entry{key.hash, key.move, /*reserved=*/0, counts.wins,
+                          counts.draws, counts.losses};
+    if (entry.Games() >= static_cast<uint32_t>(options.min_games)) {
+      result.entries.push_back(entry);
+    }
+  }
+  std::sort(result.entries.begin(), result.entries.end());
+  return result;
+}
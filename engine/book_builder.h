@@ -0,0 +1,37 @@
+#ifndef ENGINE_BOOK_BUILDER_H_
+#define ENGINE_BOOK_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+#include "engine/opening_book.h"
+
+struct BookBuilderOptions {
+  // Each file is split into as many parts, which are replayed in parallel.
+  int threads = 1;
+  // Only the first moves of each game make it into the book.
+  int max_plies = 30;
+  // Moves played in fewer games are left out.
+  int min_games = 2;
+};
+
+struct BookBuildResult {
+  // Sorted, as in book files.
+  std::vector<BookEntry> entries;
+  int64_t games = 0;
+  // Games without a result, or starting from a position which can't be
+  // parsed. Games are still used up to a move which can't be parsed.
+  int64_t skipped_games = 0;
+};
+
+// Replays the games of PGN files, and counts how each move played in them
+// fared. Each thread counts its games in its own map, and the maps are
+// merged once all the games are replayed.
+absl::StatusOr<BookBuildResult>
+BuildBook(const std::vector<std::string>& pgn_paths,
+          const BookBuilderOptions& options);
+
+#endif // ENGINE_BOOK_BUILDER_H_
@@ -0,0 +1,133 @@
+#include "engine/book_builder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "engine/move.h"
+#include "engine/notation_parser.h"
+#include "engine/position.h"
+
+namespace {
+
+static constexpr char RUY_LOPEZ[] =
+    "[Event \"Casual\"]\n"
+    "[Result \"1-0\"]\n"
+    "\n"
+    "1. e4 e5 {The most classical reply} 2. Nf3 (2. f4 exf4) 2... Nc6 $1\n"
+    "3.Bb5 a6 4. Ba4 Nf6 5. O-O! Be7 6. Re1 b5 7. Bb3 d6 8. c3 O-O 1-0\n"
+    "\n";
+static constexpr char SICILIAN[] =
+    "[Event \"Casual\"]\n"
+    "[Result \"1/2-1/2\"]\n"
+    "\n"
+    "1. e4 c5 ; Sharper\n"
+    "2. Nf3 d6 3. d4 cxd4 4. Nxd4 Nf6 5. Nc3 a6 1/2-1/2\n"
+    "\n";
+static constexpr char UNFINISHED[] =
+    "[Event \"Casual\"]\n"
+    "[Result \"*\"]\n"
+    "\n"
+    "1. d4 d5 *\n"
+    "\n";
+
+std::string WritePgn(const std::string& name, const std::string& contents) {
+  const std::string path = testing::TempDir() + name;
+  std::ofstream(path, std::ios::binary) << contents;
+  return path;
+}
+
+// Entry of a move from the starting position.
+const BookEntry* FindFirstMove(const std::vector<BookEntry>& entries,
+                               const std::string& notation) {
+  const Position position = StartingPosition();
+  const uint16_t move = PackMove(
+      *ParseAlgebraicNotation(notation, Color::WHITE, position));
+  for (const BookEntry& entry : entries) {
+    if (entry.hash == position.Hash(Color::WHITE) && entry.move == move) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+TEST(BuildBook, CountsResultsOfEachMove) {
+  const std::string path = WritePgn(
+      "counts.pgn", std::string(RUY_LOPEZ) + SICILIAN + UNFINISHED);
+  BookBuilderOptions options;
+  options.min_games = 1;
+
+  absl::StatusOr<BookBuildResult> book = BuildBook({path}, options);
+  std::remove(path.c_str());
+
+  ASSERT_TRUE(book.ok()) << book.status();
+  EXPECT_EQ(book->games, 2);
+  EXPECT_EQ(book->skipped_games, 1);
+  EXPECT_TRUE(std::is_sorted(book->entries.begin(), book->entries.end()));
+  // 1. e4 and 2. Nf3 are shared, and the 16 plies of the first game are all
+  // replayed, castling included, while its variation is left out.
+  EXPECT_EQ(book->entries.size(), 16 + 10 - 1);
+  const BookEntry* e4 = FindFirstMove(book->entries, "e4");
+  ASSERT_NE(e4, nullptr);
+  EXPECT_EQ(e4->wins, 1);
+  EXPECT_EQ(e4->draws, 1);
+  EXPECT_EQ(e4->losses, 0);
+  EXPECT_EQ(FindFirstMove(book->entries, "d4"), nullptr);
+}
+
+TEST(BuildBook, PrunesRareMovesAndLaterPlies) {
+  const std::string path =
+      WritePgn("prune.pgn", std::string(RUY_LOPEZ) + SICILIAN);
+  BookBuilderOptions options;
+  options.min_games = 2;
+
+  absl::StatusOr<BookBuildResult> book = BuildBook({path}, options);
+  ASSERT_TRUE(book.ok()) << book.status();
+  // Only 1. e4 was played in both games.
+  ASSERT_EQ(book->entries.size(), 1);
+  EXPECT_EQ(FindFirstMove(book->entries, "e4"), &book->entries[0]);
+
+  options.min_games = 1;
+  options.max_plies = 2;
+  book = BuildBook({path}, options);
+  std::remove(path.c_str());
+  ASSERT_TRUE(book.ok()) << book.status();
+  EXPECT_EQ(book->entries.size(), 3);
+}
+
+TEST(BuildBook, ThreadsFindTheSameGames) {
+  std::string contents;
+  for (int i = 0; i < 40; ++i) {
+    contents += i % 3 == 0 ? SICILIAN : RUY_LOPEZ;
+  }
+  const std::string path = WritePgn("threads.pgn", contents);
+  BookBuilderOptions options;
+  absl::StatusOr<BookBuildResult> expected = BuildBook({path}, options);
+
+  for (const int threads : {2, 3, 7}) {
+    options.threads = threads;
+    absl::StatusOr<BookBuildResult> book = BuildBook({path}, options);
+
+    ASSERT_TRUE(book.ok()) << book.status();
+    EXPECT_EQ(book->games, 40);
+    ASSERT_EQ(book->entries.size(), expected->entries.size());
+    for (size_t i = 0; i < book->entries.size(); ++i) {
+      EXPECT_EQ(book->entries[i].hash, expected->entries[i].hash);
+      EXPECT_EQ(book->entries[i].move, expected->entries[i].move);
+      EXPECT_EQ(book->entries[i].wins, expected->entries[i].wins);
+      EXPECT_EQ(book->entries[i].draws, expected->entries[i].draws);
+    }
+  }
+  std::remove(path.c_str());
+}
+
+TEST(BuildBook, FailsForMissingFiles) {
+  EXPECT_EQ(BuildBook({testing::TempDir() + "missing.pgn"}, {}).status().code(),
+            absl::StatusCode::kNotFound);
+}
@@ -0,0 +1,162 @@
+#include "engine/evaluation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+
+#include "engine/bitbases.h"
+#include "engine/bitboard.h"
+#include "engine/game_engine.h"
+
+namespace {
+
+// Longest possible capture sequence on a single square is bounded by the
+// number of pieces on the board.
+static constexpr int MAX_EXCHANGE_LENGTH = 32;
+
+// Order in which attackers are tried during static exchange evaluation.
+static constexpr Kind KINDS_BY_VALUE[] = {Kind::PAWN,   Kind::KNIGHT,
+                                          Kind::BISHOP, Kind::ROOK,
+                                          Kind::QUEEN,  Kind::KING};
+
+// Bonus for reaching an ending known to be won, so that the search prefers it
+// to keeping more material with an unknown outcome.
+static constexpr int KNOWN_WIN_BONUS = 1000;
+
+// Bonus for minor pieces close to the center, where they control more
+// squares.
+int CentralizationBonus(int x, int y) {
+  const int distance_x = std::abs(2 * x - (BOARD_SIZE - 1)) / 2;
+  const int distance_y = std::abs(2 * y - (BOARD_SIZE - 1)) / 2;
+  return 10 * (3 - std::max(distance_x, distance_y));
+}
+
+int PositionalBonus(const Piece& piece, int x, int y) {
+  switch (piece.Kind()) {
+  case Kind::PAWN:
+    // Advanced pawns are closer to promotion.
+    return 5 * (piece.Color() == Color::WHITE ? y - TWO : SEVEN - y);
+  case Kind::KNIGHT:
+  case Kind::BISHOP:
+    return CentralizationBonus(x, y);
+  default:
+    return 0;
+  }
+}
+
+// Finds the least valuable piece among `attackers`, removing it from
+// `occupancy` and returning its kind. Returns Kind::NONE if there are no
+// attackers left.
+Kind PopLeastValuableAttacker(const Position& position, Bitboard attackers,
+                              Bitboard* occupancy) {
+  for (Kind kind : KINDS_BY_VALUE) {
+    Bitboard candidates = attackers;
+    while (candidates) {
+      const int index = PopLowestSquareIndex(&candidates);
+      if (position.GetPiece(SquareFromIndex(index)).Kind() == kind) {
+        *occupancy &= ~(Bitboard{1} << index);
+        return kind;
+      }
+    }
+  }
+  return Kind::NONE;
+}
+
+} // namespace
+
+int PieceValue(Kind kind) {
+  switch (kind) {
+  case Kind::PAWN:
+    return 100;
+  case Kind::KNIGHT:
+    return 320;
+  case Kind::BISHOP:
+    return 330;
+  case Kind::ROOK:
+    return 500;
+  case Kind::QUEEN:
+    return 900;
+  case Kind::KING:
+    return 20000;
+  case Kind::NONE:
+  default:
+    return 0;
+  }
+}
+
+int Evaluate(const Position& position, Color color) {
+  const std::optional<TablebaseOutcome> outcome =
+      ProbeBitbase(position, color);
+  if (outcome == TablebaseOutcome::DRAW) {
+    return 0;
+  }
+
+  int score = 0;
+  Bitboard pieces = position.Occupancy();
+  while (pieces) {
+    const Square square = SquareFromIndex(PopLowestSquareIndex(&pieces));
+    const Piece piece = position.GetPiece(square);
+    const int value = PieceValue(piece.Kind()) +
+                      PositionalBonus(piece, square.file, square.rank);
+    score += (piece.Color() == color ? value : -value);
+  }
+  if (outcome == TablebaseOutcome::WIN) {
+    score += KNOWN_WIN_BONUS;
+  } else if (outcome == TablebaseOutcome::LOSS) {
+    score -= KNOWN_WIN_BONUS;
+  }
+  return score;
+}
+
+Kind CapturedKind(const Position& position, const Move& move) {
+  if (position.HasPiece(move.To())) {
+    return position.GetPiece(move.To()).Kind();
+  }
+  // Only a pawn taking en passant moves diagonally to an empty square.
+  return move.From().file != move.To().file &&
+                 position.GetPiece(move.From()).Kind() == Kind::PAWN
+             ? Kind::PAWN
+             : Kind::NONE;
+}
+
+int StaticExchangeEvaluation(const Position& position, const Move& move) {
+  const Square to = move.To();
+  const Piece mover = position.GetPiece(move.From());
+
+  // gain[i] is the speculative balance for the side making the i-th capture,
+  // assuming the piece it lands with is captured in turn.
+  int gain[MAX_EXCHANGE_LENGTH];
+  int depth = 0;
+  gain[0] = PieceValue(CapturedKind(position, move));
+
+  Bitboard occupancy = position.Occupancy() & ~SquareBit(move.From());
+  // A pawn taken en passant leaves the square next to the one it is taken on,
+  // which may open a line to it.
+  if (gain[0] != 0 && !position.HasPiece(to)) {
+    occupancy &= ~SquareBit(to.file, move.From().rank);
+  }
+  Kind piece_on_square = mover.Kind();
+  Color side = mover.Color();
+  while (depth + 1 < MAX_EXCHANGE_LENGTH) {
+    side = OppositeColor(side);
+    const Bitboard attackers = GetAttackersTo(position, to, occupancy) &
+                               occupancy & position.Occupancy(side);
+    if (!attackers) {
+      break;
+    }
+    ++depth;
+    gain[depth] = PieceValue(piece_on_square) - gain[depth - 1];
+    // Neither side can improve by continuing the exchange.
+    if (std::max(-gain[depth - 1], gain[depth]) < 0) {
+      break;
+    }
+    piece_on_square =
+        PopLeastValuableAttacker(position, attackers, &occupancy);
+  }
+
+  while (depth > 0) {
+    gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    --depth;
+  }
+  return gain[0];
+}
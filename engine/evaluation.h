@@ -0,0 +1,29 @@
+#ifndef ENGINE_EVALUATION_H_
+#define ENGINE_EVALUATION_H_
+
+#include "engine/base.h"
+#include "engine/move.h"
+#include "engine/position.h"
+
+// Returns material value of a piece kind in centipawns. The King is given a
+// value larger than all the other material combined, so that exchanges
+// ending with a king capture are never considered profitable.
+int PieceValue(Kind kind);
+
+// Static evaluation of a position in centipawns, from the point of view of the
+// side to move: positive values are good for `color`. Positions of the endings
+// in the bitbases score 0 when drawn.
+int Evaluate(const Position& position, Color color);
+
+// Kind of the piece a move takes: a pawn for a pawn taking en passant, which
+// lands on an empty square, and Kind::NONE for a move taking nothing.
+Kind CapturedKind(const Position& position, const Move& move);
+
+// Static Exchange Evaluation: the material balance in centipawns for the side
+// making the move, after the sequence of captures on the destination square in
+// which both sides always recapture with their least valuable attacker and may
+// stop whenever continuing would lose material. Works for non-captures too,
+// telling whether the moved piece can be safely placed on its destination.
+int StaticExchangeEvaluation(const Position& position, const Move& move);
+
+#endif // ENGINE_EVALUATION_H_
@@ -0,0 +1,112 @@
+#include "engine/evaluation.h"
+
+#include <gtest/gtest.h>
+
+TEST(Evaluate, StartingPositionIsBalanced) {
+  Position position = StartingPosition();
+
+  EXPECT_EQ(Evaluate(position, Color::WHITE), 0);
+  EXPECT_EQ(Evaluate(position, Color::BLACK), 0);
+}
+
+TEST(Evaluate, ExtraMaterialIsGoodForItsOwner) {
+  Position position = StartingPosition();
+  position.RemovePiece(D, EIGHT);
+
+  EXPECT_GT(Evaluate(position, Color::WHITE), PieceValue(Kind::ROOK));
+  EXPECT_EQ(Evaluate(position, Color::BLACK),
+            -Evaluate(position, Color::WHITE));
+}
+
+TEST(Evaluate, BitbasesTellDrawnEndings) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), B, TWO);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), C, THREE);
+
+  // Black takes the undefended rook.
+  EXPECT_EQ(Evaluate(position, Color::BLACK), 0);
+  EXPECT_GT(Evaluate(position, Color::WHITE), PieceValue(Kind::ROOK));
+}
+
+TEST(StaticExchangeEvaluation, UndefendedPieceIsWon) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), A, EIGHT);
+
+  EXPECT_EQ(StaticExchangeEvaluation(position,
+                                     Move(&position, A, ONE, A, EIGHT)),
+            PieceValue(Kind::KNIGHT));
+}
+
+TEST(StaticExchangeEvaluation, DefendedPawnCapturedByAQueenLosesMaterial) {
+  Position position;
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
+
+  EXPECT_EQ(
+      StaticExchangeEvaluation(position, Move(&position, D, ONE, D, FIVE)),
+      PieceValue(Kind::PAWN) - PieceValue(Kind::QUEEN));
+}
+
+TEST(StaticExchangeEvaluation, PawnTakingADefendedKnightWins) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FOUR);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), D, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
+
+  EXPECT_EQ(
+      StaticExchangeEvaluation(position, Move(&position, E, FOUR, D, FIVE)),
+      PieceValue(Kind::KNIGHT) - PieceValue(Kind::PAWN));
+}
+
+TEST(StaticExchangeEvaluation, XRayAttackerBehindARookIsCounted) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), D, TWO);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), D, FIVE);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), D, EIGHT);
+
+  // QxN RxQ RxR: the rook behind the queen recaptures through the d-file.
+  EXPECT_EQ(
+      StaticExchangeEvaluation(position, Move(&position, D, TWO, D, FIVE)),
+      PieceValue(Kind::KNIGHT) - PieceValue(Kind::QUEEN) +
+          PieceValue(Kind::ROOK));
+}
+
+TEST(StaticExchangeEvaluation, EnPassantCaptureTakesAPawn) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FIVE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, SEVEN);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), B, SEVEN);
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+
+  // The rook recaptures through the square the taken pawn leaves.
+  EXPECT_EQ(
+      StaticExchangeEvaluation(position, Move(&position, E, FIVE, D, SIX)),
+      PieceValue(Kind::PAWN));
+}
+
+TEST(StaticExchangeEvaluation, KingDoesNotCaptureDefendedPiece) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, FOUR);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, FIVE);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, EIGHT);
+
+  EXPECT_LT(
+      StaticExchangeEvaluation(position, Move(&position, E, FOUR, E, FIVE)), 0);
+}
+
+TEST(StaticExchangeEvaluation, QuietMoveToAnAttackedSquareLosesThePiece) {
+  Position position;
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), G, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, FOUR);
+
+  EXPECT_EQ(
+      StaticExchangeEvaluation(position, Move(&position, G, ONE, F, THREE)),
+      -PieceValue(Kind::KNIGHT));
+  EXPECT_EQ(
+      StaticExchangeEvaluation(position, Move(&position, G, ONE, H, THREE)), 0);
+}
@@ -0,0 +1,227 @@
+#include "engine/fen.h"
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+
+#include "engine/bitboard.h"
+#include "engine/piece.h"
+
+namespace {
+
+// Indexed by Kind.
+static constexpr char KIND_LETTERS[] = " pkqbnr";
+
+absl::StatusOr<Piece> ParsePiece(char letter) {
+  const char lowercase_letter =
+      letter >= 'A' && letter <= 'Z' ? letter - 'A' + 'a' : letter;
+  for (int kind = static_cast<int>(Kind::PAWN);
+       kind <= static_cast<int>(Kind::ROOK); ++kind) {
+    if (KIND_LETTERS[kind] == lowercase_letter) {
+      return Piece(static_cast<Kind>(kind),
+                   letter == lowercase_letter ? Color::BLACK : Color::WHITE);
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Invalid piece letter: '%c'", letter));
+}
+
+char PieceLetter(const Piece& piece) {
+  const char letter = KIND_LETTERS[static_cast<int>(piece.Kind())];
+  return piece.Color() == Color::WHITE ? letter - 'a' + 'A' : letter;
+}
+
+absl::Status ParsePlacement(const std::string& placement, Position* position) {
+  const std::vector<std::string> ranks = absl::StrSplit(placement, '/');
+  if (ranks.size() != BOARD_SIZE) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected %d ranks in piece placement: \"%s\"", BOARD_SIZE, placement));
+  }
+  for (int i = 0; i < BOARD_SIZE; ++i) {
+    const int y = BOARD_SIZE - 1 - i;
+    int x = 0;
+    for (const char letter : ranks[i]) {
+      if (letter >= '1' && letter <= '8') {
+        x += letter - '0';
+        continue;
+      }
+      if (x >= BOARD_SIZE) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Rank \"%s\" describes more than %d squares", ranks[i],
+            BOARD_SIZE));
+      }
+      absl::StatusOr<Piece> piece_or = ParsePiece(letter);
+      if (!piece_or.ok()) {
+        return piece_or.status();
+      }
+      position->AddPiece(*piece_or, x, y);
+      ++x;
+    }
+    if (x != BOARD_SIZE) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Rank \"%s\" doesn't describe %d squares", ranks[i], BOARD_SIZE));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ParseCastlingRights(const std::string& rights,
+                                 Position* position) {
+  bool white_short = false;
+  bool white_long = false;
+  bool black_short = false;
+  bool black_long = false;
+  if (rights != "-") {
+    for (const char letter : rights) {
+      switch (letter) {
+      case 'K':
+        white_short = true;
+        break;
+      case 'Q':
+        white_long = true;
+        break;
+      case 'k':
+        black_short = true;
+        break;
+      case 'q':
+        black_long = true;
+        break;
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Invalid castling rights: \"%s\"", rights));
+      }
+    }
+  }
+  if (!white_short) {
+    position->DisallowShortCastling(Color::WHITE);
+  }
+  if (!white_long) {
+    position->DisallowLongCastling(Color::WHITE);
+  }
+  if (!black_short) {
+    position->DisallowShortCastling(Color::BLACK);
+  }
+  if (!black_long) {
+    position->DisallowLongCastling(Color::BLACK);
+  }
+  return absl::OkStatus();
+}
+
+// Castling rights are only reported while the king and the rook are still on
+// their initial squares, as a position set up piece by piece may lack them.
+bool CanCastle(const Position& position, Color color, bool is_short) {
+  const int rank = color == Color::WHITE ? ONE : EIGHT;
+  const int rook_file = is_short ? H : A;
+  return (is_short ? position.ShortCastlingPossible(color)
+                   : position.LongCastlingPossible(color)) &&
+         position.GetPiece(E, rank) == Piece(Kind::KING, color) &&
+         position.GetPiece(rook_file, rank) == Piece(Kind::ROOK, color);
+}
+
+} // namespace
+
+absl::StatusOr<FenPosition> ParseFen(const std::string& fen) {
+  const std::vector<std::string> fields =
+      absl::StrSplit(fen, ' ', absl::SkipEmpty());
+  if (fields.size() != 4 && fields.size() != 6) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected 4 or 6 fields in FEN: \"%s\"", fen));
+  }
+
+  FenPosition fen_position;
+  absl::Status status = ParsePlacement(fields[0], &fen_position.position);
+  if (!status.ok()) {
+    return status;
+  }
+
+  if (fields[1] == "w") {
+    fen_position.side_to_move = Color::WHITE;
+  } else if (fields[1] == "b") {
+    fen_position.side_to_move = Color::BLACK;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid side to move: \"%s\"", fields[1]));
+  }
+
+  status = ParseCastlingRights(fields[2], &fen_position.position);
+  if (!status.ok()) {
+    return status;
+  }
+
+  const std::string& en_passant = fields[3];
+  if (en_passant != "-" &&
+      (en_passant.size() != 2 || en_passant[0] < 'a' || en_passant[0] > 'h' ||
+       (en_passant[1] != '3' && en_passant[1] != '6'))) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid en passant square: \"%s\"", en_passant));
+  }
+  if (en_passant != "-") {
+    fen_position.position.SetEnPassantSquare(
+        Square{en_passant[0] - 'a', en_passant[1] - '1'});
+  }
+
+  if (fields.size() == 6 &&
+      (!absl::SimpleAtoi(fields[4], &fen_position.halfmove_clock) ||
+       !absl::SimpleAtoi(fields[5], &fen_position.fullmove_number) ||
+       fen_position.halfmove_clock < 0 || fen_position.fullmove_number < 1)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid move counters: \"%s %s\"", fields[4], fields[5]));
+  }
+  return fen_position;
+}
+
+std::string ToFen(const FenPosition& fen_position) {
+  const Position& position = fen_position.position;
+  std::string fen;
+  for (int y = BOARD_SIZE - 1; y >= 0; --y) {
+    int empty_squares = 0;
+    for (int x = 0; x < BOARD_SIZE; ++x) {
+      if (!position.HasPiece(x, y)) {
+        ++empty_squares;
+        continue;
+      }
+      if (empty_squares > 0) {
+        fen.push_back('0' + empty_squares);
+        empty_squares = 0;
+      }
+      fen.push_back(PieceLetter(position.GetPiece(x, y)));
+    }
+    if (empty_squares > 0) {
+      fen.push_back('0' + empty_squares);
+    }
+    if (y > 0) {
+      fen.push_back('/');
+    }
+  }
+
+  fen += fen_position.side_to_move == Color::WHITE ? " w " : " b ";
+
+  std::string castling_rights;
+  if (CanCastle(position, Color::WHITE, /*is_short=*/true)) {
+    castling_rights.push_back('K');
+  }
+  if (CanCastle(position, Color::WHITE, /*is_short=*/false)) {
+    castling_rights.push_back('Q');
+  }
+  if (CanCastle(position, Color::BLACK, /*is_short=*/true)) {
+    castling_rights.push_back('k');
+  }
+  if (CanCastle(position, Color::BLACK, /*is_short=*/false)) {
+    castling_rights.push_back('q');
+  }
+  fen += castling_rights.empty() ? "-" : castling_rights;
+
+  const Bitboard en_passant = position.EnPassantSquare();
+  if (en_passant) {
+    const Square square = SquareFromIndex(LowestSquareIndex(en_passant));
+    fen += absl::StrFormat(" %c%c", 'a' + square.file, '1' + square.rank);
+  } else {
+    fen += " -";
+  }
+
+  return fen + absl::StrFormat(" %d %d", fen_position.halfmove_clock,
+                               fen_position.fullmove_number);
+}
@@ -0,0 +1,30 @@
+#ifndef ENGINE_FEN_H_
+#define ENGINE_FEN_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+
+#include "engine/base.h"
+#include "engine/position.h"
+
+static constexpr char STARTING_POSITION_FEN[] =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// A position together with the game state Position doesn't keep, as described
+// by Forsyth-Edwards Notation.
+struct FenPosition {
+  Position position;
+  Color side_to_move = Color::WHITE;
+  // Plies since the last capture or pawn move.
+  int halfmove_clock = 0;
+  // Starts at 1, and is incremented after each black move.
+  int fullmove_number = 1;
+};
+
+// Parses all six FEN fields. The last two may be omitted, as some tools do.
+absl::StatusOr<FenPosition> ParseFen(const std::string& fen);
+
+std::string ToFen(const FenPosition& fen_position);
+
+#endif // ENGINE_FEN_H_
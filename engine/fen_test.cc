@@ -0,0 +1,85 @@
+#include "engine/fen.h"
+
+#include <gtest/gtest.h>
+
+TEST(ParseFen, StartingPosition) {
+  absl::StatusOr<FenPosition> fen_position = ParseFen(STARTING_POSITION_FEN);
+
+  ASSERT_TRUE(fen_position.ok());
+  EXPECT_EQ(fen_position->position.Hash(Color::WHITE),
+            StartingPosition().Hash(Color::WHITE));
+  EXPECT_EQ(fen_position->side_to_move, Color::WHITE);
+  EXPECT_EQ(fen_position->halfmove_clock, 0);
+  EXPECT_EQ(fen_position->fullmove_number, 1);
+}
+
+TEST(ParseFen, PiecesSideAndCounters) {
+  absl::StatusOr<FenPosition> fen_position =
+      ParseFen("4k3/8/8/3q4/8/8/4P3/4K2R b K - 3 42");
+
+  ASSERT_TRUE(fen_position.ok());
+  const Position& position = fen_position->position;
+  EXPECT_EQ(position.GetPiece(E, EIGHT), Piece(Kind::KING, Color::BLACK));
+  EXPECT_EQ(position.GetPiece(D, FIVE), Piece(Kind::QUEEN, Color::BLACK));
+  EXPECT_EQ(position.GetPiece(E, TWO), Piece(Kind::PAWN, Color::WHITE));
+  EXPECT_EQ(position.GetPiece(H, ONE), Piece(Kind::ROOK, Color::WHITE));
+  EXPECT_EQ(PopCount(position.Occupancy()), 5);
+  EXPECT_EQ(fen_position->side_to_move, Color::BLACK);
+  EXPECT_TRUE(position.ShortCastlingPossible(Color::WHITE));
+  EXPECT_FALSE(position.LongCastlingPossible(Color::WHITE));
+  EXPECT_FALSE(position.ShortCastlingPossible(Color::BLACK));
+  EXPECT_EQ(fen_position->halfmove_clock, 3);
+  EXPECT_EQ(fen_position->fullmove_number, 42);
+}
+
+TEST(ParseFen, MoveCountersMayBeOmitted) {
+  absl::StatusOr<FenPosition> fen_position =
+      ParseFen("4k3/8/8/8/8/8/8/4K3 w - -");
+
+  ASSERT_TRUE(fen_position.ok());
+  EXPECT_EQ(fen_position->fullmove_number, 1);
+}
+
+TEST(ParseFen, MalformedFenGivesError) {
+  EXPECT_FALSE(ParseFen("").ok());
+  EXPECT_FALSE(ParseFen("4k3/8/8/8/8/8/4K3 w - - 0 1").ok());
+  EXPECT_FALSE(ParseFen("4k3/8/8/8/8/8/8/4K4 w - - 0 1").ok());
+  EXPECT_FALSE(ParseFen("4k3/8/8/8/8/8/8/4X3 w - - 0 1").ok());
+  EXPECT_FALSE(ParseFen("4k3/8/8/8/8/8/8/4K3 x - - 0 1").ok());
+  EXPECT_FALSE(ParseFen("4k3/8/8/8/8/8/8/4K3 w X - 0 1").ok());
+  EXPECT_FALSE(ParseFen("4k3/8/8/8/8/8/8/4K3 w - e5 0 1").ok());
+  EXPECT_FALSE(ParseFen("4k3/8/8/8/8/8/8/4K3 w - - x 1").ok());
+}
+
+TEST(ToFen, RoundTrips) {
+  for (const char* fen :
+       {STARTING_POSITION_FEN,
+        "r3k2r/pp3ppp/2n5/3q4/8/2N5/PP3PPP/R3K2R b Qk - 5 17",
+        "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+        "8/8/4k3/8/8/3K4/8/8 w - - 0 60"}) {
+    absl::StatusOr<FenPosition> fen_position = ParseFen(fen);
+    ASSERT_TRUE(fen_position.ok()) << fen;
+    EXPECT_EQ(ToFen(*fen_position), fen);
+  }
+}
+
+TEST(ToFen, CastlingRightsFollowMoves) {
+  FenPosition fen_position;
+  fen_position.position = StartingPosition();
+  fen_position.position.MakeMove({G, ONE}, {F, THREE});
+  fen_position.position.MakeMove({H, ONE}, {G, ONE});
+  fen_position.side_to_move = Color::BLACK;
+
+  EXPECT_EQ(ToFen(fen_position),
+            "rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKBR1 b Qkq - 0 1");
+}
+
+TEST(ToFen, EnPassantSquareFollowsMoves) {
+  FenPosition fen_position;
+  fen_position.position = StartingPosition();
+  fen_position.position.MakeMove({E, TWO}, {E, FOUR});
+  fen_position.side_to_move = Color::BLACK;
+
+  EXPECT_EQ(ToFen(fen_position),
+            "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+}
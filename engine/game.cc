@@ -0,0 +1,71 @@
+#include "engine/game.h"
+
+#include <algorithm>
+
+namespace {
+
+// Most games end before this, so the history is rarely reallocated.
+static constexpr size_t RESERVED_PLIES = 256;
+
+} // namespace
+
+Game::Game() : Game(StartingPosition(), Color::WHITE) {}
+
+Game::Game(const ::Position& position, Color side_to_move, int halfmove_clock,
+           int fullmove_number)
+    : position_(position), side_to_move_(side_to_move),
+      halfmove_clock_(halfmove_clock), fullmove_number_(fullmove_number) {
+  undo_stack_.reserve(RESERVED_PLIES);
+  hashes_.reserve(RESERVED_PLIES + 1);
+  hashes_.push_back(position_.Hash(side_to_move_));
+}
+
+int Game::Turn() const {
+  const bool black_started =
+      (side_to_move_ == Color::BLACK) == (Ply() % 2 == 0);
+  const int black_moves = black_started ? (Ply() + 1) / 2 : Ply() / 2;
+  return fullmove_number_ + black_moves;
+}
+
+void Game::MakeMove(const Move& move) {
+  const int halfmove_clock = halfmove_clock_;
+  const UndoRecord undo =
+      position_.MakeMove(move.From(), move.To(), move.Promotion());
+  undo_stack_.push_back({undo, halfmove_clock});
+  const bool irreversible =
+      undo.moved.Kind() == Kind::PAWN || undo.captured.Kind() != Kind::NONE;
+  halfmove_clock_ = irreversible ? 0 : halfmove_clock + 1;
+  side_to_move_ = OppositeColor(side_to_move_);
+  hashes_.push_back(position_.Hash(side_to_move_));
+}
+
+bool Game::TakeBack() {
+  if (undo_stack_.empty()) {
+    return false;
+  }
+  const HistoryEntry& entry = undo_stack_.back();
+  position_.UnmakeMove(entry.undo);
+  halfmove_clock_ = entry.halfmove_clock;
+  side_to_move_ = OppositeColor(side_to_move_);
+  undo_stack_.pop_back();
+  hashes_.pop_back();
+  return true;
+}
+
+std::vector<uint64_t> Game::ReversibleHashes() const {
+  const int current = static_cast<int>(hashes_.size()) - 1;
+  const int first = std::max(0, current - halfmove_clock_);
+  return std::vector<uint64_t>(hashes_.begin() + first,
+                               hashes_.begin() + current);
+}
+
+int Game::Repetitions() const {
+  const int current = static_cast<int>(hashes_.size()) - 1;
+  // Positions set up with a clock have no history for its first plies.
+  const int first = std::max(0, current - halfmove_clock_);
+  int repetitions = 0;
+  for (int ply = current - 4; ply >= first; ply -= 2) {
+    repetitions += hashes_[ply] == hashes_[current];
+  }
+  return repetitions;
+}
@@ -0,0 +1,71 @@
+#ifndef ENGINE_GAME_H_
+#define ENGINE_GAME_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "engine/base.h"
+#include "engine/move.h"
+#include "engine/position.h"
+
+// A game in progress: the current position together with the moves which led
+// to it, so that they can be taken back, and the state the draw rules need.
+class Game {
+ public:
+  // Starts from the initial position.
+  Game();
+  // Starts from an arbitrary position, e.g. one parsed from FEN.
+  Game(const ::Position& position, Color side_to_move, int halfmove_clock = 0,
+       int fullmove_number = 1);
+
+  // Starts at 1, and is incremented after each black move.
+  int Turn() const;
+  Color ActivePlayerColor() const { return side_to_move_; }
+  const ::Position& Position() const { return position_; }
+
+  // Moves made since the start of the game.
+  int Ply() const { return static_cast<int>(undo_stack_.size()); }
+
+  // Doesn't check the move is legal.
+  void MakeMove(const Move& move);
+  // Takes back the last move. Returns false if no move was made yet.
+  bool TakeBack();
+
+  // Plies since the last capture or pawn move.
+  int HalfmoveClock() const { return halfmove_clock_; }
+
+  // Number of times the current position occured before, with the same side
+  // to move. Only the positions since the last capture or pawn move are
+  // compared, as none before it can occur again, and every other one of them,
+  // as the side to move alternates.
+  int Repetitions() const;
+
+  bool IsThreefoldRepetition() const { return Repetitions() >= 2; }
+  // A hundred plies without a capture or pawn move.
+  bool IsFiftyMoveDraw() const { return halfmove_clock_ >= 100; }
+
+  // Hashes of the positions since the last capture or pawn move, oldest
+  // first, without the current one. These are the only ones later positions
+  // may repeat, e.g. for SearchOptions::game_hashes.
+  std::vector<uint64_t> ReversibleHashes() const;
+
+ private:
+  struct HistoryEntry {
+    UndoRecord undo;
+    // The clock before the move, which can't be recomputed when taking back a
+    // capture or a pawn move.
+    int halfmove_clock;
+  };
+
+  ::Position position_;
+  Color side_to_move_;
+  int halfmove_clock_;
+  int fullmove_number_;
+
+  std::vector<HistoryEntry> undo_stack_;
+  // Hashes of all the positions of the game, the current one last. Kept apart
+  // from the undo records, so that repetition checks scan contiguous memory.
+  std::vector<uint64_t> hashes_;
+};
+
+#endif // ENGINE_GAME_H_
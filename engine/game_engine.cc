@@ -5,94 +5,83 @@
 #include <utility>
 #include <vector>
 
+#include "engine/attacks.h"
+#include "engine/latency.h"
+#include "engine/stats.h"
+
 namespace {
-// The following static methods return possible move directions for Bishop, Rook
-// and Queen, and move deltas for the Knights.
-// The underlying vectors are only initialized once thanks to Meyers singleton
-// pattern: static variables with block scope are only initialized once and are
-// thread-safe.
-// We are using dynamic initialization instead of compile-time hardcoded list to
-// avoid possible typos and to brag about our design pattern knowledge.
-static const std::vector<std::pair<int, int>>& GetBishopMoveDirections() {
-  // Mind the lambda: while a static variable initialization only happens once
-  // when in a scoped context, any further modificatioins to said variable may
-  // happen any time this function is called. By initializing at declaration
-  // time, we ensure that the lambda below is only called once.
-  static const std::vector<std::pair<int, int>> move_directions = []() {
-    std::vector<std::pair<int, int>> move_directions;
-    for (int dx = -1; dx <= 1; dx += 2) {
-      for (int dy = -1; dy <= 1; dy += 2) {
-        move_directions.push_back({dx, dy});
-      }
-    }
-    return move_directions;
-  }();
-  return move_directions;
-}
+// Move directions of the sliding pieces, and move deltas of the knight, as
+// (dx, dy) pairs. Constant tables rather than containers, so that the inner
+// loops of move generation read them without any initialization check.
+static constexpr std::pair<int, int> BISHOP_DIRECTIONS[] = {
+    {-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+static constexpr std::pair<int, int> ROOK_DIRECTIONS[] = {
+    {-1, 0}, {0, -1}, {0, 1}, {1, 0}};
+static constexpr std::pair<int, int> QUEEN_DIRECTIONS[] = {
+    {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+static constexpr std::pair<int, int> KNIGHT_MOVES[] = {
+    {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
 
-static const std::vector<std::pair<int, int>>& GetRookMoveDirections() {
-  static const std::vector<std::pair<int, int>> move_directions = []() {
-    std::vector<std::pair<int, int>> move_directions;
-    for (int dx = -1; dx <= 1; ++dx) {
-      for (int dy = -1; dy <= 1; ++dy) {
-        if (std::abs(dx) + std::abs(dy) == 1) {
-          move_directions.push_back({dx, dy});
-        }
-      }
-    }
-    return move_directions;
-  }();
-  return move_directions;
-}
+// Most valuable first, so that move ordering ties favor the queen.
+static constexpr Kind PROMOTION_KINDS[] = {Kind::QUEEN, Kind::KNIGHT,
+                                           Kind::ROOK, Kind::BISHOP};
 
-static const std::vector<std::pair<int, int>>& GetQueenMoveDirections() {
-  static const std::vector<std::pair<int, int>> move_directions = []() {
-    std::vector<std::pair<int, int>> move_directions;
-    for (int dx = -1; dx <= 1; ++dx) {
-      for (int dy = -1; dy <= 1; ++dy) {
-        if (dx != 0 || dy != 0) {
-          move_directions.push_back({dx, dy});
-        }
-      }
-    }
-    return move_directions;
-  }();
-  return move_directions;
+bool IsValidCoordinate(int x, int y) {
+  return x >= 0 && y >= 0 && x < BOARD_SIZE && y < BOARD_SIZE;
 }
 
-static const std::vector<std::pair<int, int>>& GetKnightMoves() {
-  static const std::vector<std::pair<int, int>> moves = []() {
-    std::vector<std::pair<int, int>> moves;
-    for (int dx = -2; dx <= 2; ++dx) {
-      for (int dy = -2; dy <= 2; ++dy) {
-        if (std::abs(dx) + std::abs(dy) == 3) {
-          moves.push_back({dx, dy});
-        }
-      }
-    }
-    return moves;
-  }();
-  return moves;
+// Captures and quiet moves may be generated separately, so that a search
+// cutting off on a capture never pays for generating the quiet moves.
+enum class MoveSelection { ALL, CAPTURES, QUIETS };
+
+bool IsSelected(MoveSelection selection, bool is_a_capture) {
+  return selection == MoveSelection::ALL ||
+         (selection == MoveSelection::CAPTURES) == is_a_capture;
 }
 
-bool IsValidCoordinate(int x, int y) {
-  return x >= 0 && y >= 0 && x < BOARD_SIZE && y < BOARD_SIZE;
+// Compile-time constants of the pawns and the king of a side, so that move
+// generation specialized for a side never branches on its color.
+template <Color Us>
+struct Side {
+  static constexpr Color THEM =
+      Us == Color::WHITE ? Color::BLACK : Color::WHITE;
+  static constexpr int PAWN_DIRECTION = Us == Color::WHITE ? 1 : -1;
+  static constexpr int PAWN_START_RANK = Us == Color::WHITE ? TWO : SEVEN;
+  static constexpr int LAST_RANK = Us == Color::WHITE ? EIGHT : ONE;
+  // Where a pawn stands to take en passant.
+  static constexpr int EN_PASSANT_RANK = Us == Color::WHITE ? FIVE : FOUR;
+  // Where the king and the rooks castle.
+  static constexpr int BACK_RANK = Us == Color::WHITE ? ONE : EIGHT;
+};
+
+template <Kind K>
+constexpr const auto& SliderDirections() {
+  if constexpr (K == Kind::BISHOP) {
+    return BISHOP_DIRECTIONS;
+  } else if constexpr (K == Kind::ROOK) {
+    return ROOK_DIRECTIONS;
+  } else {
+    return QUEEN_DIRECTIONS;
+  }
 }
 
+template <Color Us>
 void AddMovesInDirection(const Position& position, int start_x, int start_y,
                          int direction_x, int direction_y,
-                         std::vector<Move>* moves) {
+                         MoveSelection selection, MoveList* moves) {
   int x = start_x + direction_x;
   int y = start_y + direction_y;
   while (IsValidCoordinate(x, y)) {
     if (!position.HasPiece(x, y)) {
-      moves->push_back(Move(&position, start_x, start_y, x, y));
+      if (selection != MoveSelection::CAPTURES) {
+        moves->push_back(Move(&position, start_x, start_y, x, y));
+      }
       x += direction_x;
       y += direction_y;
       continue;
     }
-    if (position.GetPiece(x, y).Color() !=
-        position.GetPiece(start_x, start_y).Color()) {
+    if (selection != MoveSelection::QUIETS &&
+        (position.Occupancy(Side<Us>::THEM) & SquareBit(x, y))) {
       moves->push_back(Move(&position, start_x, start_y, x, y));
     }
     break;
@@ -100,264 +89,499 @@ void AddMovesInDirection(const Position& position, int start_x, int start_y,
 }
 
 std::pair<int, int> FindKingOfColor(const Position& position, Color color) {
-  for (int x = 0; x < BOARD_SIZE; ++x) {
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-      if (position.HasPiece(x, y)) {
-        const Piece& piece = position.GetPiece(x, y);
-        if (piece.Kind() == Kind::KING && piece.Color() == color) {
-          return std::make_pair(x, y);
-        }
-      }
-    }
+  const int king = position.KingSquare(color);
+  if (king < 0) {
+    // Must never happen
+    return std::make_pair(-1, -1);
   }
-  // Must never happen
-  return std::make_pair(-1, -1);
+  const Square square = SquareFromIndex(king);
+  return std::make_pair(square.file, square.rank);
 }
 
-template <typename T, typename Key>
-bool Contains(const T& set_or_map, const Key& key) {
-  return set_or_map.find(key) != set_or_map.end();
+// Whether a square is attacked by the enemies of a given side.
+template <Color Us>
+bool IsAttacked(const Position& position, const Square& square) {
+  return (GetAttackersTo(position, square, position.Occupancy()) &
+          position.Occupancy(Side<Us>::THEM)) != 0;
 }
 
-std::vector<Move> GenerateNonCastlingMovesForAKing(
-    const Position& position, int x, int y,
-    const std::unordered_set<Square>& squares_under_attack) {
-  std::vector<Move> moves;
-  const Color king_color = position.GetPiece(x, y).Color();
-  const std::pair<int, int> enemy_king_position = FindKingOfColor(
-      position, king_color == Color::BLACK ? Color::WHITE : Color::BLACK);
-  for (int dx = -1; dx <= 1; ++dx) {
-    for (int dy = -1; dy <= 1; ++dy) {
-      if (dx == 0 && dy == 0) {
-        continue;
-      }
-      if (!IsValidCoordinate(x + dx, y + dy)) {
-        continue;
-      }
-      if (position.HasPiece(x + dx, y + dy) &&
-          position.GetPiece(x + dx, y + dy).Color() == king_color) {
-        continue;
-      }
-      if (Contains(squares_under_attack, Square{x + dx, y + dy})) {
-        continue;
-      }
-      if (std::abs(x + dx - enemy_king_position.first) <= 1 &&
-          std::abs(y + dy - enemy_king_position.second) <= 1) {
-        continue;
-      }
-      moves.push_back(Move(&position, x, y, x + dx, y + dy));
-    }
+// King moves are pseudo-legal as the other moves: whether the destination is
+// attacked is left to IsLegal(), so that a node cutting off before trying any
+// king move never pays for it. Only castling needs its path to be safe.
+template <Color Us>
+void AddKingMoves(const Position& position, int x, int y,
+                  MoveSelection selection, MoveList* moves) {
+  Bitboard targets = KingAttacks(SquareIndex(x, y)) & ~position.Occupancy(Us);
+  if (selection == MoveSelection::CAPTURES) {
+    targets &= position.Occupancy(Side<Us>::THEM);
+  } else if (selection == MoveSelection::QUIETS) {
+    targets &= ~position.Occupancy();
   }
-  return moves;
-}
-
-std::vector<Move> GenerateMovesForAKing(const Position& position, int x,
-                                        int y) {
-  const Color king_color = position.GetPiece(x, y).Color();
-  const std::unordered_set<Square> squares_under_attack =
-      GetSquaresUnderAttack(position, OppositeColor(king_color));
-  std::vector<Move> moves =
-      GenerateNonCastlingMovesForAKing(position, x, y, squares_under_attack);
-
-  // Castling.
-  const int starting_rank = (king_color == Color::WHITE ? ONE : EIGHT);
-  if (x != E || y != starting_rank) {
-    return moves;
-  }
-
-  if (Contains(squares_under_attack, Square{x, y})) {
-    return moves;
-  }
-  // Short castling
-  int route_x = x;
-  if (position.ShortCastlingPossible(king_color)) {
-    do {
-      if (!position.HasPiece(H, starting_rank) ||
-          (position.GetPiece(H, starting_rank) !=
-           Piece(Kind::ROOK, king_color))) {
-        break;
-      }
-      ++route_x;
-      if (position.HasPiece(Square{route_x, y})) {
-        break;
-      }
-      if (Contains(squares_under_attack, Square{route_x, y})) {
-        break;
-      }
-      if (route_x == G) {
-        moves.push_back(Move(&position, x, y, route_x, y));
-      }
-    } while (route_x < G);
-  }
-  // Long castling
-  if (position.LongCastlingPossible(king_color) &&
-      !position.HasPiece(Square{G, y})) {
-    route_x = x;
-    do {
-      if (!position.HasPiece(A, starting_rank) ||
-          (position.GetPiece(A, starting_rank) !=
-           Piece(Kind::ROOK, king_color))) {
-        break;
-      }
-      --route_x;
-      if (position.HasPiece(Square{route_x, y})) {
-        break;
-      }
-      if (Contains(squares_under_attack, Square{route_x, y})) {
-        break;
-      }
-      if (route_x == C) {
-        moves.push_back(Move(&position, x, y, route_x, y));
-      }
-    } while (route_x > C);
+  while (targets) {
+    moves->push_back(Move(&position, Square{x, y},
+                          SquareFromIndex(PopLowestSquareIndex(&targets))));
   }
 
-  return moves;
-}
-
-std::vector<Move> GenerateMovesForAKnight(const Position& position, int x,
-                                          int y) {
-  std::vector<Move> moves;
-  const Color knight_color = position.GetPiece(x, y).Color();
-
-  for (const std::pair<int, int>& move : GetKnightMoves()) {
-    int to_x = x + move.first;
-    int to_y = y + move.second;
-
-    if (IsValidCoordinate(to_x, to_y) &&
-        (!position.HasPiece(to_x, to_y) ||
-         position.GetPiece(to_x, to_y).Color() != knight_color)) {
-      moves.push_back(Move(&position, x, y, to_x, to_y));
-    }
+  // Castling, neither out of, through nor into check.
+  constexpr int starting_rank = Side<Us>::BACK_RANK;
+  if (selection == MoveSelection::CAPTURES || x != E || y != starting_rank) {
+    return;
+  }
+  const Piece rook(Kind::ROOK, Us);
+  const bool short_castling =
+      position.ShortCastlingPossible(Us) &&
+      position.HasPiece(H, starting_rank) &&
+      position.GetPiece(H, starting_rank) == rook &&
+      !position.HasPiece(F, starting_rank) &&
+      !position.HasPiece(G, starting_rank);
+  const bool long_castling =
+      position.LongCastlingPossible(Us) &&
+      position.HasPiece(A, starting_rank) &&
+      position.GetPiece(A, starting_rank) == rook &&
+      !position.HasPiece(B, starting_rank) &&
+      !position.HasPiece(C, starting_rank) &&
+      !position.HasPiece(D, starting_rank);
+  if ((!short_castling && !long_castling) ||
+      IsAttacked<Us>(position, Square{E, starting_rank})) {
+    return;
+  }
+  if (short_castling && !IsAttacked<Us>(position, Square{F, starting_rank}) &&
+      !IsAttacked<Us>(position, Square{G, starting_rank})) {
+    moves->push_back(Move(&position, x, y, G, y));
+  }
+  if (long_castling && !IsAttacked<Us>(position, Square{D, starting_rank}) &&
+      !IsAttacked<Us>(position, Square{C, starting_rank})) {
+    moves->push_back(Move(&position, x, y, C, y));
   }
-
-  return moves;
 }
 
-bool PawnHasNeverMoved(const Position& position, int x, int y) {
-  if (position.GetPiece(x, y).Color() == Color::WHITE) {
-    return y == 1;
-  } else {
-    return y == BOARD_SIZE - 2;
+// A pawn move, or one move per promotion kind if it reaches the last rank.
+template <Color Us>
+void AddPawnMove(const Position& position, int x, int y, int to_x, int to_y,
+                 MoveList* moves) {
+  if (to_y != Side<Us>::LAST_RANK) {
+    moves->push_back(Move(&position, x, y, to_x, to_y));
+    return;
+  }
+  for (const Kind promotion : PROMOTION_KINDS) {
+    moves->push_back(Move(&position, x, y, to_x, to_y, promotion));
   }
 }
 
-std::vector<Move> GenerateMovesForAPawn(const Position& position, int x,
-                                        int y) {
-  std::vector<Move> moves;
-  const Color pawn_color = position.GetPiece(x, y).Color();
-
-  const int vertical_move_direction = pawn_color == Color::WHITE ? 1 : -1;
-  if (!position.HasPiece(x, y + vertical_move_direction)) {
-    moves.push_back(Move(&position, x, y, x, y + vertical_move_direction));
-    if (PawnHasNeverMoved(position, x, y) &&
+template <Color Us>
+void AddPawnMoves(const Position& position, int x, int y,
+                  MoveSelection selection, MoveList* moves) {
+  constexpr int vertical_move_direction = Side<Us>::PAWN_DIRECTION;
+  // A pawn promotes on reaching the last rank, but may still be set up there,
+  // and must not step off the board.
+  if (y == Side<Us>::LAST_RANK) {
+    return;
+  }
+  if (selection != MoveSelection::CAPTURES &&
+      !position.HasPiece(x, y + vertical_move_direction)) {
+    AddPawnMove<Us>(position, x, y, x, y + vertical_move_direction, moves);
+    if (y == Side<Us>::PAWN_START_RANK &&
         !position.HasPiece(x, y + 2 * vertical_move_direction)) {
-      moves.push_back(
+      moves->push_back(
           Move(&position, x, y, x, y + 2 * vertical_move_direction));
     }
   }
 
+  if (selection == MoveSelection::QUIETS) {
+    return;
+  }
+  const Bitboard enemies = position.Occupancy(Side<Us>::THEM);
   if (x < BOARD_SIZE - 1 &&
-      position.HasPiece(x + 1, y + vertical_move_direction) &&
-      position.GetPiece(x + 1, y + vertical_move_direction).Color() !=
-          pawn_color) {
-    moves.push_back(Move(&position, x, y, x + 1, y + vertical_move_direction));
+      (enemies & SquareBit(x + 1, y + vertical_move_direction))) {
+    AddPawnMove<Us>(position, x, y, x + 1, y + vertical_move_direction, moves);
   }
-  if (x > 0 && position.HasPiece(x - 1, y + vertical_move_direction) &&
-      position.GetPiece(x - 1, y + vertical_move_direction).Color() !=
-          pawn_color) {
-    moves.push_back(Move(&position, x, y, x - 1, y + vertical_move_direction));
+  if (x > 0 && (enemies & SquareBit(x - 1, y + vertical_move_direction))) {
+    AddPawnMove<Us>(position, x, y, x - 1, y + vertical_move_direction, moves);
   }
 
-  // TODO: Implement en passant.
-
-  return moves;
+  // The en passant square is always empty, and behind the pawn of the other
+  // side only from the rank checked.
+  if (y == Side<Us>::EN_PASSANT_RANK) {
+    const Bitboard en_passant =
+        PawnAttacks(Us, SquareIndex(x, y)) & position.EnPassantSquare();
+    if (en_passant) {
+      moves->push_back(Move(&position, Square{x, y},
+                            SquareFromIndex(LowestSquareIndex(en_passant))));
+    }
+  }
 }
 
-} // namespace
+// Moves of a piece of a given kind and side, with everything that depends on
+// either known at compile time.
+template <Color Us, Kind K>
+void AddPieceMoves(const Position& position, int x, int y,
+                   MoveSelection selection, MoveList* moves) {
+  if constexpr (K == Kind::PAWN) {
+    AddPawnMoves<Us>(position, x, y, selection, moves);
+  } else if constexpr (K == Kind::KING) {
+    AddKingMoves<Us>(position, x, y, selection, moves);
+  } else if constexpr (K == Kind::KNIGHT) {
+    for (const auto& [dx, dy] : KNIGHT_MOVES) {
+      const int to_x = x + dx;
+      const int to_y = y + dy;
+      if (IsValidCoordinate(to_x, to_y) &&
+          !(position.Occupancy(Us) & SquareBit(to_x, to_y)) &&
+          IsSelected(selection, position.HasPiece(to_x, to_y))) {
+        moves->push_back(Move(&position, x, y, to_x, to_y));
+      }
+    }
+  } else {
+    for (const auto& [dx, dy] : SliderDirections<K>()) {
+      AddMovesInDirection<Us>(position, x, y, dx, dy, selection, moves);
+    }
+  }
+}
 
-std::vector<Move> GenerateMovesForAPiece(const Position& position, int x,
-                                         int y) {
-  const Piece piece = position.GetPiece(x, y);
-  Kind kind = piece.Kind();
-  std::vector<Move> moves;
+template <Color Us>
+void AddMovesForAPiece(const Position& position, Kind kind, int x, int y,
+                       MoveSelection selection, MoveList* moves) {
+  CountEvent(Counter::PIECE_MOVE_GENERATIONS);
   switch (kind) {
   case Kind::PAWN:
-    return GenerateMovesForAPawn(position, x, y);
+    AddPieceMoves<Us, Kind::PAWN>(position, x, y, selection, moves);
+    break;
   case Kind::BISHOP:
-    for (const std::pair<int, int>& direction : GetBishopMoveDirections()) {
-      AddMovesInDirection(position, x, y, direction.first, direction.second,
-                          &moves);
-    }
+    AddPieceMoves<Us, Kind::BISHOP>(position, x, y, selection, moves);
     break;
   case Kind::ROOK:
-    for (const std::pair<int, int>& direction : GetRookMoveDirections()) {
-      AddMovesInDirection(position, x, y, direction.first, direction.second,
-                          &moves);
-    }
+    AddPieceMoves<Us, Kind::ROOK>(position, x, y, selection, moves);
     break;
   case Kind::QUEEN:
-    for (const std::pair<int, int>& direction : GetQueenMoveDirections()) {
-      AddMovesInDirection(position, x, y, direction.first, direction.second,
-                          &moves);
-    }
+    AddPieceMoves<Us, Kind::QUEEN>(position, x, y, selection, moves);
     break;
   case Kind::KING:
-    return GenerateMovesForAKing(position, x, y);
+    AddPieceMoves<Us, Kind::KING>(position, x, y, selection, moves);
+    break;
   case Kind::KNIGHT:
-    return GenerateMovesForAKnight(position, x, y);
+    AddPieceMoves<Us, Kind::KNIGHT>(position, x, y, selection, moves);
+    break;
   case Kind::NONE:
   default:
     break;
   }
+}
+
+template <Color Us, Kind K>
+void AddMovesOfKind(const Position& position, MoveSelection selection,
+                    MoveList* moves) {
+  Bitboard pieces = position.Pieces(Us, K);
+  while (pieces) {
+    const Square square = SquareFromIndex(PopLowestSquareIndex(&pieces));
+    CountEvent(Counter::PIECE_MOVE_GENERATIONS);
+    AddPieceMoves<Us, K>(position, square.file, square.rank, selection, moves);
+  }
+}
+
+// All the moves of a side go straight into one list, one kind of piece after
+// the other, so that no piece is looked up on the board.
+template <Color Us>
+void AddSelectedMoves(const Position& position, MoveSelection selection,
+                      MoveList* moves) {
+  AddMovesOfKind<Us, Kind::PAWN>(position, selection, moves);
+  AddMovesOfKind<Us, Kind::KNIGHT>(position, selection, moves);
+  AddMovesOfKind<Us, Kind::BISHOP>(position, selection, moves);
+  AddMovesOfKind<Us, Kind::ROOK>(position, selection, moves);
+  AddMovesOfKind<Us, Kind::QUEEN>(position, selection, moves);
+  AddMovesOfKind<Us, Kind::KING>(position, selection, moves);
+}
+
+MoveList GenerateSelectedMoves(const Position& position, Color color,
+                               MoveSelection selection) {
+  ScopedLatency latency(TimedOperation::MOVE_GENERATION);
+  CountEvent(Counter::SIDE_MOVE_GENERATIONS);
+  MoveList moves(TransientMemory());
+  if (color == Color::WHITE) {
+    AddSelectedMoves<Color::WHITE>(position, selection, &moves);
+  } else {
+    AddSelectedMoves<Color::BLACK>(position, selection, &moves);
+  }
+  CountEvent(Counter::MOVE_LIST_ALLOCATIONS, !moves.empty());
+  return moves;
+}
+
+// Whether a piece may make a move, as its generated moves tell, but looking
+// the destination up in the attack tables instead of generating them.
+bool CanMakeMove(const Position& position, const Move& move) {
+  const Square from = move.From();
+  const Square to = move.To();
+  if (!position.HasPiece(from)) {
+    return false;
+  }
+  const Piece piece = position.GetPiece(from);
+  const Color color = piece.Color();
+  // Pawns must promote, and only them.
+  const bool promotes = piece.Kind() == Kind::PAWN &&
+                        to.rank == (color == Color::WHITE ? EIGHT : ONE);
+  if (promotes ? (move.Promotion() == Kind::NONE ||
+                  move.Promotion() == Kind::PAWN ||
+                  move.Promotion() == Kind::KING)
+               : move.Promotion() != Kind::NONE) {
+    return false;
+  }
+  const int from_index = SquareIndex(from);
+  const Bitboard to_bit = SquareBit(to);
+  const Bitboard occupancy = position.Occupancy();
+  const Bitboard enemies = position.Occupancy(OppositeColor(color));
+  if (position.Occupancy(color) & to_bit) {
+    return false;
+  }
+  switch (piece.Kind()) {
+  case Kind::PAWN: {
+    const int direction = color == Color::WHITE ? 1 : -1;
+    const int start_rank = color == Color::WHITE ? TWO : SEVEN;
+    if (to.file == from.file && !(occupancy & to_bit)) {
+      return to.rank == from.rank + direction ||
+             (to.rank == from.rank + 2 * direction && from.rank == start_rank &&
+              !position.HasPiece(from.file, from.rank + direction));
+    }
+    const int en_passant_rank = color == Color::WHITE ? FIVE : FOUR;
+    const Bitboard targets =
+        enemies |
+        (from.rank == en_passant_rank ? position.EnPassantSquare() : 0);
+    return (PawnAttacks(color, from_index) & targets & to_bit) != 0;
+  }
+  case Kind::KING: {
+    if (!(KingAttacks(from_index) & to_bit)) {
+      // Castling, the only other king move, is rare enough to be left to the
+      // move generation.
+      for (const Move& move :
+           GenerateMovesForAPiece(position, from.file, from.rank)) {
+        if (move.To() == to) {
+          return true;
+        }
+      }
+      return false;
+    }
+    // The king must not take a protected piece, nor stay on the line of a
+    // slider it moves away from.
+    return (GetAttackersTo(position, to, occupancy & ~SquareBit(from)) &
+            enemies & ~to_bit) == 0;
+  }
+  case Kind::NONE:
+    return false;
+  default:
+    return (PieceAttacks(piece.Kind(), from_index, occupancy) & to_bit) != 0;
+  }
+}
+
+} // namespace
+
+MoveList GenerateMovesForAPiece(const Position& position, int x, int y) {
+  MoveList moves(TransientMemory());
+  const Piece piece = position.GetPiece(x, y);
+  if (piece.Color() == Color::WHITE) {
+    AddMovesForAPiece<Color::WHITE>(position, piece.Kind(), x, y,
+                                    MoveSelection::ALL, &moves);
+  } else {
+    AddMovesForAPiece<Color::BLACK>(position, piece.Kind(), x, y,
+                                    MoveSelection::ALL, &moves);
+  }
+  CountEvent(Counter::MOVE_LIST_ALLOCATIONS, !moves.empty());
   return moves;
 }
 
 bool MoveIsValid(const Position& position, const Move& move) {
-  for (const Move& possible_move :
-       GenerateMovesForAPiece(position, move.From().file, move.From().rank)) {
-    if (move.To() == possible_move.To()) {
-      return true;
+  CountEvent(Counter::LEGALITY_CHECKS);
+  return CanMakeMove(position, move);
+}
+
+std::vector<bool> MovesAreValid(const std::vector<MoveInPosition>& moves) {
+  CountEvent(Counter::LEGALITY_CHECKS, moves.size());
+  std::vector<bool> valid(moves.size());
+  for (size_t i = 0; i < moves.size(); ++i) {
+    valid[i] = CanMakeMove(*moves[i].position, moves[i].move);
+  }
+  return valid;
+}
+
+SquareSet GetSquaresUnderAttack(const Position& position,
+                                Color attacking_color) {
+  CountEvent(Counter::ATTACK_MAP_BUILDS);
+  SquareSet squares_under_attack(TransientMemory());
+  const Bitboard pawns = position.Pieces(attacking_color, Kind::PAWN);
+  const Bitboard kings = position.Pieces(attacking_color, Kind::KING);
+  Bitboard pieces = pawns;
+  while (pieces) {
+    Bitboard targets =
+        PawnAttacks(attacking_color, PopLowestSquareIndex(&pieces)) &
+        ~position.Occupancy(attacking_color);
+    while (targets) {
+      squares_under_attack.insert(
+          SquareFromIndex(PopLowestSquareIndex(&targets)));
+    }
+  }
+  pieces = kings;
+  while (pieces) {
+    Bitboard targets = KingAttacks(PopLowestSquareIndex(&pieces)) &
+                       ~position.Occupancy(attacking_color);
+    while (targets) {
+      squares_under_attack.insert(
+          SquareFromIndex(PopLowestSquareIndex(&targets)));
+    }
+  }
+  pieces = position.Occupancy(attacking_color) & ~pawns & ~kings;
+  while (pieces) {
+    const Square square = SquareFromIndex(PopLowestSquareIndex(&pieces));
+    for (const Move& move :
+         GenerateMovesForAPiece(position, square.file, square.rank)) {
+      squares_under_attack.insert(move.To());
     }
   }
+  return squares_under_attack;
+}
 
-  return false;
+Bitboard GetAttackersTo(const Position& position, const Square& square,
+                        Bitboard occupancy) {
+  CountEvent(Counter::ATTACKER_LOOKUPS);
+  const int target = SquareIndex(square);
+  const auto both_colors = [&](Kind kind) {
+    return position.Pieces(Color::WHITE, kind) |
+           position.Pieces(Color::BLACK, kind);
+  };
+  const Bitboard queens = both_colors(Kind::QUEEN);
+
+  // Pawns attack diagonally forward, so a white pawn attacking the square
+  // stands where a black pawn on it would attack, and the other way round.
+  // Sliders see the square through the same ray it sees them through.
+  const Bitboard attackers =
+      (PawnAttacks(Color::BLACK, target) &
+       position.Pieces(Color::WHITE, Kind::PAWN)) |
+      (PawnAttacks(Color::WHITE, target) &
+       position.Pieces(Color::BLACK, Kind::PAWN)) |
+      (KnightAttacks(target) & both_colors(Kind::KNIGHT)) |
+      (KingAttacks(target) & both_colors(Kind::KING)) |
+      (BishopAttacks(target, occupancy) &
+       (both_colors(Kind::BISHOP) | queens)) |
+      (RookAttacks(target, occupancy) & (both_colors(Kind::ROOK) | queens));
+  return attackers & occupancy;
 }
 
-std::unordered_set<Square> GetSquaresUnderAttack(const Position& position,
-                                                 Color attacking_color) {
-  std::unordered_set<Square> squares_under_attack;
-  for (int x = 0; x < BOARD_SIZE; ++x) {
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-      if (position.HasPiece(x, y) &&
-          position.GetPiece(x, y).Color() == attacking_color) {
-        const Piece& piece = position.GetPiece(x, y);
-        if (piece.Kind() == Kind::PAWN) {
-          int to_x = x - 1;
-          int to_y = y + (piece.Color() == Color::WHITE ? 1 : -1);
-          if (IsValidCoordinate(to_x, to_y) &&
-              (!position.HasPiece(to_x, to_y) ||
-               position.GetPiece(to_x, to_y).Color() != piece.Color())) {
-            squares_under_attack.insert(Square{to_x, to_y});
-          }
-          to_x = x + 1;
-          if (IsValidCoordinate(to_x, to_y) &&
-              (!position.HasPiece(to_x, to_y) ||
-               position.GetPiece(to_x, to_y).Color() != piece.Color())) {
-            squares_under_attack.insert(Square{to_x, to_y});
-          }
-        } else if (piece.Kind() == Kind::KING) {
-          for (const Move& move :
-               GenerateNonCastlingMovesForAKing(position, x, y, {})) {
-            squares_under_attack.insert(move.To());
-          }
-        } else {
-          for (const Move& move : GenerateMovesForAPiece(position, x, y)) {
-            squares_under_attack.insert(move.To());
-          }
-        }
+bool IsInCheck(const Position& position, Color color) {
+  const std::pair<int, int> king = FindKingOfColor(position, color);
+  if (king.first < 0) {
+    return false;
+  }
+  return (GetAttackersTo(position, Square{king.first, king.second},
+                         position.Occupancy()) &
+          position.Occupancy(OppositeColor(color))) != 0;
+}
+
+MoveList GenerateMoves(const Position& position, Color color) {
+  return GenerateSelectedMoves(position, color, MoveSelection::ALL);
+}
+
+MoveList GenerateCaptures(const Position& position, Color color) {
+  return GenerateSelectedMoves(position, color, MoveSelection::CAPTURES);
+}
+
+MoveList GenerateQuietMoves(const Position& position, Color color) {
+  return GenerateSelectedMoves(position, color, MoveSelection::QUIETS);
+}
+
+bool LeavesKingInCheck(const Position& position, const Move& move) {
+  CountEvent(Counter::LEGALITY_CHECKS);
+  const Color color = position.GetPiece(move.From()).Color();
+  Position child = position;
+  child.MakeMove(move.From(), move.To(), move.Promotion());
+  return IsInCheck(child, color);
+}
+
+LegalityInfo ComputeLegalityInfo(const Position& position, Color color) {
+  LegalityInfo info;
+  const std::pair<int, int> king = FindKingOfColor(position, color);
+  if (king.first < 0) {
+    return info;
+  }
+  info.king_square = SquareIndex(king.first, king.second);
+  const Bitboard occupancy = position.Occupancy();
+  const Bitboard enemies = position.Occupancy(OppositeColor(color));
+  info.checkers =
+      GetAttackersTo(position, Square{king.first, king.second}, occupancy) &
+      enemies;
+
+  // Enemy sliders which would attack the king if the board were empty pin
+  // the only piece standing between them, if it is an own one.
+  const Color enemy = OppositeColor(color);
+  const auto add_pins = [&](Bitboard snipers, Kind slider_kind) {
+    snipers &= position.Pieces(enemy, slider_kind) |
+               position.Pieces(enemy, Kind::QUEEN);
+    while (snipers) {
+      const int sniper = PopLowestSquareIndex(&snipers);
+      const Bitboard between =
+          BetweenSquares(info.king_square, sniper) & occupancy;
+      if (PopCount(between) == 1 && (between & position.Occupancy(color))) {
+        info.pinned |= between;
       }
     }
+  };
+  add_pins(BishopAttacks(info.king_square, 0), Kind::BISHOP);
+  add_pins(RookAttacks(info.king_square, 0), Kind::ROOK);
+  return info;
+}
+
+bool IsLegal(const Position& position, const Move& move,
+             const LegalityInfo& info) {
+  CountEvent(Counter::LEGALITY_CHECKS);
+  if (info.king_square < 0) {
+    return true;
   }
-  return squares_under_attack;
+  const int from = SquareIndex(move.From());
+  const Bitboard to = SquareBit(move.To());
+  if (from == info.king_square) {
+    // The king must not stay on the line of a slider it moves away from, so
+    // it doesn't block any attacks on its destination.
+    const Color color = position.GetPiece(move.From()).Color();
+    const Bitboard occupancy = position.Occupancy() & ~(Bitboard{1} << from);
+    return (GetAttackersTo(position, move.To(), occupancy) &
+            position.Occupancy(OppositeColor(color)) & ~to) == 0;
+  }
+  if (move.From().file != move.To().file &&
+      (position.EnPassantSquare() & to) &&
+      position.GetPiece(move.From()).Kind() == Kind::PAWN) {
+    // Taking en passant empties two squares, which may both stand between the
+    // king and a slider on its rank, and may take a checking pawn off a square
+    // other than its destination, so the attacks on the king are looked up on
+    // the board as the move leaves it.
+    const Color color = position.GetPiece(move.From()).Color();
+    const Bitboard occupancy =
+        (position.Occupancy() & ~(Bitboard{1} << from) &
+         ~SquareBit(move.To().file, move.From().rank)) |
+        to;
+    return (GetAttackersTo(position, SquareFromIndex(info.king_square),
+                           occupancy) &
+            position.Occupancy(OppositeColor(color))) == 0;
+  }
+  if (info.checkers != 0) {
+    // Only the king can escape a double check, and a single one must
+    // otherwise be blocked or the checker taken.
+    if (PopCount(info.checkers) > 1) {
+      return false;
+    }
+    const int checker = LowestSquareIndex(info.checkers);
+    if (((BetweenSquares(info.king_square, checker) | info.checkers) & to) ==
+        0) {
+      return false;
+    }
+  }
+  if (info.pinned & (Bitboard{1} << from)) {
+    return (LineThrough(info.king_square, from) & to) != 0;
+  }
+  return true;
+}
+
+MoveList GenerateLegalMoves(const Position& position, Color color) {
+  MoveList moves(TransientMemory());
+  const LegalityInfo info = ComputeLegalityInfo(position, color);
+  for (const Move& move : GenerateMoves(position, color)) {
+    if (IsLegal(position, move, info)) {
+      moves.push_back(move);
+    }
+  }
+  CountEvent(Counter::MOVE_LIST_ALLOCATIONS, !moves.empty());
+  return moves;
 }
@@ -1,27 +1,97 @@
 #ifndef ENGINE_GAME_ENGINE_H_
 #define ENGINE_GAME_ENGINE_H_
 
+#include <memory_resource>
 #include <unordered_set>
 #include <vector>
 
+#include "engine/arena.h"
 #include "engine/base.h"
+#include "engine/bitboard.h"
 #include "engine/move.h"
 #include "engine/position.h"
 
+// Containers returned by move generation, allocated from TransientMemory(), so
+// that they come from the arena of a search or game when there is one.
+using MoveList = std::pmr::vector<Move>;
+using SquareSet = std::pmr::unordered_set<Square>;
+
+// Whether a move is among those GenerateMovesForAPiece() returns for the piece
+// on its source square, where a king must also not move into check, e.g. by
+// taking a protected piece. Only castling generates the moves of the piece,
+// all the other moves are looked up in the attack tables.
 bool MoveIsValid(const Position& position, const Move& move);
 
-// Returns a vector of possible moves for a piece at a given position.
-// Includes moves taking an enemy king, as these are only possible after a
-// check-mate.
-// TODO: Disallow moves which put the King under check, namely taking protected
-// enemy pieces and moving the pieces which protect the king.
-std::vector<Move> GenerateMovesForAPiece(const Position& position, int x,
-                                         int y);
+// A move to validate, and the position it is played in. Unowned.
+struct MoveInPosition {
+  const Position* position;
+  Move move;
+};
+
+// MoveIsValid() of each move, for callers validating many moves at once, e.g.
+// from many games being imported.
+std::vector<bool> MovesAreValid(const std::vector<MoveInPosition>& moves);
+
+// Returns a vector of possible moves for a piece at a given position, with one
+// move per promotion kind for a pawn reaching the last rank, and taking en
+// passant. Includes moves taking an enemy king, as these are only possible
+// after a check-mate. These may leave the king in check, see IsLegal() and
+// GenerateLegalMoves().
+MoveList GenerateMovesForAPiece(const Position& position, int x, int y);
 
 // Includes squares under attack from any piece of a given color.
 // TODO: Also include pieces of attacking_color protected by other pieces. That
 // would disallow the king to take protected pieces.
-std::unordered_set<Square> GetSquaresUnderAttack(const Position& position,
-                                                 Color attacking_color);
+SquareSet GetSquaresUnderAttack(const Position& position,
+                                Color attacking_color);
+
+// Returns all pieces of both colors attacking a square, considering only the
+// pieces in `occupancy` both as attackers and as blockers. Passing a reduced
+// occupancy reveals x-ray attackers standing behind removed pieces, which is
+// what the static exchange evaluation relies on.
+Bitboard GetAttackersTo(const Position& position, const Square& square,
+                        Bitboard occupancy);
+
+// Whether the king of a given color is attacked. Returns false if there is no
+// such king on the board.
+bool IsInCheck(const Position& position, Color color);
+
+// Returns moves for all the pieces of a given color, as returned by
+// GenerateMovesForAPiece(). These are pseudo-legal: they may leave the king in
+// check, which IsLegal() tells only for the moves actually tried.
+MoveList GenerateMoves(const Position& position, Color color);
+
+// Subsets of GenerateMoves(): moves taking an enemy piece, and all the other
+// moves including castling. Each only does the work needed for its own
+// subset.
+MoveList GenerateCaptures(const Position& position, Color color);
+MoveList GenerateQuietMoves(const Position& position, Color color);
+
+// Same as GenerateMoves(), but drops moves leaving own king in check.
+MoveList GenerateLegalMoves(const Position& position, Color color);
+
+// Whether making a move generated for `position` leaves the mover's king in
+// check.
+bool LeavesKingInCheck(const Position& position, const Move& move);
+
+// Checks and pins against the king of the side to move, from which the
+// legality of each of its moves follows without making the move.
+struct LegalityInfo {
+  // -1 if there is no king, in which case all moves are legal.
+  int king_square = -1;
+  // Enemy pieces giving check.
+  Bitboard checkers = 0;
+  // Own pieces which may only move along the line between the king and an
+  // enemy slider.
+  Bitboard pinned = 0;
+};
+
+// Takes about as long as IsInCheck(), once per position.
+LegalityInfo ComputeLegalityInfo(const Position& position, Color color);
+
+// Same as !LeavesKingInCheck() for a move generated for `position`, where
+// `info` was computed for the side to move, but usually a few bit operations.
+bool IsLegal(const Position& position, const Move& move,
+             const LegalityInfo& info);
 
 #endif // ENGINE_GAME_ENGINE_H_
\ No newline at end of file
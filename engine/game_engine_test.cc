@@ -1,8 +1,14 @@
 #include "engine/game_engine.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "engine/fen.h"
+
 using testing::UnorderedElementsAre;
 
 // Pawn Tests.
@@ -10,25 +16,71 @@ using testing::UnorderedElementsAre;
 TEST(GenerateMovesForAPiece, WhitePawnOnStartingPosition) {
   Position position;
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, TWO);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, TWO);
+  const MoveList moves = GenerateMovesForAPiece(position, E, TWO);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, TWO, E, THREE),
                                           Move(&position, E, TWO, E, FOUR)));
 }
 
-TEST(GenerateMovesForAPiece, BlackPawnOnRankTwo) {
+TEST(GenerateMovesForAPiece, BlackPawnOnRankTwoPromotes) {
   Position position;
   position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, TWO);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, TWO);
+  const MoveList moves = GenerateMovesForAPiece(position, E, TWO);
+
+  EXPECT_THAT(moves, UnorderedElementsAre(
+                         Move(&position, E, TWO, E, ONE, Kind::QUEEN),
+                         Move(&position, E, TWO, E, ONE, Kind::ROOK),
+                         Move(&position, E, TWO, E, ONE, Kind::BISHOP),
+                         Move(&position, E, TWO, E, ONE, Kind::KNIGHT)));
+}
+
+TEST(GenerateMovesForAPiece, PawnPromotesWhenTaking) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), G, SEVEN);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), G, EIGHT);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), H, EIGHT);
+  const MoveList moves = GenerateMovesForAPiece(position, G, SEVEN);
+
+  EXPECT_THAT(moves, UnorderedElementsAre(
+                         Move(&position, G, SEVEN, H, EIGHT, Kind::QUEEN),
+                         Move(&position, G, SEVEN, H, EIGHT, Kind::ROOK),
+                         Move(&position, G, SEVEN, H, EIGHT, Kind::BISHOP),
+                         Move(&position, G, SEVEN, H, EIGHT, Kind::KNIGHT)));
+}
+
+TEST(GenerateMovesForAPiece, PawnTakesEnPassant) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+  const MoveList moves = GenerateMovesForAPiece(position, E, FIVE);
+
+  EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, FIVE, D, SIX)));
+  EXPECT_TRUE(moves[0].IsACapture());
+  // Only right after the pawn advanced.
+  position.MakeMove({H, EIGHT}, {H, SEVEN});
+  EXPECT_THAT(GenerateMovesForAPiece(position, E, FIVE),
+              UnorderedElementsAre());
+}
+
+TEST(GenerateMovesForAPiece, PawnOnLastRankHasNoMoves) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, ONE);
 
-  EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, TWO, E, ONE)));
+  EXPECT_THAT(GenerateMovesForAPiece(position, E, EIGHT),
+              UnorderedElementsAre());
+  EXPECT_THAT(GenerateMovesForAPiece(position, D, ONE),
+              UnorderedElementsAre());
 }
 
 TEST(GenerateMovesForAPiece, PawnWithSameColorPieceBlockingItsMove) {
   Position position;
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, TWO);
   position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), E, THREE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, TWO);
+  const MoveList moves = GenerateMovesForAPiece(position, E, TWO);
 
   EXPECT_THAT(moves, UnorderedElementsAre());
 }
@@ -37,7 +89,7 @@ TEST(GenerateMovesForAPiece, PawnWithOppositeColorPieceBlockingItsMove) {
   Position position;
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, TWO);
   position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), E, THREE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, TWO);
+  const MoveList moves = GenerateMovesForAPiece(position, E, TWO);
 
   EXPECT_THAT(moves, UnorderedElementsAre());
 }
@@ -46,7 +98,7 @@ TEST(GenerateMovesForAPiece, PawnWithAPieceBlockingTwoSquaresAdvance) {
   Position position;
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, TWO);
   position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), E, FOUR);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, TWO);
+  const MoveList moves = GenerateMovesForAPiece(position, E, TWO);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, TWO, E, THREE)));
 }
@@ -56,7 +108,7 @@ TEST(GenerateMovesForAPiece, PawnTakingAPiece) {
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FOUR);
   position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), D, FIVE);
   position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), F, FIVE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, FOUR);
+  const MoveList moves = GenerateMovesForAPiece(position, E, FOUR);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, FOUR, E, FIVE),
                                           Move(&position, E, FOUR, D, FIVE),
@@ -68,7 +120,7 @@ TEST(GenerateMovesForAPiece, PawnCannotTakeSameColorPiece) {
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FOUR);
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), D, FIVE);
   position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), F, FIVE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, FOUR);
+  const MoveList moves = GenerateMovesForAPiece(position, E, FOUR);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, FOUR, E, FIVE)));
 }
@@ -77,7 +129,7 @@ TEST(GenerateMovesForAPiece, PawnOnFirstFileDoesNotCrash) {
   Position position;
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), A, THREE);
   position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), B, FOUR);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, A, THREE);
+  const MoveList moves = GenerateMovesForAPiece(position, A, THREE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, A, THREE, A, FOUR),
                                           Move(&position, A, THREE, B, FOUR)));
@@ -88,7 +140,7 @@ TEST(GenerateMovesForAPiece, PawnOnFirstFileDoesNotCrash) {
 TEST(GenerateMovesForAPiece, BishopCornered) {
   Position position;
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), A, ONE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, A, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, A, ONE);
 
   EXPECT_EQ(moves.size(), 7);
 }
@@ -96,7 +148,7 @@ TEST(GenerateMovesForAPiece, BishopCornered) {
 TEST(GenerateMovesForAPiece, BishopMoveDirectionsAreInitializedOnce) {
   Position position;
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), A, ONE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, A, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, A, ONE);
 
   // Checking that the move directions singleton vector is actually only
   // initialized once. If it isn't, moves in the same direction would be
@@ -111,7 +163,7 @@ TEST(GenerateMovesForAPiece, BishopMoveDirectionsAreInitializedOnce) {
 TEST(GenerateMovesForAPiece, BishopInAMiddleOfAnEmptyBoard) {
   Position position;
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), E, FOUR);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, FOUR);
+  const MoveList moves = GenerateMovesForAPiece(position, E, FOUR);
 
   EXPECT_THAT(
       moves,
@@ -133,7 +185,7 @@ TEST(GenerateMovesForAPiece, BishopIsBlockedByOppositeColorPieces) {
   position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), F, THREE);
   position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), D, FIVE);
   position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), D, THREE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, FOUR);
+  const MoveList moves = GenerateMovesForAPiece(position, E, FOUR);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, FOUR, F, FIVE),
                                           Move(&position, E, FOUR, G, SIX),
@@ -149,7 +201,7 @@ TEST(GenerateMovesForAPiece, BishopIsBlockedBySameColorPieces) {
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), F, THREE);
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), D, FIVE);
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), D, THREE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, FOUR);
+  const MoveList moves = GenerateMovesForAPiece(position, E, FOUR);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, FOUR, F, FIVE)));
 }
@@ -158,9 +210,9 @@ TEST(GenerateMovesForAPiece, SameColorBishopsInOppositeCorners) {
   Position position;
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), A, ONE);
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), H, EIGHT);
-  const std::vector<Move> first_moves =
+  const MoveList first_moves =
       GenerateMovesForAPiece(position, A, ONE);
-  const std::vector<Move> second_moves =
+  const MoveList second_moves =
       GenerateMovesForAPiece(position, H, EIGHT);
 
   EXPECT_EQ(first_moves.size(), 6);
@@ -171,9 +223,9 @@ TEST(GenerateMovesForAPiece, OppositeColorBishopsInOppositeCorners) {
   Position position;
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), A, ONE);
   position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), H, EIGHT);
-  const std::vector<Move> first_moves =
+  const MoveList first_moves =
       GenerateMovesForAPiece(position, A, ONE);
-  const std::vector<Move> second_moves =
+  const MoveList second_moves =
       GenerateMovesForAPiece(position, H, EIGHT);
 
   EXPECT_EQ(first_moves.size(), 7);
@@ -185,7 +237,7 @@ TEST(GenerateMovesForAPiece, OppositeColorBishopsInOppositeCorners) {
 TEST(GenerateMovesForAPiece, KnightInAMiddleOfAnEmptyBoard) {
   Position position;
   position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), C, SIX);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, C, SIX);
+  const MoveList moves = GenerateMovesForAPiece(position, C, SIX);
 
   EXPECT_THAT(
       moves,
@@ -198,7 +250,7 @@ TEST(GenerateMovesForAPiece, KnightInAMiddleOfAnEmptyBoard) {
 
 TEST(GenerateMovesForAPiece, KnightOnAStartingPosition) {
   Position position = StartingPosition();
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, B, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, B, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, B, ONE, A, THREE),
                                           Move(&position, B, ONE, C, THREE)));
@@ -214,7 +266,7 @@ TEST(GenerateMovesForAPiece, KnightDoesntCareForBeingBlocked) {
       }
     }
   }
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, C, SIX);
+  const MoveList moves = GenerateMovesForAPiece(position, C, SIX);
 
   EXPECT_THAT(
       moves,
@@ -230,7 +282,7 @@ TEST(GenerateMovesForAPiece, KnightCanTakeOppositeColorPieces) {
   position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), A, ONE);
   position.AddPiece(Piece(Kind::PAWN, Color::BLACK), B, THREE);
   position.AddPiece(Piece(Kind::PAWN, Color::BLACK), C, TWO);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, A, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, A, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, A, ONE, B, THREE),
                                           Move(&position, A, ONE, C, TWO)));
@@ -241,51 +293,77 @@ TEST(GenerateMovesForAPiece, KnightCannotTakeSameColorPieces) {
   position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), A, ONE);
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), B, THREE);
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), C, TWO);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, A, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, A, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre());
 }
 
 // King tests.
 
+// The moves GenerateMovesForAPiece() returns which don't leave the king in
+// check, as king moves are only checked for it once tried.
+MoveList GenerateLegalMovesForAPiece(const Position& position, int x, int y) {
+  MoveList moves;
+  for (const Move& move :
+       GenerateLegalMoves(position, position.GetPiece(x, y).Color())) {
+    if (move.From() == Square(x, y)) {
+      moves.push_back(move);
+    }
+  }
+  return moves;
+}
+
 TEST(GenerateMovesForAPiece, KingInAMiddleOfAnEmptyBoard) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), C, SIX);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, C, SIX);
+  const MoveList moves = GenerateMovesForAPiece(position, C, SIX);
 
   EXPECT_EQ(moves.size(), 8);
 }
 
 TEST(GenerateMovesForAPiece, KingOnAStartingPosition) {
   Position position = StartingPosition();
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, E, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre());
 }
 
-TEST(GenerateMovesForAPiece, KingCannotMoveAdjacentToEnemyKing) {
+TEST(GenerateLegalMovesForAPiece, KingCannotMoveAdjacentToEnemyKing) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), A, ONE);
   position.AddPiece(Piece(Kind::KING, Color::WHITE), C, TWO);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, A, ONE);
+  const MoveList moves = GenerateLegalMovesForAPiece(position, A, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, A, ONE, A, TWO)));
 }
 
-TEST(GenerateMovesForAPiece, KingCanTakePieces) {
+TEST(GenerateLegalMovesForAPiece, KingCanTakePieces) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), A, ONE);
   position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), B, TWO);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, A, ONE);
+  const MoveList moves = GenerateLegalMovesForAPiece(position, A, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, A, ONE, B, TWO)));
 }
 
+TEST(GenerateMovesForAPiece, KingMovesAreNotCheckedForAttacks) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), A, ONE);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), B, THREE);
+  const MoveList moves = GenerateMovesForAPiece(position, A, ONE);
+
+  EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, A, ONE, A, TWO),
+                                          Move(&position, A, ONE, B, ONE),
+                                          Move(&position, A, ONE, B, TWO)));
+  EXPECT_THAT(GenerateLegalMovesForAPiece(position, A, ONE),
+              UnorderedElementsAre());
+}
+
 TEST(GenerateMovesForAPiece, KingCanCastle) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, E, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, ONE, E, TWO),
                                           Move(&position, E, ONE, D, ONE),
@@ -304,7 +382,7 @@ TEST(GenerateMovesForAPiece, KingCannotCastleAfterMoving) {
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
   position.MakeMove({E, ONE}, {D, ONE});
   position.MakeMove({D, ONE}, {E, ONE});
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, E, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, ONE, D, ONE),
                                           Move(&position, E, ONE, F, ONE)));
@@ -319,18 +397,18 @@ TEST(GenerateMovesForAPiece, KingCannotCastleAfterRookHasMoved) {
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
   position.MakeMove({A, ONE}, {B, ONE});
   position.MakeMove({B, ONE}, {A, ONE});
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, ONE);
+  const MoveList moves = GenerateMovesForAPiece(position, E, ONE);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, ONE, D, ONE),
                                           Move(&position, E, ONE, F, ONE)));
 }
 
-TEST(GenerateMovesForAPiece, KingCannotCastleWhenUnderCheck) {
+TEST(GenerateLegalMovesForAPiece, KingCannotCastleWhenUnderCheck) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
   position.AddPiece(Piece(Kind::ROOK, Color::BLACK), H, EIGHT);
   position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), E, FOUR);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, EIGHT);
+  const MoveList moves = GenerateLegalMovesForAPiece(position, E, EIGHT);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, EIGHT, D, EIGHT),
                                           Move(&position, E, EIGHT, F, EIGHT),
@@ -338,68 +416,69 @@ TEST(GenerateMovesForAPiece, KingCannotCastleWhenUnderCheck) {
                                           Move(&position, E, EIGHT, F, SEVEN)));
 }
 
-TEST(GenerateMovesForAPiece,
+TEST(GenerateLegalMovesForAPiece,
      KingCannotMoveThroughAttackedSquaresWhileCastling) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
   position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, EIGHT);
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), H, FOUR);
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, SEVEN);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, EIGHT);
+  const MoveList moves = GenerateLegalMovesForAPiece(position, E, EIGHT);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, EIGHT, F, EIGHT)));
 
   // Protect castling route
   position.AddPiece(Piece(Kind::PAWN, Color::BLACK), F, SIX);
-  const std::vector<Move> new_moves =
-      GenerateMovesForAPiece(position, E, EIGHT);
+  const MoveList new_moves =
+      GenerateLegalMovesForAPiece(position, E, EIGHT);
   EXPECT_THAT(new_moves,
               UnorderedElementsAre(Move(&position, E, EIGHT, F, EIGHT),
                                    Move(&position, E, EIGHT, D, EIGHT),
                                    Move(&position, E, EIGHT, C, EIGHT)));
 }
 
-TEST(GenerateMovesForAPiece, KingCannotCastleToAttackedSquare) {
+TEST(GenerateLegalMovesForAPiece, KingCannotCastleToAttackedSquare) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
   position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, EIGHT);
   position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), H, THREE);
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, SEVEN);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, EIGHT);
+  const MoveList moves = GenerateLegalMovesForAPiece(position, E, EIGHT);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, EIGHT, D, EIGHT),
                                           Move(&position, E, EIGHT, F, EIGHT)));
 
   // Protect castling destination
   position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
-  const std::vector<Move> new_moves =
-      GenerateMovesForAPiece(position, E, EIGHT);
+  const MoveList new_moves =
+      GenerateLegalMovesForAPiece(position, E, EIGHT);
   EXPECT_THAT(new_moves,
               UnorderedElementsAre(Move(&position, E, EIGHT, D, EIGHT),
                                    Move(&position, E, EIGHT, F, EIGHT),
                                    Move(&position, E, EIGHT, C, EIGHT)));
 }
 
-TEST(GenerateMovesForAPiece, RookCanMoveThroughAttackedSquaresWhileCastling) {
+TEST(GenerateLegalMovesForAPiece,
+     RookCanMoveThroughAttackedSquaresWhileCastling) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
   position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, EIGHT);
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), B, ONE);
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, SEVEN);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, EIGHT);
+  const MoveList moves = GenerateLegalMovesForAPiece(position, E, EIGHT);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, EIGHT, F, EIGHT),
                                           Move(&position, E, EIGHT, D, EIGHT),
                                           Move(&position, E, EIGHT, C, EIGHT)));
 }
 
-TEST(GenerateMovesForAPiece, RookCanCastleWhenAttacked) {
+TEST(GenerateLegalMovesForAPiece, RookCanCastleWhenAttacked) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
   position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, EIGHT);
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
   position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, SEVEN);
-  const std::vector<Move> moves = GenerateMovesForAPiece(position, E, EIGHT);
+  const MoveList moves = GenerateLegalMovesForAPiece(position, E, EIGHT);
 
   EXPECT_THAT(moves, UnorderedElementsAre(Move(&position, E, EIGHT, F, EIGHT),
                                           Move(&position, E, EIGHT, D, EIGHT),
@@ -411,7 +490,7 @@ TEST(GenerateMovesForAPiece, RookCanCastleWhenAttacked) {
 TEST(GetSquaresUnderAttack, PawnAttacksEmptySquares) {
   Position position;
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), B, THREE);
-  const std::unordered_set<Square> squares =
+  const SquareSet squares =
       GetSquaresUnderAttack(position, Color::WHITE);
 
   EXPECT_THAT(squares, UnorderedElementsAre(Square{A, FOUR}, Square{C, FOUR}));
@@ -422,7 +501,7 @@ TEST(GetSquaresUnderAttack, PawnAttacksEnemyOccupiedSquares) {
   position.AddPiece(Piece(Kind::PAWN, Color::BLACK), B, TWO);
   position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), C, ONE);
   position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), A, ONE);
-  const std::unordered_set<Square> squares =
+  const SquareSet squares =
       GetSquaresUnderAttack(position, Color::BLACK);
 
   EXPECT_THAT(squares, UnorderedElementsAre(Square{C, ONE}));
@@ -432,8 +511,370 @@ TEST(GetSquaresUnderAttack, KnightInTheMiddleAttacksEightSquares) {
   Position position;
   position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), E, FOUR);
   position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), G, FIVE);
-  const std::unordered_set<Square> squares =
+  const SquareSet squares =
       GetSquaresUnderAttack(position, Color::WHITE);
 
   EXPECT_EQ(squares.size(), 8);
 }
+
+// GetAttackersTo()
+
+TEST(GetAttackersTo, FindsAttackersOfBothColors) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), D, FOUR);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), F, THREE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, SEVEN);
+  const Bitboard attackers =
+      GetAttackersTo(position, Square{E, FIVE}, position.Occupancy());
+
+  EXPECT_EQ(attackers,
+            SquareBit(D, FOUR) | SquareBit(F, THREE) | SquareBit(E, ONE));
+}
+
+TEST(GetAttackersTo, RemovedBlockerRevealsXRayAttacker) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), E, TWO);
+  const Bitboard occupancy = position.Occupancy() & ~SquareBit(E, TWO);
+
+  EXPECT_EQ(GetAttackersTo(position, Square{E, FIVE}, occupancy),
+            SquareBit(E, ONE));
+}
+
+// GenerateLegalMoves()
+
+TEST(GenerateLegalMoves, StartingPositionHasTwentyMoves) {
+  Position position = StartingPosition();
+
+  EXPECT_EQ(GenerateLegalMoves(position, Color::WHITE).size(), 20);
+  EXPECT_EQ(GenerateLegalMoves(position, Color::BLACK).size(), 20);
+}
+
+TEST(GenerateLegalMoves, PinnedPieceCannotMove) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), E, TWO);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, EIGHT);
+
+  for (const Move& move : GenerateLegalMoves(position, Color::WHITE)) {
+    EXPECT_FALSE(move.From() == Square(E, TWO));
+  }
+  EXPECT_FALSE(IsInCheck(position, Color::WHITE));
+  position.RemovePiece(E, TWO);
+  EXPECT_TRUE(IsInCheck(position, Color::WHITE));
+}
+
+// MoveIsValid() and MovesAreValid()
+
+// Checks MoveIsValid() and MovesAreValid() of every pair of squares against
+// the moves generated for the piece on the first one, but king moves into
+// check.
+void ExpectMoveIsValidMatchesGeneratedMoves(const Position& position) {
+  std::vector<MoveInPosition> moves;
+  std::vector<bool> generated;
+  for (int from = 0; from < BOARD_SIZE * BOARD_SIZE; ++from) {
+    const Square from_square = SquareFromIndex(from);
+    const MoveList piece_moves =
+        position.HasPiece(from_square)
+            ? GenerateMovesForAPiece(position, from_square.file,
+                                     from_square.rank)
+            : MoveList();
+    for (int to = 0; to < BOARD_SIZE * BOARD_SIZE; ++to) {
+      const Move move(&position, from_square, SquareFromIndex(to));
+      const bool is_generated =
+          std::find(piece_moves.begin(), piece_moves.end(), move) !=
+              piece_moves.end() &&
+          (position.GetPiece(from_square).Kind() != Kind::KING ||
+           !LeavesKingInCheck(position, move));
+      EXPECT_EQ(MoveIsValid(position, move), is_generated) << move;
+      moves.push_back({&position, move});
+      generated.push_back(is_generated);
+    }
+  }
+  EXPECT_EQ(MovesAreValid(moves), generated);
+}
+
+TEST(MoveIsValid, MatchesGeneratedMovesInTheOpening) {
+  Position position = StartingPosition();
+  ExpectMoveIsValidMatchesGeneratedMoves(position);
+  for (const Move& white_move : GenerateLegalMoves(position, Color::WHITE)) {
+    const UndoRecord white_undo =
+        position.MakeMove(white_move.From(), white_move.To());
+    for (const Move& black_move : GenerateLegalMoves(position, Color::BLACK)) {
+      const UndoRecord black_undo =
+          position.MakeMove(black_move.From(), black_move.To());
+      ExpectMoveIsValidMatchesGeneratedMoves(position);
+      position.UnmakeMove(black_undo);
+    }
+    position.UnmakeMove(white_undo);
+  }
+}
+
+TEST(MoveIsValid, KingMovesAndCastling) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, FOUR);
+  position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), A, SIX);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, THREE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), D, TWO);
+
+  EXPECT_TRUE(MoveIsValid(position, Move(&position, E, ONE, C, ONE)));
+  EXPECT_FALSE(MoveIsValid(position, Move(&position, E, ONE, G, ONE)));
+  EXPECT_FALSE(MoveIsValid(position, Move(&position, E, ONE, E, TWO)));
+  EXPECT_TRUE(MoveIsValid(position, Move(&position, E, ONE, D, TWO)));
+  ExpectMoveIsValidMatchesGeneratedMoves(position);
+}
+
+TEST(MoveIsValid, KingMustNotTakeProtectedPiece) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), D, TWO);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), F, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, THREE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+
+  EXPECT_FALSE(MoveIsValid(position, Move(&position, E, ONE, D, TWO)));
+  EXPECT_FALSE(MoveIsValid(position, Move(&position, E, ONE, F, TWO)));
+  EXPECT_TRUE(MoveIsValid(position, Move(&position, E, ONE, E, TWO)));
+  position.RemovePiece(E, THREE);
+  EXPECT_TRUE(MoveIsValid(position, Move(&position, E, ONE, D, TWO)));
+}
+
+TEST(MoveIsValid, PawnMoves) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, TWO);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), B, TWO);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), B, FOUR);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, THREE);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), H, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), A, ONE);
+
+  EXPECT_TRUE(MoveIsValid(position, Move(&position, E, TWO, E, FOUR)));
+  EXPECT_TRUE(MoveIsValid(position, Move(&position, E, TWO, D, THREE)));
+  EXPECT_FALSE(MoveIsValid(position, Move(&position, B, TWO, B, FOUR)));
+  EXPECT_FALSE(MoveIsValid(position, Move(&position, E, TWO, F, THREE)));
+  ExpectMoveIsValidMatchesGeneratedMoves(position);
+}
+
+// ComputeLegalityInfo() and IsLegal()
+
+// Checks IsLegal() against making each move, in the position and in those
+// after each of its legal moves.
+void ExpectIsLegalMatchesMakingTheMove(Position position, Color color,
+                                       int depth) {
+  const LegalityInfo info = ComputeLegalityInfo(position, color);
+  for (const Move& move : GenerateMoves(position, color)) {
+    EXPECT_EQ(IsLegal(position, move, info), !LeavesKingInCheck(position, move))
+        << move.ToCoordinateNotation();
+  }
+  if (depth <= 1) {
+    return;
+  }
+  for (const Move& move : GenerateLegalMoves(position, color)) {
+    const UndoRecord undo = position.MakeMove(move.From(), move.To());
+    ExpectIsLegalMatchesMakingTheMove(position, OppositeColor(color),
+                                      depth - 1);
+    position.UnmakeMove(undo);
+  }
+}
+
+TEST(ComputeLegalityInfo, FindsCheckersAndPinnedPieces) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), E, TWO);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), C, THREE);
+  position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), A, FIVE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), F, THREE);
+  // Not pinned, as two pieces stand between the king and the rook.
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), C, ONE);
+  position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), B, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, ONE);
+
+  const LegalityInfo info = ComputeLegalityInfo(position, Color::WHITE);
+  EXPECT_EQ(info.king_square, SquareIndex(E, ONE));
+  EXPECT_EQ(info.checkers, SquareBit(F, THREE));
+  EXPECT_EQ(info.pinned, SquareBit(E, TWO) | SquareBit(C, THREE));
+}
+
+TEST(ComputeLegalityInfo, NoKing) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), E, ONE);
+
+  EXPECT_EQ(ComputeLegalityInfo(position, Color::WHITE).king_square, -1);
+  EXPECT_THAT(GenerateLegalMoves(position, Color::WHITE),
+              testing::SizeIs(14));
+}
+
+TEST(IsLegal, PinnedPieceMovesAlongThePin) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), E, THREE);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, SIX);
+  const LegalityInfo info = ComputeLegalityInfo(position, Color::WHITE);
+
+  EXPECT_TRUE(IsLegal(position, Move(&position, E, THREE, E, SIX), info));
+  EXPECT_TRUE(IsLegal(position, Move(&position, E, THREE, E, TWO), info));
+  EXPECT_FALSE(IsLegal(position, Move(&position, E, THREE, D, THREE), info));
+  ExpectIsLegalMatchesMakingTheMove(position, Color::WHITE, 1);
+}
+
+TEST(IsLegal, KingCannotStepAlongTheLineOfItsChecker) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, TWO);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, EIGHT);
+  const LegalityInfo info = ComputeLegalityInfo(position, Color::WHITE);
+
+  EXPECT_FALSE(IsLegal(position, Move(&position, E, TWO, E, ONE), info));
+  EXPECT_TRUE(IsLegal(position, Move(&position, E, TWO, D, ONE), info));
+  ExpectIsLegalMatchesMakingTheMove(position, Color::WHITE, 1);
+}
+
+TEST(IsLegal, OnlyTheKingMovesOutOfADoubleCheck) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, FOUR);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, FOUR);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), D, THREE);
+  const LegalityInfo info = ComputeLegalityInfo(position, Color::WHITE);
+
+  EXPECT_EQ(PopCount(info.checkers), 2);
+  EXPECT_FALSE(IsLegal(position, Move(&position, A, FOUR, E, FOUR), info));
+  ExpectIsLegalMatchesMakingTheMove(position, Color::WHITE, 1);
+}
+
+TEST(IsLegal, CheckIsBlockedOrTheCheckerTaken) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, FOUR);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), C, SEVEN);
+  position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), H, TWO);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, EIGHT);
+  const LegalityInfo info = ComputeLegalityInfo(position, Color::WHITE);
+
+  EXPECT_TRUE(IsLegal(position, Move(&position, A, FOUR, E, FOUR), info));
+  EXPECT_TRUE(IsLegal(position, Move(&position, C, SEVEN, E, EIGHT), info));
+  EXPECT_FALSE(IsLegal(position, Move(&position, H, TWO, G, THREE), info));
+  ExpectIsLegalMatchesMakingTheMove(position, Color::WHITE, 1);
+}
+
+TEST(IsLegal, MatchesMakingTheMoveInTheOpening) {
+  Position position = StartingPosition();
+  position.MakeMove({E, TWO}, {E, FOUR});
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+
+  ExpectIsLegalMatchesMakingTheMove(position, Color::WHITE, 3);
+}
+
+// GenerateCaptures() and GenerateQuietMoves()
+
+TEST(GenerateCaptures, SplitsMovesIntoCapturesAndQuietMoves) {
+  Position position = StartingPosition();
+  position.MakeMove({E, TWO}, {E, FOUR});
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+  position.MakeMove({G, ONE}, {F, THREE});
+  position.MakeMove({E, SEVEN}, {E, FIVE});
+
+  const MoveList captures = GenerateCaptures(position, Color::WHITE);
+  const MoveList quiet_moves =
+      GenerateQuietMoves(position, Color::WHITE);
+
+  EXPECT_THAT(captures,
+              UnorderedElementsAre(Move(&position, E, FOUR, D, FIVE),
+                                   Move(&position, F, THREE, E, FIVE)));
+  for (const Move& move : quiet_moves) {
+    EXPECT_FALSE(move.IsACapture());
+  }
+  EXPECT_EQ(captures.size() + quiet_moves.size(),
+            GenerateMoves(position, Color::WHITE).size());
+}
+
+TEST(GenerateQuietMoves, IncludesCastling) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, FOUR);
+
+  const MoveList quiet_moves =
+      GenerateQuietMoves(position, Color::WHITE);
+  EXPECT_THAT(GenerateCaptures(position, Color::WHITE), UnorderedElementsAre());
+  EXPECT_NE(std::find(quiet_moves.begin(), quiet_moves.end(),
+                      Move(&position, E, ONE, G, ONE)),
+            quiet_moves.end());
+}
+
+// Perft: the number of leaves of the tree of legal moves to a given depth, for
+// positions whose counts other engines agree on, so that every rule is covered.
+
+int64_t Perft(Position& position, Color color, int depth) {
+  const MoveList moves = GenerateLegalMoves(position, color);
+  if (depth == 1) {
+    return moves.size();
+  }
+  int64_t leaves = 0;
+  for (const Move& move : moves) {
+    const UndoRecord undo =
+        position.MakeMove(move.From(), move.To(), move.Promotion());
+    leaves += Perft(position, OppositeColor(color), depth - 1);
+    position.UnmakeMove(undo);
+  }
+  return leaves;
+}
+
+// Also checks that taking back all the moves restores the position.
+int64_t Perft(const std::string& fen, int depth) {
+  absl::StatusOr<FenPosition> fen_position = ParseFen(fen);
+  EXPECT_TRUE(fen_position.ok()) << fen_position.status();
+  Position& position = fen_position->position;
+  const Color color = fen_position->side_to_move;
+  const uint64_t hash = position.Hash(color);
+  const std::string fen_before = ToFen(*fen_position);
+  const int64_t leaves = Perft(position, color, depth);
+  EXPECT_EQ(position.Hash(color), hash);
+  EXPECT_EQ(ToFen(*fen_position), fen_before);
+  return leaves;
+}
+
+TEST(Perft, StartingPosition) {
+  EXPECT_EQ(Perft(STARTING_POSITION_FEN, 1), 20);
+  EXPECT_EQ(Perft(STARTING_POSITION_FEN, 2), 400);
+  EXPECT_EQ(Perft(STARTING_POSITION_FEN, 3), 8902);
+}
+
+// Castling both ways, with pins, en passant and promotions soon after.
+TEST(Perft, Kiwipete) {
+  const std::string fen =
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+  EXPECT_EQ(Perft(fen, 1), 48);
+  EXPECT_EQ(Perft(fen, 2), 2039);
+  EXPECT_EQ(Perft(fen, 3), 97862);
+}
+
+// En passant captures discovering checks along the rank of the kings.
+TEST(Perft, RookEndingWithEnPassant) {
+  const std::string fen = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1";
+  EXPECT_EQ(Perft(fen, 1), 14);
+  EXPECT_EQ(Perft(fen, 2), 191);
+  EXPECT_EQ(Perft(fen, 3), 2812);
+  EXPECT_EQ(Perft(fen, 4), 43238);
+}
+
+TEST(Perft, PromotionsWhileInCheck) {
+  const std::string fen =
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1";
+  EXPECT_EQ(Perft(fen, 1), 6);
+  EXPECT_EQ(Perft(fen, 2), 264);
+  EXPECT_EQ(Perft(fen, 3), 9467);
+}
+
+TEST(Perft, UnderpromotionGivingCheck) {
+  const std::string fen =
+      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8";
+  EXPECT_EQ(Perft(fen, 1), 44);
+  EXPECT_EQ(Perft(fen, 2), 1486);
+  EXPECT_EQ(Perft(fen, 3), 62379);
+}
@@ -0,0 +1,138 @@
+#include "engine/game.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+void Play(Game& game, const Square& from, const Square& to) {
+  game.MakeMove(Move(&game.Position(), from, to));
+}
+
+// Knights out and back for both sides, repeating the starting position.
+void ShuffleKnights(Game& game) {
+  Play(game, {G, ONE}, {F, THREE});
+  Play(game, {G, EIGHT}, {F, SIX});
+  Play(game, {F, THREE}, {G, ONE});
+  Play(game, {F, SIX}, {G, EIGHT});
+}
+
+} // namespace
+
+TEST(Game, CountsTurnsAfterBlackMoves) {
+  Game game;
+  EXPECT_EQ(game.Turn(), 1);
+  EXPECT_EQ(game.ActivePlayerColor(), Color::WHITE);
+
+  Play(game, {E, TWO}, {E, FOUR});
+  EXPECT_EQ(game.Turn(), 1);
+  EXPECT_EQ(game.ActivePlayerColor(), Color::BLACK);
+
+  Play(game, {E, SEVEN}, {E, FIVE});
+  EXPECT_EQ(game.Turn(), 2);
+  EXPECT_EQ(game.ActivePlayerColor(), Color::WHITE);
+
+  Game from_black(StartingPosition(), Color::BLACK, 0, 7);
+  EXPECT_EQ(from_black.Turn(), 7);
+  Play(from_black, {E, SEVEN}, {E, FIVE});
+  EXPECT_EQ(from_black.Turn(), 8);
+}
+
+TEST(Game, TakesBackMoves) {
+  Game game;
+  const uint64_t start_hash = game.Position().Hash(Color::WHITE);
+  EXPECT_FALSE(game.TakeBack());
+
+  Play(game, {E, TWO}, {E, FOUR});
+  Play(game, {G, EIGHT}, {F, SIX});
+  EXPECT_EQ(game.HalfmoveClock(), 1);
+
+  EXPECT_TRUE(game.TakeBack());
+  EXPECT_EQ(game.HalfmoveClock(), 0);
+  EXPECT_EQ(game.ActivePlayerColor(), Color::BLACK);
+  EXPECT_TRUE(game.TakeBack());
+  EXPECT_EQ(game.Ply(), 0);
+  EXPECT_EQ(game.Turn(), 1);
+  EXPECT_EQ(game.Position().Hash(Color::WHITE), start_hash);
+  EXPECT_FALSE(game.TakeBack());
+}
+
+TEST(Game, DetectsThreefoldRepetition) {
+  Game game;
+  EXPECT_EQ(game.Repetitions(), 0);
+
+  ShuffleKnights(game);
+  EXPECT_EQ(game.Repetitions(), 1);
+  EXPECT_FALSE(game.IsThreefoldRepetition());
+
+  ShuffleKnights(game);
+  EXPECT_EQ(game.Repetitions(), 2);
+  EXPECT_TRUE(game.IsThreefoldRepetition());
+
+  game.TakeBack();
+  EXPECT_FALSE(game.IsThreefoldRepetition());
+}
+
+TEST(Game, RepetitionsIgnoreHowCastlingRightsWereLost) {
+  Game game;
+  Play(game, {E, TWO}, {E, FOUR});
+  Play(game, {E, SEVEN}, {E, FIVE});
+  Play(game, {E, ONE}, {E, TWO});
+  Play(game, {E, EIGHT}, {E, SEVEN});
+  Play(game, {E, TWO}, {E, ONE});
+  Play(game, {E, SEVEN}, {E, EIGHT});
+  EXPECT_EQ(game.Repetitions(), 0);
+
+  // Moving the king-side rooks out and back loses no castling right the king
+  // moves haven't already lost.
+  Play(game, {G, ONE}, {H, THREE});
+  Play(game, {G, EIGHT}, {H, SIX});
+  Play(game, {H, ONE}, {G, ONE});
+  Play(game, {H, EIGHT}, {G, EIGHT});
+  Play(game, {G, ONE}, {H, ONE});
+  Play(game, {G, EIGHT}, {H, EIGHT});
+  Play(game, {H, THREE}, {G, ONE});
+  Play(game, {H, SIX}, {G, EIGHT});
+  EXPECT_EQ(game.Repetitions(), 1);
+  ShuffleKnights(game);
+  EXPECT_EQ(game.Repetitions(), 2);
+}
+
+TEST(Game, PawnMovesResetTheRepetitionWindow) {
+  Game game;
+  ShuffleKnights(game);
+  Play(game, {E, TWO}, {E, FOUR});
+  Play(game, {E, SEVEN}, {E, FIVE});
+  EXPECT_EQ(game.HalfmoveClock(), 0);
+
+  ShuffleKnights(game);
+  EXPECT_EQ(game.Repetitions(), 1);
+  EXPECT_EQ(game.HalfmoveClock(), 4);
+}
+
+TEST(Game, ReversibleHashesStartAfterTheLastPawnMove) {
+  Game game;
+  Play(game, {E, TWO}, {E, FOUR});
+  const uint64_t after_pawn_move =
+      game.Position().Hash(game.ActivePlayerColor());
+  ShuffleKnights(game);
+
+  const std::vector<uint64_t> hashes = game.ReversibleHashes();
+  ASSERT_EQ(hashes.size(), 4);
+  EXPECT_EQ(hashes[0], after_pawn_move);
+  EXPECT_EQ(game.Position().Hash(game.ActivePlayerColor()), after_pawn_move);
+}
+
+TEST(Game, DrawsAfterFiftyMovesWithoutProgress) {
+  Game game(StartingPosition(), Color::WHITE, 96);
+  EXPECT_FALSE(game.IsFiftyMoveDraw());
+
+  ShuffleKnights(game);
+  EXPECT_EQ(game.HalfmoveClock(), 100);
+  EXPECT_TRUE(game.IsFiftyMoveDraw());
+
+  game.TakeBack();
+  EXPECT_FALSE(game.IsFiftyMoveDraw());
+  Play(game, {F, SIX}, {G, EIGHT});
+  Play(game, {E, TWO}, {E, FOUR});
+  EXPECT_FALSE(game.IsFiftyMoveDraw());
+}
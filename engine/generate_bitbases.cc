@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+
+#include "engine/tablebase.h"
+#include "engine/tablebase_generator.h"
+
+namespace {
+
+// Endings embedded in the engine.
+static constexpr const char* ENDINGS[] = {"KQK", "KRK", "KPK"};
+
+static constexpr int WORDS_PER_LINE = 4;
+
+// Generates the table of `material`, after adding the tables of the endings
+// its captures and promotions lead to to `tables`.
+absl::StatusOr<Tablebase> Generate(const TablebaseMaterial& material,
+                                   TablebaseSet& tables) {
+  for (const TablebaseMaterial& conversion : material.Conversions()) {
+    if (tables.Contains(conversion)) {
+      continue;
+    }
+    absl::StatusOr<Tablebase> table = Generate(conversion, tables);
+    if (!table.ok()) {
+      return table.status();
+    }
+    tables.Add(*std::move(table));
+  }
+  return GenerateTablebase(material, tables, /*threads=*/1);
+}
+
+} // namespace
+
+// Generates the bitbases of ENDINGS and prints them as C++ arrays, one bit per
+// position telling whether the stronger side wins, for the build to embed in
+// the engine, see bitbases.h.
+int main() {
+  TablebaseSet tables;
+  std::vector<std::string> names;
+  std::cout << "// Generated by generate_bitbases, do not edit.\n";
+  for (const std::string name : ENDINGS) {
+    const TablebaseMaterial material = *TablebaseMaterial::Parse(name);
+    absl::StatusOr<Tablebase> table = Generate(material, tables);
+    if (!table.ok()) {
+      std::cerr << table.status() << std::endl;
+      return 1;
+    }
+
+    // Ordered by side to move first, as in the table files.
+    const uint32_t index_count = material.IndexCount();
+    std::vector<uint64_t> words((2 * index_count + 63) / 64);
+    for (const Color color : {Color::BLACK, Color::WHITE}) {
+      for (uint32_t index = 0; index < index_count; ++index) {
+        const uint8_t value = table->Value(index, color);
+        if (value == TABLEBASE_INVALID || value == TABLEBASE_DRAW) {
+          continue;
+        }
+        const TablebaseOutcome outcome = DecodeTablebaseValue(value).outcome;
+        if ((outcome == TablebaseOutcome::WIN) == (color == Color::WHITE)) {
+          const uint32_t id = static_cast<int>(color) * index_count + index;
+          words[id / 64] |= uint64_t{1} << (id % 64);
+        }
+      }
+    }
+
+    std::cout << absl::StrFormat("\nstatic constexpr uint64_t %s_BITBASE[] = {",
+                                 name);
+    for (size_t i = 0; i < words.size(); ++i) {
+      std::cout << (i % WORDS_PER_LINE == 0 ? "\n   " : "")
+                << absl::StrFormat(" 0x%016x,", words[i]);
+    }
+    std::cout << "\n};\n";
+    names.push_back(name);
+    tables.Add(*std::move(table));
+  }
+
+  std::cout << "\nstatic constexpr BitbaseData BITBASE_DATA[] = {\n";
+  for (const std::string& name : names) {
+    std::cout << absl::StrFormat("    {\"%s\", %s_BITBASE},\n", name, name);
+  }
+  std::cout << "};\n";
+  return 0;
+}
@@ -0,0 +1,204 @@
+#include "engine/latency.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "absl/strings/str_format.h"
+
+namespace {
+
+static constexpr const char* OPERATION_NAMES[TIMED_OPERATION_COUNT] = {
+    "move_generation",
+    "notation_parse",
+    "position_update",
+};
+
+static constexpr uint64_t SUB_BUCKET_COUNT = 1 << LATENCY_SUB_BUCKET_BITS;
+static constexpr uint64_t MAX_LATENCY = (uint64_t{1} << LATENCY_MAX_BITS) - 1;
+
+// Long enough for a precise time stamp counter frequency, short enough not to
+// be noticed when timing is turned on.
+static constexpr auto TSC_CALIBRATION_TIME = std::chrono::milliseconds(20);
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<const ThreadLatencies*> threads;
+  LatencySnapshot exited;
+  // Subtracted from the sums, see ResetLatencies().
+  LatencySnapshot reset;
+};
+
+// Never destroyed, as threads may exit after static destruction begins.
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+LatencySnapshot SumLatencies(Registry& registry) {
+  LatencySnapshot sum = registry.exited;
+  for (const ThreadLatencies* latencies : registry.threads) {
+    for (int operation = 0; operation < TIMED_OPERATION_COUNT; ++operation) {
+      for (int bucket = 0; bucket < LATENCY_BUCKET_COUNT; ++bucket) {
+        sum.histograms[operation].counts[bucket] +=
+            latencies->Get(operation, bucket);
+      }
+    }
+  }
+  return sum;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+double MeasureNanosecondsPerTick() {
+  const auto start_time = std::chrono::steady_clock::now();
+  const uint64_t start_ticks = __rdtsc();
+  std::this_thread::sleep_for(TSC_CALIBRATION_TIME);
+  const uint64_t ticks = __rdtsc() - start_ticks;
+  const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start_time);
+  return static_cast<double>(nanoseconds.count()) /
+         std::max<uint64_t>(ticks, 1);
+}
+#endif
+
+} // namespace
+
+const char* TimedOperationName(TimedOperation operation) {
+  return OPERATION_NAMES[static_cast<int>(operation)];
+}
+
+bool SetLatencyClock(LatencyClock clock) {
+  if (clock == LatencyClock::TSC) {
+#if defined(__x86_64__) || defined(__i386__)
+    latency_internal::nanoseconds_per_tick = MeasureNanosecondsPerTick();
+#else
+    return false;
+#endif
+  }
+  latency_internal::clock = static_cast<int>(clock);
+  return true;
+}
+
+int LatencyBucket(uint64_t nanoseconds) {
+  nanoseconds = std::min(nanoseconds, MAX_LATENCY);
+  if (nanoseconds < SUB_BUCKET_COUNT) {
+    return static_cast<int>(nanoseconds);
+  }
+  // Buckets of the same power of two split it into equal sub-buckets.
+  const int exponent = std::bit_width(nanoseconds) - 1;
+  const int shift = exponent - LATENCY_SUB_BUCKET_BITS;
+  const uint64_t sub_bucket = (nanoseconds >> shift) & (SUB_BUCKET_COUNT - 1);
+  return static_cast<int>(((shift + 1) << LATENCY_SUB_BUCKET_BITS) +
+                          sub_bucket);
+}
+
+uint64_t LatencyBucketUpperBound(int bucket) {
+  if (bucket < static_cast<int>(SUB_BUCKET_COUNT)) {
+    return bucket;
+  }
+  const int shift = (bucket >> LATENCY_SUB_BUCKET_BITS) - 1;
+  const uint64_t sub_bucket = bucket & (SUB_BUCKET_COUNT - 1);
+  return ((SUB_BUCKET_COUNT + sub_bucket + 1) << shift) - 1;
+}
+
+uint64_t latency_internal::SteadyClockNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+ThreadLatencies::ThreadLatencies() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.threads.push_back(this);
+}
+
+ThreadLatencies::~ThreadLatencies() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (int operation = 0; operation < TIMED_OPERATION_COUNT; ++operation) {
+    for (int bucket = 0; bucket < LATENCY_BUCKET_COUNT; ++bucket) {
+      registry.exited.histograms[operation].counts[bucket] +=
+          Get(operation, bucket);
+    }
+  }
+  std::erase(registry.threads, this);
+}
+
+uint64_t LatencyHistogram::Count() const {
+  uint64_t count = 0;
+  for (const uint64_t bucket_count : counts) {
+    count += bucket_count;
+  }
+  return count;
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const {
+  const uint64_t count = Count();
+  if (count == 0) {
+    return 0;
+  }
+  // Rank of the latency, counting from one.
+  const uint64_t rank = std::clamp<uint64_t>(
+      static_cast<uint64_t>(std::ceil(fraction * count)), 1, count);
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < LATENCY_BUCKET_COUNT; ++bucket) {
+    seen += counts[bucket];
+    if (seen >= rank) {
+      return LatencyBucketUpperBound(bucket);
+    }
+  }
+  return LatencyBucketUpperBound(LATENCY_BUCKET_COUNT - 1);
+}
+
+LatencySnapshot ReadLatencies() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  LatencySnapshot latencies = SumLatencies(registry);
+  for (int operation = 0; operation < TIMED_OPERATION_COUNT; ++operation) {
+    for (int bucket = 0; bucket < LATENCY_BUCKET_COUNT; ++bucket) {
+      latencies.histograms[operation].counts[bucket] -=
+          registry.reset.histograms[operation].counts[bucket];
+    }
+  }
+  return latencies;
+}
+
+void ResetLatencies() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.reset = SumLatencies(registry);
+}
+
+std::string FormatLatenciesText(const LatencySnapshot& latencies) {
+  std::string output;
+  for (int operation = 0; operation < TIMED_OPERATION_COUNT; ++operation) {
+    const LatencyHistogram& histogram = latencies.histograms[operation];
+    absl::StrAppendFormat(&output, "%s count %d p50 %d p99 %d p999 %d max %d\n",
+                          OPERATION_NAMES[operation], histogram.Count(),
+                          histogram.Percentile(0.5),
+                          histogram.Percentile(0.99),
+                          histogram.Percentile(0.999),
+                          histogram.Percentile(1));
+  }
+  return output;
+}
+
+std::string FormatLatenciesJson(const LatencySnapshot& latencies) {
+  std::string output = "{";
+  for (int operation = 0; operation < TIMED_OPERATION_COUNT; ++operation) {
+    const LatencyHistogram& histogram = latencies.histograms[operation];
+    absl::StrAppendFormat(
+        &output,
+        "%s\"%s\": {\"count\": %d, \"p50_ns\": %d, \"p99_ns\": %d, "
+        "\"p999_ns\": %d, \"max_ns\": %d}",
+        operation == 0 ? "" : ", ", OPERATION_NAMES[operation],
+        histogram.Count(), histogram.Percentile(0.5),
+        histogram.Percentile(0.99), histogram.Percentile(0.999),
+        histogram.Percentile(1));
+  }
+  return output + "}";
+}
@@ -0,0 +1,181 @@
+#ifndef ENGINE_LATENCY_H_
+#define ENGINE_LATENCY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Latency histograms of engine operations, to see the tail latencies averages
+// hide. Timing is off until a clock is chosen with SetLatencyClock(), and a
+// timed scope then only checks a flag. Each thread records into its own
+// histograms, which are only merged when read. Building with
+// --define=engine_latency=disabled, as the release config does, compiles the
+// timing out entirely.
+#ifdef ENGINE_LATENCY_DISABLED
+static constexpr bool LATENCY_ENABLED = false;
+#else
+static constexpr bool LATENCY_ENABLED = true;
+#endif
+
+enum class TimedOperation : int {
+  // Generating the moves of all the pieces of a side.
+  MOVE_GENERATION,
+  NOTATION_PARSE,
+  // Position::MakeMove().
+  POSITION_UPDATE,
+  COUNT,
+};
+
+static constexpr int TIMED_OPERATION_COUNT =
+    static_cast<int>(TimedOperation::COUNT);
+
+// Lower case name of an operation, e.g. "notation_parse".
+const char* TimedOperationName(TimedOperation operation);
+
+enum class LatencyClock : int {
+  OFF,
+  STEADY_CLOCK,
+  // The time stamp counter of x86 processors, which is cheaper to read than
+  // the steady clock. Its frequency is measured when it is chosen.
+  TSC,
+};
+
+// Returns false if the clock isn't available, e.g. the time stamp counter on
+// other processors, in which case timing is left as it was.
+bool SetLatencyClock(LatencyClock clock);
+
+// Latencies are bucketed with 1/16 relative precision, as HdrHistogram does
+// with one significant digit, and up to about 18 minutes.
+static constexpr int LATENCY_SUB_BUCKET_BITS = 4;
+static constexpr int LATENCY_MAX_BITS = 40;
+static constexpr int LATENCY_BUCKET_COUNT =
+    (LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1)
+    << LATENCY_SUB_BUCKET_BITS;
+
+// Bucket of a latency in nanoseconds, and the largest latency in a bucket.
+int LatencyBucket(uint64_t nanoseconds);
+uint64_t LatencyBucketUpperBound(int bucket);
+
+// Histograms of one thread. Only the owning thread writes them, so recording
+// needs no read-modify-write, while other threads may read them at any time.
+class ThreadLatencies {
+ public:
+  ThreadLatencies();
+  // Adds the histograms to those of the exited threads.
+  ~ThreadLatencies();
+
+  void Record(TimedOperation operation, uint64_t nanoseconds) {
+    std::atomic<uint64_t>& count =
+        counts_[static_cast<int>(operation)][LatencyBucket(nanoseconds)];
+    count.store(count.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+  }
+
+  uint64_t Get(int operation, int bucket) const {
+    return counts_[operation][bucket].load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint64_t> counts_[TIMED_OPERATION_COUNT][LATENCY_BUCKET_COUNT] =
+      {};
+};
+
+inline thread_local ThreadLatencies thread_latencies;
+
+namespace latency_internal {
+
+// LatencyClock, read by every timed scope.
+inline std::atomic<int> clock{static_cast<int>(LatencyClock::OFF)};
+inline std::atomic<double> nanoseconds_per_tick{1};
+
+uint64_t SteadyClockNanoseconds();
+
+inline uint64_t ReadClock(LatencyClock clock) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (clock == LatencyClock::TSC) {
+    return __rdtsc();
+  }
+#endif
+  return SteadyClockNanoseconds();
+}
+
+} // namespace latency_internal
+
+// Records the time from construction to destruction of the scope, if a clock
+// is chosen.
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(TimedOperation operation) : operation_(operation) {
+    if constexpr (LATENCY_ENABLED) {
+      clock_ = static_cast<LatencyClock>(
+          latency_internal::clock.load(std::memory_order_relaxed));
+      if (clock_ != LatencyClock::OFF) {
+        start_ = latency_internal::ReadClock(clock_);
+      }
+    }
+  }
+
+  ~ScopedLatency() {
+    if constexpr (LATENCY_ENABLED) {
+      if (clock_ == LatencyClock::OFF) {
+        return;
+      }
+      uint64_t elapsed = latency_internal::ReadClock(clock_) - start_;
+      if (clock_ == LatencyClock::TSC) {
+        elapsed = static_cast<uint64_t>(
+            elapsed * latency_internal::nanoseconds_per_tick.load(
+                          std::memory_order_relaxed));
+      }
+      thread_latencies.Record(operation_, elapsed);
+    }
+  }
+
+  ScopedLatency(const ScopedLatency&) = delete;
+  ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+ private:
+  TimedOperation operation_;
+  LatencyClock clock_ = LatencyClock::OFF;
+  uint64_t start_ = 0;
+};
+
+// Merged latencies of one operation.
+struct LatencyHistogram {
+  std::vector<uint64_t> counts = std::vector<uint64_t>(LATENCY_BUCKET_COUNT);
+
+  uint64_t Count() const;
+  // Upper bound of the bucket holding the given fraction of the latencies,
+  // in nanoseconds, e.g. 0.99 for the 99th percentile. Zero if empty.
+  uint64_t Percentile(double fraction) const;
+};
+
+struct LatencySnapshot {
+  LatencyHistogram histograms[TIMED_OPERATION_COUNT];
+
+  const LatencyHistogram& Get(TimedOperation operation) const {
+    return histograms[static_cast<int>(operation)];
+  }
+};
+
+// Merges the histograms of all the threads, including exited ones, since the
+// last ResetLatencies().
+LatencySnapshot ReadLatencies();
+
+// Starts recording from empty histograms again.
+void ResetLatencies();
+
+// One line per operation with its count and p50, p99, p99.9 and maximum
+// latencies in nanoseconds, e.g.
+//   notation_parse count 120 p50 700 p99 1500 p999 2300 max 2300
+std::string FormatLatenciesText(const LatencySnapshot& latencies);
+
+// The same as a JSON object keyed by operation, e.g.
+//   {"notation_parse": {"count": 120, "p50_ns": 700, ...}, ...}
+std::string FormatLatenciesJson(const LatencySnapshot& latencies);
+
+#endif // ENGINE_LATENCY_H_
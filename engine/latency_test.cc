@@ -0,0 +1,98 @@
+#include "engine/latency.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using ::testing::HasSubstr;
+
+TEST(LatencyBucket, BucketsHoldTheirLatencies) {
+  for (uint64_t nanoseconds = 0; nanoseconds < 100000; ++nanoseconds) {
+    const int bucket = LatencyBucket(nanoseconds);
+    ASSERT_LE(nanoseconds, LatencyBucketUpperBound(bucket));
+    if (bucket > 0) {
+      ASSERT_GT(nanoseconds, LatencyBucketUpperBound(bucket - 1));
+    }
+  }
+  EXPECT_EQ(LatencyBucket(15), 15);
+  // One significant digit in binary: 1000 is in a bucket of 32 latencies.
+  EXPECT_EQ(LatencyBucketUpperBound(LatencyBucket(1000)), 1023);
+  EXPECT_EQ(LatencyBucket(uint64_t{1} << 62), LATENCY_BUCKET_COUNT - 1);
+}
+
+TEST(LatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Percentile(0.5), 0);
+  for (uint64_t nanoseconds = 1; nanoseconds <= 1000; ++nanoseconds) {
+    ++histogram.counts[LatencyBucket(nanoseconds)];
+  }
+
+  EXPECT_EQ(histogram.Count(), 1000);
+  EXPECT_EQ(histogram.Percentile(0.5), LatencyBucketUpperBound(
+                                           LatencyBucket(500)));
+  EXPECT_EQ(histogram.Percentile(0.99), LatencyBucketUpperBound(
+                                            LatencyBucket(990)));
+  EXPECT_EQ(histogram.Percentile(1), 1023);
+}
+
+TEST(ScopedLatency, RecordsOnlyWithAClock) {
+  if (!LATENCY_ENABLED) {
+    GTEST_SKIP() << "Latencies are compiled out";
+  }
+  ResetLatencies();
+  { ScopedLatency latency(TimedOperation::NOTATION_PARSE); }
+  EXPECT_EQ(ReadLatencies().Get(TimedOperation::NOTATION_PARSE).Count(), 0);
+
+  ASSERT_TRUE(SetLatencyClock(LatencyClock::STEADY_CLOCK));
+  std::thread thread([]() {
+    ScopedLatency latency(TimedOperation::NOTATION_PARSE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  });
+  thread.join();
+  { ScopedLatency latency(TimedOperation::POSITION_UPDATE); }
+  SetLatencyClock(LatencyClock::OFF);
+
+  const LatencySnapshot latencies = ReadLatencies();
+  const LatencyHistogram& parses =
+      latencies.Get(TimedOperation::NOTATION_PARSE);
+  EXPECT_EQ(parses.Count(), 1);
+  EXPECT_GE(parses.Percentile(1), 2000000);
+  EXPECT_EQ(latencies.Get(TimedOperation::POSITION_UPDATE).Count(), 1);
+  EXPECT_EQ(latencies.Get(TimedOperation::MOVE_GENERATION).Count(), 0);
+}
+
+TEST(ScopedLatency, TimeStampCounter) {
+  if (!LATENCY_ENABLED || !SetLatencyClock(LatencyClock::TSC)) {
+    GTEST_SKIP() << "No time stamp counter";
+  }
+  ResetLatencies();
+  {
+    ScopedLatency latency(TimedOperation::MOVE_GENERATION);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  SetLatencyClock(LatencyClock::OFF);
+
+  const uint64_t nanoseconds =
+      ReadLatencies().Get(TimedOperation::MOVE_GENERATION).Percentile(1);
+  EXPECT_GE(nanoseconds, 1500000);
+  EXPECT_LT(nanoseconds, 1000000000);
+}
+
+TEST(FormatLatencies, TextAndJson) {
+  LatencySnapshot latencies;
+  latencies.histograms[static_cast<int>(TimedOperation::NOTATION_PARSE)]
+      .counts[LatencyBucket(700)] = 3;
+
+  EXPECT_THAT(FormatLatenciesText(latencies),
+              HasSubstr("notation_parse count 3 p50 703 p99 703 p999 703 "
+                        "max 703\n"));
+  EXPECT_THAT(FormatLatenciesText(latencies),
+              HasSubstr("move_generation count 0 p50 0"));
+  const std::string json = FormatLatenciesJson(latencies);
+  EXPECT_THAT(json, HasSubstr("\"notation_parse\": {\"count\": 3, "
+                              "\"p50_ns\": 703, \"p99_ns\": 703, "
+                              "\"p999_ns\": 703, \"max_ns\": 703}"));
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_EQ(json.back(), '}');
+}
@@ -0,0 +1,176 @@
+#include "engine/mapped_tablebases.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+namespace {
+
+// Pages checked by each call to mincore().
+static constexpr size_t RESIDENCY_CHUNK_PAGES = 16;
+
+} // namespace
+
+MappedTablebases::MappedTablebases(size_t cache_bytes, int cache_shards)
+    : cache_(cache_bytes, cache_shards) {}
+
+MappedTablebases::~MappedTablebases() {
+  for (const auto& [key, mapped] : files_) {
+    munmap(mapped.data, mapped.size);
+  }
+}
+
+absl::Status MappedTablebases::AddFile(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Couldn't open \"%s\": %s", path, std::strerror(errno)));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    return absl::DataLossError(
+        absl::StrFormat("\"%s\" is not a tablebase", path));
+  }
+  const size_t size = file_stat.st_size;
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Couldn't map \"%s\": %s", path, std::strerror(errno)));
+  }
+  // Probes jump around the file, so reading ahead would mostly be wasted.
+  madvise(data, size, MADV_RANDOM);
+
+  absl::StatusOr<TablebaseFile> file =
+      TablebaseFile::Parse(static_cast<const uint8_t*>(data), size);
+  if (!file.ok()) {
+    munmap(data, size);
+    return absl::DataLossError(
+        absl::StrFormat("\"%s\": %s", path, file.status().message()));
+  }
+  const uint32_t key = file->Material().Key();
+  const auto previous = files_.find(key);
+  if (previous != files_.end()) {
+    munmap(previous->second.data, previous->second.size);
+    files_.erase(previous);
+  }
+  files_.emplace(key, MappedFile{data, size, *std::move(file)});
+  return absl::OkStatus();
+}
+
+absl::Status MappedTablebases::AddDirectory(const std::string& directory) {
+  std::error_code error;
+  std::filesystem::directory_iterator entries(directory, error);
+  if (error) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Couldn't list \"%s\": %s", directory, error.message()));
+  }
+  for (const std::filesystem::directory_entry& entry : entries) {
+    if (entry.path().extension() != ".tb") {
+      continue;
+    }
+    const absl::Status status = AddFile(entry.path().string());
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+bool MappedTablebases::Contains(const TablebaseMaterial& material) const {
+  return files_.count(material.Key()) != 0;
+}
+
+std::optional<TablebaseResult>
+MappedTablebases::Probe(const Position& position, Color side_to_move) const {
+  return Probe(position, side_to_move, /*wait=*/true);
+}
+
+std::optional<TablebaseResult>
+MappedTablebases::TryProbe(const Position& position,
+                           Color side_to_move) const {
+  return Probe(position, side_to_move, /*wait=*/false);
+}
+
+std::optional<TablebaseResult>
+MappedTablebases::Probe(const Position& position, Color side_to_move,
+                        bool wait) const {
+  const std::optional<TablebasePieces> pieces = TablebasePiecesOf(position);
+  if (!pieces.has_value()) {
+    return std::nullopt;
+  }
+  if (pieces->count == 2) {
+    return DecodeTablebaseValue(TABLEBASE_DRAW);
+  }
+  const std::optional<TablebaseEntry> entry =
+      FindTablebaseEntry(*pieces, side_to_move);
+  if (!entry.has_value() ||
+      entry->index == TablebaseMaterial::INVALID_INDEX) {
+    return std::nullopt;
+  }
+  const auto mapped = files_.find(entry->material.Key());
+  if (mapped == files_.end()) {
+    return std::nullopt;
+  }
+
+  const TablebaseFile& file = mapped->second.file;
+  const uint64_t id = file.ValueId(entry->index, entry->side_to_move);
+  const uint32_t block = id / TABLEBASE_BLOCK_SIZE;
+  const uint64_t key = uint64_t{entry->material.Key()} << 32 | block;
+  BlockCache::Block values = cache_.Find(key, wait);
+  if (values == nullptr) {
+    if (!wait && !IsBlockResident(mapped->second, block)) {
+      return std::nullopt;
+    }
+    auto decompressed =
+        std::make_shared<std::vector<uint8_t>>(file.BlockValueCount(block));
+    if (!file.DecompressBlock(block, decompressed->data()).ok()) {
+      return std::nullopt;
+    }
+    values = cache_.Insert(key, std::move(decompressed), wait);
+  }
+  const uint8_t value = (*values)[id % TABLEBASE_BLOCK_SIZE];
+  if (value == TABLEBASE_INVALID) {
+    return std::nullopt;
+  }
+  return DecodeTablebaseValue(value);
+}
+
+bool MappedTablebases::IsBlockResident(const MappedFile& mapped,
+                                       uint32_t block) {
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const uintptr_t data =
+      reinterpret_cast<uintptr_t>(mapped.file.BlockData(block));
+  const uintptr_t begin = data & ~(page_size - 1);
+  const uintptr_t end = data + mapped.file.BlockSize(block);
+  for (uintptr_t chunk = begin; chunk < end;
+       chunk += RESIDENCY_CHUNK_PAGES * page_size) {
+    const size_t length =
+        std::min<uintptr_t>(RESIDENCY_CHUNK_PAGES * page_size, end - chunk);
+    unsigned char residency[RESIDENCY_CHUNK_PAGES];
+    if (mincore(reinterpret_cast<void*>(chunk), length, residency) != 0) {
+      // Reading the block directly is the best left to do.
+      return true;
+    }
+    for (size_t page = 0; page * page_size < length; ++page) {
+      if ((residency[page] & 1) == 0) {
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+        return false;
+      }
+    }
+  }
+  return true;
+}
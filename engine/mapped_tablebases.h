@@ -0,0 +1,71 @@
+#ifndef ENGINE_MAPPED_TABLEBASES_H_
+#define ENGINE_MAPPED_TABLEBASES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "absl/status/status.h"
+
+#include "engine/block_cache.h"
+#include "engine/position.h"
+#include "engine/tablebase.h"
+#include "engine/tablebase_file.h"
+
+// Table files mapped into memory and probed by any number of threads. Only the
+// blocks holding probed positions are decompressed, into a cache shared by all
+// the tables whose capacity bounds the memory used besides the mapped files,
+// which the kernel reads and drops as needed.
+class MappedTablebases {
+ public:
+  explicit MappedTablebases(size_t cache_bytes, int cache_shards = 16);
+  ~MappedTablebases();
+
+  MappedTablebases(const MappedTablebases&) = delete;
+  MappedTablebases& operator=(const MappedTablebases&) = delete;
+
+  // Maps a table file, replacing any table of the same material. Not to be
+  // called while probing.
+  absl::Status AddFile(const std::string& path);
+  // Maps all the table files of a directory.
+  absl::Status AddDirectory(const std::string& directory);
+
+  bool Contains(const TablebaseMaterial& material) const;
+
+  // Nothing if the position isn't covered by the tables, see
+  // TablebaseSet::Probe(). Reads the block from the file if it isn't cached,
+  // which may wait for the disk.
+  std::optional<TablebaseResult> Probe(const Position& position,
+                                       Color side_to_move) const;
+
+  // Like Probe(), but never waits for the disk or for other threads, e.g. to
+  // probe from a search. Nothing as well when the block would have to be read
+  // from the disk, in which case the kernel starts reading it in the
+  // background for a later probe, or when another thread uses the cache.
+  std::optional<TablebaseResult> TryProbe(const Position& position,
+                                          Color side_to_move) const;
+
+  size_t CacheSizeBytes() const { return cache_.SizeBytes(); }
+
+ private:
+  struct MappedFile {
+    void* data;
+    size_t size;
+    TablebaseFile file;
+  };
+
+  std::optional<TablebaseResult> Probe(const Position& position,
+                                       Color side_to_move, bool wait) const;
+
+  // Whether the pages of the block are in memory. Otherwise asks the kernel
+  // to read them ahead.
+  static bool IsBlockResident(const MappedFile& mapped, uint32_t block);
+
+  // Keyed by TablebaseMaterial::Key().
+  std::unordered_map<uint32_t, MappedFile> files_;
+  mutable BlockCache cache_;
+};
+
+#endif // ENGINE_MAPPED_TABLEBASES_H_
@@ -0,0 +1,109 @@
+#include "engine/mapped_tablebases.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "engine/fen.h"
+#include "engine/tablebase_generator.h"
+
+namespace {
+
+static constexpr const char* FENS[] = {
+    "k7/8/1K6/8/8/8/8/6Q1 w - - 0 1",
+    "8/8/8/8/4q3/8/2k5/K7 b - - 0 1",
+    "8/8/3k4/8/8/8/8/R3K3 w - - 0 1",
+    "8/8/3k4/8/8/8/8/R3K3 b - - 0 1",
+    "8/8/8/3K4/8/8/6r1/1k6 w - - 0 1",
+    "8/8/8/3K4/8/8/8/1k6 w - - 0 1",
+};
+
+class MappedTablebasesTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = testing::TempDir() + "/mapped_tablebases";
+    std::filesystem::create_directories(directory_);
+    for (const char* name : {"KQK", "KRK"}) {
+      const TablebaseMaterial material = *TablebaseMaterial::Parse(name);
+      absl::StatusOr<Tablebase> table =
+          GenerateTablebase(material, tables_, /*threads=*/2);
+      ASSERT_TRUE(table.ok()) << table.status();
+      ASSERT_TRUE(
+          WriteTablebase(*table, directory_ + "/" + TablebaseFileName(material))
+              .ok());
+      tables_.Add(*std::move(table));
+    }
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  std::string directory_;
+  TablebaseSet tables_;
+};
+
+void ExpectSameResult(const std::optional<TablebaseResult>& mapped,
+                      const std::optional<TablebaseResult>& expected,
+                      const std::string& fen) {
+  ASSERT_EQ(mapped.has_value(), expected.has_value()) << fen;
+  if (expected.has_value()) {
+    EXPECT_EQ(mapped->outcome, expected->outcome) << fen;
+    EXPECT_EQ(mapped->plies_to_mate, expected->plies_to_mate) << fen;
+  }
+}
+
+} // namespace
+
+TEST_F(MappedTablebasesTest, ProbesLikeTheTablesInMemory) {
+  MappedTablebases mapped(/*cache_bytes=*/1 << 20);
+  ASSERT_TRUE(mapped.AddDirectory(directory_).ok());
+  EXPECT_TRUE(mapped.Contains(*TablebaseMaterial::Parse("KRK")));
+  EXPECT_FALSE(mapped.Contains(*TablebaseMaterial::Parse("KBK")));
+
+  for (const char* fen : FENS) {
+    const FenPosition position = *ParseFen(fen);
+    const std::optional<TablebaseResult> expected =
+        tables_.Probe(position.position, position.side_to_move);
+    ExpectSameResult(mapped.Probe(position.position, position.side_to_move),
+                     expected, fen);
+    // The block is cached now.
+    ExpectSameResult(
+        mapped.TryProbe(position.position, position.side_to_move), expected,
+        fen);
+  }
+  EXPECT_FALSE(mapped
+                   .Probe(ParseFen("8/8/8/3K4/8/8/6b1/1k6 w - - 0 1")->position,
+                          Color::WHITE)
+                   .has_value());
+}
+
+TEST_F(MappedTablebasesTest, BoundsTheCache) {
+  MappedTablebases mapped(/*cache_bytes=*/TABLEBASE_BLOCK_SIZE,
+                          /*cache_shards=*/1);
+  ASSERT_TRUE(
+      mapped.AddFile(directory_ + "/" +
+                     TablebaseFileName(*TablebaseMaterial::Parse("KRK")))
+          .ok());
+
+  for (const char* fen : FENS) {
+    const FenPosition position = *ParseFen(fen);
+    const std::optional<TablebaseResult> result =
+        mapped.TryProbe(position.position, position.side_to_move);
+    if (result.has_value()) {
+      ExpectSameResult(
+          result, tables_.Probe(position.position, position.side_to_move),
+          fen);
+    }
+    EXPECT_LE(mapped.CacheSizeBytes(), TABLEBASE_BLOCK_SIZE);
+  }
+}
+
+TEST(MappedTablebases, RejectsMissingFiles) {
+  MappedTablebases mapped(/*cache_bytes=*/1 << 20);
+
+  EXPECT_EQ(mapped.AddFile(testing::TempDir() + "/missing.tb").code(),
+            absl::StatusCode::kNotFound);
+  EXPECT_EQ(mapped.AddDirectory(testing::TempDir() + "/missing").code(),
+            absl::StatusCode::kNotFound);
+}
@@ -14,14 +14,37 @@ char GetFile(int x) { return 'a' + x; }
 
 char GetRank(int y) { return '0' + y + 1; }
 
+static constexpr int PACKED_SQUARE_BITS = 2 * BOARD_SIZE_LOG;
+static constexpr uint16_t PACKED_SQUARE_MASK = (1 << PACKED_SQUARE_BITS) - 1;
+// The promotion Kind is stored above both squares.
+static constexpr int PACKED_PROMOTION_SHIFT = 2 * PACKED_SQUARE_BITS;
+
+uint16_t PackSquare(const Square& square) {
+  return square.rank << BOARD_SIZE_LOG | square.file;
+}
+
+Square UnpackSquare(uint16_t packed_square) {
+  return Square{packed_square & (BOARD_SIZE - 1),
+                packed_square >> BOARD_SIZE_LOG};
+}
+
 } // namespace
 
 bool Move::operator==(const Move& other) const {
   return from_x_ == other.from_x_ && from_y_ == other.from_y_ &&
-         to_x_ == other.to_x_ && to_y_ == other.to_y_;
+         to_x_ == other.to_x_ && to_y_ == other.to_y_ &&
+         promotion_ == other.promotion_;
 }
 
 bool Move::IsACapture() const {
+  if (!position_->HasPiece(to_x_, to_y_)) {
+    // Only a pawn taking en passant moves diagonally to an empty square.
+    return from_x_ != to_x_ &&
+           position_->GetPiece(from_x_, from_y_).Kind() == Kind::PAWN;
+  }
+  // Empty cells are stored as black pieces of Kind::NONE, so the color
+  // comparison alone would report every black move to an empty square as a
+  // capture.
   return position_->GetPiece(from_x_, from_y_).Color() !=
          position_->GetPiece(to_x_, to_y_).Color();
 }
@@ -31,8 +54,23 @@ std::string Move::ToAlgebraicNotation() const {
       position_ == nullptr
           ? "?"
           : PIECE_NOTATIONS.at(position_->GetPiece(from_x_, from_y_).Kind());
-  return absl::StrFormat("%s%c%c-%c%c", piece_notation, GetFile(from_x_),
-                         GetRank(from_y_), GetFile(to_x_), GetRank(to_y_));
+  std::string notation =
+      absl::StrFormat("%s%c%c-%c%c", piece_notation, GetFile(from_x_),
+                      GetRank(from_y_), GetFile(to_x_), GetRank(to_y_));
+  if (promotion_ != Kind::NONE) {
+    notation += "=" + PIECE_NOTATIONS.at(promotion_);
+  }
+  return notation;
+}
+
+std::string Move::ToCoordinateNotation() const {
+  std::string notation =
+      absl::StrFormat("%c%c%c%c", GetFile(from_x_), GetRank(from_y_),
+                      GetFile(to_x_), GetRank(to_y_));
+  if (promotion_ != Kind::NONE) {
+    notation.push_back(PIECE_NOTATIONS.at(promotion_)[0] - 'A' + 'a');
+  }
+  return notation;
 }
 
 std::ostream& operator<<(std::ostream& out, const Move& move) {
@@ -40,4 +78,17 @@ std::ostream& operator<<(std::ostream& out, const Move& move) {
   return out;
 }
 
+uint16_t PackMove(const Move& move) {
+  return static_cast<int>(move.Promotion()) << PACKED_PROMOTION_SHIFT |
+         PackSquare(move.From()) << PACKED_SQUARE_BITS | PackSquare(move.To());
+}
+
+Move UnpackMove(uint16_t packed_move, const Position* position) {
+  return Move(position,
+              UnpackSquare((packed_move >> PACKED_SQUARE_BITS) &
+                           PACKED_SQUARE_MASK),
+              UnpackSquare(packed_move & PACKED_SQUARE_MASK),
+              static_cast<Kind>(packed_move >> PACKED_PROMOTION_SHIFT));
+}
+
 std::string Move::ToLongAlgebraicNotation() const { return "UNIMPLEMENTED"; }
@@ -1,6 +1,7 @@
 #ifndef ENGINE_MOVE_H_
 #define ENGINE_MOVE_H_
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -9,30 +10,41 @@
 #include "engine/position.h"
 
 // Represents a move of a piece, storing both source and destination
-// coordinates.
+// coordinates, and the kind a pawn promotes to when it reaches the last rank.
 // TODO: Consider adding a more compact class with only destination coordinates
 // to save on memory.
 class Move {
  public:
   Move(int from_x, int from_y, int to_x, int to_y)
       : from_x_(from_x), from_y_(from_y), to_x_(to_x), to_y_(to_y){};
-  Move(const Square& from, const Square& to)
+  Move(const Square& from, const Square& to, Kind promotion = Kind::NONE)
       : from_x_(from.file), from_y_(from.rank), to_x_(to.file),
-        to_y_(to.rank){};
-  Move(const Position* position, int from_x, int from_y, int to_x, int to_y)
+        to_y_(to.rank), promotion_(promotion){};
+  Move(const Position* position, int from_x, int from_y, int to_x, int to_y,
+       Kind promotion = Kind::NONE)
       : position_(position), from_x_(from_x), from_y_(from_y), to_x_(to_x),
-        to_y_(to_y){};
-  Move(const Position* position, const Square& from, const Square& to)
+        to_y_(to_y), promotion_(promotion){};
+  Move(const Position* position, const Square& from, const Square& to,
+       Kind promotion = Kind::NONE)
       : position_(position), from_x_(from.file), from_y_(from.rank),
-        to_x_(to.file), to_y_(to.rank){};
+        to_x_(to.file), to_y_(to.rank), promotion_(promotion){};
 
   bool operator==(const Move& other) const;
+  bool operator!=(const Move& other) const { return !(*this == other); }
 
   std::string ToAlgebraicNotation() const;
 
+  // Source and destination squares only, e.g. "e2e4" or "e1g1" for short
+  // castling, followed by the promotion piece, e.g. "e7e8q", as used by the UCI
+  // protocol. Doesn't need a position.
+  std::string ToCoordinateNotation() const;
+
   Square From() const { return {from_x_, from_y_}; }
   Square To() const { return {to_x_, to_y_}; }
+  // Kind::NONE unless a pawn reaches the last rank.
+  Kind Promotion() const { return promotion_; }
 
+  // Includes taking a pawn en passant, which lands on an empty square.
   bool IsACapture() const;
 
   friend class Position;
@@ -48,8 +60,15 @@ class Move {
   int from_y_;
   int to_x_;
   int to_y_;
+  Kind promotion_ = Kind::NONE;
 };
 
+// Packs source and destination squares and the promotion of a move into 16
+// bits, for compact storage in search tables. Zero never encodes a real move,
+// as source and destination squares always differ.
+uint16_t PackMove(const Move& move);
+Move UnpackMove(uint16_t packed_move, const Position* position);
+
 // Prints turn in FIDE algebraic notation. This is particularly useful in tests
 // which use this operator to print difering values.
 std::ostream& operator<<(std::ostream& out, const Move& move);
@@ -0,0 +1,238 @@
+#include "engine/move_picker.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "engine/arena.h"
+#include "engine/evaluation.h"
+#include "engine/game_engine.h"
+
+namespace {
+
+// Most valuable victim first, then least valuable attacker first.
+int MvvLvaScore(const Position& position, const Move& move) {
+  return 16 * PieceValue(CapturedKind(position, move)) -
+         PieceValue(position.GetPiece(move.From()).Kind()) / 100;
+}
+
+} // namespace
+
+void MoveHistory::Clear() {
+  std::fill(&killers_[0][0], &killers_[0][0] + MAX_PLY * 2, 0);
+  std::fill(counter_moves_, counter_moves_ + PACKED_MOVES, 0);
+  std::fill(&history_[0][0], &history_[0][0] + 2 * PACKED_MOVES, 0);
+}
+
+void MoveHistory::UpdateHistory(const Move& move, Color color, int bonus) {
+  // Bonuses shrink as the score approaches the bound, so it is never
+  // exceeded and older statistics fade away.
+  int& score = history_[static_cast<int>(color)][TableIndex(PackMove(move))];
+  score += bonus - score * std::abs(bonus) / MAX_HISTORY_SCORE;
+}
+
+void MoveHistory::RecordCutoff(const Move& move, Color color, int ply,
+                               int depth, uint16_t previous_move) {
+  const uint16_t packed_move = PackMove(move);
+  if (ply < MAX_PLY && killers_[ply][0] != packed_move) {
+    killers_[ply][1] = killers_[ply][0];
+    killers_[ply][0] = packed_move;
+  }
+  if (previous_move != 0) {
+    counter_moves_[TableIndex(previous_move)] = packed_move;
+  }
+  UpdateHistory(move, color, depth * depth);
+}
+
+void MoveHistory::RecordFailure(const Move& move, Color color, int depth) {
+  UpdateHistory(move, color, -depth * depth);
+}
+
+int MoveHistory::HistoryScore(const Move& move, Color color) const {
+  return history_[static_cast<int>(color)][TableIndex(PackMove(move))];
+}
+
+uint16_t MoveHistory::Killer(int ply, int index) const {
+  return ply < MAX_PLY ? killers_[ply][index] : 0;
+}
+
+uint16_t MoveHistory::CounterMove(uint16_t previous_move) const {
+  return counter_moves_[TableIndex(previous_move)];
+}
+
+MovePicker::MovePicker(const Position& position, Color color,
+                       uint16_t hash_move, const MoveHistory& history, int ply,
+                       uint16_t previous_move)
+    : position_(position), color_(color), history_(&history),
+      stage_(Stage::HASH_MOVE), hash_move_(hash_move),
+      killers_{history.Killer(ply, 0), history.Killer(ply, 1)},
+      counter_move_(history.CounterMove(previous_move)),
+      moves_(TransientMemory()), bad_captures_(TransientMemory()) {}
+
+MovePicker::MovePicker(const Position& position, Color color)
+    : position_(position), color_(color), stage_(Stage::GENERATE_CAPTURES),
+      captures_only_(true), moves_(TransientMemory()),
+      bad_captures_(TransientMemory()) {}
+
+bool MovePicker::IsPlayable(uint16_t packed_move, bool must_be_quiet) const {
+  if (packed_move == 0) {
+    return false;
+  }
+  const Move move = UnpackMove(packed_move, &position_);
+  if (!position_.HasPiece(move.From()) ||
+      position_.GetPiece(move.From()).Color() != color_) {
+    return false;
+  }
+  if (must_be_quiet &&
+      (move.IsACapture() || move.Promotion() != Kind::NONE)) {
+    return false;
+  }
+  return MoveIsValid(position_, move);
+}
+
+bool MovePicker::AlreadyPicked(const Move& move) const {
+  const uint16_t packed_move = PackMove(move);
+  if (packed_move == hash_move_) {
+    return true;
+  }
+  // Quiet queen promotions are picked along with the captures.
+  if (move.Promotion() == Kind::QUEEN && !move.IsACapture()) {
+    return true;
+  }
+  for (int i = 0; i < picked_quiets_count_; ++i) {
+    if (picked_quiets_[i] == packed_move) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void MovePicker::AddQuietQueenPromotions() {
+  const int direction = color_ == Color::WHITE ? 1 : -1;
+  const int rank = color_ == Color::WHITE ? SEVEN : TWO;
+  const int score = 16 * (PieceValue(Kind::QUEEN) - PieceValue(Kind::PAWN));
+  Bitboard pawns = position_.Pieces(color_, Kind::PAWN);
+  while (pawns) {
+    const Square from = SquareFromIndex(PopLowestSquareIndex(&pawns));
+    const Square to{from.file, from.rank + direction};
+    if (from.rank == rank && !position_.HasPiece(to)) {
+      const Move move(&position_, from, to, Kind::QUEEN);
+      if (PackMove(move) != hash_move_) {
+        moves_.push_back({move, score});
+      }
+    }
+  }
+}
+
+std::optional<Move> MovePicker::NextMove() {
+  while (true) {
+    switch (stage_) {
+    case Stage::HASH_MOVE:
+      stage_ = Stage::GENERATE_CAPTURES;
+      if (IsPlayable(hash_move_, /*must_be_quiet=*/false)) {
+        return UnpackMove(hash_move_, &position_);
+      }
+      hash_move_ = 0;
+      break;
+
+    case Stage::GENERATE_CAPTURES:
+      moves_.clear();
+      for (const Move& move : GenerateCaptures(position_, color_)) {
+        if (!AlreadyPicked(move)) {
+          moves_.push_back({move, MvvLvaScore(position_, move)});
+        }
+      }
+      AddQuietQueenPromotions();
+      next_index_ = 0;
+      stage_ = Stage::GOOD_CAPTURES;
+      break;
+
+    case Stage::GOOD_CAPTURES:
+      while (next_index_ < moves_.size()) {
+        // Selection sort, as only the first few captures are usually needed.
+        const auto best = std::max_element(
+            moves_.begin() + next_index_, moves_.end(),
+            [](const ScoredMove& lhs, const ScoredMove& rhs) {
+              return lhs.score < rhs.score;
+            });
+        std::iter_swap(moves_.begin() + next_index_, best);
+        const Move move = moves_[next_index_++].move;
+        // Taking a piece at least as valuable as the attacker never loses
+        // material, so the exchange only needs to be evaluated otherwise.
+        if (PieceValue(position_.GetPiece(move.From()).Kind()) >
+                PieceValue(CapturedKind(position_, move)) &&
+            StaticExchangeEvaluation(position_, move) < 0) {
+          if (!captures_only_) {
+            bad_captures_.push_back(move);
+          }
+          continue;
+        }
+        return move;
+      }
+      stage_ = captures_only_ ? Stage::DONE : Stage::KILLERS;
+      break;
+
+    case Stage::KILLERS:
+      while (killer_index_ < 2) {
+        const uint16_t killer = killers_[killer_index_++];
+        if (killer != hash_move_ &&
+            IsPlayable(killer, /*must_be_quiet=*/true)) {
+          picked_quiets_[picked_quiets_count_++] = killer;
+          return UnpackMove(killer, &position_);
+        }
+      }
+      stage_ = Stage::COUNTER_MOVE;
+      break;
+
+    case Stage::COUNTER_MOVE:
+      stage_ = Stage::GENERATE_QUIETS;
+      if (counter_move_ != 0 &&
+          !AlreadyPicked(UnpackMove(counter_move_, &position_)) &&
+          IsPlayable(counter_move_, /*must_be_quiet=*/true)) {
+        picked_quiets_[picked_quiets_count_++] = counter_move_;
+        return UnpackMove(counter_move_, &position_);
+      }
+      break;
+
+    case Stage::GENERATE_QUIETS:
+      moves_.clear();
+      for (const Move& move : GenerateQuietMoves(position_, color_)) {
+        if (!AlreadyPicked(move)) {
+          moves_.push_back({move, history_->HistoryScore(move, color_)});
+        }
+      }
+      // Insertion sort, stable as std::stable_sort() but without taking a
+      // buffer from the heap, and there are only a few dozen quiet moves.
+      for (auto move = moves_.begin(); move != moves_.end(); ++move) {
+        std::rotate(std::upper_bound(moves_.begin(), move, *move,
+                                     [](const ScoredMove& lhs,
+                                        const ScoredMove& rhs) {
+                                       return lhs.score > rhs.score;
+                                     }),
+                    move, move + 1);
+      }
+      next_index_ = 0;
+      stage_ = Stage::QUIETS;
+      break;
+
+    case Stage::QUIETS:
+      if (next_index_ < moves_.size()) {
+        return moves_[next_index_++].move;
+      }
+      next_index_ = 0;
+      stage_ = Stage::BAD_CAPTURES;
+      break;
+
+    case Stage::BAD_CAPTURES:
+      if (next_index_ < bad_captures_.size()) {
+        return bad_captures_[next_index_++];
+      }
+      stage_ = Stage::DONE;
+      break;
+
+    case Stage::DONE:
+    default:
+      return std::nullopt;
+    }
+  }
+}
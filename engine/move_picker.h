@@ -0,0 +1,140 @@
+#ifndef ENGINE_MOVE_PICKER_H_
+#define ENGINE_MOVE_PICKER_H_
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include "engine/base.h"
+#include "engine/move.h"
+#include "engine/position.h"
+
+// Statistics on quiet moves causing beta cutoffs, collected during a search
+// and used to order quiet moves in the other nodes. Moves are stored packed,
+// see PackMove().
+class MoveHistory {
+ public:
+  // Deepest ply killer moves are kept for.
+  static constexpr int MAX_PLY = 128;
+
+  MoveHistory() { Clear(); }
+
+  void Clear();
+
+  // Records a quiet move which caused a beta cutoff at a given ply, after
+  // `previous_move` of the opponent.
+  void RecordCutoff(const Move& move, Color color, int ply, int depth,
+                    uint16_t previous_move);
+  // Records a quiet move which was searched before the cutoff move, and thus
+  // was ordered too early.
+  void RecordFailure(const Move& move, Color color, int depth);
+
+  int HistoryScore(const Move& move, Color color) const;
+  // Two most recent quiet moves causing a cutoff at a given ply, in sibling
+  // nodes. Zero if unknown.
+  uint16_t Killer(int ply, int index) const;
+  // The quiet move which most recently refuted `previous_move`. Zero if
+  // unknown.
+  uint16_t CounterMove(uint16_t previous_move) const;
+
+ private:
+  // Number of distinct source and destination squares of packed moves, which
+  // index the tables. Promotions share the entries of their squares.
+  static constexpr int PACKED_MOVES = 1 << (4 * BOARD_SIZE_LOG);
+
+  static int TableIndex(uint16_t packed_move) {
+    return packed_move & (PACKED_MOVES - 1);
+  }
+  // Bound on history scores, keeping recent statistics more important.
+  static constexpr int MAX_HISTORY_SCORE = 1 << 14;
+
+  void UpdateHistory(const Move& move, Color color, int bonus);
+
+  uint16_t killers_[MAX_PLY][2];
+  uint16_t counter_moves_[PACKED_MOVES];
+  // Indexed by Color and packed move.
+  int history_[2][PACKED_MOVES];
+};
+
+// Yields moves for a position one by one, in the order most likely to cause a
+// beta cutoff early:
+//   1. The hash move, best move found by a previous search of the position.
+//   2. Captures and pawn pushes promoting to a queen, not losing material by
+//      static exchange evaluation, most valuable victim first and least
+//      valuable attacker first among those. A promotion counts as taking
+//      what the queen is worth over the pawn.
+//   3. Two killer moves, then the counter move to the opponent's last move.
+//   4. Other quiet moves, by their history score.
+//   5. Captures and queen promotions losing material.
+// Each group is only generated once the previous one is exhausted, so a node
+// cutting off early never pays for generating the rest. Moves may leave the
+// king in check, legality is up to the caller.
+class MovePicker {
+ public:
+  // Picks all the moves. Zero for unknown hash or previous move.
+  MovePicker(const Position& position, Color color, uint16_t hash_move,
+             const MoveHistory& history, int ply, uint16_t previous_move);
+
+  // Picks only the captures and the pawn pushes promoting to a queen, not
+  // losing material, for a quiescence search.
+  MovePicker(const Position& position, Color color);
+
+  // Returns std::nullopt once all the moves have been picked.
+  std::optional<Move> NextMove();
+
+ private:
+  enum class Stage {
+    HASH_MOVE,
+    GENERATE_CAPTURES,
+    GOOD_CAPTURES,
+    KILLERS,
+    COUNTER_MOVE,
+    GENERATE_QUIETS,
+    QUIETS,
+    BAD_CAPTURES,
+    DONE
+  };
+
+  struct ScoredMove {
+    Move move;
+    int score;
+  };
+
+  // Whether a packed move is a pseudo-legal move for the side to move, and
+  // neither a capture nor a promotion if `must_be_quiet`. Moves coming from
+  // the search tables may be stale or belong to another position sharing the
+  // hash slot.
+  bool IsPlayable(uint16_t packed_move, bool must_be_quiet) const;
+
+  // Whether a move was already yielded from the hash move, killers or counter
+  // move stages, or is a quiet queen promotion, yielded with the captures.
+  bool AlreadyPicked(const Move& move) const;
+
+  // Adds the pawn pushes to the last rank promoting to a queen but the hash
+  // move, scored above the captures of anything but a queen.
+  // Under-promotions are left to the quiet stage of the full search.
+  void AddQuietQueenPromotions();
+
+  const Position& position_;
+  const Color color_;
+  const MoveHistory* history_ = nullptr;
+  Stage stage_;
+  bool captures_only_ = false;
+
+  uint16_t hash_move_ = 0;
+  uint16_t killers_[2] = {0, 0};
+  uint16_t counter_move_ = 0;
+  // Special moves yielded before generating quiet moves.
+  uint16_t picked_quiets_[3] = {0, 0, 0};
+  int picked_quiets_count_ = 0;
+  int killer_index_ = 0;
+
+  // Allocated from TransientMemory(), like the generated moves, so that a
+  // search node takes nothing from the heap.
+  std::pmr::vector<ScoredMove> moves_;
+  size_t next_index_ = 0;
+  std::pmr::vector<Move> bad_captures_;
+};
+
+#endif // ENGINE_MOVE_PICKER_H_
@@ -0,0 +1,183 @@
+#include "engine/move_picker.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "engine/game_engine.h"
+
+using testing::ElementsAre;
+using testing::UnorderedElementsAreArray;
+
+namespace {
+
+std::vector<Move> PickAll(MovePicker* picker) {
+  std::vector<Move> moves;
+  while (const std::optional<Move> move = picker->NextMove()) {
+    moves.push_back(*move);
+  }
+  return moves;
+}
+
+} // namespace
+
+TEST(MovePicker, PicksEveryMoveExactlyOnce) {
+  Position position = StartingPosition();
+  position.MakeMove({E, TWO}, {E, FOUR});
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+  MoveHistory history;
+  MovePicker picker(position, Color::WHITE,
+                    PackMove(Move(&position, G, ONE, F, THREE)), history,
+                    /*ply=*/0, /*previous_move=*/0);
+
+  EXPECT_THAT(PickAll(&picker),
+              UnorderedElementsAreArray(GenerateMoves(position, Color::WHITE)));
+}
+
+TEST(MovePicker, HashMoveComesFirstThenCapturesByVictimValue) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), A, SEVEN);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), C, THREE);
+  position.AddPiece(Piece(Kind::QUEEN, Color::BLACK), D, FIVE);
+  const Move hash_move(&position, A, ONE, A, TWO);
+  MoveHistory history;
+  MovePicker picker(position, Color::WHITE, PackMove(hash_move), history,
+                    /*ply=*/0, /*previous_move=*/0);
+
+  EXPECT_EQ(picker.NextMove(), hash_move);
+  EXPECT_EQ(picker.NextMove(), Move(&position, C, THREE, D, FIVE));
+  EXPECT_EQ(picker.NextMove(), Move(&position, A, ONE, A, SEVEN));
+  const std::optional<Move> first_quiet_move = picker.NextMove();
+  ASSERT_TRUE(first_quiet_move.has_value());
+  EXPECT_FALSE(first_quiet_move->IsACapture());
+}
+
+TEST(MovePicker, LosingCapturesComeLast) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
+  MoveHistory history;
+  MovePicker picker(position, Color::WHITE, /*hash_move=*/0, history,
+                    /*ply=*/0, /*previous_move=*/0);
+
+  const std::vector<Move> moves = PickAll(&picker);
+  ASSERT_FALSE(moves.empty());
+  EXPECT_EQ(moves.back(), Move(&position, D, ONE, D, FIVE));
+}
+
+TEST(MovePicker, KillerAndCounterMovesComeBeforeOtherQuietMoves) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  const Move killer(&position, A, ONE, A, SEVEN);
+  const Move counter_move(&position, A, ONE, F, ONE);
+  const uint16_t previous_move = PackMove(Move(E, SEVEN, E, FIVE));
+  MoveHistory history;
+  history.RecordCutoff(killer, Color::WHITE, /*ply=*/3, /*depth=*/1,
+                       /*previous_move=*/0);
+  history.RecordCutoff(counter_move, Color::WHITE, /*ply=*/5, /*depth=*/1,
+                       previous_move);
+  MovePicker picker(position, Color::WHITE, /*hash_move=*/0, history,
+                    /*ply=*/3, previous_move);
+
+  EXPECT_EQ(picker.NextMove(), killer);
+  EXPECT_EQ(picker.NextMove(), counter_move);
+  EXPECT_EQ(PickAll(&picker).size(),
+            GenerateMoves(position, Color::WHITE).size() - 2);
+}
+
+TEST(MovePicker, QuietMovesAreSortedByHistory) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), B, ONE);
+  const Move good_move(&position, B, ONE, C, THREE);
+  const Move bad_move(&position, H, ONE, G, ONE);
+  MoveHistory history;
+  history.RecordFailure(bad_move, Color::WHITE, /*depth=*/4);
+  // Recorded at a ply where killers aren't used, to only affect the history.
+  history.RecordCutoff(good_move, Color::WHITE, /*ply=*/10, /*depth=*/4,
+                       /*previous_move=*/0);
+  MovePicker picker(position, Color::WHITE, /*hash_move=*/0, history,
+                    /*ply=*/0, /*previous_move=*/0);
+
+  const std::vector<Move> moves = PickAll(&picker);
+  ASSERT_FALSE(moves.empty());
+  EXPECT_EQ(moves.front(), good_move);
+  EXPECT_EQ(moves.back(), bad_move);
+}
+
+TEST(MovePicker, QueenPromotionsComeWithTheCaptures) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), B, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), A, SIX);
+  const Move killer(&position, A, ONE, A, TWO);
+  MoveHistory history;
+  history.RecordCutoff(killer, Color::WHITE, /*ply=*/0, /*depth=*/1,
+                       /*previous_move=*/0);
+  MovePicker picker(position, Color::WHITE, /*hash_move=*/0, history,
+                    /*ply=*/0, /*previous_move=*/0);
+
+  const std::vector<Move> moves = PickAll(&picker);
+  ASSERT_GE(moves.size(), 3);
+  EXPECT_EQ(moves[0], Move(&position, {B, SEVEN}, {B, EIGHT}, Kind::QUEEN));
+  EXPECT_EQ(moves[1], Move(&position, A, ONE, A, SIX));
+  EXPECT_EQ(moves[2], killer);
+  EXPECT_THAT(moves,
+              UnorderedElementsAreArray(GenerateMoves(position, Color::WHITE)));
+}
+
+TEST(MovePicker, StaleHashMoveIsIgnored) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  MoveHistory history;
+  MovePicker picker(position, Color::WHITE,
+                    PackMove(Move(&position, A, ONE, A, EIGHT)), history,
+                    /*ply=*/0, /*previous_move=*/0);
+
+  EXPECT_THAT(PickAll(&picker),
+              UnorderedElementsAreArray(GenerateMoves(position, Color::WHITE)));
+}
+
+TEST(MovePicker, CapturesOnlyPickerSkipsQuietAndLosingMoves) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), A, FOUR);
+  MovePicker picker(position, Color::WHITE);
+
+  EXPECT_THAT(PickAll(&picker), ElementsAre(Move(&position, D, ONE, A, FOUR)));
+}
+
+TEST(MovePicker, CapturesOnlyPickerPicksQueenPromotions) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), B, TWO);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, THREE);
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  MovePicker picker(position, Color::BLACK);
+
+  EXPECT_THAT(PickAll(&picker),
+              ElementsAre(Move(&position, {B, TWO}, {B, ONE}, Kind::QUEEN)));
+}
+
+TEST(MovePicker, CapturesOnlyPickerKeepsAnEvenEnPassantCapture) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FIVE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::QUEEN, Color::BLACK), D, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, SEVEN);
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+  MovePicker picker(position, Color::WHITE);
+
+  EXPECT_THAT(PickAll(&picker), ElementsAre(Move(&position, E, FIVE, D, SIX)));
+}
@@ -9,7 +9,15 @@ TEST(IsACapture, IsNotACapture) {
   position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, TWO);
   Move move(&position, E, TWO, E, THREE);
 
-  EXPECT_TRUE(move.IsACapture());
+  EXPECT_FALSE(move.IsACapture());
+}
+
+TEST(IsACapture, BlackMoveToAnEmptySquareIsNotACapture) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SEVEN);
+  Move move(&position, E, SEVEN, E, FIVE);
+
+  EXPECT_FALSE(move.IsACapture());
 }
 
 TEST(IsACapture, IsActuallyACapture) {
@@ -21,6 +29,15 @@ TEST(IsACapture, IsActuallyACapture) {
   EXPECT_TRUE(move.IsACapture());
 }
 
+TEST(IsACapture, TakingEnPassantIsACapture) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, SEVEN);
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+
+  EXPECT_TRUE(Move(&position, E, FIVE, D, SIX).IsACapture());
+}
+
 TEST(ToAlgebraicNotation, NoPosition) {
   Move move(E, TWO, E, FOUR);
   const std::string algebraic_notation = move.ToAlgebraicNotation();
@@ -47,3 +64,33 @@ TEST(ToAlgebraicNotation, KnownPositionKnight) {
 
   EXPECT_EQ(algebraic_notation, "Nb1-c3");
 }
+
+TEST(PackMove, RoundTrips) {
+  Position position;
+  const Move move(&position, B, ONE, C, THREE);
+  const uint16_t packed_move = PackMove(move);
+
+  EXPECT_NE(packed_move, 0);
+  EXPECT_EQ(UnpackMove(packed_move, &position), move);
+  EXPECT_EQ(UnpackMove(PackMove(Move(H, EIGHT, A, ONE)), nullptr),
+            Move(H, EIGHT, A, ONE));
+}
+
+TEST(PackMove, KeepsThePromotion) {
+  const Move move({A, TWO}, {B, ONE}, Kind::KNIGHT);
+
+  EXPECT_EQ(UnpackMove(PackMove(move), nullptr), move);
+  EXPECT_NE(PackMove(move), PackMove(Move({A, TWO}, {B, ONE}, Kind::QUEEN)));
+}
+
+TEST(ToCoordinateNotation, ListsSourceAndDestination) {
+  EXPECT_EQ(Move(E, TWO, E, FOUR).ToCoordinateNotation(), "e2e4");
+  EXPECT_EQ(Move(H, EIGHT, A, ONE).ToCoordinateNotation(), "h8a1");
+}
+
+TEST(ToCoordinateNotation, EndsWithThePromotion) {
+  EXPECT_EQ(Move({E, SEVEN}, {E, EIGHT}, Kind::QUEEN).ToCoordinateNotation(),
+            "e7e8q");
+  EXPECT_EQ(Move({B, TWO}, {A, ONE}, Kind::KNIGHT).ToCoordinateNotation(),
+            "b2a1n");
+}
@@ -4,11 +4,14 @@
 #include "absl/strings/str_format.h"
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "engine/base.h"
 #include "engine/game_engine.h"
 #include "engine/move.h"
+#include "engine/latency.h"
 #include "engine/piece.h"
+#include "engine/stats.h"
 
 namespace {
 
@@ -97,17 +100,45 @@ absl::StatusOr<Square> TryParsingSquare(std::string* notation) {
       absl::StrFormat("cannot parse square from notation: \"%s\"", *notation));
 }
 
+// Kind a pawn promotes to, e.g. "=Q" in "e8=Q", where the '=' may be left out,
+// or Kind::NONE if there is none.
+Kind TryParsingPromotion(std::string* notation) {
+  const size_t offset = !notation->empty() && (*notation)[0] == '=' ? 1 : 0;
+  if (notation->size() <= offset) {
+    return Kind::NONE;
+  }
+  const auto kind = NOTATION_TO_KIND.find((*notation)[offset]);
+  if (kind == NOTATION_TO_KIND.end() || kind->second == Kind::KING) {
+    return Kind::NONE;
+  }
+  *notation = notation->substr(offset + 1);
+  return kind->second;
+}
+
 } // namespace
 
 absl::StatusOr<Move>
 ParseAlgebraicNotation(const std::string& original_notation, Color color,
                        const Position& position) {
-  // Castling.
-  const int initial_rank = (color == Color::WHITE ? ONE : EIGHT);
-  if (original_notation == "0-0") {
-    return Move(&position, Square{E, initial_rank}, Square{G, initial_rank});
-  } else if (original_notation == "0-0-0") {
-    return Move(&position, Square{E, initial_rank}, Square{C, initial_rank});
+  ScopedLatency latency(TimedOperation::NOTATION_PARSE);
+  CountEvent(Counter::NOTATION_PARSES);
+  // Castling, which is the king move two squares to the side of the rook, and
+  // is only legal as the move generation gives it. Written with either zeros
+  // or the letter O, as in standard algebraic notation.
+  const bool short_castling =
+      original_notation == "0-0" || original_notation == "O-O";
+  const bool long_castling =
+      original_notation == "0-0-0" || original_notation == "O-O-O";
+  if (short_castling || long_castling) {
+    const int initial_rank = (color == Color::WHITE ? ONE : EIGHT);
+    const Move move(&position, Square{E, initial_rank},
+                    Square{short_castling ? G : C, initial_rank});
+    if (position.GetPiece(move.From()) != Piece(Kind::KING, color) ||
+        !MoveIsValid(position, move) || LeavesKingInCheck(position, move)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Castling \"%s\" is not legal", original_notation));
+    }
+    return move;
   }
 
   std::string notation = original_notation;
@@ -117,7 +148,7 @@ ParseAlgebraicNotation(const std::string& original_notation, Color color,
   }
 
   Kind kind = *kind_or;
-  const std::vector<Square> possible_initial_squares =
+  const std::pmr::vector<Square> possible_initial_squares =
       position.FindPieces(Piece(kind, color));
   if (possible_initial_squares.empty()) {
     // TODO: print kind and color nicely.
@@ -141,10 +172,11 @@ ParseAlgebraicNotation(const std::string& original_notation, Color color,
       return square_or.status();
     }
   }
+  const Kind promotion = TryParsingPromotion(&notation);
 
   std::vector<Move> possible_moves;
   for (const Square& initial_square : possible_initial_squares) {
-    Move move = Move(&position, initial_square, *square_or);
+    Move move = Move(&position, initial_square, *square_or, promotion);
     if (MoveIsValid(position, move)) {
       if (file_or.ok() && move.From().file != *file_or) {
         continue;
@@ -155,6 +187,12 @@ ParseAlgebraicNotation(const std::string& original_notation, Color color,
       possible_moves.push_back(move);
     }
   }
+  // Moves leaving the king in check are illegal, and the notation only names
+  // the source square when several pieces could legally move, leaving out
+  // those which are pinned.
+  std::erase_if(possible_moves, [&](const Move& move) {
+    return LeavesKingInCheck(position, move);
+  });
   // TODO: print position to the status message.
   if (possible_moves.empty()) {
     return absl::InvalidArgumentError(
@@ -180,3 +218,42 @@ ParseAlgebraicNotation(const std::string& original_notation, Color color,
 
   return possible_moves[0];
 }
+
+absl::StatusOr<Move> ParseCoordinateNotation(const std::string& notation,
+                                             Color color,
+                                             const Position& position) {
+  ScopedLatency latency(TimedOperation::NOTATION_PARSE);
+  CountEvent(Counter::NOTATION_PARSES);
+  std::string remaining_notation = notation;
+  absl::StatusOr<Square> from_or = TryParsingSquare(&remaining_notation);
+  if (!from_or.ok()) {
+    return from_or.status();
+  }
+  absl::StatusOr<Square> to_or = TryParsingSquare(&remaining_notation);
+  if (!to_or.ok()) {
+    return to_or.status();
+  }
+  // The promotion piece is in lower case, e.g. "e7e8q".
+  Kind promotion = Kind::NONE;
+  if (remaining_notation.size() == 1 && remaining_notation[0] >= 'a' &&
+      remaining_notation[0] <= 'z') {
+    const auto kind = NOTATION_TO_KIND.find(remaining_notation[0] - 'a' + 'A');
+    if (kind != NOTATION_TO_KIND.end() && kind->second != Kind::KING) {
+      promotion = kind->second;
+      remaining_notation.clear();
+    }
+  }
+  if (!remaining_notation.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unparsed notation left: \"%s\" from parsing \"%s\"",
+                        remaining_notation, notation));
+  }
+  for (const Move& move : GenerateLegalMoves(position, color)) {
+    if (move.From() == *from_or && move.To() == *to_or &&
+        move.Promotion() == promotion) {
+      return move;
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Notation \"%s\" is not a legal move", notation));
+}
@@ -7,8 +7,18 @@
 #include "engine/move.h"
 #include "engine/position.h"
 
+// Parses a move in algebraic notation, e.g. "Nf3", "exd6", "e8=Q" or "0-0",
+// which must be legal for `color` in `position`. Castling may also be written
+// with the letter O, e.g. "O-O-O".
 absl::StatusOr<Move>
 ParseAlgebraicNotation(const std::string& original_notation, Color color,
                        const Position& position);
 
+// Parses a move given by its source and destination squares, e.g. "e2e4", and
+// the promotion piece if any, e.g. "e7e8q", as used by the UCI protocol. The
+// move must be legal for `color` in `position`.
+absl::StatusOr<Move> ParseCoordinateNotation(const std::string& notation,
+                                             Color color,
+                                             const Position& position);
+
 #endif // ENGINE_NOTATION_PARSER_H_
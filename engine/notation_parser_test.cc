@@ -108,6 +108,71 @@ TEST(ParseAlgebraicNotation, NoDisambiguationWhenItsNeededCausesError) {
   EXPECT_FALSE(move.ok());
 }
 
+TEST(ParseAlgebraicNotation, PinnedPieceNeedsNoDisambiguation) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), E, TWO);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), B, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, EIGHT);
+  absl::StatusOr<Move> move =
+      ParseAlgebraicNotation("Nc3", Color::WHITE, position);
+
+  ASSERT_TRUE(move.ok()) << move.status();
+  EXPECT_EQ(*move, Move(&position, B, ONE, C, THREE));
+}
+
+TEST(ParseAlgebraicNotation, OnlyMoveIgnoringCheckGivesError) {
+  Position position = StartingPosition();
+  position.MakeMove(Square{E, TWO}, Square{E, FOUR});
+  position.MakeMove(Square{F, SEVEN}, Square{F, FIVE});
+  position.MakeMove(Square{D, ONE}, Square{H, FIVE});
+
+  EXPECT_FALSE(ParseAlgebraicNotation("a6", Color::BLACK, position).ok());
+  EXPECT_TRUE(ParseAlgebraicNotation("g6", Color::BLACK, position).ok());
+}
+
+TEST(ParseAlgebraicNotation, KingTakingProtectedPieceGivesError) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), D, TWO);
+  position.AddPiece(Piece(Kind::BISHOP, Color::BLACK), A, FIVE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+
+  EXPECT_FALSE(ParseAlgebraicNotation("Kxd2", Color::WHITE, position).ok());
+  position.RemovePiece(A, FIVE);
+  EXPECT_TRUE(ParseAlgebraicNotation("Kxd2", Color::WHITE, position).ok());
+}
+
+TEST(ParseAlgebraicNotation, PromotionIsParsed) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, SEVEN);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), D, EIGHT);
+
+  absl::StatusOr<Move> move =
+      ParseAlgebraicNotation("e8=Q", Color::WHITE, position);
+  ASSERT_TRUE(move.ok()) << move.status();
+  EXPECT_EQ(*move, Move(&position, {E, SEVEN}, {E, EIGHT}, Kind::QUEEN));
+
+  move = ParseAlgebraicNotation("exd8N", Color::WHITE, position);
+  ASSERT_TRUE(move.ok()) << move.status();
+  EXPECT_EQ(*move, Move(&position, {E, SEVEN}, {D, EIGHT}, Kind::KNIGHT));
+
+  EXPECT_FALSE(ParseAlgebraicNotation("e8", Color::WHITE, position).ok());
+  EXPECT_FALSE(ParseAlgebraicNotation("e8=K", Color::WHITE, position).ok());
+}
+
+TEST(ParseAlgebraicNotation, EnPassantIsParsed) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, SEVEN);
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+  absl::StatusOr<Move> move =
+      ParseAlgebraicNotation("exd6", Color::WHITE, position);
+
+  ASSERT_TRUE(move.ok()) << move.status();
+  EXPECT_EQ(*move, Move(&position, E, FIVE, D, SIX));
+}
+
 TEST(ParseAlgebraicNotation, ShortCastlingIsParsed) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
@@ -118,6 +183,9 @@ TEST(ParseAlgebraicNotation, ShortCastlingIsParsed) {
 
   EXPECT_TRUE(move.ok());
   EXPECT_EQ(*move, Move(&position, {E, EIGHT}, {G, EIGHT}));
+  move = ParseAlgebraicNotation("O-O", Color::BLACK, position);
+  EXPECT_TRUE(move.ok());
+  EXPECT_EQ(*move, Move(&position, {E, EIGHT}, {G, EIGHT}));
 }
 
 TEST(ParseAlgebraicNotation, LongCastlingIsParsed) {
@@ -130,4 +198,81 @@ TEST(ParseAlgebraicNotation, LongCastlingIsParsed) {
 
   EXPECT_TRUE(move.ok());
   EXPECT_EQ(*move, Move(&position, {E, ONE}, {C, ONE}));
+  move = ParseAlgebraicNotation("O-O-O", Color::WHITE, position);
+  EXPECT_TRUE(move.ok());
+  EXPECT_EQ(*move, Move(&position, {E, ONE}, {C, ONE}));
+}
+
+TEST(ParseAlgebraicNotation, IllegalCastlingGivesError) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), A, EIGHT);
+  ASSERT_TRUE(ParseAlgebraicNotation("0-0", Color::WHITE, position).ok());
+
+  // Out of check.
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), E, EIGHT);
+  EXPECT_FALSE(ParseAlgebraicNotation("0-0", Color::WHITE, position).ok());
+  position.RemovePiece(E, EIGHT);
+
+  // Through check.
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), F, EIGHT);
+  EXPECT_FALSE(ParseAlgebraicNotation("0-0", Color::WHITE, position).ok());
+  position.RemovePiece(F, EIGHT);
+
+  // Without the castling right.
+  Position moved_king = position;
+  moved_king.MakeMove(Square{E, ONE}, Square{E, TWO});
+  moved_king.MakeMove(Square{E, TWO}, Square{E, ONE});
+  EXPECT_FALSE(ParseAlgebraicNotation("0-0", Color::WHITE, moved_king).ok());
+
+  // Without a king to castle with.
+  position.RemovePiece(E, ONE);
+  EXPECT_FALSE(ParseAlgebraicNotation("0-0", Color::WHITE, position).ok());
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), E, ONE);
+  EXPECT_FALSE(ParseAlgebraicNotation("0-0", Color::WHITE, position).ok());
+}
+
+TEST(ParseCoordinateNotation, LegalMoveIsParsed) {
+  const Position position = StartingPosition();
+  absl::StatusOr<Move> move =
+      ParseCoordinateNotation("g1f3", Color::WHITE, position);
+
+  ASSERT_TRUE(move.ok());
+  EXPECT_EQ(*move, Move(&position, G, ONE, F, THREE));
+}
+
+TEST(ParseCoordinateNotation, CastlingIsTheKingMove) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  absl::StatusOr<Move> move =
+      ParseCoordinateNotation("e8g8", Color::BLACK, position);
+
+  ASSERT_TRUE(move.ok());
+  EXPECT_EQ(*move, Move(&position, E, EIGHT, G, EIGHT));
+}
+
+TEST(ParseCoordinateNotation, IllegalOrMalformedMoveGivesError) {
+  const Position position = StartingPosition();
+
+  EXPECT_FALSE(ParseCoordinateNotation("e2e5", Color::WHITE, position).ok());
+  EXPECT_FALSE(ParseCoordinateNotation("e7e5", Color::WHITE, position).ok());
+  EXPECT_FALSE(ParseCoordinateNotation("e2", Color::WHITE, position).ok());
+  EXPECT_FALSE(ParseCoordinateNotation("e2e4x", Color::WHITE, position).ok());
+}
+
+TEST(ParseCoordinateNotation, PromotionIsParsed) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), B, TWO);
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  absl::StatusOr<Move> move =
+      ParseCoordinateNotation("b2b1r", Color::BLACK, position);
+
+  ASSERT_TRUE(move.ok()) << move.status();
+  EXPECT_EQ(*move, Move(&position, {B, TWO}, {B, ONE}, Kind::ROOK));
+  EXPECT_FALSE(ParseCoordinateNotation("b2b1", Color::BLACK, position).ok());
+  EXPECT_FALSE(ParseCoordinateNotation("b2b1k", Color::BLACK, position).ok());
 }
@@ -0,0 +1,174 @@
+#include "engine/opening_book.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+
+#include "engine/game_engine.h"
+
+namespace {
+
+static constexpr char FILE_MAGIC[4] = {'C', 'B', 'K', '1'};
+
+// Keeps the entries aligned when the file is mapped.
+struct BookHeader {
+  char magic[sizeof(FILE_MAGIC)];
+  uint32_t reserved = 0;
+  uint64_t entry_count;
+};
+
+} // namespace
+
+bool operator<(const BookEntry& first, const BookEntry& second) {
+  return first.hash != second.hash ? first.hash < second.hash
+                                   : first.move < second.move;
+}
+
+absl::Status WriteBook(const std::vector<BookEntry>& entries,
+                       const std::string& path) {
+  if (!std::is_sorted(entries.begin(), entries.end())) {
+    return absl::InvalidArgumentError("Book entries must be sorted");
+  }
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return absl::PermissionDeniedError(
+        absl::StrFormat("Couldn't open \"%s\" for writing", path));
+  }
+  BookHeader header;
+  std::copy(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC), header.magic);
+  header.entry_count = entries.size();
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(entries.data()),
+             entries.size() * sizeof(BookEntry));
+  if (!file) {
+    return absl::DataLossError(
+        absl::StrFormat("Couldn't write \"%s\"", path));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<OpeningBook> OpeningBook::Open(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Couldn't open \"%s\": %s", path, std::strerror(errno)));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(BookHeader)) {
+    close(fd);
+    return absl::DataLossError(
+        absl::StrFormat("\"%s\" is not an opening book", path));
+  }
+  const size_t size = file_stat.st_size;
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Couldn't map \"%s\": %s", path, std::strerror(errno)));
+  }
+  // Binary searches jump around the file.
+  madvise(data, size, MADV_RANDOM);
+
+  OpeningBook book(data, size);
+  const BookHeader* header = static_cast<const BookHeader*>(data);
+  if (std::memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+      header->entry_count != (size - sizeof(BookHeader)) / sizeof(BookEntry) ||
+      (size - sizeof(BookHeader)) % sizeof(BookEntry) != 0) {
+    return absl::DataLossError(
+        absl::StrFormat("\"%s\" is not an opening book", path));
+  }
+  book.entries_ = reinterpret_cast<const BookEntry*>(header + 1);
+  book.entry_count_ = header->entry_count;
+  return book;
+}
+
+OpeningBook::OpeningBook(void* data, size_t size) : data_(data), size_(size) {}
+
+OpeningBook::OpeningBook(OpeningBook&& other)
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      entries_(std::exchange(other.entries_, nullptr)),
+      entry_count_(std::exchange(other.entry_count_, 0)) {}
+
+OpeningBook& OpeningBook::operator=(OpeningBook&& other) {
+  if (this != &other) {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    entries_ = std::exchange(other.entries_, nullptr);
+    entry_count_ = std::exchange(other.entry_count_, 0);
+  }
+  return *this;
+}
+
+OpeningBook::~OpeningBook() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+absl::Span<const BookEntry> OpeningBook::Find(uint64_t hash) const {
+  const BookEntry* end = entries_ + entry_count_;
+  const BookEntry* first = std::lower_bound(
+      entries_, end, hash,
+      [](const BookEntry& entry, uint64_t hash) { return entry.hash < hash; });
+  const BookEntry* last = first;
+  while (last != end && last->hash == hash) {
+    ++last;
+  }
+  return absl::Span<const BookEntry>(first, last - first);
+}
+
+std::vector<BookMove> OpeningBook::Moves(const Position& position,
+                                         Color side_to_move) const {
+  std::vector<BookMove> moves;
+  const absl::Span<const BookEntry> entries =
+      Find(position.Hash(side_to_move));
+  if (entries.empty()) {
+    return moves;
+  }
+  // Guards against other positions with the same hash.
+  for (const Move& move : GenerateLegalMoves(position, side_to_move)) {
+    const uint16_t packed_move = PackMove(move);
+    for (const BookEntry& entry : entries) {
+      const uint32_t weight = 2 * entry.wins + entry.draws;
+      if (entry.move == packed_move && weight > 0) {
+        moves.push_back({move, weight});
+      }
+    }
+  }
+  return moves;
+}
+
+std::optional<Move> OpeningBook::PickMove(const Position& position,
+                                          Color side_to_move,
+                                          uint64_t random) const {
+  const std::vector<BookMove> moves = Moves(position, side_to_move);
+  uint64_t total_weight = 0;
+  for (const BookMove& move : moves) {
+    total_weight += move.weight;
+  }
+  if (total_weight == 0) {
+    return std::nullopt;
+  }
+  uint64_t remaining = random % total_weight;
+  for (const BookMove& move : moves) {
+    if (remaining < move.weight) {
+      return move.move;
+    }
+    remaining -= move.weight;
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,86 @@
+#ifndef ENGINE_OPENING_BOOK_H_
+#define ENGINE_OPENING_BOOK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+#include "engine/base.h"
+#include "engine/move.h"
+#include "engine/position.h"
+
+// How a move played in a position fared in the games of a book, from the
+// point of view of the side making it.
+struct BookEntry {
+  // Position::Hash() before the move.
+  uint64_t hash;
+  // See PackMove().
+  uint16_t move;
+  uint16_t reserved = 0;
+  uint32_t wins;
+  uint32_t draws;
+  uint32_t losses;
+
+  uint32_t Games() const { return wins + draws + losses; }
+};
+
+static_assert(sizeof(BookEntry) == 24, "Book files store entries as they are");
+
+// Orders entries by position, so that the moves of a position are next to
+// each other, then by move.
+bool operator<(const BookEntry& first, const BookEntry& second);
+
+// Book files start with a short header, followed by the entries sorted as
+// above.
+absl::Status WriteBook(const std::vector<BookEntry>& entries,
+                       const std::string& path);
+
+struct BookMove {
+  Move move;
+  // The points the move scored, two for a win and one for a draw, which makes
+  // moves which did well more likely to be picked.
+  uint32_t weight;
+};
+
+// A book file mapped into memory, so that probes only read the pages they
+// need, and processes using the same book share it in the page cache.
+class OpeningBook {
+ public:
+  static absl::StatusOr<OpeningBook> Open(const std::string& path);
+
+  OpeningBook(OpeningBook&& other);
+  OpeningBook& operator=(OpeningBook&& other);
+  ~OpeningBook();
+
+  size_t EntryCount() const { return entry_count_; }
+
+  // Entries of a position, found by binary search, in move order.
+  absl::Span<const BookEntry> Find(uint64_t hash) const;
+
+  // Legal moves of the position in the book, leaving out those which never
+  // scored a point.
+  std::vector<BookMove> Moves(const Position& position,
+                              Color side_to_move) const;
+
+  // One of Moves() picked with a chance proportional to its weight, given a
+  // random number, e.g. from std::mt19937_64. Nothing if the position is out
+  // of the book.
+  std::optional<Move> PickMove(const Position& position, Color side_to_move,
+                               uint64_t random) const;
+
+ private:
+  OpeningBook(void* data, size_t size);
+
+  void* data_ = nullptr;
+  size_t size_ = 0;
+  const BookEntry* entries_ = nullptr;
+  size_t entry_count_ = 0;
+};
+
+#endif // ENGINE_OPENING_BOOK_H_
@@ -0,0 +1,91 @@
+#include "engine/opening_book.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+uint16_t PackedMove(const Square& from, const Square& to) {
+  return PackMove(Move(from, to));
+}
+
+BookEntry Entry(uint64_t hash, uint16_t move, uint32_t wins, uint32_t draws,
+                uint32_t losses) {
+  return BookEntry{hash, move, /*reserved=*/0, wins, draws, losses};
+}
+
+// A book of the first moves of white, and of a position nobody reaches.
+std::string WriteTestBook() {
+  const uint64_t start = StartingPosition().Hash(Color::WHITE);
+  std::vector<BookEntry> entries = {
+      Entry(start, PackedMove({E, TWO}, {E, FOUR}), 3, 0, 1),
+      Entry(start, PackedMove({D, TWO}, {D, FOUR}), 0, 2, 0),
+      Entry(start, PackedMove({G, ONE}, {F, THREE}), 0, 0, 5),
+      // Not a legal move, e.g. after a hash collision.
+      Entry(start, PackedMove({E, TWO}, {E, FIVE}), 9, 0, 0),
+      Entry(start + 1, PackedMove({A, TWO}, {A, THREE}), 1, 0, 0),
+      Entry(start - 1, PackedMove({A, TWO}, {A, THREE}), 1, 0, 0),
+  };
+  std::sort(entries.begin(), entries.end());
+  const std::string path = testing::TempDir() + "book.bin";
+  EXPECT_TRUE(WriteBook(entries, path).ok());
+  return path;
+}
+
+} // namespace
+
+TEST(OpeningBook, FindsTheEntriesOfAPosition) {
+  const std::string path = WriteTestBook();
+  absl::StatusOr<OpeningBook> book = OpeningBook::Open(path);
+  std::remove(path.c_str());
+
+  ASSERT_TRUE(book.ok()) << book.status();
+  EXPECT_EQ(book->EntryCount(), 6);
+  const uint64_t start = StartingPosition().Hash(Color::WHITE);
+  EXPECT_EQ(book->Find(start).size(), 4);
+  EXPECT_EQ(book->Find(start + 1).size(), 1);
+  EXPECT_TRUE(book->Find(start + 2).empty());
+  EXPECT_TRUE(book->Find(StartingPosition().Hash(Color::BLACK)).empty());
+}
+
+TEST(OpeningBook, PicksLegalMovesByWeight) {
+  const std::string path = WriteTestBook();
+  absl::StatusOr<OpeningBook> book = OpeningBook::Open(path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(book.ok()) << book.status();
+  const Position position = StartingPosition();
+
+  const std::vector<BookMove> moves = book->Moves(position, Color::WHITE);
+  ASSERT_EQ(moves.size(), 2);
+  std::map<std::string, int> picks;
+  // Weights of 6 for e4 and 2 for d4.
+  for (uint64_t random = 0; random < 8; ++random) {
+    const std::optional<Move> move =
+        book->PickMove(position, Color::WHITE, random);
+    ASSERT_TRUE(move.has_value());
+    ++picks[move->ToCoordinateNotation()];
+  }
+  EXPECT_EQ(picks["e2e4"], 6);
+  EXPECT_EQ(picks["d2d4"], 2);
+  EXPECT_FALSE(book->PickMove(position, Color::BLACK, 0).has_value());
+}
+
+TEST(OpeningBook, RejectsInvalidFiles) {
+  const std::string path = testing::TempDir() + "not_a_book.bin";
+  std::ofstream(path) << "Not an opening book, but long enough for a header";
+  EXPECT_EQ(OpeningBook::Open(path).status().code(),
+            absl::StatusCode::kDataLoss);
+  std::remove(path.c_str());
+  EXPECT_EQ(OpeningBook::Open(path).status().code(),
+            absl::StatusCode::kNotFound);
+
+  EXPECT_EQ(
+      WriteBook({Entry(2, 1, 1, 0, 0), Entry(1, 1, 1, 0, 0)}, path).code(),
+      absl::StatusCode::kInvalidArgument);
+}
@@ -1,6 +1,12 @@
 #include "engine/position.h"
 
+#include <cstdlib>
+#include <cstring>
+
+#include "engine/arena.h"
+#include "engine/latency.h"
 #include "engine/piece.h"
+#include "engine/stats.h"
 
 namespace {
 
@@ -15,6 +21,56 @@ int GetY(int flattened_index) {
   return (flattened_index & y_mask) >> BOARD_SIZE_LOG;
 }
 
+// Keys for Zobrist hashing. These are generated at compile time from a fixed
+// seed, so hashes are stable across runs and may be stored in files.
+struct ZobristKeys {
+  // Indexed by color, kind and flattened square index.
+  uint64_t pieces[2][7][BOARD_SIZE * BOARD_SIZE];
+  // Indexed by the castling rights lost, see Position::Hash(). Only the first
+  // 16 are used, the others are kept so that the keys after them stay the
+  // same.
+  uint64_t castling[64];
+  uint64_t black_to_move;
+  // Indexed by the file of the en passant square.
+  uint64_t en_passant[BOARD_SIZE];
+};
+
+constexpr uint64_t SplitMix64(uint64_t* state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys GenerateZobristKeys() {
+  ZobristKeys keys{};
+  uint64_t state = 0x5eed;
+  for (auto& color_keys : keys.pieces) {
+    for (auto& kind_keys : color_keys) {
+      for (uint64_t& key : kind_keys) {
+        key = SplitMix64(&state);
+      }
+    }
+  }
+  for (uint64_t& key : keys.castling) {
+    key = SplitMix64(&state);
+  }
+  keys.black_to_move = SplitMix64(&state);
+  // Drawn last, so that the other keys, and hashes stored before en passant
+  // was supported, stay the same.
+  for (uint64_t& key : keys.en_passant) {
+    key = SplitMix64(&state);
+  }
+  return keys;
+}
+
+static constexpr ZobristKeys ZOBRIST_KEYS = GenerateZobristKeys();
+
+uint64_t PieceKey(const Piece& piece, int flattened_index) {
+  return ZOBRIST_KEYS.pieces[static_cast<int>(piece.Color())]
+                            [static_cast<int>(piece.Kind())][flattened_index];
+}
+
 } // namespace
 
 Position::Position() {
@@ -22,6 +78,27 @@ Position::Position() {
                               Piece(Kind::NONE, Color::BLACK));
 }
 
+Position::Position(const Position& other)
+    : cells_(other.cells_), castling_bits_(other.castling_bits_),
+      en_passant_square_(other.en_passant_square_),
+      occupancy_{other.occupancy_[0], other.occupancy_[1]},
+      pieces_hash_(other.pieces_hash_) {
+  CountEvent(Counter::POSITION_COPIES);
+  std::memcpy(pieces_, other.pieces_, sizeof(pieces_));
+}
+
+Position& Position::operator=(const Position& other) {
+  CountEvent(Counter::POSITION_COPIES);
+  cells_ = other.cells_;
+  castling_bits_ = other.castling_bits_;
+  en_passant_square_ = other.en_passant_square_;
+  occupancy_[0] = other.occupancy_[0];
+  occupancy_[1] = other.occupancy_[1];
+  std::memcpy(pieces_, other.pieces_, sizeof(pieces_));
+  pieces_hash_ = other.pieces_hash_;
+  return *this;
+}
+
 bool Position::HasPiece(int x, int y) const {
   return cells_[GetFlattenedIndex(x, y)].Kind() != Kind::NONE;
 };
@@ -40,20 +117,40 @@ Piece Position::GetPiece(const Square& square) const {
 }
 
 void Position::AddPiece(const Piece& piece, int x, int y) {
-  cells_[GetFlattenedIndex(x, y)] = piece;
+  const int index = GetFlattenedIndex(x, y);
+  const Bitboard bit = Bitboard{1} << index;
+  if (cells_[index].Kind() != Kind::NONE) {
+    pieces_hash_ ^= PieceKey(cells_[index], index);
+    PieceBits(cells_[index]) &= ~bit;
+  }
+  cells_[index] = piece;
+  occupancy_[0] &= ~bit;
+  occupancy_[1] &= ~bit;
+  if (piece.Kind() != Kind::NONE) {
+    occupancy_[static_cast<int>(piece.Color())] |= bit;
+    PieceBits(piece) |= bit;
+    pieces_hash_ ^= PieceKey(piece, index);
+  }
 }
 
 void Position::AddPiece(const Piece& piece, const Square& square) {
-  cells_[GetFlattenedIndex(square.file, square.rank)] = piece;
+  AddPiece(piece, square.file, square.rank);
 }
 
 void Position::RemovePiece(int x, int y) {
-  cells_[GetFlattenedIndex(x, y)] = Piece(Kind::NONE, Color::BLACK);
+  const int index = GetFlattenedIndex(x, y);
+  const Bitboard bit = Bitboard{1} << index;
+  if (cells_[index].Kind() != Kind::NONE) {
+    pieces_hash_ ^= PieceKey(cells_[index], index);
+    PieceBits(cells_[index]) &= ~bit;
+  }
+  cells_[index] = Piece(Kind::NONE, Color::BLACK);
+  occupancy_[0] &= ~bit;
+  occupancy_[1] &= ~bit;
 }
 
 void Position::RemovePiece(const Square& square) {
-  cells_[GetFlattenedIndex(square.file, square.rank)] =
-      Piece(Kind::NONE, Color::BLACK);
+  RemovePiece(square.file, square.rank);
 }
 
 namespace {
@@ -63,6 +160,21 @@ static constexpr char BLACK_ROOK_A_MOVED_MASK = 1 << 2;
 static constexpr char BLACK_ROOK_H_MOVED_MASK = 1 << 3;
 static constexpr char WHITE_ROOK_A_MOVED_MASK = 1 << 4;
 static constexpr char WHITE_ROOK_H_MOVED_MASK = 1 << 5;
+
+// Castling bits to set when a piece leaves or lands on a square: a rook
+// leaving its corner, or taken on it, can no longer castle.
+char CornerMask(const Square& square) {
+  if (square.file != A && square.file != H) {
+    return 0;
+  }
+  if (square.rank == ONE) {
+    return square.file == A ? WHITE_ROOK_A_MOVED_MASK : WHITE_ROOK_H_MOVED_MASK;
+  }
+  if (square.rank == EIGHT) {
+    return square.file == A ? BLACK_ROOK_A_MOVED_MASK : BLACK_ROOK_H_MOVED_MASK;
+  }
+  return 0;
+}
 } // namespace
 
 bool Position::ShortCastlingPossible(Color color) const {
@@ -79,32 +191,58 @@ bool Position::LongCastlingPossible(Color color) const {
   return (castling_bits_ & mask) == 0;
 }
 
-std::vector<Square> Position::FindPieces(const Piece& piece) const {
-  std::vector<Square> squares;
-  for (int i = 0; i < cells_.size(); ++i) {
-    if (cells_[i] == piece) {
-      squares.push_back({GetX(i), GetY(i)});
-    }
+void Position::DisallowShortCastling(Color color) {
+  castling_bits_ |= (color == Color::BLACK ? BLACK_ROOK_H_MOVED_MASK
+                                           : WHITE_ROOK_H_MOVED_MASK);
+}
+
+void Position::DisallowLongCastling(Color color) {
+  castling_bits_ |= (color == Color::BLACK ? BLACK_ROOK_A_MOVED_MASK
+                                           : WHITE_ROOK_A_MOVED_MASK);
+}
+
+std::pmr::vector<Square> Position::FindPieces(const Piece& piece) const {
+  std::pmr::vector<Square> squares(TransientMemory());
+  if (piece.Kind() == Kind::NONE) {
+    return squares;
+  }
+  Bitboard pieces = Pieces(piece.Color(), piece.Kind());
+  squares.reserve(PopCount(pieces));
+  while (pieces) {
+    const int index = PopLowestSquareIndex(&pieces);
+    squares.push_back({GetX(index), GetY(index)});
   }
   return squares;
 }
 
-void Position::MakeMove(const Square& from, const Square& to) {
-  // TODO: Implement en passant.
+void Position::SetEnPassantSquare(const Square& square) {
+  en_passant_square_ = GetFlattenedIndex(square.file, square.rank);
+}
+
+UndoRecord Position::MakeMove(const Square& from, const Square& to,
+                              Kind promotion) {
+  ScopedLatency latency(TimedOperation::POSITION_UPDATE);
+  CountEvent(Counter::POSITION_UPDATES);
   const Piece piece = GetPiece(from);
+  UndoRecord undo{from, to, piece, GetPiece(to), castling_bits_,
+                  en_passant_square_};
+  en_passant_square_ = -1;
+  if (piece.Kind() == Kind::PAWN) {
+    if (from.file != to.file &&
+        GetFlattenedIndex(to.file, to.rank) == undo.en_passant_square) {
+      undo.captured = GetPiece(to.file, from.rank);
+      RemovePiece(to.file, from.rank);
+    } else if (std::abs(to.rank - from.rank) == 2) {
+      en_passant_square_ =
+          GetFlattenedIndex(from.file, (from.rank + to.rank) / 2);
+    }
+  }
   // Castling
   if (piece.Kind() == Kind::KING) {
     castling_bits_ |= (piece.Color() == Color::WHITE ? WHITE_KING_MOVED_MASK
                                                      : BLACK_KING_MOVED_MASK);
   }
-  if (piece.Kind() == Kind::ROOK && from.file == A) {
-    castling_bits_ |= (piece.Color() == Color::WHITE ? WHITE_ROOK_A_MOVED_MASK
-                                                     : BLACK_ROOK_A_MOVED_MASK);
-  }
-  if (piece.Kind() == Kind::ROOK && from.file == H) {
-    castling_bits_ |= (piece.Color() == Color::WHITE ? WHITE_ROOK_H_MOVED_MASK
-                                                     : BLACK_ROOK_H_MOVED_MASK);
-  }
+  castling_bits_ |= CornerMask(from) | CornerMask(to);
   if (piece.Kind() == Kind::KING && std::abs(from.file - to.file) > 1) {
     if (piece.Color() == Color::WHITE) {
       castling_bits_ |= WHITE_KING_MOVED_MASK;
@@ -131,8 +269,74 @@ void Position::MakeMove(const Square& from, const Square& to) {
     }
   }
 
-  AddPiece(piece, to);
+  if (piece.Kind() == Kind::PAWN && (to.rank == ONE || to.rank == EIGHT)) {
+    AddPiece(Piece(promotion == Kind::NONE ? Kind::QUEEN : promotion,
+                   piece.Color()),
+             to);
+  } else {
+    AddPiece(piece, to);
+  }
   RemovePiece(from);
+  return undo;
+}
+
+void Position::UnmakeMove(const UndoRecord& undo) {
+  AddPiece(undo.moved, undo.from);
+  if (undo.moved.Kind() == Kind::PAWN && undo.from.file != undo.to.file &&
+      GetFlattenedIndex(undo.to.file, undo.to.rank) ==
+          undo.en_passant_square) {
+    RemovePiece(undo.to);
+    AddPiece(undo.captured, undo.to.file, undo.from.rank);
+  } else if (undo.captured.Kind() != Kind::NONE) {
+    AddPiece(undo.captured, undo.to);
+  } else {
+    RemovePiece(undo.to);
+  }
+  if (undo.moved.Kind() == Kind::KING &&
+      std::abs(undo.from.file - undo.to.file) > 1) {
+    const int rook_from = (undo.to.file == C ? A : H);
+    const int rook_to = (undo.to.file == C ? D : F);
+    RemovePiece(rook_to, undo.from.rank);
+    AddPiece(Piece(Kind::ROOK, undo.moved.Color()), rook_from,
+             undo.from.rank);
+  }
+  castling_bits_ = undo.castling_bits;
+  en_passant_square_ = undo.en_passant_square;
+}
+
+bool Position::CanTakeEnPassant(Color color) const {
+  if (en_passant_square_ < 0) {
+    return false;
+  }
+  // The pawns which could take stand next to the pawn which advanced, on the
+  // rank the en passant square is behind for them.
+  if (GetY(en_passant_square_) != (color == Color::WHITE ? SIX : THREE)) {
+    return false;
+  }
+  const int y = color == Color::WHITE ? FIVE : FOUR;
+  const int x = GetX(en_passant_square_);
+  const Bitboard pawns = Pieces(color, Kind::PAWN);
+  return (x > 0 && (pawns & (Bitboard{1} << GetFlattenedIndex(x - 1, y)))) ||
+         (x < BOARD_SIZE - 1 &&
+          (pawns & (Bitboard{1} << GetFlattenedIndex(x + 1, y))));
+}
+
+uint64_t Position::Hash(Color side_to_move) const {
+  // Castling rights are hashed rather than the castling bits, as losing a
+  // right by moving the king or the rook makes no difference. Same for the en
+  // passant square, which only makes a difference if it can be taken on, and
+  // is left out otherwise, so that the position hashes as it would if it was
+  // reached with other moves.
+  const int lost_castling_rights =
+      (ShortCastlingPossible(Color::WHITE) ? 0 : 1) |
+      (LongCastlingPossible(Color::WHITE) ? 0 : 2) |
+      (ShortCastlingPossible(Color::BLACK) ? 0 : 4) |
+      (LongCastlingPossible(Color::BLACK) ? 0 : 8);
+  return pieces_hash_ ^ ZOBRIST_KEYS.castling[lost_castling_rights] ^
+         (side_to_move == Color::BLACK ? ZOBRIST_KEYS.black_to_move : 0) ^
+         (CanTakeEnPassant(side_to_move)
+              ? ZOBRIST_KEYS.en_passant[GetX(en_passant_square_)]
+              : 0);
 }
 
 std::string Position::ToString() const {
@@ -1,10 +1,13 @@
 #ifndef ENGINE_POSITION_H_
 #define ENGINE_POSITION_H_
 
+#include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
 #include "engine/base.h"
+#include "engine/bitboard.h"
 #include "engine/piece.h"
 
 enum File { A = 0, B = 1, C = 2, D = 3, E = 4, F = 5, G = 6, H = 7 };
@@ -22,9 +25,28 @@ enum Rank {
   EIGHT = 7
 };
 
+// Everything needed to take back a move, returned by Position::MakeMove().
+struct UndoRecord {
+  Square from;
+  Square to;
+  // The pawn, if it promoted.
+  Piece moved;
+  // Kind::NONE if the move wasn't a capture. A pawn taken en passant stood
+  // next to `from` rather than on `to`.
+  Piece captured;
+  char castling_bits;
+  // As kept by Position, from before the move.
+  int en_passant_square;
+};
+
 class Position {
  public:
   Position();
+  // Copies are counted, see Counter::POSITION_COPIES.
+  Position(const Position& other);
+  Position& operator=(const Position& other);
+  Position(Position&& other) = default;
+  Position& operator=(Position&& other) = default;
 
   bool HasPiece(int x, int y) const;
   bool HasPiece(const Square& square) const;
@@ -41,24 +63,87 @@ class Position {
   bool ShortCastlingPossible(Color color) const;
   bool LongCastlingPossible(Color color) const;
 
-  std::vector<Square> FindPieces(const Piece& piece) const;
+  // Marks the corresponding rook as moved, e.g. when setting up a position
+  // where castling is no longer possible.
+  void DisallowShortCastling(Color color);
+  void DisallowLongCastling(Color color);
+
+  // Allocated from TransientMemory(), in the order of Bitboard bits.
+  std::pmr::vector<Square> FindPieces(const Piece& piece) const;
+
+  // Squares of the pieces of a given color and kind, kept up to date with
+  // the occupancy, so that iterating over them costs one step per piece
+  // rather than one per square.
+  Bitboard Pieces(Color color, Kind kind) const {
+    return pieces_[static_cast<int>(color)][static_cast<int>(kind)];
+  }
+
+  // Flattened index of the king of a given color, -1 if there is none. If
+  // several are set up, the lowest one.
+  int KingSquare(Color color) const {
+    const Bitboard kings = Pieces(color, Kind::KING);
+    return kings == 0 ? -1 : LowestSquareIndex(kings);
+  }
+
+  // Squares occupied by pieces of a given color, or by any piece. Kept up to
+  // date by AddPiece() and RemovePiece(), so these are a single load.
+  Bitboard Occupancy(Color color) const {
+    return occupancy_[static_cast<int>(color)];
+  }
+  Bitboard Occupancy() const { return occupancy_[0] | occupancy_[1]; }
+
+  // Square a pawn just passed over by advancing two squares, where an enemy
+  // pawn may take it en passant on the next move only, or no square.
+  Bitboard EnPassantSquare() const {
+    return en_passant_square_ < 0 ? 0 : Bitboard{1} << en_passant_square_;
+  }
+  // E.g. when setting up a position from FEN. Cleared by the next move.
+  void SetEnPassantSquare(const Square& square);
 
   // Not passing a Move object to avoid circular dependencies, as Move stores a
-  // pointer to its position.
-  void MakeMove(const Square& from, const Square& to);
+  // pointer to its position. A pawn reaching the last rank becomes a piece of
+  // the `promotion` kind, or a queen if none is given.
+  UndoRecord MakeMove(const Square& from, const Square& to,
+                      Kind promotion = Kind::NONE);
+  // Restores the position as it was before the corresponding MakeMove() call.
+  // Moves must be taken back in the reverse order they were made in.
+  void UnmakeMove(const UndoRecord& undo);
+
+  // Zobrist hash of the piece placement, castling rights, the side to move and
+  // the en passant square, if a pawn can take on it. Piece placement part is
+  // updated incrementally, so this is cheap.
+  uint64_t Hash(Color side_to_move) const;
 
   std::string ToString() const;
 
  private:
+  // Whether a pawn of a given color stands where it could take on the en
+  // passant square, ignoring pins.
+  bool CanTakeEnPassant(Color color) const;
+
+  Bitboard& PieceBits(const Piece& piece) {
+    return pieces_[static_cast<int>(piece.Color())]
+                  [static_cast<int>(piece.Kind())];
+  }
+
   // Stores all the board cells state, flattened into a vector.
-  // TODO: Add the necessary fields for turn validity evaluation:
-  //   * Whether the castling is possible (kings and rooks haven't moved)
-  //   * Whether a pawn moved two squares last turn (for en passant)
   std::vector<Piece> cells_;
 
   // A single byte of data storing all the necessary bits required to get
   // whether each one of 4 castling kinds is possible.
   char castling_bits_ = 0;
+
+  // Flattened index of the en passant square, -1 if there is none.
+  int en_passant_square_ = -1;
+
+  // Occupied squares, indexed by Color.
+  Bitboard occupancy_[2] = {0, 0};
+
+  // Occupied squares, indexed by Color and Kind. Kind::NONE is always empty.
+  Bitboard pieces_[2][7] = {};
+
+  // Zobrist hash of the pieces on the board.
+  uint64_t pieces_hash_ = 0;
 };
 
 Position StartingPosition();
@@ -1,5 +1,7 @@
 #include "engine/position.h"
 
+#include <utility>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -63,6 +65,41 @@ TEST(MakeMove, LongCastlingMovesBothPieces) {
   EXPECT_EQ(position.GetPiece(D, EIGHT), Piece(Kind::ROOK, Color::BLACK));
 }
 
+TEST(MakeMove, PawnAdvancingTwoSquaresSetsTheEnPassantSquare) {
+  Position position = StartingPosition();
+  EXPECT_EQ(position.EnPassantSquare(), 0);
+  position.MakeMove({E, TWO}, {E, FOUR});
+  EXPECT_EQ(position.EnPassantSquare(), SquareBit(E, THREE));
+  position.MakeMove({G, EIGHT}, {F, SIX});
+  EXPECT_EQ(position.EnPassantSquare(), 0);
+}
+
+TEST(MakeMove, PawnTakesEnPassant) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, FOUR);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, TWO);
+  position.MakeMove({E, TWO}, {E, FOUR});
+  position.MakeMove({D, FOUR}, {E, THREE});
+
+  EXPECT_FALSE(position.HasPiece(E, FOUR));
+  EXPECT_FALSE(position.HasPiece(D, FOUR));
+  EXPECT_EQ(position.GetPiece(E, THREE), Piece(Kind::PAWN, Color::BLACK));
+  EXPECT_EQ(position.Occupancy(Color::WHITE), 0);
+}
+
+TEST(MakeMove, PawnPromotes) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), B, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, TWO);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  position.MakeMove({B, SEVEN}, {B, EIGHT}, Kind::KNIGHT);
+  position.MakeMove({G, TWO}, {H, ONE});
+
+  EXPECT_EQ(position.GetPiece(B, EIGHT), Piece(Kind::KNIGHT, Color::WHITE));
+  // A queen unless told otherwise.
+  EXPECT_EQ(position.GetPiece(H, ONE), Piece(Kind::QUEEN, Color::BLACK));
+}
+
 TEST(CastlingPossible, CastlingIsImpossibleAfterKingHasMoved) {
   Position position;
   position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
@@ -87,9 +124,22 @@ TEST(CastlingPossible, CastlingIsImpossibleAfterRookHasMoved) {
   EXPECT_TRUE(position.LongCastlingPossible(Color::WHITE));
 }
 
+TEST(CastlingPossible, CastlingIsImpossibleAfterRookIsTaken) {
+  Position position = StartingPosition();
+  position.RemovePiece(G, TWO);
+  position.RemovePiece(G, SEVEN);
+  position.MakeMove({F, ONE}, {G, TWO});
+  position.MakeMove({G, TWO}, {H, EIGHT});
+
+  EXPECT_FALSE(position.ShortCastlingPossible(Color::BLACK));
+  EXPECT_TRUE(position.LongCastlingPossible(Color::BLACK));
+  // A rook leaving the corner of the other side doesn't matter to this one.
+  EXPECT_TRUE(position.ShortCastlingPossible(Color::WHITE));
+}
+
 TEST(FindPieces, FindsPiecesAsExpected) {
   Position position = StartingPosition();
-  const std::vector<Square> squares =
+  const std::pmr::vector<Square> squares =
       position.FindPieces(Piece(Kind::BISHOP, Color::BLACK));
   EXPECT_THAT(squares,
               UnorderedElementsAre(Square{C, EIGHT}, Square{F, EIGHT}));
@@ -97,7 +147,230 @@ TEST(FindPieces, FindsPiecesAsExpected) {
 
 TEST(FindPieces, FindsExpectedNumberOfPawns) {
   Position position = StartingPosition();
-  const std::vector<Square> squares =
+  const std::pmr::vector<Square> squares =
       position.FindPieces(Piece(Kind::PAWN, Color::WHITE));
   EXPECT_EQ(squares.size(), 8);
 }
+
+TEST(Pieces, TracksAddedReplacedAndRemovedPieces) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  EXPECT_EQ(position.Pieces(Color::WHITE, Kind::ROOK),
+            SquareBit(A, ONE) | SquareBit(H, ONE));
+
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), A, ONE);
+  EXPECT_EQ(position.Pieces(Color::WHITE, Kind::ROOK), SquareBit(H, ONE));
+  EXPECT_EQ(position.Pieces(Color::BLACK, Kind::KNIGHT), SquareBit(A, ONE));
+
+  position.RemovePiece(A, ONE);
+  EXPECT_EQ(position.Pieces(Color::BLACK, Kind::KNIGHT), 0);
+}
+
+TEST(Pieces, FollowMovesAndTheirUnmaking) {
+  Position position = StartingPosition();
+  const Position before = position;
+  const Bitboard white_pawns = position.Pieces(Color::WHITE, Kind::PAWN);
+  const UndoRecord first = position.MakeMove({E, TWO}, {E, FOUR});
+  const UndoRecord second = position.MakeMove({D, SEVEN}, {D, FIVE});
+  const UndoRecord third = position.MakeMove({E, FOUR}, {D, FIVE});
+  EXPECT_EQ(position.Pieces(Color::WHITE, Kind::PAWN),
+            (white_pawns & ~SquareBit(E, TWO)) | SquareBit(D, FIVE));
+  EXPECT_EQ(PopCount(position.Pieces(Color::BLACK, Kind::PAWN)), 7);
+
+  position.UnmakeMove(third);
+  position.UnmakeMove(second);
+  position.UnmakeMove(first);
+  for (const Color color : {Color::WHITE, Color::BLACK}) {
+    for (const Kind kind : {Kind::PAWN, Kind::KNIGHT, Kind::BISHOP, Kind::ROOK,
+                            Kind::QUEEN, Kind::KING}) {
+      EXPECT_EQ(position.Pieces(color, kind), before.Pieces(color, kind));
+    }
+  }
+}
+
+TEST(KingSquare, FollowsTheKing) {
+  Position position;
+  EXPECT_EQ(position.KingSquare(Color::WHITE), -1);
+
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+  position.MakeMove({E, ONE}, {G, ONE});
+  EXPECT_EQ(position.KingSquare(Color::WHITE), SquareIndex(G, ONE));
+  EXPECT_EQ(position.KingSquare(Color::BLACK), SquareIndex(E, EIGHT));
+}
+
+TEST(Occupancy, TracksAddedAndRemovedPieces) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), B, EIGHT);
+  EXPECT_EQ(position.Occupancy(Color::WHITE), SquareBit(A, ONE));
+  EXPECT_EQ(position.Occupancy(Color::BLACK), SquareBit(B, EIGHT));
+
+  position.RemovePiece(A, ONE);
+  EXPECT_EQ(position.Occupancy(), SquareBit(B, EIGHT));
+}
+
+TEST(Occupancy, CaptureReplacesOccupantColor) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), A, EIGHT);
+  position.MakeMove({A, ONE}, {A, EIGHT});
+
+  EXPECT_EQ(position.Occupancy(Color::WHITE), SquareBit(A, EIGHT));
+  EXPECT_EQ(position.Occupancy(Color::BLACK), 0);
+}
+
+TEST(Occupancy, StartingPosition) {
+  Position position = StartingPosition();
+  EXPECT_EQ(PopCount(position.Occupancy(Color::WHITE)), 16);
+  EXPECT_EQ(PopCount(position.Occupancy(Color::BLACK)), 16);
+  EXPECT_EQ(position.Occupancy(Color::WHITE), 0xffffULL);
+}
+
+TEST(Hash, DependsOnPiecePlacementAndSideToMove) {
+  Position position = StartingPosition();
+  const uint64_t initial_hash = position.Hash(Color::WHITE);
+  EXPECT_NE(initial_hash, position.Hash(Color::BLACK));
+
+  position.MakeMove({G, ONE}, {F, THREE});
+  EXPECT_NE(position.Hash(Color::BLACK), initial_hash);
+  position.MakeMove({F, THREE}, {G, ONE});
+  EXPECT_EQ(position.Hash(Color::WHITE), initial_hash);
+}
+
+TEST(Hash, TranspositionsHashEqually) {
+  Position first = StartingPosition();
+  first.MakeMove({G, ONE}, {F, THREE});
+  first.MakeMove({B, EIGHT}, {C, SIX});
+  first.MakeMove({B, ONE}, {C, THREE});
+
+  Position second = StartingPosition();
+  second.MakeMove({B, ONE}, {C, THREE});
+  second.MakeMove({B, EIGHT}, {C, SIX});
+  second.MakeMove({G, ONE}, {F, THREE});
+
+  EXPECT_EQ(first.Hash(Color::BLACK), second.Hash(Color::BLACK));
+}
+
+TEST(Hash, DependsOnCastlingRights) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  const uint64_t initial_hash = position.Hash(Color::WHITE);
+
+  position.MakeMove({H, ONE}, {H, TWO});
+  position.MakeMove({H, TWO}, {H, ONE});
+  EXPECT_NE(position.Hash(Color::WHITE), initial_hash);
+}
+
+TEST(Hash, DependsOnCastlingRightsNotOnHowTheyWereLost) {
+  Position king_moved;
+  king_moved.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  king_moved.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  king_moved.AddPiece(Piece(Kind::ROOK, Color::WHITE), H, ONE);
+  king_moved.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+  Position rooks_moved = king_moved;
+  Position rights_disallowed = king_moved;
+
+  king_moved.MakeMove({E, ONE}, {E, TWO});
+  king_moved.MakeMove({E, TWO}, {E, ONE});
+  rooks_moved.MakeMove({A, ONE}, {A, TWO});
+  rooks_moved.MakeMove({A, TWO}, {A, ONE});
+  rooks_moved.MakeMove({H, ONE}, {H, TWO});
+  rooks_moved.MakeMove({H, TWO}, {H, ONE});
+  rights_disallowed.DisallowShortCastling(Color::WHITE);
+  rights_disallowed.DisallowLongCastling(Color::WHITE);
+
+  EXPECT_EQ(king_moved.Hash(Color::WHITE), rooks_moved.Hash(Color::WHITE));
+  EXPECT_EQ(king_moved.Hash(Color::WHITE),
+            rights_disallowed.Hash(Color::WHITE));
+}
+
+TEST(Hash, DependsOnEnPassantOnlyIfAPawnCanTake) {
+  Position position = StartingPosition();
+  position.MakeMove({E, TWO}, {E, FOUR});
+  Position transposed = StartingPosition();
+  transposed.MakeMove({E, TWO}, {E, THREE});
+  transposed.MakeMove({E, THREE}, {E, FOUR});
+  EXPECT_EQ(position.Hash(Color::BLACK), transposed.Hash(Color::BLACK));
+
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+  position.MakeMove({E, FOUR}, {E, FIVE});
+  position.MakeMove({F, SEVEN}, {F, FIVE});
+  transposed.MakeMove({D, SEVEN}, {D, FIVE});
+  transposed.MakeMove({E, FOUR}, {E, FIVE});
+  transposed.MakeMove({F, SEVEN}, {F, SIX});
+  transposed.MakeMove({F, SIX}, {F, FIVE});
+  EXPECT_NE(position.Hash(Color::WHITE), transposed.Hash(Color::WHITE));
+}
+
+TEST(UnmakeMove, RestoresCapturedPiece) {
+  Position position;
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), A, EIGHT);
+  const uint64_t initial_hash = position.Hash(Color::WHITE);
+  const UndoRecord undo = position.MakeMove({A, ONE}, {A, EIGHT});
+  position.UnmakeMove(undo);
+
+  EXPECT_EQ(position.GetPiece(A, ONE), Piece(Kind::ROOK, Color::WHITE));
+  EXPECT_EQ(position.GetPiece(A, EIGHT), Piece(Kind::KNIGHT, Color::BLACK));
+  EXPECT_EQ(position.Hash(Color::WHITE), initial_hash);
+  EXPECT_TRUE(position.LongCastlingPossible(Color::WHITE));
+}
+
+TEST(UnmakeMove, RestoresCastling) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, EIGHT);
+  const uint64_t initial_hash = position.Hash(Color::BLACK);
+  const UndoRecord undo = position.MakeMove({E, EIGHT}, {C, EIGHT});
+  position.UnmakeMove(undo);
+
+  EXPECT_EQ(position.GetPiece(E, EIGHT), Piece(Kind::KING, Color::BLACK));
+  EXPECT_EQ(position.GetPiece(A, EIGHT), Piece(Kind::ROOK, Color::BLACK));
+  EXPECT_FALSE(position.HasPiece(C, EIGHT));
+  EXPECT_FALSE(position.HasPiece(D, EIGHT));
+  EXPECT_TRUE(position.LongCastlingPossible(Color::BLACK));
+  EXPECT_EQ(position.Hash(Color::BLACK), initial_hash);
+}
+
+TEST(UnmakeMove, RestoresAfterSeveralMoves) {
+  Position position = StartingPosition();
+  const std::string initial_board = position.ToString();
+  const uint64_t initial_hash = position.Hash(Color::WHITE);
+  const UndoRecord first = position.MakeMove({E, TWO}, {E, FOUR});
+  const UndoRecord second = position.MakeMove({D, SEVEN}, {D, FIVE});
+  const UndoRecord third = position.MakeMove({E, FOUR}, {D, FIVE});
+  position.UnmakeMove(third);
+  position.UnmakeMove(second);
+  position.UnmakeMove(first);
+
+  EXPECT_EQ(position.ToString(), initial_board);
+  EXPECT_EQ(position.Hash(Color::WHITE), initial_hash);
+  EXPECT_EQ(position.Occupancy(), StartingPosition().Occupancy());
+}
+
+TEST(UnmakeMove, RestoresEnPassantAndPromotion) {
+  Position position;
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), A, SEVEN);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), B, EIGHT);
+  const UndoRecord advance = position.MakeMove({D, SEVEN}, {D, FIVE});
+  const std::string board = position.ToString();
+  const uint64_t hash = position.Hash(Color::WHITE);
+
+  for (const auto& [from, to] :
+       {std::pair(Square{E, FIVE}, Square{D, SIX}),
+        std::pair(Square{A, SEVEN}, Square{B, EIGHT})}) {
+    const UndoRecord undo = position.MakeMove(from, to, Kind::ROOK);
+    position.UnmakeMove(undo);
+    EXPECT_EQ(position.ToString(), board);
+    EXPECT_EQ(position.Hash(Color::WHITE), hash);
+    EXPECT_EQ(position.EnPassantSquare(), SquareBit(D, SIX));
+  }
+  position.UnmakeMove(advance);
+  EXPECT_EQ(position.EnPassantSquare(), 0);
+}
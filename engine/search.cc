@@ -0,0 +1,800 @@
+#include "engine/search.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "engine/arena.h"
+#include "engine/bitboard.h"
+#include "engine/evaluation.h"
+#include "engine/game_engine.h"
+#include "engine/move_picker.h"
+#include "engine/task.h"
+
+namespace {
+
+// Table size used when the caller doesn't provide one.
+static constexpr size_t DEFAULT_TABLE_SIZE_IN_MEGABYTES = 16;
+
+// Scores beyond this are mates, which are stored in the transposition table
+// relative to the node rather than to the root.
+static constexpr int MATE_BOUND = MATE_SCORE - 1000;
+
+// Null move pruning is only tried this far from the leaves, and cutoffs this
+// far from the leaves are verified with a reduced search without a null move.
+static constexpr int NULL_MOVE_MIN_DEPTH = 3;
+static constexpr int NULL_MOVE_VERIFICATION_DEPTH = 8;
+
+// Futility pruning only applies to nodes this close to the leaves, where the
+// static evaluation is not expected to change by more than the margin per
+// remaining ply.
+static constexpr int FUTILITY_MAX_DEPTH = 3;
+static constexpr int FUTILITY_MARGIN = 150;
+static constexpr int REVERSE_FUTILITY_MARGIN = 120;
+
+// Late move reductions start with the moves after this many, at nodes at least
+// this deep. History scores shift the reduction by up to
+// MAX_HISTORY_SCORE / HISTORY_REDUCTION_DIVISOR plies either way.
+static constexpr int LMR_MIN_DEPTH = 3;
+static constexpr int LMR_MIN_MOVE_COUNT = 3;
+static constexpr int HISTORY_REDUCTION_DIVISOR = 8192;
+// Depths and move numbers beyond the table share its last entries.
+static constexpr int LMR_TABLE_SIZE = 64;
+
+// Iterations from this depth on search a window around the previous score
+// first, widened each time the score falls outside of it.
+static constexpr int ASPIRATION_MIN_DEPTH = 4;
+static constexpr int ASPIRATION_WINDOW = 50;
+
+// Score of a position drawn by repetition or by the fifty-move rule.
+static constexpr int DRAW_SCORE = 0;
+// Plies without a capture or pawn move after which the game is drawn.
+static constexpr int FIFTY_MOVE_PLIES = 100;
+
+// Reading the clock and the stop flag is not free, so they are only checked
+// once per this many nodes, which is well under a millisecond of search.
+static constexpr int64_t NODES_BETWEEN_LIMIT_CHECKS = 1024;
+
+struct SearchContext {
+  const SearchOptions* options = nullptr;
+  TranspositionTable* table = nullptr;
+  MoveHistory history;
+  int64_t nodes = 0;
+  // Limits are only enforced once an iteration is completed.
+  bool can_stop = false;
+  // Once set, every search returns immediately, and the results of the
+  // unfinished iteration are discarded.
+  bool stopped = false;
+  // Nodes visited by the helper threads of a multi-threaded search, which
+  // add their nodes after each iteration. Shared by all the threads.
+  std::atomic<int64_t>* helper_nodes = nullptr;
+  bool is_helper = false;
+  // Nodes of a helper already added to helper_nodes.
+  int64_t published_nodes = 0;
+  // A resumable search yields after the first move, at any node, that takes it
+  // to this many nodes.
+  int64_t yield_at_nodes = std::numeric_limits<int64_t>::max();
+  // Hashes of the positions of the game since the last capture or pawn move,
+  // then of the root and of the positions on the path to the node being
+  // searched, which is last.
+  std::vector<uint64_t> keys;
+  // Plies since the last capture or pawn move at the root and at each of the
+  // positions on the path, in the same order.
+  std::vector<int> halfmove_clocks;
+};
+
+// Makes a move of the search, recording the position it leads to for the draw
+// rules.
+UndoRecord MakeSearchMove(Position& position, Color color, const Move& move,
+                          SearchContext* context) {
+  const UndoRecord undo =
+      position.MakeMove(move.From(), move.To(), move.Promotion());
+  const bool irreversible =
+      undo.moved.Kind() == Kind::PAWN || undo.captured.Kind() != Kind::NONE;
+  context->keys.push_back(position.Hash(OppositeColor(color)));
+  context->halfmove_clocks.push_back(
+      irreversible ? 0 : context->halfmove_clocks.back() + 1);
+  return undo;
+}
+
+void UnmakeSearchMove(Position& position, const UndoRecord& undo,
+                      SearchContext* context) {
+  position.UnmakeMove(undo);
+  context->keys.pop_back();
+  context->halfmove_clocks.pop_back();
+}
+
+// Whether the position last on the path is drawn by the fifty-move rule, or
+// repeats one with the same side to move. A single repetition is enough, as
+// what can be repeated once can be repeated again.
+bool IsDraw(const SearchContext& context) {
+  const int halfmove_clock = context.halfmove_clocks.back();
+  if (halfmove_clock >= FIFTY_MOVE_PLIES) {
+    return true;
+  }
+  const int current = static_cast<int>(context.keys.size()) - 1;
+  const int first = std::max(0, current - halfmove_clock);
+  for (int i = current - 4; i >= first; i -= 2) {
+    if (context.keys[i] == context.keys[current]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ShouldStop(SearchContext* context) {
+  if (context->stopped) {
+    return true;
+  }
+  if (!context->can_stop) {
+    return false;
+  }
+  const SearchOptions& options = *context->options;
+  if (options.max_nodes > 0 && context->nodes >= options.max_nodes) {
+    context->stopped = true;
+  } else if (context->nodes % NODES_BETWEEN_LIMIT_CHECKS == 0) {
+    context->stopped =
+        (options.stop != nullptr &&
+         options.stop->load(std::memory_order_relaxed)) ||
+        (options.time_manager != nullptr &&
+         options.time_manager->HardLimitReached());
+  }
+  return context->stopped;
+}
+
+using LateMoveReductionTable =
+    std::array<std::array<int8_t, LMR_TABLE_SIZE>, LMR_TABLE_SIZE>;
+
+// Base reductions for late moves by depth and move number, growing with both.
+const LateMoveReductionTable LATE_MOVE_REDUCTIONS = []() {
+  LateMoveReductionTable reductions = {};
+  for (int d = 1; d < LMR_TABLE_SIZE; ++d) {
+    for (int m = 1; m < LMR_TABLE_SIZE; ++m) {
+      reductions[d][m] =
+          static_cast<int8_t>(0.75 + std::log(d) * std::log(m) / 2.25);
+    }
+  }
+  return reductions;
+}();
+
+int LateMoveReduction(int depth, int move_count) {
+  return LATE_MOVE_REDUCTIONS[std::min(depth, LMR_TABLE_SIZE - 1)]
+                             [std::min(move_count, LMR_TABLE_SIZE - 1)];
+}
+
+// Zugzwang, where any move makes things worse, is mostly a pawn ending issue.
+// Null move pruning assumes that passing is never better than moving, so it is
+// only used when the side to move has pieces other than pawns.
+bool HasNonPawnMaterial(const Position& position, Color color) {
+  return (position.Occupancy(color) & ~position.Pieces(color, Kind::PAWN) &
+          ~position.Pieces(color, Kind::KING)) != 0;
+}
+
+int ScoreToTable(int score, int ply) {
+  if (score > MATE_BOUND) {
+    return score + ply;
+  }
+  if (score < -MATE_BOUND) {
+    return score - ply;
+  }
+  return score;
+}
+
+int ScoreFromTable(int score, int ply) {
+  if (score > MATE_BOUND) {
+    return score - ply;
+  }
+  if (score < -MATE_BOUND) {
+    return score + ply;
+  }
+  return score;
+}
+
+int QuiescenceImpl(Position& position, Color color, int alpha, int beta,
+                   int ply, SearchContext* context) {
+  if (ShouldStop(context)) {
+    return 0;
+  }
+  ++context->nodes;
+  const LegalityInfo legality = ComputeLegalityInfo(position, color);
+  const bool in_check = legality.checkers != 0;
+  int best_score = -MATE_SCORE + ply;
+  if (!in_check) {
+    best_score = Evaluate(position, color);
+    if (best_score >= beta) {
+      return best_score;
+    }
+    alpha = std::max(alpha, best_score);
+  }
+
+  // All the evasions are searched when in check, ordered as in the main
+  // search.
+  MovePicker picker =
+      in_check ? MovePicker(position, color, /*hash_move=*/0,
+                            context->history, ply, /*previous_move=*/0)
+               : MovePicker(position, color);
+  while (const std::optional<Move> move = picker.NextMove()) {
+    if (!IsLegal(position, *move, legality)) {
+      continue;
+    }
+    const UndoRecord undo =
+        position.MakeMove(move->From(), move->To(), move->Promotion());
+    const int score = -QuiescenceImpl(position, OppositeColor(color), -beta,
+                                      -alpha, ply + 1, context);
+    position.UnmakeMove(undo);
+    if (score > best_score) {
+      best_score = score;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          break;
+        }
+      }
+    }
+  }
+  return best_score;
+}
+
+Task<int> AlphaBeta(Position& position, Color color, int depth, int alpha,
+                    int beta, int ply, uint16_t previous_move,
+                    bool null_move_allowed, SearchContext* context) {
+  if (IsDraw(*context)) {
+    co_return DRAW_SCORE;
+  }
+  if (depth <= 0) {
+    co_return QuiescenceImpl(position, color, alpha, beta, ply, context);
+  }
+  if (ShouldStop(context)) {
+    co_return 0;
+  }
+  ++context->nodes;
+  const SearchOptions& options = *context->options;
+  // Nodes searched with a non-null window may become part of the principal
+  // variation, so they are never pruned or cut off by the table.
+  const bool is_pv_node = beta - alpha > 1;
+
+  const uint64_t key = context->keys.back();
+  TranspositionTable::Entry entry;
+  uint16_t hash_move = 0;
+  if (context->table->Probe(key, &entry)) {
+    hash_move = entry.move;
+    const int score = ScoreFromTable(entry.score, ply);
+    if (!is_pv_node && entry.depth >= depth &&
+        (entry.bound == TranspositionTable::Bound::EXACT ||
+         (entry.bound == TranspositionTable::Bound::LOWER && score >= beta) ||
+         (entry.bound == TranspositionTable::Bound::UPPER && score <= alpha))) {
+      co_return score;
+    }
+  }
+
+  // Moves are only checked for legality once tried, as most nodes cut off
+  // after the first few.
+  const LegalityInfo legality = ComputeLegalityInfo(position, color);
+  const bool in_check = legality.checkers != 0;
+  const int static_evaluation =
+      in_check ? -INFINITE_SCORE : Evaluate(position, color);
+
+  // Reverse futility pruning: close to the leaves, a position this far above
+  // beta is unlikely to drop below it.
+  if (options.futility_pruning && !is_pv_node && !in_check &&
+      depth <= FUTILITY_MAX_DEPTH && std::abs(beta) < MATE_BOUND &&
+      static_evaluation - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+    co_return static_evaluation;
+  }
+
+  // Null move pruning: if passing the turn still leaves a reduced search above
+  // beta, a real move would almost surely do too.
+  if (options.null_move_pruning && null_move_allowed && !is_pv_node &&
+      !in_check && depth >= NULL_MOVE_MIN_DEPTH && static_evaluation >= beta &&
+      HasNonPawnMaterial(position, color)) {
+    const int reduction = 2 + depth / 4;
+    // No position before the null move can be repeated after it, so it starts
+    // the draw rules afresh.
+    context->keys.push_back(position.Hash(OppositeColor(color)));
+    context->halfmove_clocks.push_back(0);
+    int score = -co_await AlphaBeta(position, OppositeColor(color),
+                                    depth - 1 - reduction, -beta, -beta + 1,
+                                    ply + 1, /*previous_move=*/0,
+                                    /*null_move_allowed=*/false, context);
+    context->keys.pop_back();
+    context->halfmove_clocks.pop_back();
+    if (context->stopped) {
+      co_return 0;
+    }
+    if (score >= beta) {
+      // Mates found after passing the turn are not real.
+      if (score > MATE_BOUND) {
+        score = beta;
+      }
+      if (depth < NULL_MOVE_VERIFICATION_DEPTH ||
+          co_await AlphaBeta(position, color, depth - 1 - reduction, beta - 1,
+                             beta, ply, previous_move,
+                             /*null_move_allowed=*/false, context) >= beta) {
+        co_return score;
+      }
+    }
+  }
+
+  const bool futility_applies =
+      options.futility_pruning && !is_pv_node && !in_check &&
+      depth <= FUTILITY_MAX_DEPTH &&
+      static_evaluation + FUTILITY_MARGIN * depth <= alpha;
+
+  const int original_alpha = alpha;
+  int best_score = -INFINITE_SCORE;
+  uint16_t best_move = 0;
+  int move_count = 0;
+  std::pmr::vector<Move> tried_quiet_moves(TransientMemory());
+  MovePicker picker(position, color, hash_move, context->history, ply,
+                    previous_move);
+  while (const std::optional<Move> move = picker.NextMove()) {
+    if (!IsLegal(position, *move, legality)) {
+      continue;
+    }
+    // Promotions change the material balance as much as captures, so they are
+    // never pruned or reduced as quiet moves.
+    const bool is_quiet =
+        !move->IsACapture() && move->Promotion() == Kind::NONE;
+    const UndoRecord undo = MakeSearchMove(position, color, *move, context);
+    ++move_count;
+    const bool gives_check = IsInCheck(position, OppositeColor(color));
+
+    // Futility pruning: close to the leaves, a quiet move is unlikely to
+    // raise a position this far below alpha above it.
+    if (futility_applies && is_quiet && !gives_check && move_count > 1) {
+      UnmakeSearchMove(position, undo, context);
+      best_score = std::max(best_score,
+                            static_evaluation + FUTILITY_MARGIN * depth);
+      continue;
+    }
+
+    // Principal variation search: the first move is searched with the full
+    // window, and the others only need to be proven worse with a null window
+    // unless they turn out to be better.
+    const uint16_t packed_move = PackMove(*move);
+    int score;
+    if (move_count == 1) {
+      score = -co_await AlphaBeta(position, OppositeColor(color), depth - 1,
+                                  -beta, -alpha, ply + 1, packed_move,
+                                  /*null_move_allowed=*/true, context);
+    } else {
+      // Late move reductions: quiet moves ordered late are unlikely to be
+      // good, the more so the worse their history, and are searched to a
+      // reduced depth first.
+      int reduction = 0;
+      if (options.late_move_reductions && depth >= LMR_MIN_DEPTH &&
+          move_count > LMR_MIN_MOVE_COUNT && is_quiet && !in_check &&
+          !gives_check) {
+        reduction = LateMoveReduction(depth, move_count) -
+                    context->history.HistoryScore(*move, color) /
+                        HISTORY_REDUCTION_DIVISOR;
+        if (is_pv_node) {
+          --reduction;
+        }
+        reduction = std::clamp(reduction, 0, depth - 2);
+      }
+      score = -co_await AlphaBeta(position, OppositeColor(color),
+                                  depth - 1 - reduction, -alpha - 1, -alpha,
+                                  ply + 1, packed_move,
+                                  /*null_move_allowed=*/true, context);
+      if (score > alpha && reduction > 0) {
+        score = -co_await AlphaBeta(position, OppositeColor(color), depth - 1,
+                                    -alpha - 1, -alpha, ply + 1, packed_move,
+                                    /*null_move_allowed=*/true, context);
+      }
+      if (score > alpha && score < beta) {
+        score = -co_await AlphaBeta(position, OppositeColor(color), depth - 1,
+                                    -beta, -alpha, ply + 1, packed_move,
+                                    /*null_move_allowed=*/true, context);
+      }
+    }
+    UnmakeSearchMove(position, undo, context);
+    if (context->nodes >= context->yield_at_nodes) {
+      co_await Yield();
+    }
+    if (context->stopped) {
+      co_return 0;
+    }
+
+    if (score > best_score) {
+      best_score = score;
+      best_move = packed_move;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          if (is_quiet) {
+            context->history.RecordCutoff(*move, color, ply, depth,
+                                          previous_move);
+            for (const Move& tried_move : tried_quiet_moves) {
+              context->history.RecordFailure(tried_move, color, depth);
+            }
+          }
+          break;
+        }
+      }
+    }
+    if (is_quiet) {
+      tried_quiet_moves.push_back(*move);
+    }
+  }
+
+  if (move_count == 0) {
+    // Checkmate or stalemate.
+    co_return in_check ? -MATE_SCORE + ply : 0;
+  }
+
+  const TranspositionTable::Bound bound =
+      best_score >= beta ? TranspositionTable::Bound::LOWER
+      : best_score > original_alpha ? TranspositionTable::Bound::EXACT
+                                    : TranspositionTable::Bound::UPPER;
+  context->table->Store(key, best_move, depth, bound,
+                        ScoreToTable(best_score, ply));
+  co_return best_score;
+}
+
+// Searches all the root moves but the excluded ones to a given depth within a
+// window, trying the best move of the previous iteration first. If all the
+// moves fail low, the returned score is an upper bound and the best move is
+// unreliable. Only the search of the best line, without excluded moves, is
+// stored in the table, as the others don't give the score of the root.
+Task<SearchResult> SearchRoot(Position& position, Color color, int depth,
+                              int alpha, int beta, uint16_t previous_best_move,
+                              const std::vector<uint16_t>& excluded_moves,
+                              SearchContext* context) {
+  SearchResult result;
+  if (ShouldStop(context)) {
+    co_return result;
+  }
+  ++context->nodes;
+
+  const int original_alpha = alpha;
+  int best_score = -INFINITE_SCORE;
+  const LegalityInfo legality = ComputeLegalityInfo(position, color);
+  MovePicker picker(position, color, previous_best_move, context->history,
+                    /*ply=*/0, /*previous_move=*/0);
+  while (const std::optional<Move> move = picker.NextMove()) {
+    const uint16_t packed_move = PackMove(*move);
+    if (std::find(excluded_moves.begin(), excluded_moves.end(),
+                  packed_move) != excluded_moves.end()) {
+      continue;
+    }
+    if (!IsLegal(position, *move, legality)) {
+      continue;
+    }
+    const UndoRecord undo = MakeSearchMove(position, color, *move, context);
+    int score;
+    if (!result.best_move.has_value()) {
+      score = -co_await AlphaBeta(position, OppositeColor(color), depth - 1,
+                                  -beta, -alpha, /*ply=*/1, packed_move,
+                                  /*null_move_allowed=*/true, context);
+    } else {
+      score = -co_await AlphaBeta(position, OppositeColor(color), depth - 1,
+                                  -alpha - 1, -alpha, /*ply=*/1, packed_move,
+                                  /*null_move_allowed=*/true, context);
+      if (score > alpha && score < beta) {
+        score = -co_await AlphaBeta(position, OppositeColor(color), depth - 1,
+                                    -beta, -alpha, /*ply=*/1, packed_move,
+                                    /*null_move_allowed=*/true, context);
+      }
+    }
+    UnmakeSearchMove(position, undo, context);
+    if (context->nodes >= context->yield_at_nodes) {
+      co_await Yield();
+    }
+    if (context->stopped) {
+      co_return result;
+    }
+
+    if (!result.best_move.has_value() || score > best_score) {
+      best_score = score;
+      result.best_move = *move;
+      result.score = score;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          break;
+        }
+      }
+    }
+  }
+
+  if (!result.best_move.has_value()) {
+    result.score = IsInCheck(position, color) ? -MATE_SCORE : 0;
+  } else if (excluded_moves.empty()) {
+    // A score outside the window only bounds the score of the root, as in
+    // AlphaBeta().
+    const TranspositionTable::Bound bound =
+        result.score >= beta ? TranspositionTable::Bound::LOWER
+        : result.score > original_alpha ? TranspositionTable::Bound::EXACT
+                                        : TranspositionTable::Bound::UPPER;
+    context->table->Store(position.Hash(color), PackMove(*result.best_move),
+                          depth, bound, result.score);
+  }
+  co_return result;
+}
+
+// Follows the best moves stored in the table from the root, as long as they
+// are legal and don't repeat a position.
+std::vector<Move> PrincipalVariation(Position& position, Color color,
+                                     uint16_t best_move, int max_length,
+                                     const TranspositionTable& table) {
+  std::vector<Move> variation;
+  std::vector<UndoRecord> undo_records;
+  std::vector<uint64_t> visited_keys = {position.Hash(color)};
+  uint16_t packed_move = best_move;
+  while (packed_move != 0 &&
+         static_cast<int>(variation.size()) < max_length) {
+    const MoveList legal_moves = GenerateLegalMoves(position, color);
+    const auto legal_move = std::find_if(
+        legal_moves.begin(), legal_moves.end(),
+        [&](const Move& move) { return PackMove(move) == packed_move; });
+    if (legal_move == legal_moves.end()) {
+      break;
+    }
+    variation.push_back(
+        Move(legal_move->From(), legal_move->To(), legal_move->Promotion()));
+    undo_records.push_back(
+        position.MakeMove(legal_move->From(), legal_move->To(),
+                          legal_move->Promotion()));
+    color = OppositeColor(color);
+    const uint64_t key = position.Hash(color);
+    if (std::find(visited_keys.begin(), visited_keys.end(), key) !=
+        visited_keys.end()) {
+      break;
+    }
+    visited_keys.push_back(key);
+    TranspositionTable::Entry entry;
+    packed_move = table.Probe(key, &entry) ? entry.move : 0;
+  }
+  for (auto undo = undo_records.rbegin(); undo != undo_records.rend();
+       ++undo) {
+    position.UnmakeMove(*undo);
+  }
+  return variation;
+}
+
+// Searches the root with a window around the expected score first, widening
+// it each time the score falls outside. Mate scores are searched with the full
+// window, as they change by more than any window between iterations.
+Task<SearchResult> AspirationSearch(Position& root, Color color, int depth,
+                                    const SearchLine* previous_line,
+                                    const std::vector<uint16_t>& excluded_moves,
+                                    SearchContext* context) {
+  const SearchOptions& options = *context->options;
+  const uint16_t previous_best_move =
+      previous_line != nullptr ? PackMove(previous_line->principal_variation[0])
+                               : 0;
+  int window = ASPIRATION_WINDOW;
+  int alpha = -INFINITE_SCORE;
+  int beta = INFINITE_SCORE;
+  if (options.aspiration_windows && depth >= ASPIRATION_MIN_DEPTH &&
+      previous_line != nullptr && std::abs(previous_line->score) < MATE_BOUND) {
+    alpha = previous_line->score - window;
+    beta = previous_line->score + window;
+  }
+  while (true) {
+    const SearchResult result =
+        co_await SearchRoot(root, color, depth, alpha, beta, previous_best_move,
+                            excluded_moves, context);
+    if (!result.best_move.has_value() || context->stopped) {
+      co_return result;
+    }
+    if (result.score <= alpha && alpha > -INFINITE_SCORE) {
+      alpha = std::max(result.score - window, -INFINITE_SCORE);
+    } else if (result.score >= beta && beta < INFINITE_SCORE) {
+      beta = std::min(result.score + window, INFINITE_SCORE);
+    } else {
+      co_return result;
+    }
+    window *= 2;
+  }
+}
+
+// Iterative deepening: shallow searches are cheap, and fill the transposition
+// table and history with moves to try first in the deeper ones. They also leave
+// a result to return when a limit stops the search. The best move of the result
+// refers to `position`.
+//
+// Each iteration searches the lines of a multi-PV search one after another,
+// excluding the root moves of the lines already found. The later lines reuse
+// the table entries of the earlier ones, so they cost much less than separate
+// searches.
+Task<SearchResult> IterativeDeepening(const Position& position, Color color,
+                                      int first_depth,
+                                      SearchContext* context) {
+  const SearchOptions& options = *context->options;
+  Position root = position;
+  context->keys = options.game_hashes;
+  context->keys.push_back(root.Hash(color));
+  context->halfmove_clocks = {options.halfmove_clock};
+  SearchResult result;
+  for (int depth = first_depth; depth <= std::max(options.depth, 1); ++depth) {
+    if (context->can_stop &&
+        ((options.stop != nullptr &&
+          options.stop->load(std::memory_order_relaxed)) ||
+         (options.time_manager != nullptr &&
+          !options.time_manager->ShouldStartIteration()))) {
+      break;
+    }
+    std::vector<SearchLine> lines;
+    std::vector<uint16_t> excluded_moves;
+    SearchResult first_line;
+    for (int i = 0; i < std::max(options.multi_pv, 1); ++i) {
+      const SearchLine* previous_line =
+          i < static_cast<int>(result.lines.size()) ? &result.lines[i]
+                                                    : nullptr;
+      const SearchResult line = co_await AspirationSearch(
+          root, color, depth, previous_line, excluded_moves, context);
+      if (i == 0) {
+        first_line = line;
+      }
+      if (!line.best_move.has_value() || context->stopped) {
+        break;
+      }
+      const uint16_t packed_move = PackMove(*line.best_move);
+      excluded_moves.push_back(packed_move);
+      lines.push_back({line.score,
+                       PrincipalVariation(root, color, packed_move, depth,
+                                          *context->table)});
+    }
+    if (context->stopped) {
+      break;
+    }
+    result.depth = depth;
+    if (lines.empty()) {
+      // Checkmate or stalemate at the root.
+      result.score = first_line.score;
+      break;
+    }
+    // A later line may score higher than an earlier one when the search is
+    // unstable.
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const SearchLine& first, const SearchLine& second) {
+                       return first.score > second.score;
+                     });
+    const Move& best_move = lines[0].principal_variation[0];
+    result.best_move = Move(&position, best_move.From(), best_move.To(),
+                            best_move.Promotion());
+    result.score = lines[0].score;
+    result.principal_variation = lines[0].principal_variation;
+    result.lines = std::move(lines);
+    context->can_stop = true;
+    if (context->is_helper) {
+      context->helper_nodes->fetch_add(context->nodes -
+                                       context->published_nodes);
+      context->published_nodes = context->nodes;
+    } else if (options.on_iteration) {
+      result.nodes = context->nodes + context->helper_nodes->load();
+      options.on_iteration(result);
+    }
+  }
+  result.nodes = context->nodes;
+  co_return result;
+}
+
+// Runs a search without ever yielding.
+SearchResult RunToCompletion(Task<SearchResult> search) {
+  while (!search.Resume()) {
+  }
+  return std::move(search.Result());
+}
+
+} // namespace
+
+int MateInMoves(int score) {
+  if (score > MATE_BOUND) {
+    return (MATE_SCORE - score + 1) / 2;
+  }
+  if (score < -MATE_BOUND) {
+    return -(MATE_SCORE + score) / 2;
+  }
+  return 0;
+}
+
+int Quiescence(const Position& position, Color color, int alpha, int beta) {
+  SearchContext context;
+  Position copy = position;
+  return QuiescenceImpl(copy, color, alpha, beta, /*ply=*/0, &context);
+}
+
+SearchResult SearchBestMove(const Position& position, Color color, int depth) {
+  TranspositionTable table(DEFAULT_TABLE_SIZE_IN_MEGABYTES);
+  return SearchBestMove(position, color, depth, &table);
+}
+
+SearchResult SearchBestMove(const Position& position, Color color, int depth,
+                            TranspositionTable* table) {
+  SearchOptions options;
+  options.depth = depth;
+  return SearchBestMove(position, color, options, table);
+}
+
+SearchResult SearchBestMove(const Position& position, Color color,
+                            const SearchOptions& options,
+                            TranspositionTable* table) {
+  // Lazy SMP: helper threads run the same search on their own copies of the
+  // position, and only share results through the table. They fill it with
+  // moves and scores the main thread then finds ready, and odd helpers start a
+  // ply deeper so that the threads don't all search the same nodes at once.
+  // Each thread generates moves in its own arena, released once it is done.
+  ScopedArena arena;
+  std::atomic<int64_t> helper_nodes(0);
+  std::atomic<bool> stop_helpers(false);
+  SearchOptions helper_options = options;
+  helper_options.depth = MAX_SEARCH_DEPTH;
+  helper_options.max_nodes = 0;
+  helper_options.time_manager = nullptr;
+  helper_options.stop = &stop_helpers;
+  helper_options.on_iteration = nullptr;
+  std::vector<std::thread> helpers;
+  for (int i = 1; i < options.threads; ++i) {
+    helpers.emplace_back([&, i]() {
+      ScopedArena arena;
+      SearchContext context;
+      context.options = &helper_options;
+      context.table = table;
+      context.helper_nodes = &helper_nodes;
+      context.is_helper = true;
+      RunToCompletion(IterativeDeepening(position, color,
+                                         /*first_depth=*/1 + i % 2, &context));
+      helper_nodes.fetch_add(context.nodes - context.published_nodes);
+    });
+  }
+
+  SearchContext context;
+  context.options = &options;
+  context.table = table;
+  context.helper_nodes = &helper_nodes;
+  SearchResult result = RunToCompletion(
+      IterativeDeepening(position, color, /*first_depth=*/1, &context));
+
+  stop_helpers = true;
+  for (std::thread& helper : helpers) {
+    helper.join();
+  }
+  result.nodes += helper_nodes;
+  return result;
+}
+
+struct ResumableSearch::State {
+  Position position;
+  SearchOptions options;
+  SearchContext context;
+  std::atomic<int64_t> helper_nodes{0};
+  std::optional<Task<SearchResult>> task;
+};
+
+ResumableSearch::ResumableSearch(const Position& position, Color color,
+                                 const SearchOptions& options,
+                                 TranspositionTable* table)
+    : state_(std::make_unique<State>()) {
+  state_->position = position;
+  state_->options = options;
+  state_->context.options = &state_->options;
+  state_->context.table = table;
+  state_->context.helper_nodes = &state_->helper_nodes;
+  // The frames of the search outlive any arena of the caller.
+  ScopedTransientMemory memory(std::pmr::new_delete_resource());
+  state_->task.emplace(IterativeDeepening(
+      state_->position, color, /*first_depth=*/1, &state_->context));
+}
+
+ResumableSearch::~ResumableSearch() = default;
+
+bool ResumableSearch::Resume(int64_t nodes) {
+  // The search may resume on another thread, which must not free memory from
+  // the arena of this one.
+  ScopedTransientMemory memory(std::pmr::new_delete_resource());
+  state_->context.yield_at_nodes = state_->context.nodes + nodes;
+  return state_->task->Resume();
+}
+
+bool ResumableSearch::Done() const { return state_->task->Done(); }
+
+const SearchResult& ResumableSearch::Result() const {
+  return state_->task->Result();
+}
@@ -0,0 +1,159 @@
+#ifndef ENGINE_SEARCH_H_
+#define ENGINE_SEARCH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "engine/base.h"
+#include "engine/move.h"
+#include "engine/position.h"
+#include "engine/time_manager.h"
+#include "engine/transposition_table.h"
+
+// Score of being checkmated at the root. Mates found further from the root
+// score closer to zero, so that shorter mates are preferred.
+static constexpr int MATE_SCORE = 1000000;
+// Bound on all the scores, used as an initial search window.
+static constexpr int INFINITE_SCORE = MATE_SCORE + 1;
+// Depth for searches limited by time, nodes or an external stop only.
+static constexpr int MAX_SEARCH_DEPTH = 64;
+
+struct SearchResult;
+
+struct SearchOptions {
+  // Maximum depth in plies.
+  int depth = 1;
+
+  // Limits stopping the search before it reaches the depth. A stopped search
+  // returns the result of the last completed iteration. The first iteration
+  // is always completed, so that there is a move to return.
+  //
+  // Maximum number of nodes, zero for no limit.
+  int64_t max_nodes = 0;
+  // Unowned, may be null for no time limit.
+  const TimeManager* time_manager = nullptr;
+  // Set from another thread to stop the search. Unowned, may be null.
+  const std::atomic<bool>* stop = nullptr;
+  // Called after each completed iteration with its result, e.g. to report
+  // progress.
+  std::function<void(const SearchResult&)> on_iteration;
+
+  // Selective search techniques. These make the search reach greater depths in
+  // the same time, at the cost of rare misjudgements. They can be turned off
+  // one by one to measure their effect.
+  //
+  // Skips a node if passing the turn still fails high.
+  bool null_move_pruning = true;
+  // Searches quiet moves ordered late to a reduced depth first.
+  bool late_move_reductions = true;
+  // Skips quiet moves close to the leaves when the position is far below
+  // alpha, and skips nodes far above beta.
+  bool futility_pruning = true;
+  // Searches a narrow window around the previous iteration's score first.
+  bool aspiration_windows = true;
+
+  // Number of best root moves to find, each with its own score and principal
+  // variation.
+  int multi_pv = 1;
+
+  // Number of threads searching in parallel. The limits, the depth and the
+  // callback apply to the first thread, and the others stop with it.
+  int threads = 1;
+
+  // The game leading to the searched position, for the draw rules. Positions
+  // repeating one of the game or of the search with the same side to move, or
+  // reached a hundred plies after the last capture or pawn move, score as
+  // draws.
+  //
+  // Hashes of the positions since the last capture or pawn move, oldest
+  // first, without the searched position. See Game::ReversibleHashes().
+  std::vector<uint64_t> game_hashes;
+  // Plies since the last capture or pawn move at the searched position.
+  int halfmove_clock = 0;
+};
+
+// One of the best root moves, with its score and expected continuation.
+struct SearchLine {
+  // Score from the point of view of the side to move.
+  int score = 0;
+  // Starts with the root move. The moves don't refer to a position, as each
+  // one applies to the position after the previous one.
+  std::vector<Move> principal_variation;
+};
+
+struct SearchResult {
+  // Empty if there are no legal moves at the root.
+  std::optional<Move> best_move;
+  // Score from the point of view of the side to move.
+  int score = 0;
+  // Number of positions visited, including quiescence nodes.
+  int64_t nodes = 0;
+  // Depth of the last completed iteration.
+  int depth = 0;
+  // Expected continuation, starting with the best move. The moves don't refer
+  // to a position, as each one applies to the position after the previous one.
+  std::vector<Move> principal_variation;
+  // Best root moves, best first, as many as SearchOptions::multi_pv asks for
+  // and there are legal moves. The first line repeats the best move, its score
+  // and principal variation.
+  std::vector<SearchLine> lines;
+};
+
+// Number of moves until mate, negative if the side to move is getting mated,
+// or zero if the score isn't a mate score.
+int MateInMoves(int score);
+
+// Searches captures and queen promotions only until the position is quiet, so
+// that a search stopping in the middle of an exchange or right before a pawn
+// promotes doesn't misjudge the position. The side to move may "stand pat" and
+// accept the static evaluation instead. Moves losing material according to the
+// static exchange evaluation are not searched. When in check, all the evasions
+// are searched instead.
+int Quiescence(const Position& position, Color color, int alpha, int beta);
+
+// Alpha-beta search of a given depth in plies, resolved with a quiescence
+// search at the leaves. Iteratively deepens one ply at a time, ordering moves
+// with the results of the previous iterations.
+SearchResult SearchBestMove(const Position& position, Color color, int depth);
+
+// Same as above, reusing results stored in `table` by previous searches.
+SearchResult SearchBestMove(const Position& position, Color color, int depth,
+                            TranspositionTable* table);
+
+SearchResult SearchBestMove(const Position& position, Color color,
+                            const SearchOptions& options,
+                            TranspositionTable* table);
+
+// The search of SearchBestMove() on a single thread, run a slice at a time, so
+// that one thread can take turns between many searches. Every node of the
+// search is a coroutine, and the whole line being searched suspends after the
+// first move, at any depth, that uses up the slice.
+class ResumableSearch {
+ public:
+  // The position, options and table are the same as for SearchBestMove(),
+  // except for the number of threads. The position and options are copied,
+  // while the table must outlive the search.
+  ResumableSearch(const Position& position, Color color,
+                  const SearchOptions& options, TranspositionTable* table);
+  ~ResumableSearch();
+
+  // Searches at least `nodes` more nodes, up to the end of the move being
+  // searched then, unless the search completes first. Returns true once the
+  // search is complete.
+  bool Resume(int64_t nodes);
+
+  bool Done() const;
+
+  // Only valid once the search is complete.
+  const SearchResult& Result() const;
+
+ private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
+
+#endif // ENGINE_SEARCH_H_
@@ -0,0 +1,584 @@
+#include "engine/search.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "engine/evaluation.h"
+#include "engine/game.h"
+#include "engine/game_engine.h"
+
+TEST(Quiescence, QuietPositionReturnsStaticEvaluation) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+
+  EXPECT_EQ(Quiescence(position, Color::WHITE, -INFINITE_SCORE, INFINITE_SCORE),
+            Evaluate(position, Color::WHITE));
+}
+
+TEST(Quiescence, HangingPieceIsCaptured) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), A, SIX);
+
+  Position after_capture = position;
+  after_capture.MakeMove({A, ONE}, {A, SIX});
+  EXPECT_EQ(Quiescence(position, Color::WHITE, -INFINITE_SCORE, INFINITE_SCORE),
+            Evaluate(after_capture, Color::WHITE));
+}
+
+TEST(Quiescence, LosingCaptureIsNotSearched) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
+
+  EXPECT_EQ(Quiescence(position, Color::WHITE, -INFINITE_SCORE, INFINITE_SCORE),
+            Evaluate(position, Color::WHITE));
+}
+
+TEST(Quiescence, PawnAboutToPromoteIsPromoted) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), A, SEVEN);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, SIX);
+
+  Position after_promotion = position;
+  after_promotion.MakeMove({A, SEVEN}, {A, EIGHT}, Kind::QUEEN);
+  EXPECT_EQ(Quiescence(position, Color::WHITE, -INFINITE_SCORE, INFINITE_SCORE),
+            Evaluate(after_promotion, Color::WHITE));
+}
+
+TEST(Quiescence, DefendedEnPassantCaptureIsSearched) {
+  // The knight defending d6 is pinned, so taking en passant wins a pawn.
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), G, ONE);
+  position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), B, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FIVE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, SEVEN);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), E, FOUR);
+  position.AddPiece(Piece(Kind::ROOK, Color::BLACK), A, FOUR);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, SEVEN);
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+
+  Position after_capture = position;
+  after_capture.MakeMove({E, FIVE}, {D, SIX});
+  EXPECT_EQ(Quiescence(position, Color::WHITE, -INFINITE_SCORE, INFINITE_SCORE),
+            Evaluate(after_capture, Color::WHITE));
+}
+
+TEST(SearchBestMove, FindsBackRankMate) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), G, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), G, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), F, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), H, SEVEN);
+
+  const SearchResult result = SearchBestMove(position, Color::WHITE, 2);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_EQ(*result.best_move, Move(&position, A, ONE, A, EIGHT));
+  EXPECT_EQ(result.score, MATE_SCORE - 1);
+}
+
+TEST(SearchBestMove, DoesNotGrabAPoisonedPawn) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), H, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), D, FIVE);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, SIX);
+
+  const SearchResult result = SearchBestMove(position, Color::WHITE, 2);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_NE(*result.best_move, Move(&position, D, ONE, D, FIVE));
+  EXPECT_GT(result.score, 0);
+}
+
+TEST(SearchBestMove, CheckmatedSideHasNoMove) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), G, SEVEN);
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), G, SIX);
+
+  const SearchResult result = SearchBestMove(position, Color::BLACK, 1);
+
+  EXPECT_FALSE(result.best_move.has_value());
+  EXPECT_EQ(result.score, -MATE_SCORE);
+}
+
+TEST(SearchBestMove, StalematedSideScoresADraw) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::QUEEN, Color::WHITE), F, SEVEN);
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), G, SIX);
+
+  const SearchResult result = SearchBestMove(position, Color::BLACK, 1);
+
+  EXPECT_FALSE(result.best_move.has_value());
+  EXPECT_EQ(result.score, 0);
+}
+
+TEST(SearchBestMove, SharedTableGivesSameResult) {
+  Position position = StartingPosition();
+  position.MakeMove({E, TWO}, {E, FOUR});
+  position.MakeMove({D, SEVEN}, {D, FIVE});
+  TranspositionTable table(1);
+
+  const SearchResult first = SearchBestMove(position, Color::WHITE, 3, &table);
+  const SearchResult second = SearchBestMove(position, Color::WHITE, 3, &table);
+
+  ASSERT_TRUE(first.best_move.has_value());
+  EXPECT_EQ(second.best_move, first.best_move);
+  EXPECT_EQ(second.score, first.score);
+  EXPECT_LT(second.nodes, first.nodes);
+}
+
+namespace {
+
+SearchOptions WithoutSelectiveSearch(int depth) {
+  SearchOptions options;
+  options.depth = depth;
+  options.null_move_pruning = false;
+  options.late_move_reductions = false;
+  options.futility_pruning = false;
+  options.aspiration_windows = false;
+  return options;
+}
+
+Position OpeningPosition() {
+  Position position = StartingPosition();
+  position.MakeMove({E, TWO}, {E, FOUR});
+  position.MakeMove({E, SEVEN}, {E, FIVE});
+  position.MakeMove({G, ONE}, {F, THREE});
+  position.MakeMove({B, EIGHT}, {C, SIX});
+  return position;
+}
+
+} // namespace
+
+TEST(SearchOptions, EveryTechniqueAloneFindsTheMate) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), G, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::WHITE), B, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), G, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), F, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), H, SEVEN);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), H, FIVE);
+
+  for (int technique = 0; technique < 4; ++technique) {
+    SearchOptions options = WithoutSelectiveSearch(4);
+    options.null_move_pruning = technique == 0;
+    options.late_move_reductions = technique == 1;
+    options.futility_pruning = technique == 2;
+    options.aspiration_windows = technique == 3;
+    TranspositionTable table(1);
+    const SearchResult result =
+        SearchBestMove(position, Color::WHITE, options, &table);
+
+    ASSERT_TRUE(result.best_move.has_value());
+    EXPECT_EQ(*result.best_move, Move(&position, A, ONE, A, EIGHT));
+    EXPECT_EQ(result.score, MATE_SCORE - 1);
+  }
+}
+
+TEST(SearchOptions, SelectiveSearchVisitsFewerNodes) {
+  const Position position = OpeningPosition();
+  TranspositionTable full_width_table(1);
+  const SearchResult full_width = SearchBestMove(
+      position, Color::WHITE, WithoutSelectiveSearch(5), &full_width_table);
+  SearchOptions options;
+  options.depth = 5;
+  TranspositionTable selective_table(1);
+  const SearchResult selective =
+      SearchBestMove(position, Color::WHITE, options, &selective_table);
+
+  ASSERT_TRUE(selective.best_move.has_value());
+  EXPECT_LT(selective.nodes, full_width.nodes);
+}
+
+TEST(SearchOptions, NullMoveIsNotTriedInPawnEndings) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), E, ONE);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), E, FOUR);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), F, THREE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), E, FIVE);
+  SearchOptions without_null_move = WithoutSelectiveSearch(6);
+  SearchOptions with_null_move = without_null_move;
+  with_null_move.null_move_pruning = true;
+
+  TranspositionTable first_table(1);
+  const SearchResult first =
+      SearchBestMove(position, Color::WHITE, without_null_move, &first_table);
+  TranspositionTable second_table(1);
+  const SearchResult second =
+      SearchBestMove(position, Color::WHITE, with_null_move, &second_table);
+
+  EXPECT_EQ(first.nodes, second.nodes);
+  EXPECT_EQ(first.score, second.score);
+}
+
+TEST(SearchOptions, FutilityPruningKeepsQuietPromotions) {
+  // Black stops the d-pawn with the knight, but not the h-pawn, which only
+  // the quiet h7-h8=Q two plies later shows. That node is far below alpha,
+  // close enough to the leaves for futility pruning to apply.
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), D, ONE);
+  position.AddPiece(Piece(Kind::BISHOP, Color::WHITE), F, SIX);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), D, SIX);
+  position.AddPiece(Piece(Kind::PAWN, Color::WHITE), H, SIX);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), F, FOUR);
+  position.AddPiece(Piece(Kind::KNIGHT, Color::BLACK), A, FIVE);
+  SearchOptions with_futility = WithoutSelectiveSearch(3);
+  with_futility.futility_pruning = true;
+
+  TranspositionTable full_width_table(1);
+  const SearchResult full_width = SearchBestMove(
+      position, Color::WHITE, WithoutSelectiveSearch(3), &full_width_table);
+  TranspositionTable table(1);
+  const SearchResult result =
+      SearchBestMove(position, Color::WHITE, with_futility, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_EQ(*full_width.best_move, Move(&position, H, SIX, H, SEVEN));
+  EXPECT_EQ(*result.best_move, Move(&position, H, SIX, H, SEVEN));
+  EXPECT_EQ(result.score, full_width.score);
+}
+
+namespace {
+
+// Rook against king, where the side to move can repeat the position of three
+// plies earlier: white with Rb1-b2 and black with Kh7-g7. The black king has
+// moved before, so that its moves don't change the castling rights.
+Game RookShuffle(Color side_to_move) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), C, THREE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), B, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), G, SEVEN);
+  position.MakeMove({G, SEVEN}, {H, SEVEN});
+  if (side_to_move == Color::WHITE) {
+    position.MakeMove({B, ONE}, {B, TWO});
+    Game game(position, Color::BLACK);
+    game.MakeMove(Move(&game.Position(), H, SEVEN, G, SEVEN));
+    game.MakeMove(Move(&game.Position(), B, TWO, B, ONE));
+    game.MakeMove(Move(&game.Position(), G, SEVEN, H, SEVEN));
+    return game;
+  }
+  position.MakeMove({H, SEVEN}, {G, SEVEN});
+  Game game(position, Color::WHITE);
+  game.MakeMove(Move(&game.Position(), B, ONE, B, TWO));
+  game.MakeMove(Move(&game.Position(), G, SEVEN, H, SEVEN));
+  game.MakeMove(Move(&game.Position(), B, TWO, B, ONE));
+  return game;
+}
+
+SearchOptions WithGameHistory(const Game& game, int depth) {
+  SearchOptions options;
+  options.depth = depth;
+  options.game_hashes = game.ReversibleHashes();
+  options.halfmove_clock = game.HalfmoveClock();
+  return options;
+}
+
+} // namespace
+
+TEST(DrawRules, WinningSideAvoidsARepetition) {
+  const Game game = RookShuffle(Color::WHITE);
+  const Move repeating_move(&game.Position(), B, ONE, B, TWO);
+  SearchOptions options = WithGameHistory(game, 4);
+  options.multi_pv = static_cast<int>(
+      GenerateLegalMoves(game.Position(), Color::WHITE).size());
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(game.Position(), Color::WHITE, options, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_NE(*result.best_move, repeating_move);
+  EXPECT_GT(result.score, 0);
+  const auto repeating_line =
+      std::find_if(result.lines.begin(), result.lines.end(),
+                   [&](const SearchLine& line) {
+                     return line.principal_variation[0] == repeating_move;
+                   });
+  ASSERT_NE(repeating_line, result.lines.end());
+  EXPECT_EQ(repeating_line->score, 0);
+}
+
+TEST(DrawRules, LosingSideTakesARepetition) {
+  const Game game = RookShuffle(Color::BLACK);
+  TranspositionTable first_table(1);
+  const SearchResult without_history =
+      SearchBestMove(game.Position(), Color::BLACK, 4, &first_table);
+  TranspositionTable second_table(1);
+  const SearchResult result = SearchBestMove(
+      game.Position(), Color::BLACK, WithGameHistory(game, 4), &second_table);
+
+  EXPECT_LT(without_history.score, 0);
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_EQ(*result.best_move, Move(&game.Position(), H, SEVEN, G, SEVEN));
+  EXPECT_EQ(result.score, 0);
+}
+
+TEST(DrawRules, FiftyMoveRuleDrawsAWonPosition) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), C, THREE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), E, FIVE);
+  SearchOptions options;
+  options.depth = 3;
+  options.halfmove_clock = 99;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(position, Color::WHITE, options, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_EQ(result.score, 0);
+}
+
+TEST(SearchLimits, NodeLimitStopsTheSearch) {
+  SearchOptions options;
+  options.depth = MAX_SEARCH_DEPTH;
+  options.max_nodes = 20000;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(OpeningPosition(), Color::WHITE, options, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_GE(result.depth, 1);
+  EXPECT_LE(result.nodes, options.max_nodes);
+}
+
+TEST(SearchLimits, StoppedSearchStillCompletesFirstIteration) {
+  const std::atomic<bool> stop(true);
+  SearchOptions options;
+  options.depth = MAX_SEARCH_DEPTH;
+  options.stop = &stop;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(OpeningPosition(), Color::WHITE, options, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_EQ(result.depth, 1);
+}
+
+TEST(SearchLimits, StopFromAnotherThread) {
+  std::atomic<bool> stop(false);
+  SearchOptions options;
+  options.depth = MAX_SEARCH_DEPTH;
+  options.stop = &stop;
+  TranspositionTable table(1);
+  std::thread stopper([&stop]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stop = true;
+  });
+
+  const SearchResult result =
+      SearchBestMove(OpeningPosition(), Color::WHITE, options, &table);
+  stopper.join();
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_LT(result.depth, MAX_SEARCH_DEPTH);
+}
+
+TEST(SearchLimits, MoveTimeIsRespected) {
+  TimeControl control;
+  control.move_time_ms = 50;
+  const TimeManager time_manager(control);
+  SearchOptions options;
+  options.depth = MAX_SEARCH_DEPTH;
+  options.time_manager = &time_manager;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(OpeningPosition(), Color::WHITE, options, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  // Generous, as the test may share the machine with others.
+  EXPECT_LT(time_manager.ElapsedMilliseconds(), 500);
+}
+
+TEST(SearchLimits, ReportsEveryCompletedIteration) {
+  std::vector<int> depths;
+  SearchOptions options;
+  options.depth = 4;
+  options.on_iteration = [&depths](const SearchResult& result) {
+    depths.push_back(result.depth);
+  };
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(OpeningPosition(), Color::WHITE, options, &table);
+
+  EXPECT_EQ(depths, std::vector<int>({1, 2, 3, 4}));
+  EXPECT_EQ(result.depth, 4);
+}
+
+TEST(SearchBestMove, PrincipalVariationStartsWithBestMove) {
+  const Position position = OpeningPosition();
+  TranspositionTable table(1);
+
+  const SearchResult result = SearchBestMove(position, Color::WHITE, 4, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  ASSERT_GE(result.principal_variation.size(), 2);
+  EXPECT_LE(result.principal_variation.size(), 4);
+  EXPECT_EQ(result.principal_variation[0], *result.best_move);
+}
+
+TEST(SearchBestMove, ThreadsShareTheTable) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), G, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), G, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), F, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), H, SEVEN);
+  SearchOptions options;
+  options.depth = 5;
+  options.threads = 4;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(position, Color::WHITE, options, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  EXPECT_EQ(*result.best_move, Move(&position, A, ONE, A, EIGHT));
+  EXPECT_EQ(result.score, MATE_SCORE - 1);
+  EXPECT_EQ(result.depth, 5);
+}
+
+TEST(ResumableSearch, FindsTheSameMoveInSlices) {
+  const Position position = OpeningPosition();
+  TranspositionTable table(1);
+  const SearchResult expected =
+      SearchBestMove(position, Color::WHITE, 4, &table);
+  SearchOptions options;
+  options.depth = 4;
+  TranspositionTable resumable_table(1);
+
+  ResumableSearch search(position, Color::WHITE, options, &resumable_table);
+  int slices = 1;
+  while (!search.Resume(/*nodes=*/100)) {
+    EXPECT_FALSE(search.Done());
+    ++slices;
+  }
+
+  EXPECT_GT(slices, 10);
+  ASSERT_TRUE(search.Result().best_move.has_value());
+  EXPECT_EQ(*search.Result().best_move, *expected.best_move);
+  EXPECT_EQ(search.Result().score, expected.score);
+  EXPECT_EQ(search.Result().nodes, expected.nodes);
+}
+
+TEST(ResumableSearch, StopsBetweenSlices) {
+  std::atomic<bool> stop(false);
+  SearchOptions options;
+  options.depth = MAX_SEARCH_DEPTH;
+  options.stop = &stop;
+  int depth = 0;
+  options.on_iteration = [&](const SearchResult& result) {
+    depth = result.depth;
+  };
+  TranspositionTable table(1);
+
+  ResumableSearch search(OpeningPosition(), Color::WHITE, options, &table);
+  while (depth < 2) {
+    ASSERT_FALSE(search.Resume(/*nodes=*/100));
+  }
+  stop = true;
+  while (!search.Resume(/*nodes=*/100)) {
+  }
+
+  EXPECT_TRUE(search.Result().best_move.has_value());
+  EXPECT_LT(search.Result().depth, MAX_SEARCH_DEPTH);
+}
+
+TEST(MateInMoves, CountsMovesOfTheSideToMove) {
+  EXPECT_EQ(MateInMoves(MATE_SCORE - 1), 1);
+  EXPECT_EQ(MateInMoves(MATE_SCORE - 3), 2);
+  EXPECT_EQ(MateInMoves(-MATE_SCORE + 2), -1);
+  EXPECT_EQ(MateInMoves(350), 0);
+  EXPECT_EQ(MateInMoves(-350), 0);
+}
+
+TEST(MultiPv, ReportsDistinctBestLinesInOrder) {
+  const Position position = OpeningPosition();
+  SearchOptions options;
+  options.depth = 4;
+  options.multi_pv = 3;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(position, Color::WHITE, options, &table);
+
+  ASSERT_TRUE(result.best_move.has_value());
+  ASSERT_EQ(result.lines.size(), 3);
+  EXPECT_EQ(result.lines[0].principal_variation[0], *result.best_move);
+  EXPECT_EQ(result.lines[0].score, result.score);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_FALSE(result.lines[i].principal_variation.empty());
+    for (int j = 0; j < i; ++j) {
+      EXPECT_NE(result.lines[i].principal_variation[0],
+                result.lines[j].principal_variation[0]);
+      EXPECT_GE(result.lines[j].score, result.lines[i].score);
+    }
+  }
+}
+
+TEST(MultiPv, SecondLineScoresTheNextBestMove) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), G, ONE);
+  position.AddPiece(Piece(Kind::ROOK, Color::WHITE), A, ONE);
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), G, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), F, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), H, SEVEN);
+  SearchOptions options = WithoutSelectiveSearch(3);
+  options.multi_pv = 2;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(position, Color::WHITE, options, &table);
+
+  ASSERT_EQ(result.lines.size(), 2);
+  EXPECT_EQ(result.lines[0].principal_variation[0], Move(A, ONE, A, EIGHT));
+  EXPECT_EQ(result.lines[0].score, MATE_SCORE - 1);
+  EXPECT_LT(result.lines[1].score, result.lines[0].score);
+}
+
+TEST(MultiPv, LinesAreLimitedByLegalMoves) {
+  Position position;
+  position.AddPiece(Piece(Kind::KING, Color::BLACK), H, EIGHT);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), H, SEVEN);
+  position.AddPiece(Piece(Kind::PAWN, Color::BLACK), G, SEVEN);
+  position.AddPiece(Piece(Kind::KING, Color::WHITE), A, ONE);
+  SearchOptions options;
+  options.depth = 3;
+  options.multi_pv = 10;
+  TranspositionTable table(1);
+
+  const SearchResult result =
+      SearchBestMove(position, Color::BLACK, options, &table);
+
+  EXPECT_EQ(result.lines.size(),
+            GenerateLegalMoves(position, Color::BLACK).size());
+}
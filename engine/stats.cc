@@ -0,0 +1,102 @@
+#include "engine/stats.h"
+
+#include <mutex>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+namespace {
+
+static constexpr const char* COUNTER_NAMES[COUNTER_COUNT] = {
+    "piece_move_generations",
+    "side_move_generations",
+    "legality_checks",
+    "attack_map_builds",
+    "attacker_lookups",
+    "position_updates",
+    "position_copies",
+    "move_list_allocations",
+    "notation_parses",
+    "table_probes",
+    "table_hits",
+};
+
+// Counters of the running threads, and the counts of the exited ones.
+struct Registry {
+  std::mutex mutex;
+  std::vector<const ThreadCounters*> threads;
+  StatsSnapshot exited;
+  // Subtracted from the sums, see ResetStats().
+  StatsSnapshot reset;
+};
+
+// Never destroyed, as threads may exit after static destruction begins.
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+StatsSnapshot SumCounters(Registry& registry) {
+  StatsSnapshot sum = registry.exited;
+  for (const ThreadCounters* counters : registry.threads) {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+      sum.counts[i] += counters->Get(i);
+    }
+  }
+  return sum;
+}
+
+} // namespace
+
+const char* CounterName(Counter counter) {
+  return COUNTER_NAMES[static_cast<int>(counter)];
+}
+
+ThreadCounters::ThreadCounters() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.threads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (int i = 0; i < COUNTER_COUNT; ++i) {
+    registry.exited.counts[i] += Get(i);
+  }
+  std::erase(registry.threads, this);
+}
+
+StatsSnapshot ReadStats() {
+  if constexpr (!STATS_ENABLED) {
+    return StatsSnapshot();
+  }
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  StatsSnapshot stats = SumCounters(registry);
+  for (int i = 0; i < COUNTER_COUNT; ++i) {
+    stats.counts[i] -= registry.reset.counts[i];
+  }
+  return stats;
+}
+
+void ResetStats() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.reset = SumCounters(registry);
+}
+
+std::string FormatStats(const StatsSnapshot& stats) {
+  std::string output;
+  for (int i = 0; i < COUNTER_COUNT; ++i) {
+    absl::StrAppendFormat(&output, "%s %d\n", COUNTER_NAMES[i],
+                          stats.counts[i]);
+  }
+  const uint64_t probes = stats.Get(Counter::TABLE_PROBES);
+  absl::StrAppendFormat(
+      &output, "table_hit_rate %.3f\n",
+      probes == 0 ? 0.0
+                  : static_cast<double>(stats.Get(Counter::TABLE_HITS)) /
+                        probes);
+  return output;
+}
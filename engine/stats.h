@@ -0,0 +1,95 @@
+#ifndef ENGINE_STATS_H_
+#define ENGINE_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Counts of engine operations, to tell why a search or a service got slower.
+// Each thread counts into its own counters, which are only summed when read,
+// so that counting costs a thread-local increment. Building with
+// --define=engine_stats=disabled, as the release config does, compiles the
+// counting out entirely.
+#ifdef ENGINE_STATS_DISABLED
+static constexpr bool STATS_ENABLED = false;
+#else
+static constexpr bool STATS_ENABLED = true;
+#endif
+
+enum class Counter : int {
+  // Calls generating the moves of a single piece.
+  PIECE_MOVE_GENERATIONS,
+  // Calls generating the moves of all the pieces of a side.
+  SIDE_MOVE_GENERATIONS,
+  // MoveIsValid(), LeavesKingInCheck() and IsLegal() calls.
+  LEGALITY_CHECKS,
+  // GetSquaresUnderAttack() calls, each building a set of squares.
+  ATTACK_MAP_BUILDS,
+  // GetAttackersTo() calls.
+  ATTACKER_LOOKUPS,
+  // Moves made on a Position.
+  POSITION_UPDATES,
+  // Position copies, each allocating the board.
+  POSITION_COPIES,
+  // Move vectors returned with moves, each allocated at least once.
+  MOVE_LIST_ALLOCATIONS,
+  NOTATION_PARSES,
+  TABLE_PROBES,
+  TABLE_HITS,
+  COUNT,
+};
+
+static constexpr int COUNTER_COUNT = static_cast<int>(Counter::COUNT);
+
+// Lower case name of a counter, e.g. "table_hits".
+const char* CounterName(Counter counter);
+
+// Counters of one thread. Only the owning thread writes them, so increments
+// need no read-modify-write, while other threads may read them at any time.
+class ThreadCounters {
+ public:
+  ThreadCounters();
+  // Adds the counts to those of the exited threads.
+  ~ThreadCounters();
+
+  void Add(Counter counter, uint64_t amount) {
+    std::atomic<uint64_t>& count = counts_[static_cast<int>(counter)];
+    count.store(count.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+  }
+
+  uint64_t Get(int counter) const {
+    return counts_[counter].load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint64_t> counts_[COUNTER_COUNT] = {};
+};
+
+inline thread_local ThreadCounters thread_counters;
+
+inline void CountEvent(Counter counter, uint64_t amount = 1) {
+  if constexpr (STATS_ENABLED) {
+    thread_counters.Add(counter, amount);
+  }
+}
+
+struct StatsSnapshot {
+  uint64_t counts[COUNTER_COUNT] = {};
+
+  uint64_t Get(Counter counter) const {
+    return counts[static_cast<int>(counter)];
+  }
+};
+
+// Sums the counters of all the threads, including exited ones, since the
+// last ResetStats(). All zero if stats are compiled out.
+StatsSnapshot ReadStats();
+
+// Starts counting from zero again.
+void ResetStats();
+
+// One "<name> <count>" line per counter, followed by the table hit rate.
+std::string FormatStats(const StatsSnapshot& stats);
+
+#endif // ENGINE_STATS_H_
@@ -0,0 +1,56 @@
+#include "engine/stats.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using ::testing::HasSubstr;
+
+TEST(Stats, SumsCountsOfAllThreads) {
+  if (!STATS_ENABLED) {
+    GTEST_SKIP() << "Stats are compiled out";
+  }
+  ResetStats();
+  CountEvent(Counter::TABLE_PROBES, 3);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < 1000; ++j) {
+        CountEvent(Counter::TABLE_PROBES);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // Includes the exited threads.
+  EXPECT_EQ(ReadStats().Get(Counter::TABLE_PROBES), 4003);
+  EXPECT_EQ(ReadStats().Get(Counter::TABLE_HITS), 0);
+}
+
+TEST(Stats, ResetStartsFromZero) {
+  if (!STATS_ENABLED) {
+    GTEST_SKIP() << "Stats are compiled out";
+  }
+  CountEvent(Counter::NOTATION_PARSES, 5);
+  ResetStats();
+  EXPECT_EQ(ReadStats().Get(Counter::NOTATION_PARSES), 0);
+  CountEvent(Counter::NOTATION_PARSES);
+  EXPECT_EQ(ReadStats().Get(Counter::NOTATION_PARSES), 1);
+}
+
+TEST(Stats, FormatsEveryCounterAndHitRate) {
+  StatsSnapshot stats;
+  stats.counts[static_cast<int>(Counter::TABLE_PROBES)] = 4;
+  stats.counts[static_cast<int>(Counter::TABLE_HITS)] = 1;
+
+  const std::string output = FormatStats(stats);
+
+  EXPECT_THAT(output, HasSubstr("piece_move_generations 0\n"));
+  EXPECT_THAT(output, HasSubstr("table_probes 4\n"));
+  EXPECT_THAT(output, HasSubstr("table_hit_rate 0.250\n"));
+  EXPECT_STREQ(CounterName(Counter::LEGALITY_CHECKS), "legality_checks");
+}
@@ -0,0 +1,512 @@
+#include "engine/tablebase.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+
+#include "engine/bitboard.h"
+
+namespace {
+
+static constexpr int KING_PLACEMENTS = 462;
+static constexpr int PAWN_KING_PLACEMENTS = 1806;
+static constexpr int SQUARE_COUNT = BOARD_SIZE * BOARD_SIZE;
+static constexpr int16_t NO_KING_PLACEMENT = -1;
+
+// Placements of the two kings left after mirroring the board, see
+// TablebaseMaterial.
+struct KingPlacements {
+  int16_t index[SQUARE_COUNT][SQUARE_COUNT];
+  int white_king[PAWN_KING_PLACEMENTS];
+  int black_king[PAWN_KING_PLACEMENTS];
+};
+
+bool IsBelowDiagonal(int square) {
+  return (square >> BOARD_SIZE_LOG) < (square & (BOARD_SIZE - 1));
+}
+
+bool IsOnDiagonal(int square) {
+  return (square >> BOARD_SIZE_LOG) == (square & (BOARD_SIZE - 1));
+}
+
+KingPlacements ComputeKingPlacements(bool pawns) {
+  KingPlacements placements;
+  int count = 0;
+  for (int white_king = 0; white_king < SQUARE_COUNT; ++white_king) {
+    for (int black_king = 0; black_king < SQUARE_COUNT; ++black_king) {
+      placements.index[white_king][black_king] = NO_KING_PLACEMENT;
+      const Square white = SquareFromIndex(white_king);
+      const Square black = SquareFromIndex(black_king);
+      if (white.file >= BOARD_SIZE / 2 ||
+          (std::abs(white.file - black.file) <= 1 &&
+           std::abs(white.rank - black.rank) <= 1)) {
+        continue;
+      }
+      if (!pawns && (white.rank > white.file ||
+                     (IsOnDiagonal(white_king) && !IsOnDiagonal(black_king) &&
+                      !IsBelowDiagonal(black_king)))) {
+        continue;
+      }
+      placements.index[white_king][black_king] = count;
+      placements.white_king[count] = white_king;
+      placements.black_king[count] = black_king;
+      ++count;
+    }
+  }
+  return placements;
+}
+
+const KingPlacements& GetKingPlacements(bool pawns) {
+  static const KingPlacements placements =
+      ComputeKingPlacements(/*pawns=*/false);
+  static const KingPlacements pawn_placements =
+      ComputeKingPlacements(/*pawns=*/true);
+  return pawns ? pawn_placements : placements;
+}
+
+// Order of the pieces other than kings in the index, most valuable first.
+int KindOrder(Kind kind) {
+  switch (kind) {
+  case Kind::QUEEN:
+    return 0;
+  case Kind::ROOK:
+    return 1;
+  case Kind::BISHOP:
+    return 2;
+  case Kind::KNIGHT:
+    return 3;
+  case Kind::PAWN:
+    return 4;
+  default:
+    return 5;
+  }
+}
+
+char KindLetter(Kind kind) {
+  switch (kind) {
+  case Kind::KING:
+    return 'K';
+  case Kind::QUEEN:
+    return 'Q';
+  case Kind::ROOK:
+    return 'R';
+  case Kind::BISHOP:
+    return 'B';
+  case Kind::KNIGHT:
+    return 'N';
+  case Kind::PAWN:
+    return 'P';
+  default:
+    return '?';
+  }
+}
+
+std::optional<Kind> KindFromLetter(char letter) {
+  switch (letter) {
+  case 'Q':
+    return Kind::QUEEN;
+  case 'R':
+    return Kind::ROOK;
+  case 'B':
+    return Kind::BISHOP;
+  case 'N':
+    return Kind::KNIGHT;
+  case 'P':
+    return Kind::PAWN;
+  default:
+    return std::nullopt;
+  }
+}
+
+// Pieces of one side other than the king, in index order.
+struct Side {
+  int count = 0;
+  Kind kinds[MAX_TABLEBASE_PIECES];
+
+  void Add(Kind kind) {
+    int i = count++;
+    while (i > 0 && KindOrder(kinds[i - 1]) > KindOrder(kind)) {
+      kinds[i] = kinds[i - 1];
+      --i;
+    }
+    kinds[i] = kind;
+  }
+};
+
+// Whether `first` has more pieces, or the same number of pieces but more
+// valuable ones.
+bool IsStronger(const Side& first, const Side& second) {
+  if (first.count != second.count) {
+    return first.count > second.count;
+  }
+  for (int i = 0; i < first.count; ++i) {
+    if (first.kinds[i] != second.kinds[i]) {
+      return KindOrder(first.kinds[i]) < KindOrder(second.kinds[i]);
+    }
+  }
+  return false;
+}
+
+uint32_t SquareCountPower(int exponent) {
+  return uint32_t{1} << (BOARD_SIZE_LOG * 2 * exponent);
+}
+
+int MirrorFile(int square) { return square ^ (BOARD_SIZE - 1); }
+
+int MirrorRank(int square) {
+  return square ^ ((BOARD_SIZE - 1) << BOARD_SIZE_LOG);
+}
+
+int MirrorDiagonal(int square) {
+  return (square & (BOARD_SIZE - 1)) << BOARD_SIZE_LOG |
+         square >> BOARD_SIZE_LOG;
+}
+
+bool CastlingPossible(const Position& position, Color color) {
+  const int rank = color == Color::WHITE ? ONE : EIGHT;
+  if (position.GetPiece(E, rank) != Piece(Kind::KING, color)) {
+    return false;
+  }
+  const Piece rook(Kind::ROOK, color);
+  return (position.ShortCastlingPossible(color) &&
+          position.GetPiece(H, rank) == rook) ||
+         (position.LongCastlingPossible(color) &&
+          position.GetPiece(A, rank) == rook);
+}
+
+} // namespace
+
+TablebaseResult DecodeTablebaseValue(uint8_t value) {
+  if (value == TABLEBASE_DRAW) {
+    return {TablebaseOutcome::DRAW, 0};
+  }
+  return {value % 2 == 0 ? TablebaseOutcome::WIN : TablebaseOutcome::LOSS,
+          value - 1};
+}
+
+absl::StatusOr<TablebaseMaterial>
+TablebaseMaterial::Parse(const std::string& name) {
+  const size_t second_king = name.find('K', 1);
+  if (name.empty() || name[0] != 'K' || second_king == std::string::npos) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected two kings in \"%s\"", name));
+  }
+  if (name.size() > MAX_TABLEBASE_PIECES) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "More than %d pieces in \"%s\"", MAX_TABLEBASE_PIECES, name));
+  }
+  TablebasePieces pieces;
+  for (size_t i = 0; i < name.size(); ++i) {
+    const std::optional<Kind> kind =
+        i == 0 || i == second_king ? Kind::KING : KindFromLetter(name[i]);
+    if (!kind.has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Unexpected piece '%c' in \"%s\"", name[i], name));
+    }
+    pieces.kinds[pieces.count] = *kind;
+    pieces.colors[pieces.count] =
+        i < second_king ? Color::WHITE : Color::BLACK;
+    pieces.squares[pieces.count] = 0;
+    ++pieces.count;
+  }
+  bool colors_swapped;
+  return *Of(pieces, &colors_swapped);
+}
+
+std::optional<TablebaseMaterial>
+TablebaseMaterial::Of(const TablebasePieces& pieces, bool* colors_swapped) {
+  if (pieces.count > MAX_TABLEBASE_PIECES) {
+    return std::nullopt;
+  }
+  int kings[2] = {0, 0};
+  Side sides[2];
+  for (int i = 0; i < pieces.count; ++i) {
+    const int color = static_cast<int>(pieces.colors[i]);
+    if (pieces.kinds[i] == Kind::KING) {
+      ++kings[color];
+    } else if (KindOrder(pieces.kinds[i]) < 5) {
+      sides[color].Add(pieces.kinds[i]);
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (kings[0] != 1 || kings[1] != 1) {
+    return std::nullopt;
+  }
+
+  const Side& white = sides[static_cast<int>(Color::WHITE)];
+  const Side& black = sides[static_cast<int>(Color::BLACK)];
+  *colors_swapped = IsStronger(black, white);
+  const Side& stronger = *colors_swapped ? black : white;
+  const Side& weaker = *colors_swapped ? white : black;
+  TablebaseMaterial material;
+  material.kinds_[0] = Kind::KING;
+  material.colors_[0] = Color::WHITE;
+  material.kinds_[1] = Kind::KING;
+  material.colors_[1] = Color::BLACK;
+  material.piece_count_ = 2;
+  for (const Side* side : {&stronger, &weaker}) {
+    for (int i = 0; i < side->count; ++i) {
+      material.kinds_[material.piece_count_] = side->kinds[i];
+      material.colors_[material.piece_count_] =
+          side == &stronger ? Color::WHITE : Color::BLACK;
+      material.has_pawns_ |= side->kinds[i] == Kind::PAWN;
+      ++material.piece_count_;
+    }
+  }
+  // Three bits per piece, and the number of white pieces, which tells where
+  // the black ones start.
+  material.key_ = stronger.count;
+  for (int i = 2; i < material.piece_count_; ++i) {
+    material.key_ =
+        material.key_ << 3 | static_cast<uint32_t>(material.kinds_[i]);
+  }
+  return material;
+}
+
+std::string TablebaseMaterial::Name() const {
+  std::string name = "K";
+  for (const Color color : {Color::WHITE, Color::BLACK}) {
+    if (color == Color::BLACK) {
+      name += 'K';
+    }
+    for (int i = 2; i < piece_count_; ++i) {
+      if (colors_[i] == color) {
+        name += KindLetter(kinds_[i]);
+      }
+    }
+  }
+  return name;
+}
+
+std::vector<TablebaseMaterial> TablebaseMaterial::Conversions() const {
+  std::vector<TablebaseMaterial> conversions;
+  const auto add = [&](const TablebasePieces& pieces) {
+    if (pieces.count == 2) {
+      return;
+    }
+    bool colors_swapped;
+    const TablebaseMaterial material = *Of(pieces, &colors_swapped);
+    if (std::none_of(conversions.begin(), conversions.end(),
+                     [&](const TablebaseMaterial& other) {
+                       return other.Key() == material.Key();
+                     })) {
+      conversions.push_back(material);
+    }
+  };
+  TablebasePieces all;
+  for (int i = 0; i < piece_count_; ++i) {
+    all.kinds[i] = kinds_[i];
+    all.colors[i] = colors_[i];
+    all.squares[i] = 0;
+  }
+  all.count = piece_count_;
+  const auto without = [](TablebasePieces pieces, int captured) {
+    --pieces.count;
+    for (int i = captured; i < pieces.count; ++i) {
+      pieces.kinds[i] = pieces.kinds[i + 1];
+      pieces.colors[i] = pieces.colors[i + 1];
+    }
+    return pieces;
+  };
+
+  for (int captured = 2; captured < piece_count_; ++captured) {
+    add(without(all, captured));
+  }
+  // A pawn may also capture as it promotes.
+  for (int promoted = 2; promoted < piece_count_; ++promoted) {
+    if (kinds_[promoted] != Kind::PAWN) {
+      continue;
+    }
+    for (const Kind kind : {Kind::QUEEN, Kind::ROOK, Kind::BISHOP,
+                            Kind::KNIGHT}) {
+      TablebasePieces promotion = all;
+      promotion.kinds[promoted] = kind;
+      add(promotion);
+      for (int captured = 2; captured < piece_count_; ++captured) {
+        if (colors_[captured] != colors_[promoted]) {
+          add(without(promotion, captured));
+        }
+      }
+    }
+  }
+  return conversions;
+}
+
+uint32_t TablebaseMaterial::IndexCount() const {
+  return (has_pawns_ ? PAWN_KING_PLACEMENTS : KING_PLACEMENTS) *
+         SquareCountPower(piece_count_ - 2);
+}
+
+uint32_t TablebaseMaterial::Index(const TablebasePieces& pieces) const {
+  // Puts the pieces in index order, which only leaves pieces of the same kind
+  // and color to sort by square once the board is mirrored.
+  int squares[MAX_TABLEBASE_PIECES] = {};
+  bool placed[MAX_TABLEBASE_PIECES] = {};
+  for (int slot = 0; slot < piece_count_; ++slot) {
+    for (int i = 0; i < pieces.count; ++i) {
+      if (!placed[i] && pieces.kinds[i] == kinds_[slot] &&
+          pieces.colors[i] == colors_[slot]) {
+        placed[i] = true;
+        squares[slot] = pieces.squares[i];
+        break;
+      }
+    }
+  }
+
+  // Pawns only move one way, so the board can only be mirrored left to
+  // right with them.
+  const Square white_king = SquareFromIndex(squares[0]);
+  const bool mirror_file = white_king.file >= BOARD_SIZE / 2;
+  const bool mirror_rank = !has_pawns_ && white_king.rank >= BOARD_SIZE / 2;
+  for (int i = 0; i < piece_count_; ++i) {
+    if (mirror_file) {
+      squares[i] = MirrorFile(squares[i]);
+    }
+    if (mirror_rank) {
+      squares[i] = MirrorRank(squares[i]);
+    }
+  }
+  if (!has_pawns_ && !IsBelowDiagonal(squares[0]) &&
+      (!IsOnDiagonal(squares[0]) ||
+       (!IsOnDiagonal(squares[1]) && !IsBelowDiagonal(squares[1])))) {
+    for (int i = 0; i < piece_count_; ++i) {
+      squares[i] = MirrorDiagonal(squares[i]);
+    }
+  }
+  for (int i = 3; i < piece_count_; ++i) {
+    for (int j = i; j > 2 && kinds_[j - 1] == kinds_[j] &&
+                    colors_[j - 1] == colors_[j] &&
+                    squares[j - 1] > squares[j];
+         --j) {
+      std::swap(squares[j - 1], squares[j]);
+    }
+  }
+
+  Bitboard occupancy = 0;
+  for (int i = 0; i < piece_count_; ++i) {
+    const Square square = SquareFromIndex(squares[i]);
+    if (kinds_[i] == Kind::PAWN &&
+        (square.rank == ONE || square.rank == EIGHT)) {
+      return INVALID_INDEX;
+    }
+    occupancy |= SquareBit(square);
+  }
+  const int king_placement =
+      GetKingPlacements(has_pawns_).index[squares[0]][squares[1]];
+  if (PopCount(occupancy) != piece_count_ ||
+      king_placement == NO_KING_PLACEMENT) {
+    return INVALID_INDEX;
+  }
+  uint32_t index = king_placement;
+  for (int i = 2; i < piece_count_; ++i) {
+    index = index * SQUARE_COUNT + squares[i];
+  }
+  return index;
+}
+
+TablebasePieces TablebaseMaterial::Pieces(uint32_t index) const {
+  TablebasePieces pieces;
+  pieces.count = piece_count_;
+  for (int i = piece_count_ - 1; i >= 0; --i) {
+    pieces.kinds[i] = kinds_[i];
+    pieces.colors[i] = colors_[i];
+    if (i >= 2) {
+      pieces.squares[i] = index % SQUARE_COUNT;
+      index /= SQUARE_COUNT;
+    }
+  }
+  pieces.squares[0] = GetKingPlacements(has_pawns_).white_king[index];
+  pieces.squares[1] = GetKingPlacements(has_pawns_).black_king[index];
+  return pieces;
+}
+
+std::optional<TablebasePieces> TablebasePiecesOf(const Position& position) {
+  Bitboard occupancy = position.Occupancy();
+  if (PopCount(occupancy) > MAX_TABLEBASE_PIECES ||
+      CastlingPossible(position, Color::WHITE) ||
+      CastlingPossible(position, Color::BLACK)) {
+    return std::nullopt;
+  }
+  TablebasePieces pieces;
+  while (occupancy != 0) {
+    const int square = PopLowestSquareIndex(&occupancy);
+    const Piece piece = position.GetPiece(SquareFromIndex(square));
+    pieces.kinds[pieces.count] = piece.Kind();
+    pieces.colors[pieces.count] = piece.Color();
+    pieces.squares[pieces.count] = square;
+    ++pieces.count;
+  }
+  return pieces;
+}
+
+std::optional<TablebaseEntry> FindTablebaseEntry(const TablebasePieces& pieces,
+                                                 Color side_to_move) {
+  bool colors_swapped;
+  const std::optional<TablebaseMaterial> material =
+      TablebaseMaterial::Of(pieces, &colors_swapped);
+  if (!material.has_value()) {
+    return std::nullopt;
+  }
+  if (!colors_swapped) {
+    return TablebaseEntry{*material, material->Index(pieces), side_to_move};
+  }
+  TablebasePieces mirrored = pieces;
+  for (int i = 0; i < mirrored.count; ++i) {
+    mirrored.colors[i] = OppositeColor(mirrored.colors[i]);
+    mirrored.squares[i] = MirrorRank(mirrored.squares[i]);
+  }
+  return TablebaseEntry{*material, material->Index(mirrored),
+                        OppositeColor(side_to_move)};
+}
+
+Tablebase::Tablebase(const TablebaseMaterial& material,
+                     std::vector<uint8_t> white_to_move,
+                     std::vector<uint8_t> black_to_move)
+    : material_(material) {
+  values_[static_cast<int>(Color::WHITE)] = std::move(white_to_move);
+  values_[static_cast<int>(Color::BLACK)] = std::move(black_to_move);
+}
+
+void TablebaseSet::Add(Tablebase table) {
+  const uint32_t key = table.Material().Key();
+  tables_.insert_or_assign(key, std::move(table));
+}
+
+bool TablebaseSet::Contains(const TablebaseMaterial& material) const {
+  return tables_.count(material.Key()) != 0;
+}
+
+std::optional<uint8_t> TablebaseSet::ProbeValue(const TablebasePieces& pieces,
+                                                Color side_to_move) const {
+  if (pieces.count == 2) {
+    return TABLEBASE_DRAW;
+  }
+  const std::optional<TablebaseEntry> entry =
+      FindTablebaseEntry(pieces, side_to_move);
+  if (!entry.has_value()) {
+    return std::nullopt;
+  }
+  const auto table = tables_.find(entry->material.Key());
+  if (table == tables_.end()) {
+    return std::nullopt;
+  }
+  return entry->index == TablebaseMaterial::INVALID_INDEX
+             ? TABLEBASE_INVALID
+             : table->second.Value(entry->index, entry->side_to_move);
+}
+
+std::optional<TablebaseResult> TablebaseSet::Probe(const Position& position,
+                                                   Color side_to_move) const {
+  const std::optional<TablebasePieces> pieces = TablebasePiecesOf(position);
+  if (!pieces.has_value()) {
+    return std::nullopt;
+  }
+  const std::optional<uint8_t> value = ProbeValue(*pieces, side_to_move);
+  if (!value.has_value() || *value == TABLEBASE_INVALID) {
+    return std::nullopt;
+  }
+  return DecodeTablebaseValue(*value);
+}
@@ -0,0 +1,171 @@
+#ifndef ENGINE_TABLEBASE_H_
+#define ENGINE_TABLEBASE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+#include "engine/base.h"
+#include "engine/position.h"
+
+// Endgame tablebases: the exact outcome of every position of an ending with
+// few pieces, with the number of plies to checkmate under best play. Castling,
+// en passant and the fifty-move rule are ignored.
+
+// Kings included.
+static constexpr int MAX_TABLEBASE_PIECES = 5;
+
+// Values of positions in a table, one byte each. Other values are one more
+// than the number of plies to checkmate: even values are won by the side to
+// move, and odd ones are lost, 1 being checkmated already.
+static constexpr uint8_t TABLEBASE_DRAW = 0;
+// Positions where the side not to move is in check, and unused indices.
+static constexpr uint8_t TABLEBASE_INVALID = 255;
+static constexpr int TABLEBASE_MAX_PLIES_TO_MATE = 253;
+
+enum class TablebaseOutcome { LOSS, DRAW, WIN };
+
+struct TablebaseResult {
+  // For the side to move.
+  TablebaseOutcome outcome = TablebaseOutcome::DRAW;
+  // Zero for a draw.
+  int plies_to_mate = 0;
+};
+
+// Undefined for TABLEBASE_INVALID.
+TablebaseResult DecodeTablebaseValue(uint8_t value);
+
+// Pieces of a position, as plain arrays which are cheap to copy and change.
+struct TablebasePieces {
+  int count = 0;
+  Kind kinds[MAX_TABLEBASE_PIECES];
+  Color colors[MAX_TABLEBASE_PIECES];
+  // Square indices, see SquareIndex().
+  int squares[MAX_TABLEBASE_PIECES];
+};
+
+// Pieces of an ending, e.g. "KRKN" for king and rook against king and knight.
+// The stronger side is white in the table, so a position with the colors
+// reversed is probed with the board mirrored.
+//
+// Positions are indexed by the squares of the pieces in index order: the white
+// king, the black king, the other white pieces and the other black ones, from
+// the queens to the pawns. Positions which are mirror images of each other
+// share an index. The board is mirrored so that the white king stands in the
+// a1-d1-d4 triangle, and the black king on or below the a1-h8 diagonal when
+// the white king stands on it, which leaves 462 placements of the kings. With
+// pawns, the board is only mirrored left to right, so that the white king
+// stands on the a to d files, which leaves 1806 placements.
+class TablebaseMaterial {
+ public:
+  // Accepts the pieces of either side first, and in any order after their
+  // king. Fails for more than MAX_TABLEBASE_PIECES pieces.
+  static absl::StatusOr<TablebaseMaterial> Parse(const std::string& name);
+
+  // Material of the pieces, with `colors_swapped` set if black is the stronger
+  // side. Nothing if the pieces can't be in a table.
+  static std::optional<TablebaseMaterial> Of(const TablebasePieces& pieces,
+                                             bool* colors_swapped);
+
+  // Stronger side first, its pieces ordered as in the index.
+  std::string Name() const;
+  // Materials after each possible capture of a piece other than a king, with
+  // more than two kings left, and after each possible promotion of a pawn,
+  // capturing or not.
+  std::vector<TablebaseMaterial> Conversions() const;
+
+  // Pieces in index order.
+  int PieceCount() const { return piece_count_; }
+  Kind PieceKind(int i) const { return kinds_[i]; }
+  Color PieceColor(int i) const { return colors_[i]; }
+
+  // Number of indices for each side to move. Some of them are unused, e.g.
+  // when two pieces stand on the same square.
+  uint32_t IndexCount() const;
+
+  // Index of pieces of this material, in any order and with white being the
+  // stronger side. Returns INVALID_INDEX if the kings are adjacent, two
+  // pieces stand on the same square or a pawn stands on the first or last
+  // rank.
+  uint32_t Index(const TablebasePieces& pieces) const;
+  static constexpr uint32_t INVALID_INDEX = 0xffffffff;
+
+  // Pieces at an index, in index order. They may overlap, or be a mirror
+  // image of the pieces at another index.
+  TablebasePieces Pieces(uint32_t index) const;
+
+  // Identifies the material, e.g. as a map key.
+  uint32_t Key() const { return key_; }
+
+ private:
+  TablebaseMaterial() = default;
+
+  int piece_count_ = 0;
+  Kind kinds_[MAX_TABLEBASE_PIECES];
+  Color colors_[MAX_TABLEBASE_PIECES];
+  uint32_t key_ = 0;
+  bool has_pawns_ = false;
+};
+
+// Pieces of a position, in no particular order. Nothing if there are too many
+// of them, or castling is still possible.
+std::optional<TablebasePieces> TablebasePiecesOf(const Position& position);
+
+// Where the value of a position is stored: its material, its index, which is
+// INVALID_INDEX if the position is impossible, and the side to move in the
+// table, which is the other side if the colors are swapped.
+struct TablebaseEntry {
+  TablebaseMaterial material;
+  uint32_t index;
+  Color side_to_move;
+};
+
+// Nothing if the pieces can't be in a table, e.g. kings alone.
+std::optional<TablebaseEntry> FindTablebaseEntry(const TablebasePieces& pieces,
+                                                 Color side_to_move);
+
+// The values of all the positions of an ending, indexed by side to move and
+// TablebaseMaterial::Index().
+class Tablebase {
+ public:
+  Tablebase(const TablebaseMaterial& material,
+            std::vector<uint8_t> white_to_move,
+            std::vector<uint8_t> black_to_move);
+
+  const TablebaseMaterial& Material() const { return material_; }
+
+  uint8_t Value(uint32_t index, Color side_to_move) const {
+    return values_[static_cast<int>(side_to_move)][index];
+  }
+
+ private:
+  TablebaseMaterial material_;
+  // Indexed by Color.
+  std::vector<uint8_t> values_[2];
+};
+
+// Tables of several endings, probed by position.
+class TablebaseSet {
+ public:
+  void Add(Tablebase table);
+  bool Contains(const TablebaseMaterial& material) const;
+
+  // Nothing if the position isn't covered by the tables, e.g. if castling is
+  // still possible.
+  std::optional<TablebaseResult> Probe(const Position& position,
+                                       Color side_to_move) const;
+
+  // Value of a position, e.g. after a capture, without any allocation. Kings
+  // alone are a draw. Nothing if the material isn't in the set.
+  std::optional<uint8_t> ProbeValue(const TablebasePieces& pieces,
+                                    Color side_to_move) const;
+
+ private:
+  std::unordered_map<uint32_t, Tablebase> tables_;
+};
+
+#endif // ENGINE_TABLEBASE_H_
@@ -0,0 +1,236 @@
+#include "engine/tablebase_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+namespace {
+
+static constexpr char FILE_MAGIC[4] = {'C', 'T', 'B', '2'};
+static constexpr char FILE_EXTENSION[] = ".tb";
+
+// Each run of values starts with a byte telling its kind and length: either
+// up to MAX_LITERAL values copied as they are, or one value repeated from
+// MIN_REPEAT to MAX_REPEAT times.
+static constexpr int MAX_LITERAL = 128;
+static constexpr int MIN_REPEAT = 3;
+static constexpr int MAX_REPEAT = MIN_REPEAT + 127;
+
+uint32_t BlockCountOf(const TablebaseMaterial& material) {
+  const uint64_t value_count = 2 * uint64_t{material.IndexCount()};
+  return (value_count + TABLEBASE_BLOCK_SIZE - 1) / TABLEBASE_BLOCK_SIZE;
+}
+
+void Compress(const uint8_t* values, size_t count, std::string* output) {
+  const auto repeats = [&](size_t i) {
+    return i + MIN_REPEAT <= count &&
+           std::all_of(values + i + 1, values + i + MIN_REPEAT,
+                       [&](uint8_t value) { return value == values[i]; });
+  };
+  size_t i = 0;
+  while (i < count) {
+    if (repeats(i)) {
+      size_t end = i + MIN_REPEAT;
+      while (end < count && end - i < MAX_REPEAT && values[end] == values[i]) {
+        ++end;
+      }
+      output->push_back(static_cast<char>(MAX_LITERAL + end - i - MIN_REPEAT));
+      output->push_back(static_cast<char>(values[i]));
+      i = end;
+      continue;
+    }
+    size_t end = i + 1;
+    while (end < count && end - i < MAX_LITERAL && !repeats(end)) {
+      ++end;
+    }
+    output->push_back(static_cast<char>(end - i - 1));
+    output->append(reinterpret_cast<const char*>(values + i), end - i);
+    i = end;
+  }
+}
+
+// Whether `size` compressed bytes decompress to exactly `count` values.
+bool Decompress(const uint8_t* data, size_t size, uint8_t* values,
+                size_t count) {
+  size_t read = 0;
+  size_t written = 0;
+  while (read < size) {
+    const int header = data[read++];
+    if (header < MAX_LITERAL) {
+      const size_t length = header + 1;
+      if (read + length > size || written + length > count) {
+        return false;
+      }
+      std::memcpy(values + written, data + read, length);
+      read += length;
+      written += length;
+    } else {
+      const size_t length = header - MAX_LITERAL + MIN_REPEAT;
+      if (read + 1 > size || written + length > count) {
+        return false;
+      }
+      std::memset(values + written, data[read], length);
+      ++read;
+      written += length;
+    }
+  }
+  return written == count;
+}
+
+} // namespace
+
+std::string TablebaseFileName(const TablebaseMaterial& material) {
+  return material.Name() + FILE_EXTENSION;
+}
+
+absl::Status WriteTablebase(const Tablebase& table, const std::string& path) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return absl::PermissionDeniedError(
+        absl::StrFormat("Couldn't open \"%s\" for writing", path));
+  }
+  const TablebaseMaterial& material = table.Material();
+  const uint32_t index_count = material.IndexCount();
+  std::vector<uint8_t> values;
+  values.reserve(2 * uint64_t{index_count});
+  for (const Color color : {Color::BLACK, Color::WHITE}) {
+    for (uint32_t index = 0; index < index_count; ++index) {
+      values.push_back(table.Value(index, color));
+    }
+  }
+  const uint32_t block_count = BlockCountOf(material);
+  std::vector<uint32_t> offsets = {0};
+  std::string blocks;
+  for (uint32_t block = 0; block < block_count; ++block) {
+    const size_t begin = size_t{block} * TABLEBASE_BLOCK_SIZE;
+    Compress(values.data() + begin,
+             std::min<size_t>(TABLEBASE_BLOCK_SIZE, values.size() - begin),
+             &blocks);
+    offsets.push_back(blocks.size());
+  }
+
+  const std::string name = material.Name();
+  const uint8_t name_size = name.size();
+  file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+  file.write(reinterpret_cast<const char*>(&name_size), sizeof(name_size));
+  file.write(name.data(), name.size());
+  file.write(reinterpret_cast<const char*>(&block_count), sizeof(block_count));
+  file.write(reinterpret_cast<const char*>(offsets.data()),
+             offsets.size() * sizeof(uint32_t));
+  file.write(blocks.data(), blocks.size());
+  if (!file) {
+    return absl::DataLossError(
+        absl::StrFormat("Couldn't write \"%s\"", path));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Tablebase> ReadTablebase(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return absl::NotFoundError(absl::StrFormat("Couldn't open \"%s\"", path));
+  }
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  absl::StatusOr<TablebaseFile> table_file = TablebaseFile::Parse(
+      reinterpret_cast<const uint8_t*>(contents.data()), contents.size());
+  if (!table_file.ok()) {
+    return absl::DataLossError(absl::StrFormat(
+        "\"%s\": %s", path, table_file.status().message()));
+  }
+
+  const uint32_t index_count = table_file->Material().IndexCount();
+  std::vector<uint8_t> values(2 * uint64_t{index_count});
+  for (uint32_t block = 0; block < table_file->BlockCount(); ++block) {
+    const absl::Status status = table_file->DecompressBlock(
+        block, values.data() + size_t{block} * TABLEBASE_BLOCK_SIZE);
+    if (!status.ok()) {
+      return absl::DataLossError(
+          absl::StrFormat("\"%s\": %s", path, status.message()));
+    }
+  }
+  std::vector<uint8_t> white_to_move(values.begin() + index_count,
+                                     values.end());
+  values.resize(index_count);
+  return Tablebase(table_file->Material(), std::move(white_to_move),
+                   std::move(values));
+}
+
+absl::StatusOr<TablebaseFile> TablebaseFile::Parse(const uint8_t* data,
+                                                   size_t size) {
+  size_t offset = sizeof(FILE_MAGIC) + 1;
+  if (size < offset ||
+      std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+    return absl::DataLossError("Not a tablebase");
+  }
+  const uint8_t name_size = data[sizeof(FILE_MAGIC)];
+  if (size < offset + name_size + sizeof(uint32_t)) {
+    return absl::DataLossError("Truncated header");
+  }
+  const std::string name(reinterpret_cast<const char*>(data + offset),
+                         name_size);
+  offset += name_size;
+  absl::StatusOr<TablebaseMaterial> material = TablebaseMaterial::Parse(name);
+  if (!material.ok()) {
+    return material.status();
+  }
+
+  uint32_t block_count;
+  std::memcpy(&block_count, data + offset, sizeof(block_count));
+  offset += sizeof(block_count);
+  if (block_count != BlockCountOf(*material)) {
+    return absl::DataLossError(
+        absl::StrFormat("Expected %d blocks for %s, got %d",
+                        BlockCountOf(*material), name, block_count));
+  }
+  const size_t offsets_size = (size_t{block_count} + 1) * sizeof(uint32_t);
+  if (size < offset + offsets_size) {
+    return absl::DataLossError("Truncated block offsets");
+  }
+  const TablebaseFile file(*material, block_count, data + offset,
+                           data + offset + offsets_size);
+  for (uint32_t block = 0; block < block_count; ++block) {
+    if (file.Offset(block) > file.Offset(block + 1)) {
+      return absl::DataLossError(
+          absl::StrFormat("Block %d ends before it starts", block));
+    }
+  }
+  if (file.Offset(block_count) != size - offset - offsets_size) {
+    return absl::DataLossError("Truncated blocks");
+  }
+  return file;
+}
+
+uint32_t TablebaseFile::BlockValueCount(uint32_t block) const {
+  const uint64_t value_count = 2 * uint64_t{material_.IndexCount()};
+  const uint64_t begin = uint64_t{block} * TABLEBASE_BLOCK_SIZE;
+  return std::min<uint64_t>(TABLEBASE_BLOCK_SIZE, value_count - begin);
+}
+
+const uint8_t* TablebaseFile::BlockData(uint32_t block) const {
+  return blocks_ + Offset(block);
+}
+
+size_t TablebaseFile::BlockSize(uint32_t block) const {
+  return Offset(block + 1) - Offset(block);
+}
+
+absl::Status TablebaseFile::DecompressBlock(uint32_t block,
+                                            uint8_t* values) const {
+  if (!Decompress(BlockData(block), BlockSize(block), values,
+                  BlockValueCount(block))) {
+    return absl::DataLossError(absl::StrFormat("Corrupt block %d", block));
+  }
+  return absl::OkStatus();
+}
+
+uint32_t TablebaseFile::Offset(uint32_t i) const {
+  uint32_t offset;
+  std::memcpy(&offset, offsets_ + i * sizeof(uint32_t), sizeof(offset));
+  return offset;
+}
@@ -0,0 +1,65 @@
+#ifndef ENGINE_TABLEBASE_FILE_H_
+#define ENGINE_TABLEBASE_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+#include "engine/tablebase.h"
+
+// Table files hold the values of the positions with black to move, then white
+// to move, in blocks of TABLEBASE_BLOCK_SIZE values compressed separately, so
+// that a probe only decompresses one block. Runs of the same value, which are
+// frequent with the draws and the unused indices, are compressed to two bytes.
+static constexpr uint32_t TABLEBASE_BLOCK_SIZE = 8192;
+
+// Named after the material, e.g. "KRKN.tb".
+std::string TablebaseFileName(const TablebaseMaterial& material);
+absl::Status WriteTablebase(const Tablebase& table, const std::string& path);
+// Decompresses the whole table.
+absl::StatusOr<Tablebase> ReadTablebase(const std::string& path);
+
+// A table file in memory, e.g. mapped, which must outlive it.
+class TablebaseFile {
+ public:
+  static absl::StatusOr<TablebaseFile> Parse(const uint8_t* data, size_t size);
+
+  const TablebaseMaterial& Material() const { return material_; }
+
+  // Position of a value in the file, counting the values of both sides to
+  // move, which tells its block and its offset in the block.
+  uint64_t ValueId(uint32_t index, Color side_to_move) const {
+    return static_cast<int>(side_to_move) * uint64_t{material_.IndexCount()} +
+           index;
+  }
+
+  uint32_t BlockCount() const { return block_count_; }
+  // TABLEBASE_BLOCK_SIZE, except for the last block.
+  uint32_t BlockValueCount(uint32_t block) const;
+
+  // Compressed bytes of a block.
+  const uint8_t* BlockData(uint32_t block) const;
+  size_t BlockSize(uint32_t block) const;
+
+  // Decompresses a block into BlockValueCount() values.
+  absl::Status DecompressBlock(uint32_t block, uint8_t* values) const;
+
+ private:
+  TablebaseFile(const TablebaseMaterial& material, uint32_t block_count,
+                const uint8_t* offsets, const uint8_t* blocks)
+      : material_(material), block_count_(block_count), offsets_(offsets),
+        blocks_(blocks) {}
+
+  uint32_t Offset(uint32_t i) const;
+
+  TablebaseMaterial material_;
+  uint32_t block_count_;
+  // BlockCount() + 1 unaligned offsets of the blocks from `blocks_`.
+  const uint8_t* offsets_;
+  const uint8_t* blocks_;
+};
+
+#endif // ENGINE_TABLEBASE_FILE_H_
@@ -0,0 +1,80 @@
+#include "engine/tablebase_file.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+TEST(TablebaseFile, WritesAndReadsBack) {
+  const TablebaseMaterial material = *TablebaseMaterial::Parse("KNK");
+  std::vector<uint8_t> white_to_move(material.IndexCount(), TABLEBASE_DRAW);
+  std::vector<uint8_t> black_to_move(material.IndexCount(), TABLEBASE_DRAW);
+  white_to_move[7] = 4;
+  black_to_move[9] = TABLEBASE_INVALID;
+  // Runs too short to repeat, and longer than a literal.
+  for (uint32_t index = 1000; index < 1300; ++index) {
+    white_to_move[index] = index % 7;
+  }
+  const std::string path = testing::TempDir() + TablebaseFileName(material);
+
+  ASSERT_TRUE(
+      WriteTablebase(Tablebase(material, white_to_move, black_to_move), path)
+          .ok());
+  absl::StatusOr<Tablebase> table = ReadTablebase(path);
+  std::remove(path.c_str());
+
+  ASSERT_TRUE(table.ok()) << table.status();
+  EXPECT_EQ(table->Material().Name(), "KNK");
+  for (uint32_t index = 0; index < material.IndexCount(); ++index) {
+    ASSERT_EQ(table->Value(index, Color::WHITE), white_to_move[index]);
+    ASSERT_EQ(table->Value(index, Color::BLACK), black_to_move[index]);
+  }
+  EXPECT_FALSE(ReadTablebase(path).ok());
+}
+
+TEST(TablebaseFile, LocatesValuesInBlocks) {
+  const TablebaseMaterial material = *TablebaseMaterial::Parse("KRK");
+  std::vector<uint8_t> white_to_move(material.IndexCount(), TABLEBASE_DRAW);
+  std::vector<uint8_t> black_to_move(material.IndexCount(), TABLEBASE_DRAW);
+  black_to_move[material.IndexCount() - 1] = 3;
+  white_to_move[0] = 2;
+  const std::string path = testing::TempDir() + TablebaseFileName(material);
+  ASSERT_TRUE(
+      WriteTablebase(Tablebase(material, white_to_move, black_to_move), path)
+          .ok());
+  std::ifstream stream(path, std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(stream)),
+                             std::istreambuf_iterator<char>());
+  std::remove(path.c_str());
+
+  absl::StatusOr<TablebaseFile> file = TablebaseFile::Parse(
+      reinterpret_cast<const uint8_t*>(contents.data()), contents.size());
+
+  ASSERT_TRUE(file.ok()) << file.status();
+  // 2 * 462 * 64 values.
+  ASSERT_EQ(file->BlockCount(), 8);
+  EXPECT_EQ(file->BlockValueCount(7), 2 * 462 * 64 - 7 * TABLEBASE_BLOCK_SIZE);
+  // Far smaller than the values, which are mostly draws.
+  EXPECT_LT(contents.size(), 2 * 462 * 64 / 16);
+  const uint64_t last = file->ValueId(material.IndexCount() - 1, Color::BLACK);
+  const uint64_t first = file->ValueId(0, Color::WHITE);
+  EXPECT_EQ(first, last + 1);
+  std::vector<uint8_t> values(TABLEBASE_BLOCK_SIZE);
+  ASSERT_TRUE(
+      file->DecompressBlock(first / TABLEBASE_BLOCK_SIZE, values.data()).ok());
+  EXPECT_EQ(values[last % TABLEBASE_BLOCK_SIZE], 3);
+  EXPECT_EQ(values[first % TABLEBASE_BLOCK_SIZE], 2);
+
+  EXPECT_FALSE(TablebaseFile::Parse(
+                   reinterpret_cast<const uint8_t*>(contents.data()),
+                   contents.size() - 1)
+                   .ok());
+  std::string corrupt = contents;
+  corrupt[0] = 'X';
+  EXPECT_FALSE(
+      TablebaseFile::Parse(reinterpret_cast<const uint8_t*>(corrupt.data()),
+                           corrupt.size())
+          .ok());
+}
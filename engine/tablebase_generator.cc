@@ -0,0 +1,398 @@
+#include "engine/tablebase_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+#include "engine/attacks.h"
+#include "engine/bitboard.h"
+
+namespace {
+
+// A position found by a pass, and its value.
+struct Found {
+  uint32_t id;
+  uint8_t value;
+};
+
+static constexpr Kind PROMOTION_KINDS[] = {Kind::QUEEN, Kind::ROOK,
+                                           Kind::BISHOP, Kind::KNIGHT};
+
+int PawnDirection(Color color) { return color == Color::WHITE ? 1 : -1; }
+
+Bitboard Attacks(Kind kind, Color color, int square, Bitboard occupancy) {
+  return kind == Kind::PAWN ? PawnAttacks(color, square)
+                            : PieceAttacks(kind, square, occupancy);
+}
+
+// Squares a pawn may move to: one or, from its starting rank, two squares
+// ahead if they are empty, and diagonally ahead onto an enemy piece.
+Bitboard PawnTargets(Color color, int square, Bitboard occupancy,
+                     Bitboard enemies) {
+  const Square from = SquareFromIndex(square);
+  const int direction = PawnDirection(color);
+  Bitboard targets = PawnAttacks(color, square) & enemies;
+  const Bitboard ahead = SquareBit(from.file, from.rank + direction);
+  if (ahead & occupancy) {
+    return targets;
+  }
+  targets |= ahead;
+  if (from.rank == (color == Color::WHITE ? TWO : SEVEN)) {
+    targets |= SquareBit(from.file, from.rank + 2 * direction) & ~occupancy;
+  }
+  return targets;
+}
+
+// Holds the values of both sides to move in a single vector, the positions
+// with white to move coming after those with black to move. Only the passes
+// write to the vector, between the parallel sections which read it.
+class Generator {
+ public:
+  Generator(const TablebaseMaterial& material,
+            const TablebaseSet& smaller_tables, int threads)
+      : material_(material), smaller_tables_(smaller_tables),
+        threads_(std::max(threads, 1)), index_count_(material.IndexCount()) {}
+
+  absl::StatusOr<Tablebase> Run();
+
+ private:
+  uint32_t Id(uint32_t index, Color side_to_move) const {
+    return static_cast<int>(side_to_move) * index_count_ + index;
+  }
+
+  Color SideToMove(uint32_t id) const {
+    return id >= index_count_ ? Color::WHITE : Color::BLACK;
+  }
+
+  TablebasePieces PiecesOf(uint32_t id) const {
+    return material_.Pieces(id % index_count_);
+  }
+
+  bool IsInCheck(const TablebasePieces& pieces, Color color) const;
+
+  // Value of a position from the values of its children known so far: the
+  // shortest win, the longest loss once all the children are won by the
+  // opponent, or a draw while neither is known. May exceed the values which
+  // fit in a table. The first pass only knows the values after captures and
+  // promotions, which lead to smaller tables, and skips looking up the
+  // others.
+  int Evaluate(const TablebasePieces& pieces, Color side_to_move,
+               bool conversions_only = false) const;
+
+  // Calls `visit(id, pieces)` for each position whose side to move can reach
+  // `pieces` with a move other than a capture or a promotion.
+  template <typename Visit>
+  void ForEachPredecessor(const TablebasePieces& pieces, Color side_to_move,
+                          const Visit& visit) const;
+
+  // Splits `count` items between the threads, and calls
+  // `process(thread, begin, end)` for each share.
+  template <typename Process>
+  void Parallel(size_t count, const Process& process) const;
+
+  const TablebaseMaterial& material_;
+  const TablebaseSet& smaller_tables_;
+  const int threads_;
+  const uint32_t index_count_;
+  std::vector<uint8_t> values_;
+};
+
+bool Generator::IsInCheck(const TablebasePieces& pieces, Color color) const {
+  Bitboard occupancy = 0;
+  Bitboard king = 0;
+  for (int i = 0; i < pieces.count; ++i) {
+    const Bitboard square = Bitboard{1} << pieces.squares[i];
+    occupancy |= square;
+    if (pieces.kinds[i] == Kind::KING && pieces.colors[i] == color) {
+      king = square;
+    }
+  }
+  for (int i = 0; i < pieces.count; ++i) {
+    if (pieces.colors[i] != color &&
+        (Attacks(pieces.kinds[i], pieces.colors[i], pieces.squares[i],
+                 occupancy) &
+         king)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int Generator::Evaluate(const TablebasePieces& pieces, Color side_to_move,
+                        bool conversions_only) const {
+  Bitboard occupancy = 0;
+  Bitboard own = 0;
+  for (int i = 0; i < pieces.count; ++i) {
+    occupancy |= Bitboard{1} << pieces.squares[i];
+    if (pieces.colors[i] == side_to_move) {
+      own |= Bitboard{1} << pieces.squares[i];
+    }
+  }
+
+  bool has_moves = false;
+  bool all_lost = true;
+  int shortest_win = 0;
+  int longest_loss = 0;
+  const Color opponent = OppositeColor(side_to_move);
+  const int last_rank = side_to_move == Color::WHITE ? EIGHT : ONE;
+  for (int i = 0; i < pieces.count; ++i) {
+    if (pieces.colors[i] != side_to_move) {
+      continue;
+    }
+    const bool pawn = pieces.kinds[i] == Kind::PAWN;
+    Bitboard targets =
+        pawn ? PawnTargets(side_to_move, pieces.squares[i], occupancy,
+                           occupancy & ~own)
+             : PieceAttacks(pieces.kinds[i], pieces.squares[i], occupancy) &
+                   ~own;
+    while (targets != 0) {
+      const int target = PopLowestSquareIndex(&targets);
+      const bool promotes =
+          pawn && SquareFromIndex(target).rank == last_rank;
+      for (const Kind promotion : PROMOTION_KINDS) {
+        TablebasePieces child = pieces;
+        child.squares[i] = target;
+        if (promotes) {
+          child.kinds[i] = promotion;
+        }
+        int captured = -1;
+        for (int j = 0; j < pieces.count; ++j) {
+          if (j != i && pieces.squares[j] == target) {
+            captured = j;
+          }
+        }
+        if (captured >= 0) {
+          --child.count;
+          child.kinds[captured] = child.kinds[child.count];
+          child.colors[captured] = child.colors[child.count];
+          child.squares[captured] = child.squares[child.count];
+        }
+        if (IsInCheck(child, side_to_move)) {
+          // Promoting to another piece doesn't help.
+          break;
+        }
+        has_moves = true;
+        const bool converts = captured >= 0 || promotes;
+        if (!converts && conversions_only) {
+          all_lost = false;
+          break;
+        }
+
+        const int value =
+            converts ? *smaller_tables_.ProbeValue(child, opponent)
+                     : values_[Id(material_.Index(child), opponent)];
+        if (value == TABLEBASE_DRAW) {
+          all_lost = false;
+        } else if (value % 2 == 1) {
+          shortest_win = shortest_win == 0 ? value + 1
+                                           : std::min(shortest_win, value + 1);
+        } else {
+          longest_loss = std::max(longest_loss, value + 1);
+        }
+        if (!promotes) {
+          break;
+        }
+      }
+    }
+  }
+
+  if (!has_moves) {
+    return IsInCheck(pieces, side_to_move) ? 1 : TABLEBASE_DRAW;
+  }
+  if (shortest_win != 0) {
+    return shortest_win;
+  }
+  return all_lost ? longest_loss : TABLEBASE_DRAW;
+}
+
+template <typename Visit>
+void Generator::ForEachPredecessor(const TablebasePieces& pieces,
+                                   Color side_to_move,
+                                   const Visit& visit) const {
+  Bitboard occupancy = 0;
+  for (int i = 0; i < pieces.count; ++i) {
+    occupancy |= Bitboard{1} << pieces.squares[i];
+  }
+  const Color mover = OppositeColor(side_to_move);
+  for (int i = 0; i < pieces.count; ++i) {
+    if (pieces.colors[i] != mover) {
+      continue;
+    }
+    // Moves other than captures and promotions are reversible, so a piece
+    // came from a square it could move to now, and a pawn from the square
+    // behind it, or the one behind that on its starting rank.
+    Bitboard origins = 0;
+    if (pieces.kinds[i] == Kind::PAWN) {
+      const Square square = SquareFromIndex(pieces.squares[i]);
+      const int direction = PawnDirection(mover);
+      const int start_rank = mover == Color::WHITE ? TWO : SEVEN;
+      const int behind = square.rank - direction;
+      if ((behind - start_rank) * direction >= 0 &&
+          !(occupancy & SquareBit(square.file, behind))) {
+        origins |= SquareBit(square.file, behind);
+        if (behind - direction == start_rank) {
+          origins |= SquareBit(square.file, start_rank) & ~occupancy;
+        }
+      }
+    } else {
+      origins = PieceAttacks(pieces.kinds[i], pieces.squares[i], occupancy) &
+                ~occupancy;
+    }
+    while (origins != 0) {
+      TablebasePieces predecessor = pieces;
+      predecessor.squares[i] = PopLowestSquareIndex(&origins);
+      const uint32_t index = material_.Index(predecessor);
+      if (index != TablebaseMaterial::INVALID_INDEX) {
+        visit(Id(index, mover), predecessor);
+      }
+    }
+  }
+}
+
+template <typename Process>
+void Generator::Parallel(size_t count, const Process& process) const {
+  const size_t share = (count + threads_ - 1) / threads_;
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < threads_; ++thread) {
+    const size_t begin = std::min(count, thread * share);
+    const size_t end = std::min(count, begin + share);
+    threads.emplace_back(
+        [&process, thread, begin, end]() { process(thread, begin, end); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+absl::StatusOr<Tablebase> Generator::Run() {
+  for (const TablebaseMaterial& conversion : material_.Conversions()) {
+    if (!smaller_tables_.Contains(conversion)) {
+      return absl::FailedPreconditionError(
+          absl::StrFormat("Generating %s needs the table of %s first",
+                          material_.Name(), conversion.Name()));
+    }
+  }
+
+  const uint32_t id_count = 2 * index_count_;
+  values_.assign(id_count, TABLEBASE_DRAW);
+  Parallel(id_count, [&](int, size_t begin, size_t end) {
+    for (uint32_t id = begin; id < end; ++id) {
+      const TablebasePieces pieces = PiecesOf(id);
+      if (material_.Index(pieces) != id % index_count_ ||
+          IsInCheck(pieces, OppositeColor(SideToMove(id)))) {
+        values_[id] = TABLEBASE_INVALID;
+      }
+    }
+  });
+
+  // Positions to evaluate again once the pass reaches a number of plies,
+  // as their value depends on captures and promotions, which may be further
+  // from mate than the other moves.
+  std::vector<std::vector<uint32_t>> pending(TABLEBASE_MAX_PLIES_TO_MATE + 1);
+  int last_pending_plies = 0;
+  std::atomic<bool> too_long(false);
+  std::vector<std::vector<Found>> found(threads_);
+  std::vector<std::vector<Found>> later(threads_);
+  const auto handle = [&](int thread, uint32_t id, int value, int plies) {
+    if (value == TABLEBASE_DRAW) {
+      return;
+    }
+    if (value - 1 > TABLEBASE_MAX_PLIES_TO_MATE) {
+      too_long = true;
+    } else if (value - 1 > plies) {
+      later[thread].push_back({id, static_cast<uint8_t>(value)});
+    } else {
+      found[thread].push_back({id, static_cast<uint8_t>(value)});
+    }
+  };
+  // Applies the values found by a pass, and returns the positions which
+  // didn't have one yet.
+  const auto apply = [&]() {
+    std::vector<uint32_t> resolved;
+    for (int thread = 0; thread < threads_; ++thread) {
+      for (const Found& position : found[thread]) {
+        if (values_[position.id] == TABLEBASE_DRAW) {
+          values_[position.id] = position.value;
+          resolved.push_back(position.id);
+        }
+      }
+      found[thread].clear();
+      for (const Found& position : later[thread]) {
+        pending[position.value - 1].push_back(position.id);
+        last_pending_plies = std::max(last_pending_plies, position.value - 1);
+      }
+      later[thread].clear();
+    }
+    return resolved;
+  };
+
+  // Checkmates, and positions decided by captures and promotions alone.
+  Parallel(id_count, [&](int thread, size_t begin, size_t end) {
+    for (uint32_t id = begin; id < end; ++id) {
+      if (values_[id] != TABLEBASE_INVALID) {
+        handle(thread, id,
+               Evaluate(PiecesOf(id), SideToMove(id),
+                        /*conversions_only=*/true),
+               /*plies=*/0);
+      }
+    }
+  });
+  std::vector<uint32_t> resolved = apply();
+
+  for (int plies = 1; !resolved.empty() || plies <= last_pending_plies;
+       ++plies) {
+    if (too_long || plies > TABLEBASE_MAX_PLIES_TO_MATE) {
+      return absl::OutOfRangeError(
+          absl::StrFormat("%s has mates longer than %d plies",
+                          material_.Name(), TABLEBASE_MAX_PLIES_TO_MATE));
+    }
+    const std::vector<uint32_t>& recheck = pending[plies];
+    Parallel(resolved.size() + recheck.size(), [&](int thread, size_t begin,
+                                                   size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (i >= resolved.size()) {
+          const uint32_t id = recheck[i - resolved.size()];
+          if (values_[id] == TABLEBASE_DRAW) {
+            handle(thread, id, Evaluate(PiecesOf(id), SideToMove(id)), plies);
+          }
+          continue;
+        }
+        // A lost position makes all its predecessors won, while a won one
+        // makes them lost only if all their other moves are won too.
+        const uint32_t id = resolved[i];
+        const bool lost = values_[id] % 2 == 1;
+        ForEachPredecessor(
+            PiecesOf(id), SideToMove(id),
+            [&](uint32_t predecessor, const TablebasePieces& pieces) {
+              if (values_[predecessor] != TABLEBASE_DRAW) {
+                return;
+              }
+              handle(thread, predecessor,
+                     lost ? plies + 1
+                          : Evaluate(pieces, SideToMove(predecessor)),
+                     plies);
+            });
+      }
+    });
+    std::vector<uint32_t>().swap(pending[plies]);
+    resolved = apply();
+  }
+
+  std::vector<uint8_t> white_to_move(values_.begin() + index_count_,
+                                     values_.end());
+  values_.resize(index_count_);
+  values_.shrink_to_fit();
+  return Tablebase(material_, std::move(white_to_move), std::move(values_));
+}
+
+} // namespace
+
+absl::StatusOr<Tablebase> GenerateTablebase(const TablebaseMaterial& material,
+                                            const TablebaseSet& smaller_tables,
+                                            int threads) {
+  return Generator(material, smaller_tables, threads).Run();
+}
@@ -0,0 +1,18 @@
+#ifndef ENGINE_TABLEBASE_GENERATOR_H_
+#define ENGINE_TABLEBASE_GENERATOR_H_
+
+#include "absl/status/statusor.h"
+
+#include "engine/tablebase.h"
+
+// Builds the table of an ending by retrograde analysis: starting from the
+// checkmates, each pass finds the positions one ply further from mate by
+// taking back moves from those found by the previous pass. Captures and
+// promotions lead to other endings, which must all be in `smaller_tables`, see
+// TablebaseMaterial::Conversions(). Each pass is split between `threads`
+// threads.
+absl::StatusOr<Tablebase> GenerateTablebase(const TablebaseMaterial& material,
+                                            const TablebaseSet& smaller_tables,
+                                            int threads);
+
+#endif // ENGINE_TABLEBASE_GENERATOR_H_
@@ -0,0 +1,134 @@
+#include "engine/tablebase_generator.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "engine/fen.h"
+
+namespace {
+
+// Longest win for white to move, in plies.
+int LongestWin(const Tablebase& table) {
+  int longest = 0;
+  for (uint32_t index = 0; index < table.Material().IndexCount(); ++index) {
+    const uint8_t value = table.Value(index, Color::WHITE);
+    if (value != TABLEBASE_INVALID &&
+        DecodeTablebaseValue(value).outcome == TablebaseOutcome::WIN) {
+      longest = std::max(longest, DecodeTablebaseValue(value).plies_to_mate);
+    }
+  }
+  return longest;
+}
+
+std::optional<TablebaseResult> Probe(const TablebaseSet& tables,
+                                     const std::string& fen) {
+  const FenPosition position = *ParseFen(fen);
+  return tables.Probe(position.position, position.side_to_move);
+}
+
+} // namespace
+
+TEST(GenerateTablebase, KingAndQueenMateInAtMostTenMoves) {
+  TablebaseSet tables;
+  absl::StatusOr<Tablebase> table =
+      GenerateTablebase(*TablebaseMaterial::Parse("KQK"), tables, 4);
+  ASSERT_TRUE(table.ok()) << table.status();
+  EXPECT_EQ(LongestWin(*table), 19);
+  tables.Add(*std::move(table));
+
+  std::optional<TablebaseResult> result =
+      Probe(tables, "k7/8/1K6/8/8/8/8/6Q1 w - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::WIN);
+  EXPECT_EQ(result->plies_to_mate, 1);
+
+  result = Probe(tables, "k7/Q7/1K6/8/8/8/8/8 b - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::LOSS);
+  EXPECT_EQ(result->plies_to_mate, 0);
+
+  // Black has the queen, and stalemates white.
+  result = Probe(tables, "8/8/8/8/8/1q6/2k5/K7 w - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::DRAW);
+  result = Probe(tables, "8/8/8/8/4q3/8/2k5/K7 b - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::WIN);
+  EXPECT_EQ(result->plies_to_mate, 1);
+
+  EXPECT_FALSE(Probe(tables, "8/8/8/8/4r3/8/2k5/K7 b - - 0 1").has_value());
+  EXPECT_FALSE(Probe(tables, "8/8/8/8/4q3/8/2k5/K6P b - - 0 1").has_value());
+}
+
+TEST(GenerateTablebase, KingAndRookMateInAtMostSixteenMoves) {
+  TablebaseSet tables;
+  absl::StatusOr<Tablebase> table =
+      GenerateTablebase(*TablebaseMaterial::Parse("KRK"), tables, 2);
+
+  ASSERT_TRUE(table.ok()) << table.status();
+  EXPECT_EQ(LongestWin(*table), 31);
+}
+
+TEST(GenerateTablebase, CapturesUseSmallerTables) {
+  TablebaseSet tables;
+  const TablebaseMaterial material = *TablebaseMaterial::Parse("KRKN");
+  EXPECT_FALSE(GenerateTablebase(material, tables, 1).ok());
+
+  for (const char* smaller : {"KRK", "KNK"}) {
+    absl::StatusOr<Tablebase> table =
+        GenerateTablebase(*TablebaseMaterial::Parse(smaller), tables, 4);
+    ASSERT_TRUE(table.ok()) << table.status();
+    tables.Add(*std::move(table));
+  }
+  absl::StatusOr<Tablebase> table = GenerateTablebase(material, tables, 4);
+  ASSERT_TRUE(table.ok()) << table.status();
+  tables.Add(*std::move(table));
+
+  // The rook takes the knight.
+  std::optional<TablebaseResult> result =
+      Probe(tables, "8/8/8/8/8/2k5/8/n2R2K1 w - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::WIN);
+  // The knight takes the rook.
+  result = Probe(tables, "7k/8/8/8/8/1n6/8/R5K1 b - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::DRAW);
+}
+
+TEST(GenerateTablebase, PawnsPromote) {
+  TablebaseSet tables;
+  const TablebaseMaterial material = *TablebaseMaterial::Parse("KPK");
+  EXPECT_FALSE(GenerateTablebase(material, tables, 1).ok());
+
+  for (const char* promoted : {"KQK", "KRK", "KBK", "KNK"}) {
+    absl::StatusOr<Tablebase> table =
+        GenerateTablebase(*TablebaseMaterial::Parse(promoted), tables, 4);
+    ASSERT_TRUE(table.ok()) << table.status();
+    tables.Add(*std::move(table));
+  }
+  absl::StatusOr<Tablebase> table = GenerateTablebase(material, tables, 4);
+  ASSERT_TRUE(table.ok()) << table.status();
+  tables.Add(*std::move(table));
+
+  // The king in front of its pawn, with the opposition.
+  std::optional<TablebaseResult> result =
+      Probe(tables, "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::WIN);
+  // Stalemates, with either side stronger.
+  result = Probe(tables, "8/8/8/8/8/4k3/4p3/4K3 w - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::DRAW);
+  result = Probe(tables, "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::DRAW);
+  // A rook pawn doesn't win against a king in front of it.
+  result = Probe(tables, "k7/8/K7/P7/8/8/8/8 w - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::DRAW);
+  // Black pawns promote on the first rank.
+  result = Probe(tables, "8/8/8/8/8/8/3kp3/7K b - - 0 1");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->outcome, TablebaseOutcome::WIN);
+}
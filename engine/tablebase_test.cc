@@ -0,0 +1,131 @@
+#include "engine/tablebase.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(TablebaseMaterial, ParsesEitherSideFirst) {
+  absl::StatusOr<TablebaseMaterial> material = TablebaseMaterial::Parse("KNKR");
+
+  ASSERT_TRUE(material.ok()) << material.status();
+  EXPECT_EQ(material->Name(), "KRKN");
+  EXPECT_EQ(material->PieceCount(), 4);
+  EXPECT_EQ(material->PieceKind(2), Kind::ROOK);
+  EXPECT_EQ(material->PieceColor(2), Color::WHITE);
+  EXPECT_EQ(material->PieceKind(3), Kind::KNIGHT);
+  EXPECT_EQ(material->PieceColor(3), Color::BLACK);
+  EXPECT_EQ(material->Key(), TablebaseMaterial::Parse("KRKN")->Key());
+  EXPECT_EQ(TablebaseMaterial::Parse("KBNQK")->Name(), "KQBNK");
+}
+
+TEST(TablebaseMaterial, RejectsUnsupportedEndings) {
+  EXPECT_FALSE(TablebaseMaterial::Parse("KPKX").ok());
+  EXPECT_FALSE(TablebaseMaterial::Parse("KQ").ok());
+  EXPECT_FALSE(TablebaseMaterial::Parse("QKK").ok());
+  EXPECT_FALSE(TablebaseMaterial::Parse("KQRKRN").ok());
+}
+
+TEST(TablebaseMaterial, CapturesLeadToSmallerEndings) {
+  const std::vector<TablebaseMaterial> captures =
+      TablebaseMaterial::Parse("KRRKN")->Conversions();
+
+  ASSERT_EQ(captures.size(), 2);
+  EXPECT_EQ(captures[0].Name(), "KRKN");
+  EXPECT_EQ(captures[1].Name(), "KRRK");
+  EXPECT_TRUE(TablebaseMaterial::Parse("KQK")->Conversions().empty());
+}
+
+TEST(TablebaseMaterial, PawnsPromote) {
+  std::vector<std::string> names;
+  for (const TablebaseMaterial& material :
+       TablebaseMaterial::Parse("KPK")->Conversions()) {
+    names.push_back(material.Name());
+  }
+  EXPECT_EQ(names, (std::vector<std::string>{"KQK", "KRK", "KBK", "KNK"}));
+
+  names.clear();
+  for (const TablebaseMaterial& material :
+       TablebaseMaterial::Parse("KRKP")->Conversions()) {
+    names.push_back(material.Name());
+  }
+  EXPECT_EQ(names, (std::vector<std::string>{"KPK", "KRK", "KQKR", "KQK",
+                                             "KRKR", "KRKB", "KBK", "KRKN",
+                                             "KNK"}));
+}
+
+TEST(TablebaseMaterial, MirrorImagesShareAnIndex) {
+  const TablebaseMaterial material = *TablebaseMaterial::Parse("KRKN");
+  TablebasePieces pieces;
+  pieces.count = 4;
+  const Kind kinds[] = {Kind::KNIGHT, Kind::KING, Kind::ROOK, Kind::KING};
+  const Color colors[] = {Color::BLACK, Color::WHITE, Color::WHITE,
+                          Color::BLACK};
+  const int squares[] = {SquareIndex(C, SIX), SquareIndex(G, TWO),
+                         SquareIndex(A, EIGHT), SquareIndex(E, FIVE)};
+  for (int i = 0; i < 4; ++i) {
+    pieces.kinds[i] = kinds[i];
+    pieces.colors[i] = colors[i];
+    pieces.squares[i] = squares[i];
+  }
+  TablebasePieces mirrored = pieces;
+  for (int i = 0; i < 4; ++i) {
+    const Square square = SquareFromIndex(pieces.squares[i]);
+    mirrored.squares[i] =
+        SquareIndex(square.rank, BOARD_SIZE - 1 - square.file);
+  }
+
+  const uint32_t index = material.Index(pieces);
+  ASSERT_NE(index, TablebaseMaterial::INVALID_INDEX);
+  EXPECT_LT(index, material.IndexCount());
+  EXPECT_EQ(material.Index(mirrored), index);
+  EXPECT_EQ(material.Index(material.Pieces(index)), index);
+
+  pieces.squares[0] = pieces.squares[2];
+  EXPECT_EQ(material.Index(pieces), TablebaseMaterial::INVALID_INDEX);
+}
+
+TEST(TablebaseMaterial, PawnsAreOnlyMirroredLeftToRight) {
+  const TablebaseMaterial material = *TablebaseMaterial::Parse("KPK");
+  TablebasePieces pieces;
+  pieces.count = 3;
+  const Kind kinds[] = {Kind::KING, Kind::PAWN, Kind::KING};
+  const Color colors[] = {Color::WHITE, Color::WHITE, Color::BLACK};
+  const int squares[] = {SquareIndex(G, TWO), SquareIndex(F, FOUR),
+                         SquareIndex(B, SEVEN)};
+  for (int i = 0; i < 3; ++i) {
+    pieces.kinds[i] = kinds[i];
+    pieces.colors[i] = colors[i];
+    pieces.squares[i] = squares[i];
+  }
+  TablebasePieces mirrored = pieces;
+  TablebasePieces flipped = pieces;
+  for (int i = 0; i < 3; ++i) {
+    const Square square = SquareFromIndex(pieces.squares[i]);
+    mirrored.squares[i] =
+        SquareIndex(BOARD_SIZE - 1 - square.file, square.rank);
+    flipped.squares[i] =
+        SquareIndex(square.file, BOARD_SIZE - 1 - square.rank);
+  }
+
+  const uint32_t index = material.Index(pieces);
+  ASSERT_NE(index, TablebaseMaterial::INVALID_INDEX);
+  EXPECT_LT(index, material.IndexCount());
+  EXPECT_EQ(material.Index(mirrored), index);
+  EXPECT_NE(material.Index(flipped), index);
+  EXPECT_EQ(material.Index(material.Pieces(index)), index);
+
+  pieces.squares[1] = SquareIndex(F, EIGHT);
+  EXPECT_EQ(material.Index(pieces), TablebaseMaterial::INVALID_INDEX);
+  pieces.squares[1] = SquareIndex(F, ONE);
+  EXPECT_EQ(material.Index(pieces), TablebaseMaterial::INVALID_INDEX);
+}
+
+TEST(DecodeTablebaseValue, ParityTellsTheWinner) {
+  EXPECT_EQ(DecodeTablebaseValue(TABLEBASE_DRAW).outcome,
+            TablebaseOutcome::DRAW);
+  EXPECT_EQ(DecodeTablebaseValue(1).outcome, TablebaseOutcome::LOSS);
+  EXPECT_EQ(DecodeTablebaseValue(1).plies_to_mate, 0);
+  EXPECT_EQ(DecodeTablebaseValue(20).outcome, TablebaseOutcome::WIN);
+  EXPECT_EQ(DecodeTablebaseValue(20).plies_to_mate, 19);
+}
@@ -0,0 +1,151 @@
+#ifndef ENGINE_TASK_H_
+#define ENGINE_TASK_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+
+#include "engine/arena.h"
+
+// State shared by the promises of all the tasks, whatever their value.
+struct TaskPromiseBase {
+  // Frames come from TransientMemory(), so that a search made of tasks takes
+  // nothing from the heap within a ScopedArena. The memory resource is kept
+  // ahead of the frame, which may be destroyed after the scope it was
+  // allocated in.
+  static void* operator new(size_t size) {
+    std::pmr::memory_resource* memory = TransientMemory();
+    std::byte* block = static_cast<std::byte*>(
+        memory->allocate(size + FRAME_HEADER_SIZE, FRAME_ALIGNMENT));
+    *reinterpret_cast<std::pmr::memory_resource**>(block) = memory;
+    return block + FRAME_HEADER_SIZE;
+  }
+  static void operator delete(void* frame, size_t size) {
+    std::byte* block = static_cast<std::byte*>(frame) - FRAME_HEADER_SIZE;
+    (*reinterpret_cast<std::pmr::memory_resource**>(block))
+        ->deallocate(block, size + FRAME_HEADER_SIZE, FRAME_ALIGNMENT);
+  }
+
+  // Task awaiting this one, resumed once this one completes. Null for the
+  // outermost task.
+  std::coroutine_handle<> continuation;
+  // Outermost task of the chain of tasks awaiting each other.
+  TaskPromiseBase* outermost = this;
+  // Innermost task of the chain, where Resume() continues from. Only used in
+  // the outermost task.
+  std::coroutine_handle<> resume_point;
+  // Whether this task is being run from within the co_await of its
+  // continuation, which then carries on by itself once this one completes.
+  bool run_by_continuation = false;
+
+ private:
+  static constexpr size_t FRAME_ALIGNMENT = alignof(std::max_align_t);
+  static constexpr size_t FRAME_HEADER_SIZE = FRAME_ALIGNMENT;
+};
+
+// A coroutine computing a value of type T. It doesn't start until it is either
+// awaited by another task, or resumed by its owner.
+//
+// Awaiting a task runs it within the awaiting one, so a whole chain of tasks
+// can suspend at once with Yield() and return to the caller of Resume(). The
+// next call continues where the chain left off.
+template <typename T> class Task {
+ public:
+  struct promise_type : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task get_return_object() {
+      resume_point = std::coroutine_handle<promise_type>::from_promise(*this);
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept { return FinalAwaiter(); }
+    void return_value(T result) { value = std::move(result); }
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task& operator=(Task&& other) noexcept {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+  // Destroys the coroutine, and the tasks it is awaiting, even if they are
+  // suspended.
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  // Runs the task until it either yields or completes, and returns true once
+  // it is complete. Only for the outermost task.
+  bool Resume() {
+    handle_.promise().resume_point.resume();
+    return handle_.done();
+  }
+
+  bool Done() const { return handle_.done(); }
+
+  // Only valid once the task is complete.
+  T& Result() const { return *handle_.promise().value; }
+
+  auto operator co_await() && noexcept { return Awaiter{handle_}; }
+
+ private:
+  using Handle = std::coroutine_handle<promise_type>;
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(Handle handle) noexcept {
+      const promise_type& promise = handle.promise();
+      return promise.continuation && !promise.run_by_continuation
+                 ? promise.continuation
+                 : std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+
+  struct Awaiter {
+    Handle handle;
+
+    bool await_ready() noexcept { return false; }
+    // The awaited task is run from here rather than transferred to, as
+    // compilers don't always make the transfer a tail call, and the stack
+    // would then grow with every task awaited. It only grows with the depth
+    // of the chain this way. The awaiting task only suspends if the awaited
+    // one yields.
+    template <typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> awaiting) noexcept {
+      handle.promise().continuation = awaiting;
+      handle.promise().outermost = awaiting.promise().outermost;
+      handle.promise().run_by_continuation = true;
+      handle.resume();
+      if (handle.done()) {
+        return false;
+      }
+      handle.promise().run_by_continuation = false;
+      return true;
+    }
+    T await_resume() { return std::move(*handle.promise().value); }
+  };
+
+  explicit Task(Handle handle) : handle_(handle) {}
+
+  Handle handle_;
+};
+
+// Suspends the chain of tasks awaiting each other, up to the caller of
+// Task::Resume() on the outermost one.
+struct Yield {
+  bool await_ready() noexcept { return false; }
+  template <typename Promise>
+  void await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+    handle.promise().outermost->resume_point = handle;
+  }
+  void await_resume() noexcept {}
+};
+
+#endif // ENGINE_TASK_H_
@@ -0,0 +1,89 @@
+#include "engine/task.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+Task<int> Leaf(int value, std::vector<int>* trace) {
+  trace->push_back(value);
+  co_await Yield();
+  trace->push_back(-value);
+  co_return value;
+}
+
+// Counts the coroutine frames destroyed.
+struct DestructionCounter {
+  int* count;
+  ~DestructionCounter() { ++*count; }
+};
+
+Task<int> Suspended(int* destroyed) {
+  const DestructionCounter counter{destroyed};
+  co_await Yield();
+  co_return 0;
+}
+
+Task<int> AwaitSuspended(int* destroyed) {
+  const DestructionCounter counter{destroyed};
+  co_return co_await Suspended(destroyed);
+}
+
+Task<int> Sum(std::vector<int>* trace) {
+  const int first = co_await Leaf(1, trace);
+  const int second = co_await Leaf(2, trace);
+  co_return first + second;
+}
+
+Task<int> One() { co_return 1; }
+
+Task<int> Count(int tasks) {
+  int count = 0;
+  for (int i = 0; i < tasks; ++i) {
+    count += co_await One();
+  }
+  co_return count;
+}
+
+} // namespace
+
+TEST(Task, DoesNotStartBeforeResumed) {
+  std::vector<int> trace;
+  Task<int> task = Leaf(1, &trace);
+
+  EXPECT_FALSE(task.Done());
+  EXPECT_TRUE(trace.empty());
+}
+
+TEST(Task, YieldSuspendsAllTheAwaitingTasks) {
+  std::vector<int> trace;
+  Task<int> task = Sum(&trace);
+
+  EXPECT_FALSE(task.Resume());
+  EXPECT_EQ(trace, std::vector<int>({1}));
+  EXPECT_FALSE(task.Resume());
+  EXPECT_EQ(trace, std::vector<int>({1, -1, 2}));
+  EXPECT_TRUE(task.Resume());
+  EXPECT_EQ(trace, std::vector<int>({1, -1, 2, -2}));
+  EXPECT_EQ(task.Result(), 3);
+}
+
+TEST(Task, DestroysSuspendedTasks) {
+  int destroyed = 0;
+  {
+    Task<int> task = AwaitSuspended(&destroyed);
+    EXPECT_FALSE(task.Resume());
+    EXPECT_EQ(destroyed, 0);
+  }
+  EXPECT_EQ(destroyed, 2);
+}
+
+TEST(Task, AwaitsTasksWithoutGrowingTheStack) {
+  // Enough tasks to overflow the stack if each one took even a few bytes of
+  // it.
+  Task<int> task = Count(10'000'000);
+
+  EXPECT_TRUE(task.Resume());
+  EXPECT_EQ(task.Result(), 10'000'000);
+}
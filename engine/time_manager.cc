@@ -0,0 +1,72 @@
+#include "engine/time_manager.h"
+
+#include <algorithm>
+
+namespace {
+
+// Time kept in reserve for communication and process scheduling delays.
+static constexpr int64_t MOVE_OVERHEAD_MS = 20;
+// Number of moves the remaining time is split between in sudden death games.
+static constexpr int DEFAULT_MOVES_TO_GO = 30;
+// The search may overrun its optimum time up to this many times to finish an
+// iteration, but never use more than this fraction of the remaining time.
+static constexpr int MAXIMUM_TO_OPTIMUM_RATIO = 4;
+static constexpr double MAXIMUM_FRACTION_OF_TIME_LEFT = 0.5;
+
+} // namespace
+
+TimeManager::TimeManager(const TimeControl& control, bool pondering)
+    : pondering_(pondering), start_(Clock::now().time_since_epoch().count()) {
+  if (control.move_time_ms > 0) {
+    is_limited_ = true;
+    optimum_ms_ = maximum_ms_ =
+        std::max<int64_t>(control.move_time_ms - MOVE_OVERHEAD_MS, 1);
+    return;
+  }
+  if (control.time_left_ms <= 0) {
+    return;
+  }
+
+  is_limited_ = true;
+  const int moves_to_go =
+      control.moves_to_go > 0
+          ? std::min(control.moves_to_go, DEFAULT_MOVES_TO_GO)
+          : DEFAULT_MOVES_TO_GO;
+  const int64_t usable_ms =
+      std::max<int64_t>(control.time_left_ms - MOVE_OVERHEAD_MS, 1);
+  optimum_ms_ = std::min(usable_ms / moves_to_go + control.increment_ms * 3 / 4,
+                         usable_ms);
+  maximum_ms_ = std::min<int64_t>(
+      optimum_ms_ * MAXIMUM_TO_OPTIMUM_RATIO,
+      static_cast<int64_t>(usable_ms * MAXIMUM_FRACTION_OF_TIME_LEFT));
+  maximum_ms_ = std::max<int64_t>(std::max(maximum_ms_, optimum_ms_), 1);
+  optimum_ms_ = std::max<int64_t>(optimum_ms_, 1);
+}
+
+bool TimeManager::ShouldStartIteration() const {
+  if (!is_limited_ || pondering_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  return ElapsedMilliseconds() < optimum_ms_ / 2;
+}
+
+bool TimeManager::HardLimitReached() const {
+  if (!is_limited_ || pondering_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  return ElapsedMilliseconds() >= maximum_ms_;
+}
+
+void TimeManager::PonderHit() {
+  start_.store(Clock::now().time_since_epoch().count(),
+               std::memory_order_relaxed);
+  pondering_.store(false, std::memory_order_release);
+}
+
+int64_t TimeManager::ElapsedMilliseconds() const {
+  const Clock::time_point start(
+      Clock::duration(start_.load(std::memory_order_relaxed)));
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                               start)
+      .count();
+}
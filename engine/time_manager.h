@@ -0,0 +1,60 @@
+#ifndef ENGINE_TIME_MANAGER_H_
+#define ENGINE_TIME_MANAGER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Time available for a move. All times are in milliseconds, zero when not
+// given. A search with neither a clock nor a move time is not time limited.
+struct TimeControl {
+  // Remaining time on the clock of the side to move.
+  int64_t time_left_ms = 0;
+  // Time added to the clock after each move.
+  int64_t increment_ms = 0;
+  // Moves until the next time control, zero if the remaining time is for the
+  // rest of the game.
+  int moves_to_go = 0;
+  // Exact time to spend on this move, overrides the clock.
+  int64_t move_time_ms = 0;
+};
+
+// Splits the remaining clock time between moves, and tells an iterative
+// deepening search whether to start another iteration or to stop. The clock
+// starts running on construction, or, for a search pondering on the
+// opponent's time, once the opponent plays the expected move. Safe to use from
+// multiple threads.
+class TimeManager {
+ public:
+  explicit TimeManager(const TimeControl& control, bool pondering = false);
+
+  // Whether another iteration is likely to finish before the optimum time.
+  // Each iteration usually takes a few times longer than the previous one, so
+  // starting one late is wasted effort.
+  bool ShouldStartIteration() const;
+
+  // Whether the search must stop immediately, abandoning the current
+  // iteration.
+  bool HardLimitReached() const;
+
+  // Starts the clock of a pondering search.
+  void PonderHit();
+
+  int64_t ElapsedMilliseconds() const;
+
+  // Time the search aims to use, and the time it must never exceed.
+  int64_t OptimumMilliseconds() const { return optimum_ms_; }
+  int64_t MaximumMilliseconds() const { return maximum_ms_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  bool is_limited_ = false;
+  int64_t optimum_ms_ = 0;
+  int64_t maximum_ms_ = 0;
+
+  std::atomic<bool> pondering_;
+  std::atomic<Clock::rep> start_;
+};
+
+#endif // ENGINE_TIME_MANAGER_H_
@@ -0,0 +1,69 @@
+#include "engine/time_manager.h"
+
+#include <gtest/gtest.h>
+
+TEST(TimeManager, UnlimitedWithoutClockOrMoveTime) {
+  TimeManager time_manager(TimeControl{});
+
+  EXPECT_TRUE(time_manager.ShouldStartIteration());
+  EXPECT_FALSE(time_manager.HardLimitReached());
+}
+
+TEST(TimeManager, MoveTimeIsBothOptimumAndMaximum) {
+  TimeControl control;
+  control.move_time_ms = 1000;
+  TimeManager time_manager(control);
+
+  EXPECT_EQ(time_manager.OptimumMilliseconds(),
+            time_manager.MaximumMilliseconds());
+  EXPECT_LE(time_manager.MaximumMilliseconds(), 1000);
+  EXPECT_GT(time_manager.MaximumMilliseconds(), 900);
+}
+
+TEST(TimeManager, ClockTimeIsSplitBetweenMoves) {
+  TimeControl control;
+  control.time_left_ms = 60000;
+  control.increment_ms = 1000;
+  TimeManager time_manager(control);
+
+  EXPECT_GT(time_manager.OptimumMilliseconds(), 1000);
+  EXPECT_LT(time_manager.OptimumMilliseconds(), 60000 / 10);
+  EXPECT_GT(time_manager.MaximumMilliseconds(),
+            time_manager.OptimumMilliseconds());
+  EXPECT_LE(time_manager.MaximumMilliseconds(), 30000);
+}
+
+TEST(TimeManager, FewMovesToGoGetMoreTimeEach) {
+  TimeControl sudden_death;
+  sudden_death.time_left_ms = 60000;
+  TimeControl two_moves_to_go = sudden_death;
+  two_moves_to_go.moves_to_go = 2;
+
+  EXPECT_GT(TimeManager(two_moves_to_go).OptimumMilliseconds(),
+            TimeManager(sudden_death).OptimumMilliseconds());
+}
+
+TEST(TimeManager, AlmostFlaggedClockStillLeavesSomeTime) {
+  TimeControl control;
+  control.time_left_ms = 5;
+  TimeManager time_manager(control);
+
+  EXPECT_GE(time_manager.OptimumMilliseconds(), 1);
+  EXPECT_GE(time_manager.MaximumMilliseconds(), 1);
+}
+
+TEST(TimeManager, PonderingIgnoresLimitsUntilPonderHit) {
+  TimeControl control;
+  control.move_time_ms = 1;
+  TimeManager time_manager(control, /*pondering=*/true);
+  while (time_manager.ElapsedMilliseconds() < 5) {
+  }
+
+  EXPECT_FALSE(time_manager.HardLimitReached());
+  time_manager.PonderHit();
+  EXPECT_LT(time_manager.ElapsedMilliseconds(), 5);
+  while (time_manager.ElapsedMilliseconds() < 5) {
+  }
+  EXPECT_TRUE(time_manager.HardLimitReached());
+  EXPECT_FALSE(time_manager.ShouldStartIteration());
+}
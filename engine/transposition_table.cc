@@ -0,0 +1,95 @@
+#include "engine/transposition_table.h"
+
+#include <algorithm>
+
+#include "engine/stats.h"
+
+namespace {
+
+static constexpr size_t BYTES_IN_MEGABYTE = 1 << 20;
+
+// Layout of the data word of a slot.
+static constexpr int MOVE_SHIFT = 0;
+static constexpr int DEPTH_SHIFT = 16;
+static constexpr int BOUND_SHIFT = 24;
+static constexpr uint8_t BOUND_MASK = 0x3;
+static constexpr int SCORE_SHIFT = 32;
+// Set in every stored entry, so that empty slots never match.
+static constexpr uint64_t OCCUPIED_BIT = uint64_t{1} << 31;
+
+uint64_t PackData(uint16_t move, int depth, TranspositionTable::Bound bound,
+                  int score) {
+  const int8_t clamped_depth =
+      static_cast<int8_t>(std::clamp(depth, -128, 127));
+  return OCCUPIED_BIT | uint64_t{move} << MOVE_SHIFT |
+         uint64_t{static_cast<uint8_t>(clamped_depth)} << DEPTH_SHIFT |
+         uint64_t{static_cast<uint8_t>(bound)} << BOUND_SHIFT |
+         uint64_t{static_cast<uint32_t>(score)} << SCORE_SHIFT;
+}
+
+TranspositionTable::Entry UnpackData(uint64_t key, uint64_t data) {
+  TranspositionTable::Entry entry;
+  entry.key = key;
+  entry.move = static_cast<uint16_t>(data >> MOVE_SHIFT);
+  entry.depth = static_cast<int8_t>(data >> DEPTH_SHIFT);
+  entry.bound = static_cast<TranspositionTable::Bound>(
+      static_cast<uint8_t>(data >> BOUND_SHIFT) & BOUND_MASK);
+  entry.score = static_cast<int32_t>(data >> SCORE_SHIFT);
+  return entry;
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t size_in_megabytes) {
+  const size_t max_entries =
+      size_in_megabytes * BYTES_IN_MEGABYTE / BYTES_PER_ENTRY;
+  size_ = 1;
+  while (size_ * 2 <= max_entries) {
+    size_ *= 2;
+  }
+  slots_ = std::make_unique<Slot[]>(size_);
+}
+
+bool TranspositionTable::Probe(uint64_t key, Entry* entry) const {
+  CountEvent(Counter::TABLE_PROBES);
+  const bool found = Find(key, entry);
+  CountEvent(Counter::TABLE_HITS, found);
+  return found;
+}
+
+bool TranspositionTable::Find(uint64_t key, Entry* entry) const {
+  const Slot& slot = slots_[key & (size_ - 1)];
+  const uint64_t data = slot.data.load(std::memory_order_relaxed);
+  if ((data & OCCUPIED_BIT) == 0 ||
+      (slot.key_xor_data.load(std::memory_order_relaxed) ^ data) != key) {
+    return false;
+  }
+  *entry = UnpackData(key, data);
+  return true;
+}
+
+void TranspositionTable::Store(uint64_t key, uint16_t move, int depth,
+                               Bound bound, int score) {
+  Slot& slot = slots_[key & (size_ - 1)];
+  Entry stored;
+  if (Find(key, &stored)) {
+    if (depth < stored.depth && bound != Bound::EXACT) {
+      return;
+    }
+    // Keep the best move of a previous search if this one didn't find any,
+    // e.g. because all the moves failed low.
+    if (move == 0) {
+      move = stored.move;
+    }
+  }
+  const uint64_t data = PackData(move, depth, bound, score);
+  slot.key_xor_data.store(key ^ data, std::memory_order_relaxed);
+  slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::Clear() {
+  for (size_t i = 0; i < size_; ++i) {
+    slots_[i].key_xor_data.store(0, std::memory_order_relaxed);
+    slots_[i].data.store(0, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef ENGINE_TRANSPOSITION_TABLE_H_
+#define ENGINE_TRANSPOSITION_TABLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Caches search results by position hash, so that positions reached through
+// different move orders, or searched again at a greater depth, reuse the work
+// already done. The best move found is kept even when the score is too shallow
+// to be reused, as it is the best candidate to try first.
+//
+// Safe to share between search threads without locking. Each slot stores the
+// key xor-ed with the data, so that a slot torn by two concurrent writes
+// fails the key check instead of returning a mix of two entries.
+class TranspositionTable {
+ public:
+  // Tells how the stored score relates to the real one: the search only
+  // learns exact scores of the nodes where a move falls inside the window.
+  enum class Bound : uint8_t { EXACT, LOWER, UPPER };
+
+  struct Entry {
+    uint64_t key = 0;
+    // Packed best move, see PackMove(). Zero if unknown.
+    uint16_t move = 0;
+    int16_t depth = 0;
+    Bound bound = Bound::EXACT;
+    int32_t score = 0;
+  };
+
+  static constexpr size_t BYTES_PER_ENTRY = 2 * sizeof(uint64_t);
+
+  // Allocates the largest power of two number of entries fitting in the
+  // given size.
+  explicit TranspositionTable(size_t size_in_megabytes);
+
+  // Returns false if there is no entry for the key.
+  bool Probe(uint64_t key, Entry* entry) const;
+
+  // Replaces an entry of another position, or a shallower entry of the same
+  // one. Depths are stored in a byte, and clamped to fit.
+  void Store(uint64_t key, uint16_t move, int depth, Bound bound, int score);
+
+  // Not safe to call while the table is used by a search.
+  void Clear();
+
+  size_t Size() const { return size_; }
+
+ private:
+  // Probe() without counting it, see Counter::TABLE_PROBES.
+  bool Find(uint64_t key, Entry* entry) const;
+
+  struct Slot {
+    std::atomic<uint64_t> key_xor_data{0};
+    std::atomic<uint64_t> data{0};
+  };
+
+  size_t size_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+#endif // ENGINE_TRANSPOSITION_TABLE_H_
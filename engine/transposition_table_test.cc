@@ -0,0 +1,72 @@
+#include "engine/transposition_table.h"
+
+#include <gtest/gtest.h>
+
+TEST(TranspositionTable, SizeIsAPowerOfTwo) {
+  TranspositionTable table(1);
+  EXPECT_GT(table.Size(), 0);
+  EXPECT_EQ(table.Size() & (table.Size() - 1), 0);
+  EXPECT_LE(table.Size() * TranspositionTable::BYTES_PER_ENTRY, 1 << 20);
+}
+
+TEST(TranspositionTable, StoredEntryIsFound) {
+  TranspositionTable table(1);
+  table.Store(42, 7, 3, TranspositionTable::Bound::LOWER, 150);
+
+  TranspositionTable::Entry entry;
+  ASSERT_TRUE(table.Probe(42, &entry));
+  EXPECT_EQ(entry.move, 7);
+  EXPECT_EQ(entry.depth, 3);
+  EXPECT_EQ(entry.bound, TranspositionTable::Bound::LOWER);
+  EXPECT_EQ(entry.score, 150);
+  EXPECT_FALSE(table.Probe(43, &entry));
+}
+
+TEST(TranspositionTable, ShallowerBoundDoesNotReplaceDeeperEntry) {
+  TranspositionTable table(1);
+  table.Store(42, 7, 5, TranspositionTable::Bound::EXACT, 150);
+  table.Store(42, 8, 2, TranspositionTable::Bound::UPPER, -30);
+
+  TranspositionTable::Entry entry;
+  ASSERT_TRUE(table.Probe(42, &entry));
+  EXPECT_EQ(entry.move, 7);
+  EXPECT_EQ(entry.depth, 5);
+}
+
+TEST(TranspositionTable, BestMoveIsKeptWhenNewResultHasNone) {
+  TranspositionTable table(1);
+  table.Store(42, 7, 2, TranspositionTable::Bound::EXACT, 150);
+  table.Store(42, 0, 3, TranspositionTable::Bound::UPPER, 100);
+
+  TranspositionTable::Entry entry;
+  ASSERT_TRUE(table.Probe(42, &entry));
+  EXPECT_EQ(entry.move, 7);
+  EXPECT_EQ(entry.depth, 3);
+}
+
+TEST(TranspositionTable, ClearRemovesEntries) {
+  TranspositionTable table(1);
+  table.Store(42, 7, 2, TranspositionTable::Bound::EXACT, 150);
+  table.Clear();
+
+  TranspositionTable::Entry entry;
+  EXPECT_FALSE(table.Probe(42, &entry));
+}
+
+TEST(TranspositionTable, NegativeScoresAndDeepEntriesRoundTrip) {
+  TranspositionTable table(1);
+  table.Store(42, 7, 100, TranspositionTable::Bound::UPPER, -999999);
+
+  TranspositionTable::Entry entry;
+  ASSERT_TRUE(table.Probe(42, &entry));
+  EXPECT_EQ(entry.depth, 100);
+  EXPECT_EQ(entry.bound, TranspositionTable::Bound::UPPER);
+  EXPECT_EQ(entry.score, -999999);
+}
+
+TEST(TranspositionTable, EmptySlotDoesNotMatchZeroKey) {
+  TranspositionTable table(1);
+
+  TranspositionTable::Entry entry;
+  EXPECT_FALSE(table.Probe(0, &entry));
+}
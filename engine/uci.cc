@@ -0,0 +1,318 @@
+#include "engine/uci.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+
+#include "engine/move.h"
+#include "engine/notation_parser.h"
+
+namespace {
+
+static constexpr char ENGINE_NAME[] = "chess";
+static constexpr char ENGINE_AUTHOR[] = "arssav";
+
+static constexpr int DEFAULT_HASH_SIZE_IN_MEGABYTES = 16;
+static constexpr int MAX_HASH_SIZE_IN_MEGABYTES = 65536;
+static constexpr int MAX_THREADS = 256;
+static constexpr int MAX_MULTI_PV = 256;
+
+// Joins the arguments between `name` and `next`, or the end, e.g. "Hash" for
+// name "name" and next "value" in "name Hash value 64".
+std::string ArgumentValue(const std::vector<std::string>& arguments,
+                          const std::string& name, const std::string& next) {
+  const auto name_position =
+      std::find(arguments.begin(), arguments.end(), name);
+  if (name_position == arguments.end()) {
+    return "";
+  }
+  const auto value_end = std::find(name_position, arguments.end(), next);
+  return absl::StrJoin(name_position + 1, value_end, " ");
+}
+
+} // namespace
+
+UciEngine::UciEngine(std::ostream& output)
+    : output_(output), table_(std::make_unique<TranspositionTable>(
+                           DEFAULT_HASH_SIZE_IN_MEGABYTES)) {
+  position_ = *ParseFen(STARTING_POSITION_FEN);
+}
+
+UciEngine::~UciEngine() { StopSearch(); }
+
+bool UciEngine::HandleCommand(const std::string& line) {
+  const std::vector<std::string> tokens =
+      absl::StrSplit(line, absl::ByAnyChar(" \t\r"), absl::SkipEmpty());
+  if (tokens.empty()) {
+    return true;
+  }
+  const std::string& command = tokens[0];
+  const std::vector<std::string> arguments(tokens.begin() + 1, tokens.end());
+  if (command == "uci") {
+    PrintLine(absl::StrFormat("id name %s", ENGINE_NAME));
+    PrintLine(absl::StrFormat("id author %s", ENGINE_AUTHOR));
+    PrintLine(absl::StrFormat(
+        "option name Hash type spin default %d min 1 max %d",
+        DEFAULT_HASH_SIZE_IN_MEGABYTES, MAX_HASH_SIZE_IN_MEGABYTES));
+    PrintLine(absl::StrFormat(
+        "option name Threads type spin default 1 min 1 max %d", MAX_THREADS));
+    PrintLine(absl::StrFormat(
+        "option name MultiPV type spin default 1 min 1 max %d", MAX_MULTI_PV));
+    PrintLine("option name Ponder type check default false");
+    PrintLine("uciok");
+  } else if (command == "isready") {
+    PrintLine("readyok");
+  } else if (command == "ucinewgame") {
+    StopSearch();
+    table_->Clear();
+  } else if (command == "position") {
+    StopSearch();
+    SetPosition(arguments);
+  } else if (command == "setoption") {
+    StopSearch();
+    SetOption(arguments);
+  } else if (command == "go") {
+    Go(arguments);
+  } else if (command == "stop") {
+    StopSearch();
+  } else if (command == "ponderhit") {
+    PonderHit();
+  } else if (command == "quit") {
+    StopSearch();
+    return false;
+  }
+  // Unknown commands, and "debug" and "register", are ignored as the protocol
+  // requires.
+  return true;
+}
+
+void UciEngine::SetPosition(const std::vector<std::string>& arguments) {
+  if (arguments.empty()) {
+    return;
+  }
+  const auto moves_position =
+      std::find(arguments.begin(), arguments.end(), "moves");
+  absl::StatusOr<FenPosition> fen_position_or;
+  if (arguments[0] == "startpos") {
+    fen_position_or = ParseFen(STARTING_POSITION_FEN);
+  } else if (arguments[0] == "fen") {
+    fen_position_or =
+        ParseFen(absl::StrJoin(arguments.begin() + 1, moves_position, " "));
+  } else {
+    fen_position_or = absl::InvalidArgumentError(
+        absl::StrFormat("Unknown position type: \"%s\"", arguments[0]));
+  }
+  if (!fen_position_or.ok()) {
+    PrintLine(absl::StrFormat("info string %s",
+                              fen_position_or.status().ToString()));
+    return;
+  }
+
+  FenPosition fen_position = *std::move(fen_position_or);
+  std::vector<uint64_t> game_hashes;
+  if (moves_position != arguments.end()) {
+    for (auto notation = moves_position + 1; notation != arguments.end();
+         ++notation) {
+      absl::StatusOr<Move> move_or = ParseCoordinateNotation(
+          *notation, fen_position.side_to_move, fen_position.position);
+      if (!move_or.ok()) {
+        PrintLine(
+            absl::StrFormat("info string %s", move_or.status().ToString()));
+        return;
+      }
+      const bool resets_halfmove_clock =
+          move_or->IsACapture() ||
+          fen_position.position.GetPiece(move_or->From()).Kind() == Kind::PAWN;
+      if (resets_halfmove_clock) {
+        game_hashes.clear();
+      } else {
+        game_hashes.push_back(
+            fen_position.position.Hash(fen_position.side_to_move));
+      }
+      fen_position.position.MakeMove(move_or->From(), move_or->To(),
+                                     move_or->Promotion());
+      fen_position.halfmove_clock =
+          resets_halfmove_clock ? 0 : fen_position.halfmove_clock + 1;
+      if (fen_position.side_to_move == Color::BLACK) {
+        ++fen_position.fullmove_number;
+      }
+      fen_position.side_to_move = OppositeColor(fen_position.side_to_move);
+    }
+  }
+  position_ = std::move(fen_position);
+  game_hashes_ = std::move(game_hashes);
+}
+
+void UciEngine::SetOption(const std::vector<std::string>& arguments) {
+  const std::string name = ArgumentValue(arguments, "name", "value");
+  const std::string value = ArgumentValue(arguments, "value", "");
+  int number;
+  if (name == "Hash" && absl::SimpleAtoi(value, &number)) {
+    table_ = std::make_unique<TranspositionTable>(
+        std::clamp(number, 1, MAX_HASH_SIZE_IN_MEGABYTES));
+  } else if (name == "Threads" && absl::SimpleAtoi(value, &number)) {
+    threads_ = std::clamp(number, 1, MAX_THREADS);
+  } else if (name == "MultiPV" && absl::SimpleAtoi(value, &number)) {
+    multi_pv_ = std::clamp(number, 1, MAX_MULTI_PV);
+  }
+}
+
+void UciEngine::Go(const std::vector<std::string>& arguments) {
+  StopSearch();
+
+  const Color color = position_.side_to_move;
+  TimeControl control;
+  SearchOptions options;
+  options.depth = MAX_SEARCH_DEPTH;
+  bool infinite = false;
+  bool ponder = false;
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    const std::string& name = arguments[i];
+    if (name == "infinite") {
+      infinite = true;
+      continue;
+    }
+    if (name == "ponder") {
+      ponder = true;
+      continue;
+    }
+    int64_t value;
+    if (i + 1 == arguments.size() ||
+        !absl::SimpleAtoi(arguments[i + 1], &value)) {
+      continue;
+    }
+    ++i;
+    if (name == "depth") {
+      options.depth = std::clamp<int64_t>(value, 1, MAX_SEARCH_DEPTH);
+    } else if (name == "nodes") {
+      options.max_nodes = std::max<int64_t>(value, 1);
+    } else if (name == "movetime") {
+      control.move_time_ms = value;
+    } else if (name == "movestogo") {
+      control.moves_to_go = static_cast<int>(value);
+    } else if (name == (color == Color::WHITE ? "wtime" : "btime")) {
+      // Some GUIs send zero or negative times when the clock has run out.
+      control.time_left_ms = std::max<int64_t>(value, 1);
+    } else if (name == (color == Color::WHITE ? "winc" : "binc")) {
+      control.increment_ms = value;
+    }
+  }
+  if (infinite) {
+    control = TimeControl();
+  }
+
+  time_manager_ = std::make_unique<TimeManager>(control, ponder);
+  stop_ = false;
+  {
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    infinite_ = infinite;
+    pondering_ = ponder;
+  }
+  options.time_manager = time_manager_.get();
+  options.stop = &stop_;
+  options.threads = threads_;
+  options.multi_pv = multi_pv_;
+  options.game_hashes = game_hashes_;
+  options.halfmove_clock = position_.halfmove_clock;
+  const auto start = std::chrono::steady_clock::now();
+  options.on_iteration = [this, start](const SearchResult& result) {
+    PrintInfo(result,
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count());
+  };
+
+  search_thread_ = std::thread([this, options, color]() {
+    const SearchResult result =
+        SearchBestMove(position_.position, color, options, table_.get());
+    {
+      std::unique_lock<std::mutex> lock(report_mutex_);
+      report_allowed_.wait(lock,
+                           [this]() { return !infinite_ && !pondering_; });
+    }
+    PrintBestMove(result);
+  });
+}
+
+void UciEngine::PonderHit() {
+  if (time_manager_ != nullptr) {
+    time_manager_->PonderHit();
+  }
+  std::lock_guard<std::mutex> lock(report_mutex_);
+  pondering_ = false;
+  report_allowed_.notify_all();
+}
+
+void UciEngine::StopSearch() {
+  if (!search_thread_.joinable()) {
+    return;
+  }
+  stop_ = true;
+  {
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    infinite_ = false;
+    pondering_ = false;
+    report_allowed_.notify_all();
+  }
+  search_thread_.join();
+}
+
+void UciEngine::PrintInfo(const SearchResult& result, int64_t elapsed_ms) {
+  const int64_t nodes_per_second =
+      result.nodes * 1000 / std::max<int64_t>(elapsed_ms, 1);
+  for (size_t i = 0; i < result.lines.size(); ++i) {
+    const SearchLine& line = result.lines[i];
+    const int mate_in_moves = MateInMoves(line.score);
+    const std::string score =
+        mate_in_moves != 0 ? absl::StrFormat("mate %d", mate_in_moves)
+                           : absl::StrFormat("cp %d", line.score);
+    // Single line searches leave the line number out, as some older GUIs
+    // don't expect it.
+    const std::string line_number =
+        multi_pv_ > 1 ? absl::StrFormat(" multipv %d", i + 1) : "";
+    std::vector<std::string> variation;
+    for (const Move& move : line.principal_variation) {
+      variation.push_back(move.ToCoordinateNotation());
+    }
+    PrintLine(absl::StrFormat(
+        "info depth %d%s score %s nodes %d nps %d time %d pv %s", result.depth,
+        line_number, score, result.nodes, nodes_per_second, elapsed_ms,
+        absl::StrJoin(variation, " ")));
+  }
+}
+
+void UciEngine::PrintBestMove(const SearchResult& result) {
+  if (!result.best_move.has_value()) {
+    // The protocol has no way to say there are no legal moves.
+    PrintLine("bestmove 0000");
+    return;
+  }
+  std::string line =
+      absl::StrFormat("bestmove %s", result.best_move->ToCoordinateNotation());
+  if (result.principal_variation.size() >= 2) {
+    line += absl::StrFormat(
+        " ponder %s", result.principal_variation[1].ToCoordinateNotation());
+  }
+  PrintLine(line);
+}
+
+void UciEngine::PrintLine(const std::string& line) {
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  output_ << line << std::endl;
+}
+
+void RunUciLoop(std::istream& input, std::ostream& output) {
+  UciEngine engine(output);
+  std::string line;
+  while (std::getline(input, line)) {
+    if (!engine.HandleCommand(line)) {
+      break;
+    }
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef ENGINE_UCI_H_
+#define ENGINE_UCI_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/fen.h"
+#include "engine/search.h"
+#include "engine/time_manager.h"
+#include "engine/transposition_table.h"
+
+// Speaks the Universal Chess Interface protocol, as used by chess GUIs and
+// tournament managers. Searches run on their own thread, so that commands such
+// as "stop" are handled as soon as they are read.
+class UciEngine {
+ public:
+  explicit UciEngine(std::ostream& output);
+  // Stops the search, if any.
+  ~UciEngine();
+
+  // Handles one line of input. Returns false once asked to quit.
+  bool HandleCommand(const std::string& line);
+
+ private:
+  void Go(const std::vector<std::string>& arguments);
+  void SetPosition(const std::vector<std::string>& arguments);
+  void SetOption(const std::vector<std::string>& arguments);
+  void PonderHit();
+  // Stops the search, if any, and waits until it reports its best move.
+  void StopSearch();
+
+  void PrintInfo(const SearchResult& result, int64_t elapsed_ms);
+  void PrintBestMove(const SearchResult& result);
+  void PrintLine(const std::string& line);
+
+  std::ostream& output_;
+  std::mutex output_mutex_;
+
+  FenPosition position_;
+  // Hashes of the positions since the last capture or pawn move before
+  // `position_`, from the moves of the "position" command, so that the search
+  // can tell repetitions.
+  std::vector<uint64_t> game_hashes_;
+  std::unique_ptr<TranspositionTable> table_;
+  int threads_ = 1;
+  int multi_pv_ = 1;
+
+  std::thread search_thread_;
+  std::unique_ptr<TimeManager> time_manager_;
+  std::atomic<bool> stop_{false};
+  // The best move of an infinite or pondering search may only be reported
+  // after "stop", or "ponderhit" respectively, even if the search completes
+  // earlier.
+  std::mutex report_mutex_;
+  std::condition_variable report_allowed_;
+  bool infinite_ = false;
+  bool pondering_ = false;
+};
+
+// Reads commands until "quit" or the end of input.
+void RunUciLoop(std::istream& input, std::ostream& output);
+
+#endif // ENGINE_UCI_H_
@@ -0,0 +1,154 @@
+#include "engine/uci.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
+
+namespace {
+
+// The last line of the output, without the line break.
+std::string LastLine(const std::string& output) {
+  const std::string trimmed = output.substr(0, output.size() - 1);
+  return trimmed.substr(trimmed.rfind('\n') + 1);
+}
+
+} // namespace
+
+TEST(UciEngine, IdentifiesItselfAndItsOptions) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  EXPECT_TRUE(engine.HandleCommand("uci"));
+
+  EXPECT_THAT(output.str(), StartsWith("id name "));
+  EXPECT_THAT(output.str(), HasSubstr("option name Hash type spin"));
+  EXPECT_THAT(output.str(), HasSubstr("option name Threads type spin"));
+  EXPECT_THAT(output.str(), EndsWith("uciok\n"));
+}
+
+TEST(UciEngine, AnswersIsReady) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  engine.HandleCommand("isready");
+
+  EXPECT_EQ(output.str(), "readyok\n");
+}
+
+TEST(UciEngine, QuitEndsTheLoop) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  EXPECT_TRUE(engine.HandleCommand("unknown command"));
+  EXPECT_FALSE(engine.HandleCommand("quit"));
+}
+
+TEST(UciEngine, DepthLimitedSearchReportsInfoAndBestMove) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  engine.HandleCommand("position startpos moves e2e4 e7e5");
+  engine.HandleCommand("go depth 3");
+  // Waits for the search to report its best move.
+  engine.HandleCommand("stop");
+
+  EXPECT_THAT(output.str(), HasSubstr("info depth 1 score cp "));
+  EXPECT_THAT(LastLine(output.str()), StartsWith("bestmove "));
+}
+
+TEST(UciEngine, FindsMateFromFen) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  engine.HandleCommand("position fen 6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+  engine.HandleCommand("go depth 2");
+  engine.HandleCommand("stop");
+
+  EXPECT_THAT(output.str(), HasSubstr("score mate 1 "));
+  EXPECT_THAT(LastLine(output.str()), StartsWith("bestmove a1a8"));
+}
+
+TEST(UciEngine, MovesAreAppliedForTheRightSide) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  // After 1. e4, black to move can't be searched as white: a white move in
+  // the best move would mean the side to move wasn't switched.
+  engine.HandleCommand(
+      "position fen 4k3/8/8/8/8/8/4P3/4K3 w - - 0 1 moves e2e4");
+  engine.HandleCommand("go depth 1");
+  engine.HandleCommand("stop");
+
+  EXPECT_THAT(LastLine(output.str()), StartsWith("bestmove e8"));
+}
+
+TEST(UciEngine, MultiPvReportsNumberedLines) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  engine.HandleCommand("setoption name MultiPV value 3");
+  engine.HandleCommand("position startpos");
+  engine.HandleCommand("go depth 2");
+  engine.HandleCommand("stop");
+
+  // Stopping may cut the search short, but not the first iteration.
+  EXPECT_THAT(output.str(), HasSubstr("info depth 1 multipv 1 score cp "));
+  EXPECT_THAT(output.str(), HasSubstr("info depth 1 multipv 3 score cp "));
+  EXPECT_THAT(output.str(), Not(HasSubstr("multipv 4")));
+}
+
+TEST(UciEngine, InvalidPositionIsReported) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  engine.HandleCommand("position startpos moves e2e5");
+
+  EXPECT_THAT(output.str(), StartsWith("info string "));
+}
+
+TEST(UciEngine, InfiniteSearchRunsUntilStopped) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  engine.HandleCommand("setoption name Threads value 2");
+  engine.HandleCommand("setoption name Hash value 1");
+  engine.HandleCommand("position startpos");
+  engine.HandleCommand("go infinite");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  engine.HandleCommand("stop");
+
+  EXPECT_THAT(output.str(), HasSubstr("info depth"));
+  EXPECT_THAT(LastLine(output.str()), StartsWith("bestmove "));
+}
+
+TEST(UciEngine, PonderSearchReportsAfterPonderHit) {
+  std::ostringstream output;
+  UciEngine engine(output);
+
+  engine.HandleCommand("position startpos moves e2e4");
+  engine.HandleCommand("go ponder movetime 50");
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  engine.HandleCommand("ponderhit");
+  // Stopping after the move time has passed doesn't cut the search short.
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  engine.HandleCommand("stop");
+
+  EXPECT_THAT(LastLine(output.str()), StartsWith("bestmove "));
+}
+
+TEST(RunUciLoop, HandlesCommandsUntilQuit) {
+  std::istringstream input("uci\nisready\nquit\nisready\n");
+  std::ostringstream output;
+
+  RunUciLoop(input, output);
+
+  EXPECT_THAT(output.str(), EndsWith("uciok\nreadyok\n"));
+}
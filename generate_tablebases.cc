@@ -0,0 +1,83 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+#include "engine/tablebase.h"
+#include "engine/tablebase_file.h"
+#include "engine/tablebase_generator.h"
+
+ABSL_FLAG(std::string, output_directory, ".",
+          "Directory to write the tables to, where existing tables are reused "
+          "for the endings after captures and promotions.");
+ABSL_FLAG(int, threads, std::thread::hardware_concurrency(),
+          "Number of threads generating each table.");
+
+namespace {
+
+// Loads or generates the tables of the endings after captures and promotions
+// first, then generates the table of `material` unless it already exists.
+absl::Status LoadOrGenerate(const TablebaseMaterial& material,
+                            TablebaseSet& tables) {
+  if (tables.Contains(material)) {
+    return absl::OkStatus();
+  }
+  const std::string path = absl::GetFlag(FLAGS_output_directory) + "/" +
+                           TablebaseFileName(material);
+  absl::StatusOr<Tablebase> table = ReadTablebase(path);
+  if (table.ok()) {
+    tables.Add(*std::move(table));
+    return absl::OkStatus();
+  }
+
+  for (const TablebaseMaterial& conversion : material.Conversions()) {
+    const absl::Status status = LoadOrGenerate(conversion, tables);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  const auto start = std::chrono::steady_clock::now();
+  table = GenerateTablebase(material, tables, absl::GetFlag(FLAGS_threads));
+  if (!table.ok()) {
+    return table.status();
+  }
+  const absl::Status status = WriteTablebase(*table, path);
+  if (!status.ok()) {
+    return status;
+  }
+  std::cout << "Generated " << path << " in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count()
+            << " ms" << std::endl;
+  tables.Add(*std::move(table));
+  return absl::OkStatus();
+}
+
+} // namespace
+
+// Generates the tables of the endings given as arguments, e.g. "KQK KRKN", and
+// of all the smaller endings they lead to.
+int main(int argc, char* argv[]) {
+  const std::vector<char*> arguments = absl::ParseCommandLine(argc, argv);
+  TablebaseSet tables;
+  for (size_t i = 1; i < arguments.size(); ++i) {
+    absl::StatusOr<TablebaseMaterial> material =
+        TablebaseMaterial::Parse(arguments[i]);
+    absl::Status status = material.status();
+    if (status.ok()) {
+      status = LoadOrGenerate(*material, tables);
+    }
+    if (!status.ok()) {
+      std::cerr << status << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,149 @@
+#include "server/analysis_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_split.h"
+
+namespace {
+
+static constexpr char CANCEL_COMMAND[] = "cancel";
+
+TimeControl MoveTime(int64_t move_time_ms) {
+  TimeControl control;
+  control.move_time_ms = move_time_ms;
+  return control;
+}
+
+} // namespace
+
+AnalysisScheduler::ScheduledJob::ScheduledJob(AnalysisJob analysis_job,
+                                              TranspositionTable* table)
+    : job(std::move(analysis_job)), start(std::chrono::steady_clock::now()),
+      time_manager(MoveTime(job.move_time_ms)),
+      search(job.position.position, job.position.side_to_move,
+             [this]() {
+               SearchOptions options =
+                   AnalysisSearchOptions(job, &time_manager);
+               options.stop = &stop;
+               return options;
+             }(),
+             table) {}
+
+AnalysisScheduler::AnalysisScheduler(const AnalysisSchedulerOptions& options,
+                                     AnalysisServer::ResultCallback on_result)
+    : slice_nodes_(std::max<int64_t>(options.slice_nodes, 1)),
+      on_result_(std::move(on_result)),
+      table_(options.table_size_in_megabytes) {
+  for (int i = 0; i < std::max(options.threads, 1); ++i) {
+    threads_.emplace_back(&AnalysisScheduler::RunThread, this);
+  }
+}
+
+AnalysisScheduler::~AnalysisScheduler() { Shutdown(); }
+
+bool AnalysisScheduler::Submit(AnalysisJob job) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shutting_down_) {
+    return false;
+  }
+  jobs_.emplace_back(std::move(job), &table_);
+  ready_jobs_.push_back(std::prev(jobs_.end()));
+  job_ready_.notify_one();
+  return true;
+}
+
+int AnalysisScheduler::Cancel(const std::string& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int cancelled = 0;
+  for (ScheduledJob& scheduled_job : jobs_) {
+    if (scheduled_job.job.id == id) {
+      scheduled_job.stop = true;
+      ++cancelled;
+    }
+  }
+  return cancelled;
+}
+
+void AnalysisScheduler::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+    job_ready_.notify_all();
+  }
+  for (std::thread& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+void AnalysisScheduler::RunThread() {
+  while (true) {
+    JobIterator scheduled_job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_ready_.wait(lock, [this]() {
+        return !ready_jobs_.empty() || (shutting_down_ && jobs_.empty());
+      });
+      if (ready_jobs_.empty()) {
+        return;
+      }
+      scheduled_job = ready_jobs_.front();
+      ready_jobs_.pop_front();
+    }
+
+    // Only this thread accesses the job until it is back in the queue.
+    if (!scheduled_job->search.Resume(slice_nodes_)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_jobs_.push_back(scheduled_job);
+      job_ready_.notify_one();
+      continue;
+    }
+
+    on_result_(scheduled_job->job, scheduled_job->search.Result(),
+               std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - scheduled_job->start)
+                   .count());
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.erase(scheduled_job);
+    if (shutting_down_ && jobs_.empty()) {
+      job_ready_.notify_all();
+    }
+  }
+}
+
+void RunAnalysisScheduler(std::istream& input, std::ostream& output,
+                          const AnalysisSchedulerOptions& options) {
+  std::mutex output_mutex;
+  AnalysisScheduler scheduler(options, [&](const AnalysisJob& job,
+                                           const SearchResult& result,
+                                           int64_t elapsed_ms) {
+    const std::string formatted_result =
+        FormatAnalysisResult(job, result, elapsed_ms);
+    std::lock_guard<std::mutex> lock(output_mutex);
+    output << formatted_result << std::flush;
+  });
+
+  std::string line;
+  while (std::getline(input, line)) {
+    const std::vector<std::string> tokens =
+        absl::StrSplit(line, absl::ByAnyChar(" \t\r"), absl::SkipEmpty());
+    if (tokens.empty()) {
+      continue;
+    }
+    if (tokens.size() == 2 && tokens[0] == CANCEL_COMMAND) {
+      scheduler.Cancel(tokens[1]);
+      continue;
+    }
+    absl::StatusOr<AnalysisJob> job_or = ParseAnalysisJob(line);
+    if (job_or.ok()) {
+      scheduler.Submit(*std::move(job_or));
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(output_mutex);
+    output << tokens[0] << " error " << job_or.status().message() << std::endl;
+  }
+  scheduler.Shutdown();
+}
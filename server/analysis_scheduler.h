@@ -0,0 +1,98 @@
+#ifndef SERVER_ANALYSIS_SCHEDULER_H_
+#define SERVER_ANALYSIS_SCHEDULER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/search.h"
+#include "engine/time_manager.h"
+#include "engine/transposition_table.h"
+#include "server/analysis_server.h"
+
+struct AnalysisSchedulerOptions {
+  int threads = 1;
+  // Nodes a job searches before its thread moves on to the next job. The
+  // search suspends after the first move, at any node, that uses them up, so a
+  // slice only overruns them by the few nodes of that move.
+  int64_t slice_nodes = 4096;
+  // Shared by all the jobs.
+  size_t table_size_in_megabytes = 64;
+};
+
+// Runs any number of analysis jobs at once on a few threads. The threads take
+// turns between the jobs, searching each one for a slice of nodes before
+// moving on to the next one, so that all the jobs make progress and short jobs
+// don't wait for long ones. Unlike AnalysisServer, jobs are never queued
+// without being started, and they can be cancelled.
+//
+// A slice ends within the tree, see ResumableSearch, so however deep a job
+// goes, the other jobs never wait much longer than slice_nodes for their turn.
+//
+// Time limits run from the submission of a job, whether it is being searched
+// or waiting for its turn.
+class AnalysisScheduler {
+ public:
+  AnalysisScheduler(const AnalysisSchedulerOptions& options,
+                    AnalysisServer::ResultCallback on_result);
+  // Completes the submitted jobs, see Shutdown().
+  ~AnalysisScheduler();
+
+  // Doesn't block. Returns false if the scheduler is shut down.
+  bool Submit(AnalysisJob job);
+
+  // Stops the search of the jobs with this id, which complete with the result
+  // of their last completed iteration. Returns the number of jobs stopped.
+  int Cancel(const std::string& id);
+
+  // Completes the submitted jobs and stops the threads. No more jobs may be
+  // submitted.
+  void Shutdown();
+
+ private:
+  struct ScheduledJob {
+    ScheduledJob(AnalysisJob analysis_job, TranspositionTable* table);
+
+    AnalysisJob job;
+    std::chrono::steady_clock::time_point start;
+    TimeManager time_manager;
+    std::atomic<bool> stop{false};
+    ResumableSearch search;
+  };
+  using JobIterator = std::list<ScheduledJob>::iterator;
+
+  void RunThread();
+
+  const int64_t slice_nodes_;
+  AnalysisServer::ResultCallback on_result_;
+  TranspositionTable table_;
+
+  std::mutex mutex_;
+  std::condition_variable job_ready_;
+  // All the jobs not completed yet.
+  std::list<ScheduledJob> jobs_;
+  // Jobs waiting for their next slice, in turn.
+  std::deque<JobIterator> ready_jobs_;
+  bool shutting_down_ = false;
+
+  std::vector<std::thread> threads_;
+};
+
+// Same as RunAnalysisServer(), multiplexing the jobs on the threads of an
+// AnalysisScheduler. A request line of the form
+//   cancel <id>
+// stops the search of the jobs with this id.
+void RunAnalysisScheduler(std::istream& input, std::ostream& output,
+                          const AnalysisSchedulerOptions& options);
+
+#endif // SERVER_ANALYSIS_SCHEDULER_H_
@@ -0,0 +1,142 @@
+#include "server/analysis_scheduler.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "absl/strings/str_format.h"
+
+using ::testing::HasSubstr;
+
+namespace {
+
+AnalysisJob Job(const std::string& line) {
+  absl::StatusOr<AnalysisJob> job = ParseAnalysisJob(line);
+  EXPECT_TRUE(job.ok()) << job.status();
+  return *std::move(job);
+}
+
+} // namespace
+
+TEST(AnalysisScheduler, RunsManyJobsOnOneThread) {
+  AnalysisSchedulerOptions options;
+  options.slice_nodes = 64;
+  options.table_size_in_megabytes = 1;
+  std::mutex mutex;
+  std::set<std::string> completed;
+  {
+    AnalysisScheduler scheduler(options, [&](const AnalysisJob& job,
+                                             const SearchResult& result,
+                                             int64_t) {
+      EXPECT_TRUE(result.best_move.has_value()) << job.id;
+      EXPECT_EQ(result.depth, 3) << job.id;
+      std::lock_guard<std::mutex> lock(mutex);
+      completed.insert(job.id);
+    });
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_TRUE(
+          scheduler.Submit(Job(absl::StrFormat("%d depth 3 startpos", i))));
+    }
+    scheduler.Shutdown();
+    EXPECT_FALSE(scheduler.Submit(Job("late startpos")));
+  }
+
+  EXPECT_EQ(completed.size(), 100);
+}
+
+TEST(AnalysisScheduler, ShortJobCompletesWhileLongJobRuns) {
+  AnalysisSchedulerOptions options;
+  options.slice_nodes = 256;
+  options.table_size_in_megabytes = 1;
+  std::mutex mutex;
+  std::condition_variable completed_condition;
+  std::vector<std::string> completed;
+  int long_job_depth = 0;
+  AnalysisScheduler scheduler(options, [&](const AnalysisJob& job,
+                                           const SearchResult& result,
+                                           int64_t) {
+    std::lock_guard<std::mutex> lock(mutex);
+    completed.push_back(job.id);
+    if (job.id == "long") {
+      long_job_depth = result.depth;
+    }
+    completed_condition.notify_all();
+  });
+
+  ASSERT_TRUE(scheduler.Submit(Job("long depth 64 startpos")));
+  ASSERT_TRUE(scheduler.Submit(Job("short depth 2 startpos")));
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    completed_condition.wait(lock, [&]() { return !completed.empty(); });
+    EXPECT_EQ(completed, std::vector<std::string>({"short"}));
+  }
+  EXPECT_EQ(scheduler.Cancel("long"), 1);
+  EXPECT_EQ(scheduler.Cancel("unknown"), 0);
+  scheduler.Shutdown();
+
+  EXPECT_EQ(completed, std::vector<std::string>({"short", "long"}));
+  EXPECT_GE(long_job_depth, 1);
+  EXPECT_LT(long_job_depth, 64);
+}
+
+TEST(AnalysisScheduler, ShallowJobCompletesWithinADeepIteration) {
+  AnalysisSchedulerOptions options;
+  options.slice_nodes = 256;
+  options.table_size_in_megabytes = 1;
+  std::mutex mutex;
+  std::condition_variable completed_condition;
+  std::vector<std::string> completed;
+  int64_t shallow_job_elapsed_ms = 0;
+  AnalysisScheduler scheduler(options, [&](const AnalysisJob& job,
+                                           const SearchResult&,
+                                           int64_t elapsed_ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    completed.push_back(job.id);
+    if (job.id == "shallow") {
+      shallow_job_elapsed_ms = elapsed_ms;
+    }
+    completed_condition.notify_all();
+  });
+
+  // By then the deep job is well into an iteration whose root moves take far
+  // longer than a slice, and it has to suspend within one of them.
+  ASSERT_TRUE(scheduler.Submit(Job("deep depth 64 startpos")));
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  ASSERT_TRUE(scheduler.Submit(Job("shallow depth 1 startpos")));
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    completed_condition.wait(lock, [&]() { return !completed.empty(); });
+    EXPECT_EQ(completed, std::vector<std::string>({"shallow"}));
+    EXPECT_LT(shallow_job_elapsed_ms, 200);
+  }
+  EXPECT_EQ(scheduler.Cancel("deep"), 1);
+  scheduler.Shutdown();
+
+  EXPECT_EQ(completed, std::vector<std::string>({"shallow", "deep"}));
+}
+
+TEST(RunAnalysisScheduler, AnswersEveryRequest) {
+  std::istringstream input(
+      "mate depth 2 fen 6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1\n"
+      "forever depth 64 startpos\n"
+      "bad depth 2\n"
+      "cancel forever\n"
+      "stalemate fen 7k/5Q2/6K1/8/8/8/8/8 b - - 0 1\n");
+  std::ostringstream output;
+  AnalysisSchedulerOptions options;
+  options.threads = 2;
+  options.table_size_in_megabytes = 1;
+
+  RunAnalysisScheduler(input, output, options);
+
+  EXPECT_THAT(output.str(), HasSubstr("mate bestmove a1a8 depth 2 "));
+  EXPECT_THAT(output.str(), HasSubstr("forever bestmove "));
+  EXPECT_THAT(output.str(), HasSubstr("bad error Missing position\n"));
+  EXPECT_THAT(output.str(), HasSubstr("stalemate bestmove none "));
+}
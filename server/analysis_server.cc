@@ -0,0 +1,188 @@
+#include "server/analysis_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+
+#include "engine/time_manager.h"
+#include "engine/transposition_table.h"
+
+namespace {
+
+static constexpr int MAX_ANALYSIS_LINES = 256;
+
+std::string CoordinateNotation(const std::vector<Move>& moves) {
+  std::vector<std::string> notations;
+  for (const Move& move : moves) {
+    notations.push_back(move.ToCoordinateNotation());
+  }
+  return absl::StrJoin(notations, " ");
+}
+
+} // namespace
+
+AnalysisServer::AnalysisServer(const AnalysisServerOptions& options,
+                               ResultCallback on_result)
+    : on_result_(std::move(on_result)),
+      queue_(std::max<size_t>(options.queue_capacity, 1)) {
+  for (int i = 0; i < std::max(options.workers, 1); ++i) {
+    workers_.emplace_back(&AnalysisServer::RunWorker, this,
+                          options.table_size_in_megabytes);
+  }
+}
+
+AnalysisServer::~AnalysisServer() { Shutdown(); }
+
+bool AnalysisServer::Submit(AnalysisJob job) {
+  return queue_.Push(std::move(job));
+}
+
+void AnalysisServer::Shutdown() {
+  queue_.Close();
+  for (std::thread& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void AnalysisServer::RunWorker(size_t table_size_in_megabytes) {
+  // Entries of earlier jobs stay valid, as they are keyed by position, so the
+  // table isn't cleared between jobs.
+  TranspositionTable table(table_size_in_megabytes);
+  while (std::optional<AnalysisJob> job = queue_.Pop()) {
+    const auto start = std::chrono::steady_clock::now();
+    TimeControl control;
+    control.move_time_ms = job->move_time_ms;
+    const TimeManager time_manager(control);
+
+    const SearchResult result = SearchBestMove(
+        job->position.position, job->position.side_to_move,
+        AnalysisSearchOptions(*job, &time_manager), &table);
+
+    on_result_(*job, result,
+               std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count());
+  }
+}
+
+SearchOptions AnalysisSearchOptions(const AnalysisJob& job,
+                                    const TimeManager* time_manager) {
+  SearchOptions options;
+  options.depth = job.depth;
+  if (options.depth == 0) {
+    options.depth = job.max_nodes > 0 || job.move_time_ms > 0
+                        ? MAX_SEARCH_DEPTH
+                        : DEFAULT_ANALYSIS_DEPTH;
+  }
+  options.max_nodes = job.max_nodes;
+  options.time_manager = time_manager;
+  options.multi_pv = job.multi_pv;
+  return options;
+}
+
+absl::StatusOr<AnalysisJob> ParseAnalysisJob(const std::string& line) {
+  const std::vector<std::string> tokens =
+      absl::StrSplit(line, absl::ByAnyChar(" \t\r"), absl::SkipEmpty());
+  if (tokens.empty()) {
+    return absl::InvalidArgumentError("Empty request");
+  }
+  AnalysisJob job;
+  job.id = tokens[0];
+  for (size_t i = 1; i < tokens.size(); ++i) {
+    const std::string& name = tokens[i];
+    if (name == "startpos") {
+      job.position = *ParseFen(STARTING_POSITION_FEN);
+      return job;
+    }
+    if (name == "fen") {
+      absl::StatusOr<FenPosition> fen_position_or = ParseFen(
+          absl::StrJoin(tokens.begin() + i + 1, tokens.end(), " "));
+      if (!fen_position_or.ok()) {
+        return fen_position_or.status();
+      }
+      job.position = *std::move(fen_position_or);
+      return job;
+    }
+    int64_t value;
+    if (i + 1 == tokens.size() || !absl::SimpleAtoi(tokens[i + 1], &value) ||
+        value <= 0) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected a positive number after \"%s\"", name));
+    }
+    ++i;
+    if (name == "depth") {
+      job.depth = static_cast<int>(std::min<int64_t>(value, MAX_SEARCH_DEPTH));
+    } else if (name == "nodes") {
+      job.max_nodes = value;
+    } else if (name == "movetime") {
+      job.move_time_ms = value;
+    } else if (name == "multipv") {
+      job.multi_pv =
+          static_cast<int>(std::min<int64_t>(value, MAX_ANALYSIS_LINES));
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unknown limit: \"%s\"", name));
+    }
+  }
+  return absl::InvalidArgumentError("Missing position");
+}
+
+std::string FormatAnalysisResult(const AnalysisJob& job,
+                                 const SearchResult& result,
+                                 int64_t elapsed_ms) {
+  std::string output;
+  for (size_t i = 0; i < result.lines.size(); ++i) {
+    const SearchLine& line = result.lines[i];
+    const int mate_in_moves = MateInMoves(line.score);
+    absl::StrAppendFormat(
+        &output, "%s info multipv %d score %s pv %s\n", job.id, i + 1,
+        mate_in_moves != 0 ? absl::StrFormat("mate %d", mate_in_moves)
+                           : absl::StrFormat("cp %d", line.score),
+        CoordinateNotation(line.principal_variation));
+  }
+  absl::StrAppendFormat(
+      &output, "%s bestmove %s depth %d nodes %d time %d\n", job.id,
+      result.best_move.has_value() ? result.best_move->ToCoordinateNotation()
+                                   : "none",
+      result.depth, result.nodes, elapsed_ms);
+  return output;
+}
+
+void RunAnalysisServer(std::istream& input, std::ostream& output,
+                       const AnalysisServerOptions& options) {
+  std::mutex output_mutex;
+  AnalysisServer server(options, [&](const AnalysisJob& job,
+                                     const SearchResult& result,
+                                     int64_t elapsed_ms) {
+    const std::string formatted_result =
+        FormatAnalysisResult(job, result, elapsed_ms);
+    std::lock_guard<std::mutex> lock(output_mutex);
+    output << formatted_result << std::flush;
+  });
+
+  std::string line;
+  while (std::getline(input, line)) {
+    absl::StatusOr<AnalysisJob> job_or = ParseAnalysisJob(line);
+    if (job_or.ok()) {
+      server.Submit(*std::move(job_or));
+      continue;
+    }
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    const std::vector<std::string> tokens =
+        absl::StrSplit(line, absl::ByAnyChar(" \t\r"), absl::SkipEmpty());
+    std::lock_guard<std::mutex> lock(output_mutex);
+    output << tokens[0] << " error " << job_or.status().message() << std::endl;
+  }
+  server.Shutdown();
+}
@@ -0,0 +1,99 @@
+#ifndef SERVER_ANALYSIS_SERVER_H_
+#define SERVER_ANALYSIS_SERVER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+#include "engine/fen.h"
+#include "engine/search.h"
+#include "engine/time_manager.h"
+#include "server/bounded_queue.h"
+
+// A position to analyze, with the limits of its search. Without any limit, the
+// position is searched to DEFAULT_ANALYSIS_DEPTH.
+struct AnalysisJob {
+  // Chosen by the client to match results with jobs, which may complete out
+  // of order.
+  std::string id;
+  FenPosition position;
+  // Zero for no limit.
+  int depth = 0;
+  int64_t max_nodes = 0;
+  int64_t move_time_ms = 0;
+  int multi_pv = 1;
+};
+
+static constexpr int DEFAULT_ANALYSIS_DEPTH = 6;
+
+struct AnalysisServerOptions {
+  int workers = 1;
+  // Jobs submitted while this many are waiting block the submitter.
+  size_t queue_capacity = 1024;
+  // Each worker has its own table, kept across jobs.
+  size_t table_size_in_megabytes = 16;
+};
+
+// Analyzes positions on a pool of worker threads. Each worker searches one
+// job at a time on a single thread, which keeps many small jobs from fighting
+// over the same cores.
+class AnalysisServer {
+ public:
+  // Called from the worker threads as jobs complete, possibly concurrently.
+  using ResultCallback = std::function<void(
+      const AnalysisJob& job, const SearchResult& result, int64_t elapsed_ms)>;
+
+  AnalysisServer(const AnalysisServerOptions& options,
+                 ResultCallback on_result);
+  // Completes the submitted jobs, see Shutdown().
+  ~AnalysisServer();
+
+  // Blocks while the queue is full. Returns false if the server is shut down.
+  bool Submit(AnalysisJob job);
+
+  // Completes the submitted jobs and stops the workers. No more jobs may be
+  // submitted.
+  void Shutdown();
+
+ private:
+  void RunWorker(size_t table_size_in_megabytes);
+
+  ResultCallback on_result_;
+  BoundedQueue<AnalysisJob> queue_;
+  std::vector<std::thread> workers_;
+};
+
+// Search limits of a job. `time_manager` enforces the move time of the job.
+SearchOptions AnalysisSearchOptions(const AnalysisJob& job,
+                                    const TimeManager* time_manager);
+
+// Parses a request line of the form
+//   <id> [depth <plies>] [nodes <count>] [movetime <ms>] [multipv <lines>]
+//       (fen <fen> | startpos)
+absl::StatusOr<AnalysisJob> ParseAnalysisJob(const std::string& line);
+
+// Formats the result of a job as one line per principal variation,
+//   <id> info multipv <line> score (cp <centipawns> | mate <moves>) pv <moves>
+// followed by
+//   <id> bestmove <move> depth <plies> nodes <count> time <ms>
+// where the best move is "none" if there are no legal moves. Moves are in
+// coordinate notation.
+std::string FormatAnalysisResult(const AnalysisJob& job,
+                                 const SearchResult& result,
+                                 int64_t elapsed_ms);
+
+// Serves requests read line by line from `input`, and writes the results to
+// `output` as they complete. Malformed requests are answered with
+//   <id> error <message>
+// Returns once all the requests are answered after the end of input.
+void RunAnalysisServer(std::istream& input, std::ostream& output,
+                       const AnalysisServerOptions& options);
+
+#endif // SERVER_ANALYSIS_SERVER_H_
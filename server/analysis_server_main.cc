@@ -0,0 +1,42 @@
+#include <iostream>
+#include <thread>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+
+#include "server/analysis_scheduler.h"
+#include "server/analysis_server.h"
+
+ABSL_FLAG(int, workers, std::thread::hardware_concurrency(),
+          "Number of positions analyzed in parallel.");
+ABSL_FLAG(int, queue_capacity, 1024,
+          "Number of requests read ahead before reading blocks.");
+ABSL_FLAG(int, hash, 16, "Transposition table size per worker, in MB.");
+ABSL_FLAG(int64_t, slice_nodes, 0,
+          "If positive, all the requests are analyzed at once, each worker "
+          "taking turns between them after at least this many nodes, at the "
+          "end of a root move. Requests can then be cancelled with "
+          "\"cancel <id>\", and the table is shared by all the workers.");
+
+// Reads analysis requests from stdin and writes results to stdout, see
+// RunAnalysisServer() for the protocol.
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
+  std::ios::sync_with_stdio(false);
+
+  if (absl::GetFlag(FLAGS_slice_nodes) > 0) {
+    AnalysisSchedulerOptions options;
+    options.threads = absl::GetFlag(FLAGS_workers);
+    options.slice_nodes = absl::GetFlag(FLAGS_slice_nodes);
+    options.table_size_in_megabytes = absl::GetFlag(FLAGS_hash);
+    RunAnalysisScheduler(std::cin, std::cout, options);
+    return 0;
+  }
+
+  AnalysisServerOptions options;
+  options.workers = absl::GetFlag(FLAGS_workers);
+  options.queue_capacity = absl::GetFlag(FLAGS_queue_capacity);
+  options.table_size_in_megabytes = absl::GetFlag(FLAGS_hash);
+  RunAnalysisServer(std::cin, std::cout, options);
+  return 0;
+}
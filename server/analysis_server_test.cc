@@ -0,0 +1,109 @@
+#include "server/analysis_server.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <sstream>
+
+#include "absl/strings/str_format.h"
+
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+TEST(ParseAnalysisJob, LimitsAndFen) {
+  absl::StatusOr<AnalysisJob> job = ParseAnalysisJob(
+      "job-1 depth 4 nodes 1000 movetime 50 multipv 2 fen "
+      "4k3/8/8/8/8/8/4P3/4K3 b - - 0 1");
+
+  ASSERT_TRUE(job.ok()) << job.status();
+  EXPECT_EQ(job->id, "job-1");
+  EXPECT_EQ(job->depth, 4);
+  EXPECT_EQ(job->max_nodes, 1000);
+  EXPECT_EQ(job->move_time_ms, 50);
+  EXPECT_EQ(job->multi_pv, 2);
+  EXPECT_EQ(job->position.side_to_move, Color::BLACK);
+  EXPECT_EQ(PopCount(job->position.position.Occupancy()), 3);
+}
+
+TEST(ParseAnalysisJob, StartingPositionWithoutLimits) {
+  absl::StatusOr<AnalysisJob> job = ParseAnalysisJob("7 startpos");
+
+  ASSERT_TRUE(job.ok()) << job.status();
+  EXPECT_EQ(job->id, "7");
+  EXPECT_EQ(job->depth, 0);
+  EXPECT_EQ(PopCount(job->position.position.Occupancy()), 32);
+}
+
+TEST(ParseAnalysisJob, MalformedRequestsGiveErrors) {
+  EXPECT_FALSE(ParseAnalysisJob("").ok());
+  EXPECT_FALSE(ParseAnalysisJob("1 depth 4").ok());
+  EXPECT_FALSE(ParseAnalysisJob("1 depth startpos").ok());
+  EXPECT_FALSE(ParseAnalysisJob("1 depth -3 startpos").ok());
+  EXPECT_FALSE(ParseAnalysisJob("1 width 3 startpos").ok());
+  EXPECT_FALSE(ParseAnalysisJob("1 fen 8/8/8 w - - 0 1").ok());
+}
+
+TEST(FormatAnalysisResult, ListsLinesThenBestMove) {
+  AnalysisJob job;
+  job.id = "a";
+  SearchResult result;
+  result.best_move = Move(A, ONE, A, EIGHT);
+  result.depth = 3;
+  result.nodes = 120;
+  result.lines = {{MATE_SCORE - 1, {Move(A, ONE, A, EIGHT)}},
+                  {25, {Move(G, ONE, F, ONE), Move(G, EIGHT, F, EIGHT)}}};
+
+  EXPECT_EQ(FormatAnalysisResult(job, result, 5),
+            "a info multipv 1 score mate 1 pv a1a8\n"
+            "a info multipv 2 score cp 25 pv g1f1 g8f8\n"
+            "a bestmove a1a8 depth 3 nodes 120 time 5\n");
+}
+
+TEST(AnalysisServer, CompletesAllJobsThroughAFullQueue) {
+  AnalysisServerOptions options;
+  options.workers = 2;
+  options.queue_capacity = 1;
+  options.table_size_in_megabytes = 1;
+  std::atomic<int> completed(0);
+  {
+    AnalysisServer server(options, [&](const AnalysisJob& job,
+                                       const SearchResult& result, int64_t) {
+      EXPECT_TRUE(result.best_move.has_value()) << job.id;
+      ++completed;
+    });
+    for (int i = 0; i < 20; ++i) {
+      absl::StatusOr<AnalysisJob> job =
+          ParseAnalysisJob(absl::StrFormat("%d depth 2 startpos", i));
+      ASSERT_TRUE(job.ok());
+      EXPECT_TRUE(server.Submit(*job));
+    }
+    server.Shutdown();
+    EXPECT_FALSE(server.Submit(AnalysisJob()));
+  }
+
+  EXPECT_EQ(completed, 20);
+}
+
+TEST(RunAnalysisServer, AnswersEveryRequest) {
+  std::istringstream input(
+      "mate depth 2 fen 6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1\n"
+      "\n"
+      "bad depth 2\n"
+      "nodes nodes 500 startpos\n"
+      "stalemate fen 7k/5Q2/6K1/8/8/8/8/8 b - - 0 1\n");
+  std::ostringstream output;
+  AnalysisServerOptions options;
+  options.workers = 3;
+  options.table_size_in_megabytes = 1;
+
+  RunAnalysisServer(input, output, options);
+
+  EXPECT_THAT(output.str(),
+              HasSubstr("mate info multipv 1 score mate 1 pv a1a8\n"));
+  EXPECT_THAT(output.str(), HasSubstr("mate bestmove a1a8 depth 2 "));
+  EXPECT_THAT(output.str(), HasSubstr("bad error Missing position\n"));
+  EXPECT_THAT(output.str(), HasSubstr("nodes bestmove "));
+  EXPECT_THAT(output.str(), HasSubstr("stalemate bestmove none "));
+}
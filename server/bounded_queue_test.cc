@@ -0,0 +1,71 @@
+#include "server/bounded_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST(BoundedQueue, ItemsComeOutInOrder) {
+  BoundedQueue<int> queue(3);
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_TRUE(queue.Push(2));
+  EXPECT_TRUE(queue.TryPush(3));
+
+  EXPECT_EQ(queue.Size(), 3);
+  EXPECT_EQ(queue.Pop(), 1);
+  EXPECT_EQ(queue.Pop(), 2);
+  EXPECT_EQ(queue.Pop(), 3);
+}
+
+TEST(BoundedQueue, TryPushFailsWhenFull) {
+  BoundedQueue<int> queue(1);
+  EXPECT_TRUE(queue.TryPush(1));
+  EXPECT_FALSE(queue.TryPush(2));
+}
+
+TEST(BoundedQueue, PushBlocksUntilThereIsRoom) {
+  BoundedQueue<int> queue(1);
+  queue.Push(1);
+  std::atomic<bool> pushed(false);
+  std::thread producer([&]() {
+    queue.Push(2);
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(pushed);
+
+  EXPECT_EQ(queue.Pop(), 1);
+  producer.join();
+  EXPECT_TRUE(pushed);
+  EXPECT_EQ(queue.Pop(), 2);
+}
+
+TEST(BoundedQueue, CloseDrainsRemainingItems) {
+  BoundedQueue<int> queue(2);
+  queue.Push(1);
+  queue.Close();
+
+  EXPECT_FALSE(queue.Push(2));
+  EXPECT_EQ(queue.Pop(), 1);
+  EXPECT_EQ(queue.Pop(), std::nullopt);
+}
+
+TEST(BoundedQueue, CloseWakesUpConsumers) {
+  BoundedQueue<int> queue(2);
+  std::vector<std::thread> consumers;
+  std::atomic<int> finished(0);
+  for (int i = 0; i < 4; ++i) {
+    consumers.emplace_back([&]() {
+      EXPECT_EQ(queue.Pop(), std::nullopt);
+      ++finished;
+    });
+  }
+  queue.Close();
+  for (std::thread& consumer : consumers) {
+    consumer.join();
+  }
+
+  EXPECT_EQ(finished, 4);
+}
@@ -0,0 +1,137 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+
+#include "tools/tournament.h"
+
+ABSL_FLAG(std::string, first, "name=first",
+          "Settings of the first engine, see ParsePlayerOptions().");
+ABSL_FLAG(std::string, second, "name=second",
+          "Settings of the second engine, see ParsePlayerOptions().");
+ABSL_FLAG(int64_t, games, 100, "Maximum number of games to play.");
+ABSL_FLAG(int, concurrency, std::thread::hardware_concurrency(),
+          "Number of games played in parallel.");
+ABSL_FLAG(std::string, openings, "",
+          "File of FEN or EPD positions to start games from, each played "
+          "with both colors. Games start from the initial position if empty.");
+ABSL_FLAG(std::string, pgn, "", "File the games are appended to in PGN.");
+ABSL_FLAG(int, max_plies, 400, "Games are drawn after this many plies.");
+ABSL_FLAG(int, win_score, 1000,
+          "Games are won once both engines agree the score is this high.");
+ABSL_FLAG(int, win_moves, 4,
+          "Number of moves each engine must agree on a win, zero to never "
+          "adjudicate wins.");
+ABSL_FLAG(int, draw_score, 10,
+          "Games are drawn once both engines agree the score is this close "
+          "to zero.");
+ABSL_FLAG(int, draw_moves, 8,
+          "Number of moves each engine must agree on a draw, zero to never "
+          "adjudicate draws.");
+ABSL_FLAG(int, draw_min_plies, 80, "Games are never adjudicated as draws "
+                                   "before this many plies.");
+ABSL_FLAG(bool, sprt, false,
+          "Stops once a sequential probability ratio test decides between "
+          "--elo0 and --elo1.");
+ABSL_FLAG(double, elo0, 0, "Elo difference of the null hypothesis.");
+ABSL_FLAG(double, elo1, 5, "Elo difference of the alternative hypothesis.");
+ABSL_FLAG(double, alpha, 0.05, "False positive rate of the test.");
+ABSL_FLAG(double, beta, 0.05, "False negative rate of the test.");
+
+// Plays games between two settings of the engine, and reports the score of
+// the first one.
+int main(int argc, char* argv[]) {
+  absl::ParseCommandLine(argc, argv);
+
+  TournamentOptions options;
+  for (const auto& [flag, player] :
+       {std::pair(&FLAGS_first, &options.first),
+        std::pair(&FLAGS_second, &options.second)}) {
+    absl::StatusOr<PlayerOptions> player_or =
+        ParsePlayerOptions(absl::GetFlag(*flag));
+    if (!player_or.ok()) {
+      std::cerr << player_or.status() << std::endl;
+      return 1;
+    }
+    *player = *std::move(player_or);
+  }
+  options.games = absl::GetFlag(FLAGS_games);
+  options.concurrency = absl::GetFlag(FLAGS_concurrency);
+  options.adjudication.max_plies = absl::GetFlag(FLAGS_max_plies);
+  options.adjudication.win_score = absl::GetFlag(FLAGS_win_score);
+  options.adjudication.win_moves = absl::GetFlag(FLAGS_win_moves);
+  options.adjudication.draw_score = absl::GetFlag(FLAGS_draw_score);
+  options.adjudication.draw_moves = absl::GetFlag(FLAGS_draw_moves);
+  options.adjudication.draw_min_plies = absl::GetFlag(FLAGS_draw_min_plies);
+  options.sprt.enabled = absl::GetFlag(FLAGS_sprt);
+  options.sprt.elo0 = absl::GetFlag(FLAGS_elo0);
+  options.sprt.elo1 = absl::GetFlag(FLAGS_elo1);
+  options.sprt.alpha = absl::GetFlag(FLAGS_alpha);
+  options.sprt.beta = absl::GetFlag(FLAGS_beta);
+
+  const std::string openings_path = absl::GetFlag(FLAGS_openings);
+  if (!openings_path.empty()) {
+    std::ifstream openings_file(openings_path);
+    if (!openings_file) {
+      std::cerr << "Couldn't open " << openings_path << std::endl;
+      return 1;
+    }
+    absl::StatusOr<std::vector<FenPosition>> openings_or =
+        ReadOpenings(openings_file);
+    if (!openings_or.ok()) {
+      std::cerr << openings_or.status() << std::endl;
+      return 1;
+    }
+    options.openings = *std::move(openings_or);
+  }
+
+  std::ofstream pgn_file;
+  const std::string pgn_path = absl::GetFlag(FLAGS_pgn);
+  if (!pgn_path.empty()) {
+    pgn_file.open(pgn_path, std::ios::app);
+    if (!pgn_file) {
+      std::cerr << "Couldn't open " << pgn_path << std::endl;
+      return 1;
+    }
+  }
+
+  const TournamentScore score = RunTournament(
+      options, [&](const SelfPlayGame& game, const TournamentScore& score) {
+        if (pgn_file.is_open()) {
+          pgn_file << FormatPgn(game) << std::flush;
+        }
+        std::cout << absl::StrFormat(
+                         "Game %d: %s - %s, %s by %s. Score %d-%d-%d, "
+                         "Elo %+.1f, LLR %.2f",
+                         game.index + 1, game.white, game.black,
+                         game.result == GameResult::DRAW ? "draw"
+                         : game.result == GameResult::WHITE_WINS
+                             ? "white wins"
+                             : "black wins",
+                         game.termination, score.wins, score.draws,
+                         score.losses, score.EloDifference(),
+                         SprtLogLikelihoodRatio(score, options.sprt))
+                  << std::endl;
+      });
+
+  if (options.sprt.enabled) {
+    switch (DecideSprt(score, options.sprt)) {
+    case SprtDecision::ACCEPT_ELO0:
+      std::cout << "SPRT accepted elo0" << std::endl;
+      break;
+    case SprtDecision::ACCEPT_ELO1:
+      std::cout << "SPRT accepted elo1" << std::endl;
+      break;
+    default:
+      std::cout << "SPRT undecided" << std::endl;
+    }
+  }
+  return 0;
+}
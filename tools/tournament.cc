@@ -0,0 +1,484 @@
+#include "tools/tournament.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+
+#include "engine/arena.h"
+#include "engine/game.h"
+#include "engine/game_engine.h"
+#include "engine/time_manager.h"
+
+namespace {
+
+static constexpr int PGN_LINE_WIDTH = 80;
+
+char PieceLetter(Kind kind) {
+  switch (kind) {
+  case Kind::KING:
+    return 'K';
+  case Kind::QUEEN:
+    return 'Q';
+  case Kind::BISHOP:
+    return 'B';
+  case Kind::KNIGHT:
+    return 'N';
+  case Kind::ROOK:
+    return 'R';
+  default:
+    return '?';
+  }
+}
+
+std::string SquareName(const Square& square) {
+  return absl::StrFormat("%c%c", 'a' + square.file, '1' + square.rank);
+}
+
+// Standard algebraic notation of a legal move, which ParseAlgebraicNotation()
+// reads back once the check marks are stripped.
+std::string ToStandardAlgebraicNotation(const Position& position, Color color,
+                                        const Move& move,
+                                        const MoveList& legal_moves) {
+  const Piece piece = position.GetPiece(move.From());
+  std::string notation;
+  if (piece.Kind() == Kind::KING &&
+      std::abs(move.From().file - move.To().file) > 1) {
+    notation = move.To().file == G ? "O-O" : "O-O-O";
+  } else {
+    const bool capture = move.IsACapture();
+    if (piece.Kind() == Kind::PAWN) {
+      if (capture) {
+        notation += static_cast<char>('a' + move.From().file);
+      }
+    } else {
+      notation += PieceLetter(piece.Kind());
+      // Names the source file, rank or both if other pieces of the same kind
+      // can reach the same square.
+      bool ambiguous = false;
+      bool same_file = false;
+      bool same_rank = false;
+      for (const Move& other : legal_moves) {
+        if (other.To() == move.To() && !(other.From() == move.From()) &&
+            position.GetPiece(other.From()).Kind() == piece.Kind()) {
+          ambiguous = true;
+          same_file |= other.From().file == move.From().file;
+          same_rank |= other.From().rank == move.From().rank;
+        }
+      }
+      if (ambiguous && (!same_file || same_rank)) {
+        notation += static_cast<char>('a' + move.From().file);
+      }
+      if (ambiguous && same_file) {
+        notation += static_cast<char>('1' + move.From().rank);
+      }
+    }
+    if (capture) {
+      notation += 'x';
+    }
+    notation += SquareName(move.To());
+    if (move.Promotion() != Kind::NONE) {
+      notation += '=';
+      notation += PieceLetter(move.Promotion());
+    }
+  }
+
+  Position after = position;
+  after.MakeMove(move.From(), move.To(), move.Promotion());
+  const Color opponent = OppositeColor(color);
+  if (IsInCheck(after, opponent)) {
+    notation += GenerateLegalMoves(after, opponent).empty() ? '#' : '+';
+  }
+  return notation;
+}
+
+// Consecutive moves of both engines agreeing on a win or a draw.
+class Adjudicator {
+ public:
+  explicit Adjudicator(const AdjudicationOptions& options)
+      : options_(options) {}
+
+  // Records the score of the move about to be made at `ply`, from the point
+  // of view of `color`. Returns the result once it is clear.
+  std::optional<GameResult> Record(int ply, Color color, int score) {
+    const int white_score = color == Color::WHITE ? score : -score;
+    white_wins_ = white_score >= options_.win_score ? white_wins_ + 1 : 0;
+    black_wins_ = -white_score >= options_.win_score ? black_wins_ + 1 : 0;
+    draws_ = ply >= options_.draw_min_plies &&
+                     std::abs(white_score) <= options_.draw_score
+                 ? draws_ + 1
+                 : 0;
+    // Both engines make a move each per two plies.
+    if (options_.win_moves > 0 && white_wins_ >= 2 * options_.win_moves) {
+      return GameResult::WHITE_WINS;
+    }
+    if (options_.win_moves > 0 && black_wins_ >= 2 * options_.win_moves) {
+      return GameResult::BLACK_WINS;
+    }
+    if (options_.draw_moves > 0 && draws_ >= 2 * options_.draw_moves) {
+      return GameResult::DRAW;
+    }
+    return std::nullopt;
+  }
+
+ private:
+  const AdjudicationOptions& options_;
+  int white_wins_ = 0;
+  int black_wins_ = 0;
+  int draws_ = 0;
+};
+
+SearchResult SearchMove(const Game& game, const PlayerOptions& player,
+                        TranspositionTable* table) {
+  TimeControl control;
+  control.move_time_ms = player.move_time_ms;
+  const TimeManager time_manager(control);
+  SearchOptions options = player.search;
+  options.time_manager = &time_manager;
+  options.threads = 1;
+  options.multi_pv = 1;
+  options.on_iteration = nullptr;
+  options.game_hashes = game.ReversibleHashes();
+  options.halfmove_clock = game.HalfmoveClock();
+  return SearchBestMove(game.Position(), game.ActivePlayerColor(), options,
+                        table);
+}
+
+std::string ResultString(GameResult result) {
+  switch (result) {
+  case GameResult::WHITE_WINS:
+    return "1-0";
+  case GameResult::BLACK_WINS:
+    return "0-1";
+  default:
+    return "1/2-1/2";
+  }
+}
+
+bool ParseFlag(const std::string& value, bool* flag) {
+  if (value == "1" || value == "true") {
+    *flag = true;
+  } else if (value == "0" || value == "false") {
+    *flag = false;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+absl::StatusOr<PlayerOptions> ParsePlayerOptions(const std::string& spec) {
+  PlayerOptions player;
+  player.search.depth = 0;
+  const std::vector<std::string> settings =
+      absl::StrSplit(spec, ',', absl::SkipEmpty());
+  for (const std::string& setting : settings) {
+    const std::vector<std::string> key_value =
+        absl::StrSplit(setting, absl::MaxSplits('=', 1));
+    if (key_value.size() != 2 || key_value[1].empty()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected key=value, got \"%s\"", setting));
+    }
+    const std::string& key = key_value[0];
+    const std::string& value = key_value[1];
+    if (key == "name") {
+      player.name = value;
+      continue;
+    }
+    bool parsed = false;
+    if (key == "nullmove") {
+      parsed = ParseFlag(value, &player.search.null_move_pruning);
+    } else if (key == "lmr") {
+      parsed = ParseFlag(value, &player.search.late_move_reductions);
+    } else if (key == "futility") {
+      parsed = ParseFlag(value, &player.search.futility_pruning);
+    } else if (key == "aspiration") {
+      parsed = ParseFlag(value, &player.search.aspiration_windows);
+    } else {
+      int64_t number;
+      if (!absl::SimpleAtoi(value, &number) || number <= 0) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Expected a positive number for \"%s\", got \"%s\"", key, value));
+      }
+      parsed = true;
+      if (key == "depth") {
+        player.search.depth =
+            static_cast<int>(std::min<int64_t>(number, MAX_SEARCH_DEPTH));
+      } else if (key == "nodes") {
+        player.search.max_nodes = number;
+      } else if (key == "movetime") {
+        player.move_time_ms = number;
+      } else if (key == "hash") {
+        player.table_size_in_megabytes = number;
+      } else {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Unknown player setting: \"%s\"", key));
+      }
+    }
+    if (!parsed) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Expected 0 or 1 for \"%s\", got \"%s\"", key, value));
+    }
+  }
+  if (player.search.depth == 0) {
+    player.search.depth = player.search.max_nodes > 0 || player.move_time_ms > 0
+                              ? MAX_SEARCH_DEPTH
+                              : DEFAULT_SELF_PLAY_DEPTH;
+  }
+  return player;
+}
+
+SelfPlayGame PlayGame(const FenPosition& opening, const PlayerOptions& white,
+                      const PlayerOptions& black,
+                      const AdjudicationOptions& adjudication,
+                      TranspositionTable* white_table,
+                      TranspositionTable* black_table) {
+  white_table->Clear();
+  black_table->Clear();
+  // Games run in parallel, so each generates moves in an arena of its thread.
+  ScopedArena arena;
+  SelfPlayGame record;
+  record.opening = opening;
+  record.white = white.name;
+  record.black = black.name;
+
+  Game game(opening.position, opening.side_to_move, opening.halfmove_clock,
+            opening.fullmove_number);
+  Adjudicator adjudicator(adjudication);
+  while (true) {
+    const Color color = game.ActivePlayerColor();
+    const MoveList legal_moves =
+        GenerateLegalMoves(game.Position(), color);
+    if (legal_moves.empty()) {
+      const bool checkmate = IsInCheck(game.Position(), color);
+      record.result = !checkmate            ? GameResult::DRAW
+                      : color == Color::WHITE ? GameResult::BLACK_WINS
+                                              : GameResult::WHITE_WINS;
+      record.termination = checkmate ? "checkmate" : "stalemate";
+      break;
+    }
+    if (game.IsThreefoldRepetition()) {
+      record.termination = "threefold repetition";
+      break;
+    }
+    if (game.IsFiftyMoveDraw()) {
+      record.termination = "fifty-move rule";
+      break;
+    }
+    if (game.Ply() >= adjudication.max_plies) {
+      record.termination = "move limit";
+      break;
+    }
+
+    const bool white_to_move = color == Color::WHITE;
+    const SearchResult result =
+        SearchMove(game, white_to_move ? white : black,
+                   white_to_move ? white_table : black_table);
+    if (const std::optional<GameResult> adjudicated =
+            adjudicator.Record(game.Ply(), color, result.score)) {
+      record.result = *adjudicated;
+      record.termination = "adjudication";
+      break;
+    }
+    const Move move(&game.Position(), result.best_move->From(),
+                    result.best_move->To(), result.best_move->Promotion());
+    record.moves.push_back(ToStandardAlgebraicNotation(
+        game.Position(), color, move, legal_moves));
+    game.MakeMove(move);
+  }
+  return record;
+}
+
+double TournamentScore::Fraction() const {
+  return Games() == 0 ? 0.5 : (wins + 0.5 * draws) / Games();
+}
+
+double TournamentScore::EloDifference() const {
+  const double fraction = Fraction();
+  if (fraction <= 0 || fraction >= 1) {
+    return fraction <= 0 ? -std::numeric_limits<double>::infinity()
+                         : std::numeric_limits<double>::infinity();
+  }
+  return -400 * std::log10(1 / fraction - 1);
+}
+
+double SprtLogLikelihoodRatio(const TournamentScore& score,
+                              const SprtOptions& sprt) {
+  const int64_t games = score.Games();
+  if (games == 0) {
+    return 0;
+  }
+  const double fraction = score.Fraction();
+  const double variance =
+      (score.wins * (1 - fraction) * (1 - fraction) +
+       score.draws * (0.5 - fraction) * (0.5 - fraction) +
+       score.losses * fraction * fraction) /
+      games;
+  if (variance <= 0) {
+    return 0;
+  }
+  const auto expected_fraction = [](double elo) {
+    return 1 / (1 + std::pow(10, -elo / 400));
+  };
+  const double fraction0 = expected_fraction(sprt.elo0);
+  const double fraction1 = expected_fraction(sprt.elo1);
+  return games * (fraction1 - fraction0) *
+         (2 * fraction - fraction0 - fraction1) / (2 * variance);
+}
+
+SprtDecision DecideSprt(const TournamentScore& score, const SprtOptions& sprt) {
+  const double ratio = SprtLogLikelihoodRatio(score, sprt);
+  if (ratio >= std::log((1 - sprt.beta) / sprt.alpha)) {
+    return SprtDecision::ACCEPT_ELO1;
+  }
+  if (ratio <= std::log(sprt.beta / (1 - sprt.alpha))) {
+    return SprtDecision::ACCEPT_ELO0;
+  }
+  return SprtDecision::CONTINUE;
+}
+
+TournamentScore RunTournament(const TournamentOptions& options,
+                              const GameCallback& on_game) {
+  std::vector<FenPosition> openings = options.openings;
+  if (openings.empty()) {
+    openings.push_back(*ParseFen(STARTING_POSITION_FEN));
+  }
+  std::atomic<int64_t> next_game = 0;
+  std::atomic<bool> stop = false;
+  std::mutex score_mutex;
+  TournamentScore score;
+
+  const auto run_worker = [&]() {
+    // Each player keeps its table across the games of the worker, which
+    // spares reallocating it for every game.
+    TranspositionTable first_table(options.first.table_size_in_megabytes);
+    TranspositionTable second_table(options.second.table_size_in_megabytes);
+    while (!stop) {
+      const int64_t index = next_game++;
+      if (index >= options.games) {
+        return;
+      }
+      const FenPosition& opening = openings[(index / 2) % openings.size()];
+      const bool first_is_white = index % 2 == 0;
+      SelfPlayGame game =
+          first_is_white
+              ? PlayGame(opening, options.first, options.second,
+                         options.adjudication, &first_table, &second_table)
+              : PlayGame(opening, options.second, options.first,
+                         options.adjudication, &second_table, &first_table);
+      game.index = index;
+
+      std::lock_guard<std::mutex> lock(score_mutex);
+      if (game.result == GameResult::DRAW) {
+        ++score.draws;
+      } else if ((game.result == GameResult::WHITE_WINS) == first_is_white) {
+        ++score.wins;
+      } else {
+        ++score.losses;
+      }
+      on_game(game, score);
+      if (options.sprt.enabled &&
+          DecideSprt(score, options.sprt) != SprtDecision::CONTINUE) {
+        stop = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < std::max(options.concurrency, 1); ++i) {
+    workers.emplace_back(run_worker);
+  }
+  run_worker();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return score;
+}
+
+absl::StatusOr<std::vector<FenPosition>> ReadOpenings(std::istream& input) {
+  std::vector<FenPosition> openings;
+  std::string line;
+  int line_number = 0;
+  while (std::getline(input, line)) {
+    ++line_number;
+    const std::vector<std::string> fields =
+        absl::StrSplit(line, absl::ByAnyChar(" \t\r"), absl::SkipEmpty());
+    if (fields.empty() || fields[0][0] == '#') {
+      continue;
+    }
+    // EPD has the first four FEN fields, followed by operations instead of
+    // the move counters.
+    size_t fen_fields = std::min<size_t>(fields.size(), 6);
+    int counter;
+    if (fen_fields == 6 && !(absl::SimpleAtoi(fields[4], &counter) &&
+                             absl::SimpleAtoi(fields[5], &counter))) {
+      fen_fields = 4;
+    }
+    absl::StatusOr<FenPosition> opening = ParseFen(
+        absl::StrJoin(fields.begin(), fields.begin() + fen_fields, " "));
+    if (!opening.ok()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Line %d: %s", line_number, opening.status().message()));
+    }
+    openings.push_back(*std::move(opening));
+  }
+  return openings;
+}
+
+std::string FormatPgn(const SelfPlayGame& game) {
+  const std::string result = ResultString(game.result);
+  std::string pgn;
+  absl::StrAppendFormat(&pgn, "[Event \"Self-play\"]\n");
+  absl::StrAppendFormat(&pgn, "[Round \"%d\"]\n", game.index + 1);
+  absl::StrAppendFormat(&pgn, "[White \"%s\"]\n", game.white);
+  absl::StrAppendFormat(&pgn, "[Black \"%s\"]\n", game.black);
+  absl::StrAppendFormat(&pgn, "[Result \"%s\"]\n", result);
+  const std::string fen = ToFen(game.opening);
+  if (fen != STARTING_POSITION_FEN) {
+    absl::StrAppendFormat(&pgn, "[SetUp \"1\"]\n[FEN \"%s\"]\n", fen);
+  }
+  absl::StrAppendFormat(&pgn, "[Termination \"%s\"]\n\n", game.termination);
+
+  std::vector<std::string> tokens;
+  Color color = game.opening.side_to_move;
+  int turn = game.opening.fullmove_number;
+  for (size_t i = 0; i < game.moves.size(); ++i) {
+    if (color == Color::WHITE) {
+      tokens.push_back(absl::StrFormat("%d.", turn));
+    } else if (i == 0) {
+      tokens.push_back(absl::StrFormat("%d...", turn));
+    }
+    tokens.push_back(game.moves[i]);
+    if (color == Color::BLACK) {
+      ++turn;
+    }
+    color = OppositeColor(color);
+  }
+  tokens.push_back(result);
+
+  size_t line_length = 0;
+  for (const std::string& token : tokens) {
+    if (line_length > 0 && line_length + 1 + token.size() > PGN_LINE_WIDTH) {
+      pgn += '\n';
+      line_length = 0;
+    } else if (line_length > 0) {
+      pgn += ' ';
+      ++line_length;
+    }
+    pgn += token;
+    line_length += token.size();
+  }
+  return pgn + "\n\n";
+}
@@ -0,0 +1,148 @@
+#ifndef TOOLS_TOURNAMENT_H_
+#define TOOLS_TOURNAMENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+#include "engine/fen.h"
+#include "engine/search.h"
+#include "engine/transposition_table.h"
+
+// Search settings of one of the two engines of a tournament, so that a change
+// to the search can be measured against the search without it.
+struct PlayerOptions {
+  std::string name = "engine";
+  // Only the depth, the node limit and the selective search techniques are
+  // used. Each player searches on a single thread, as games are played in
+  // parallel instead.
+  SearchOptions search;
+  // Zero for no time limit.
+  int64_t move_time_ms = 0;
+  size_t table_size_in_megabytes = 16;
+};
+
+// Parses comma separated settings, e.g. "name=base,nodes=20000,nullmove=0",
+// where the keys are name, depth, nodes, movetime, hash, and the flags
+// nullmove, lmr, futility and aspiration. Without a depth, node or time limit,
+// the player searches to DEFAULT_SELF_PLAY_DEPTH.
+absl::StatusOr<PlayerOptions> ParsePlayerOptions(const std::string& spec);
+
+static constexpr int DEFAULT_SELF_PLAY_DEPTH = 4;
+
+// Ends games early once their result is clear, which saves most of the time
+// otherwise spent in long won or drawn endings.
+struct AdjudicationOptions {
+  // A game is won once both engines agree for this many moves each that the
+  // score is at least this far in favor of the same side. Zero moves to turn
+  // off.
+  int win_score = 1000;
+  int win_moves = 4;
+  // A game is drawn once both engines agree for this many moves each that the
+  // score is within this of zero, after the first `draw_min_plies`.
+  int draw_score = 10;
+  int draw_moves = 8;
+  int draw_min_plies = 80;
+  // Games still going after this many plies are drawn.
+  int max_plies = 400;
+};
+
+enum class GameResult { WHITE_WINS, BLACK_WINS, DRAW };
+
+// A finished game, as it is written out.
+struct SelfPlayGame {
+  // Position in the tournament, starting from zero.
+  int64_t index = 0;
+  FenPosition opening;
+  std::string white;
+  std::string black;
+  // In standard algebraic notation, e.g. "Nf3" or "O-O".
+  std::vector<std::string> moves;
+  GameResult result = GameResult::DRAW;
+  // Why the game ended, e.g. "checkmate" or "adjudication".
+  std::string termination;
+};
+
+// Plays one game from `opening`, each player searching with its own table.
+// The tables are cleared first, so that games don't depend on each other.
+SelfPlayGame PlayGame(const FenPosition& opening, const PlayerOptions& white,
+                      const PlayerOptions& black,
+                      const AdjudicationOptions& adjudication,
+                      TranspositionTable* white_table,
+                      TranspositionTable* black_table);
+
+// Wins, draws and losses of the first player of a tournament.
+struct TournamentScore {
+  int64_t wins = 0;
+  int64_t draws = 0;
+  int64_t losses = 0;
+
+  int64_t Games() const { return wins + draws + losses; }
+  // Points scored per game, a win counting one and a draw half.
+  double Fraction() const;
+  // Elo difference matching Fraction(), infinite if all games are won or
+  // lost.
+  double EloDifference() const;
+};
+
+// Sequential probability ratio test of the hypothesis that the first player
+// is `elo1` stronger than the second, against the hypothesis that it is only
+// `elo0` stronger.
+struct SprtOptions {
+  bool enabled = false;
+  double elo0 = 0;
+  double elo1 = 5;
+  // Chances of accepting the first hypothesis when the second one holds, and
+  // the other way round.
+  double alpha = 0.05;
+  double beta = 0.05;
+};
+
+// Log-likelihood ratio of the two hypotheses, from a normal approximation of
+// the distribution of game results. Zero until the results vary.
+double SprtLogLikelihoodRatio(const TournamentScore& score,
+                              const SprtOptions& sprt);
+
+enum class SprtDecision { CONTINUE, ACCEPT_ELO0, ACCEPT_ELO1 };
+
+SprtDecision DecideSprt(const TournamentScore& score, const SprtOptions& sprt);
+
+struct TournamentOptions {
+  PlayerOptions first;
+  PlayerOptions second;
+  AdjudicationOptions adjudication;
+  SprtOptions sprt;
+  // Each opening is played twice in a row, with both colors, and openings are
+  // reused in order once they run out. Empty for the starting position only.
+  std::vector<FenPosition> openings;
+  // Upper bound, the SPRT may stop the tournament earlier.
+  int64_t games = 100;
+  // Number of games played at once, each on its own thread.
+  int concurrency = 1;
+};
+
+// Called once per game, one call at a time, with the score including the
+// game.
+using GameCallback =
+    std::function<void(const SelfPlayGame& game, const TournamentScore& score)>;
+
+// Plays the games of a tournament on a pool of threads, each playing one game
+// at a time with tables of its own. Games are handed out in order, but may
+// finish out of order. Returns the final score of the first player.
+TournamentScore RunTournament(const TournamentOptions& options,
+                              const GameCallback& on_game);
+
+// Reads one position per line, either in FEN or in EPD, where the move
+// counters are left out and operations may follow. Empty lines and lines
+// starting with '#' are skipped.
+absl::StatusOr<std::vector<FenPosition>> ReadOpenings(std::istream& input);
+
+// Formats a game in PGN, with its moves wrapped to 80 columns.
+std::string FormatPgn(const SelfPlayGame& game);
+
+#endif // TOOLS_TOURNAMENT_H_
@@ -0,0 +1,162 @@
+#include "tools/tournament.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <set>
+#include <sstream>
+
+using ::testing::HasSubstr;
+
+namespace {
+
+AdjudicationOptions NoAdjudication() {
+  AdjudicationOptions adjudication;
+  adjudication.win_moves = 0;
+  adjudication.draw_moves = 0;
+  return adjudication;
+}
+
+} // namespace
+
+TEST(ParsePlayerOptions, LimitsAndFlags) {
+  absl::StatusOr<PlayerOptions> player =
+      ParsePlayerOptions("name=base,nodes=2000,hash=4,nullmove=0,lmr=false");
+
+  ASSERT_TRUE(player.ok()) << player.status();
+  EXPECT_EQ(player->name, "base");
+  EXPECT_EQ(player->search.max_nodes, 2000);
+  EXPECT_EQ(player->search.depth, MAX_SEARCH_DEPTH);
+  EXPECT_EQ(player->table_size_in_megabytes, 4);
+  EXPECT_FALSE(player->search.null_move_pruning);
+  EXPECT_FALSE(player->search.late_move_reductions);
+  EXPECT_TRUE(player->search.futility_pruning);
+
+  EXPECT_EQ(ParsePlayerOptions("")->search.depth, DEFAULT_SELF_PLAY_DEPTH);
+  EXPECT_FALSE(ParsePlayerOptions("depth").ok());
+  EXPECT_FALSE(ParsePlayerOptions("depth=-1").ok());
+  EXPECT_FALSE(ParsePlayerOptions("lmr=maybe").ok());
+  EXPECT_FALSE(ParsePlayerOptions("width=3").ok());
+}
+
+TEST(ReadOpenings, FenAndEpdLines) {
+  std::istringstream input(
+      "# Openings\n"
+      "\n"
+      "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1\n"
+      "4k3/8/8/8/8/8/4P3/4K3 w - - bm e4; id \"pawn\";\n");
+  absl::StatusOr<std::vector<FenPosition>> openings = ReadOpenings(input);
+
+  ASSERT_TRUE(openings.ok()) << openings.status();
+  ASSERT_EQ(openings->size(), 2);
+  EXPECT_EQ((*openings)[0].side_to_move, Color::BLACK);
+  EXPECT_EQ((*openings)[1].side_to_move, Color::WHITE);
+
+  std::istringstream malformed("8/8/8 w - -\n");
+  EXPECT_FALSE(ReadOpenings(malformed).ok());
+}
+
+TEST(PlayGame, EndsInCheckmate) {
+  const FenPosition opening = *ParseFen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+  PlayerOptions player;
+  player.search.depth = 2;
+  TranspositionTable white_table(1);
+  TranspositionTable black_table(1);
+
+  const SelfPlayGame game = PlayGame(opening, player, player, NoAdjudication(),
+                                     &white_table, &black_table);
+
+  EXPECT_EQ(game.result, GameResult::WHITE_WINS);
+  EXPECT_EQ(game.termination, "checkmate");
+  EXPECT_EQ(game.moves, std::vector<std::string>{"Ra8#"});
+}
+
+TEST(PlayGame, AdjudicatesWinsAndLongGames) {
+  const FenPosition opening = *ParseFen("4k3/8/8/8/8/8/8/QQ2K3 w - - 0 1");
+  PlayerOptions player;
+  player.search.depth = 1;
+  TranspositionTable white_table(1);
+  TranspositionTable black_table(1);
+
+  const SelfPlayGame won = PlayGame(opening, player, player,
+                                    AdjudicationOptions(), &white_table,
+                                    &black_table);
+  EXPECT_EQ(won.result, GameResult::WHITE_WINS);
+  EXPECT_EQ(won.termination, "adjudication");
+
+  AdjudicationOptions adjudication = NoAdjudication();
+  adjudication.max_plies = 2;
+  const SelfPlayGame drawn =
+      PlayGame(*ParseFen(STARTING_POSITION_FEN), player, player, adjudication,
+               &white_table, &black_table);
+  EXPECT_EQ(drawn.result, GameResult::DRAW);
+  EXPECT_EQ(drawn.termination, "move limit");
+  EXPECT_EQ(drawn.moves.size(), 2);
+}
+
+TEST(Sprt, DecidesOnceResultsAreClear) {
+  SprtOptions sprt;
+  sprt.enabled = true;
+  EXPECT_EQ(SprtLogLikelihoodRatio(TournamentScore(), sprt), 0);
+
+  TournamentScore even{20000, 20000, 20000};
+  EXPECT_DOUBLE_EQ(even.Fraction(), 0.5);
+  EXPECT_DOUBLE_EQ(even.EloDifference(), 0);
+  EXPECT_EQ(DecideSprt(even, sprt), SprtDecision::ACCEPT_ELO0);
+
+  TournamentScore strong{1300, 1000, 700};
+  EXPECT_GT(strong.EloDifference(), 50);
+  EXPECT_EQ(DecideSprt(strong, sprt), SprtDecision::ACCEPT_ELO1);
+
+  TournamentScore few{3, 2, 1};
+  EXPECT_EQ(DecideSprt(few, sprt), SprtDecision::CONTINUE);
+}
+
+TEST(RunTournament, PlaysEachOpeningWithBothColors) {
+  TournamentOptions options;
+  options.first.name = "first";
+  options.first.search.depth = 1;
+  options.first.table_size_in_megabytes = 1;
+  options.second = options.first;
+  options.second.name = "second";
+  options.adjudication.max_plies = 6;
+  options.games = 4;
+  options.concurrency = 2;
+
+  std::mutex mutex;
+  std::set<int64_t> indices;
+  const TournamentScore score = RunTournament(
+      options, [&](const SelfPlayGame& game, const TournamentScore& score) {
+        std::lock_guard<std::mutex> lock(mutex);
+        indices.insert(game.index);
+        EXPECT_EQ(game.white, game.index % 2 == 0 ? "first" : "second");
+        EXPECT_EQ(game.moves.size(), 6);
+        EXPECT_EQ(score.Games(), indices.size());
+      });
+
+  EXPECT_EQ(score.Games(), 4);
+  EXPECT_EQ(score.draws, 4);
+  EXPECT_EQ(indices, (std::set<int64_t>{0, 1, 2, 3}));
+}
+
+TEST(FormatPgn, TagsAndNumberedMoves) {
+  SelfPlayGame game;
+  game.index = 2;
+  game.opening =
+      *ParseFen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1");
+  game.white = "first";
+  game.black = "second";
+  game.moves = {"e5", "Nf3", "Nc6"};
+  game.result = GameResult::DRAW;
+  game.termination = "move limit";
+
+  const std::string pgn = FormatPgn(game);
+
+  EXPECT_THAT(pgn, HasSubstr("[Round \"3\"]\n"));
+  EXPECT_THAT(pgn, HasSubstr("[White \"first\"]\n"));
+  EXPECT_THAT(pgn, HasSubstr("[Result \"1/2-1/2\"]\n"));
+  EXPECT_THAT(pgn, HasSubstr("[FEN \"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/"
+                             "RNBQKBNR b KQkq - 0 1\"]\n"));
+  EXPECT_THAT(pgn, HasSubstr("\n\n1... e5 2. Nf3 Nc6 1/2-1/2\n\n"));
+}
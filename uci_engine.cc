@@ -0,0 +1,9 @@
+#include <iostream>
+
+#include "engine/uci.h"
+
+int main() {
+  std::ios::sync_with_stdio(false);
+  RunUciLoop(std::cin, std::cout);
+  return 0;
+}